@@ -15,12 +15,15 @@ LOCAL_SRC_FILES := \
     AnimationController.cpp \
     AnimationTarget.cpp \
     AnimationValue.cpp \
+    AsyncLoader.cpp \
     AudioBuffer.cpp \
     AudioController.cpp \
     AudioListener.cpp \
     AudioSource.cpp \
+    AudioStream.cpp \
     BoundingBox.cpp \
     BoundingSphere.cpp \
+    BoundingVolumeTree.cpp \
     Bundle.cpp \
     Button.cpp \
     Camera.cpp \
@@ -45,23 +48,28 @@ LOCAL_SRC_FILES := \
 	ImageControl.cpp \
 	InAppPurchase.cpp \
 	InAppPurchaseAndroid.cpp \
+    InstancedModel.cpp \
     Joint.cpp \
     Joystick.cpp \
     Label.cpp \
     Layout.cpp \
     Light.cpp \
+    LightGrid.cpp \
     Logger.cpp \
     Material.cpp \
     MaterialParameter.cpp \
     MathUtil.cpp \
     Matrix.cpp \
+    MemoryStream.cpp \
     Mesh.cpp \
     MeshBatch.cpp \
     MeshPart.cpp \
     MeshSkin.cpp \
     Model.cpp \
     Node.cpp \
+    PackFile.cpp \
     ParticleEmitter.cpp \
+    ParticleSystem.cpp \
     Pass.cpp \
     PhysicsCharacter.cpp \
     PhysicsCollisionObject.cpp \
@@ -80,14 +88,18 @@ LOCAL_SRC_FILES := \
     Plane.cpp \
     Platform.cpp \
     PlatformAndroid.cpp \
+    Profiler.cpp \
+    ProgramCache.cpp \
     Properties.cpp \
     Quaternion.cpp \
     RadioButton.cpp \
     Ray.cpp \
     Rectangle.cpp \
     Ref.cpp \
+    RenderQueue.cpp \
     RenderState.cpp \
     RenderTarget.cpp \
+    ResourceCache.cpp \
     Scene.cpp \
     SceneLoader.cpp \
     ScreenDisplayer.cpp \
@@ -102,6 +114,7 @@ LOCAL_SRC_FILES := \
     Texture.cpp \
     Theme.cpp \
     ThemeStyle.cpp \
+    ThreadPool.cpp \
     Transform.cpp \
     Vector2.cpp \
     Vector3.cpp \
@@ -283,6 +296,7 @@ LOCAL_SRC_FILES := \
     
 LOCAL_CFLAGS := -D__ANDROID__ -I"../external-deps/lua/include" -I"../external-deps/bullet/include" -I"../external-deps/libpng/include" -I"../external-deps/oggvorbis/include" -I"../external-deps/openal/include" -I"../external-deps/libktx/include"
 	
+LOCAL_ARM_NEON := true
 LOCAL_STATIC_LIBRARIES := android_native_app_glue
 
 include $(BUILD_STATIC_LIBRARY)
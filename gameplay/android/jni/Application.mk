@@ -1,3 +1,4 @@
 APP_STL     := stlport_static
 APP_PLATFORM := android-9
+APP_ABI := armeabi-v7a
 APP_MODULES := libgameplay
\ No newline at end of file
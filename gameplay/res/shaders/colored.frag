@@ -41,6 +41,9 @@ varying vec3 v_lightDirection;					// Direction of light in tangent space
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;                 // Camera direction
 #endif
+#if defined(CLUSTERED_LIGHTING)
+varying vec3 v_positionViewSpace;               // Position in view space
+#endif
 
 // Lighting
 #include "lighting.frag"
@@ -51,6 +54,9 @@ varying vec3 v_cameraDirection;                 // Camera direction
 #else
 #include "lighting-directional.frag"
 #endif
+#if defined(CLUSTERED_LIGHTING)
+#include "lighting-clustered.frag"
+#endif
 
 void main()
 {
@@ -64,6 +70,9 @@ void main()
     // Light the pixel
     gl_FragColor.a = _baseColor.a;
     gl_FragColor.rgb = getLitPixel();
+    #if defined(CLUSTERED_LIGHTING)
+    gl_FragColor.rgb += getClusteredLight(normalize(v_normalVector));
+    #endif
     
 	#if defined(MODULATE_COLOR)
     gl_FragColor *= u_modulateColor;
@@ -36,6 +36,9 @@ varying vec3 v_normalVector;								// Normal vector in view space.
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;								// Direction the camera is looking at in tangent space.
 #endif
+#if defined(CLUSTERED_LIGHTING)
+varying vec3 v_positionViewSpace;							// Position in view space.
+#endif
 
 // Lighting
 #if defined(POINT_LIGHT)
@@ -74,6 +77,9 @@ void main()
 
     // Apply light.
     applyLight(position);
+    #if defined(CLUSTERED_LIGHTING)
+    v_positionViewSpace = (u_worldViewMatrix * position).xyz;
+    #endif
     
     // Pass the vertex color to fragment shader
     #if defined(VERTEX_COLOR)
@@ -0,0 +1,64 @@
+// Uniforms
+uniform sampler2D u_clusterGridTexture;         // Offset and count of the light list of each cluster
+uniform sampler2D u_clusterIndexTexture;        // Light lists, four light indices per texel
+uniform sampler2D u_clusterLightTexture;        // Position, color and direction texels of each light
+uniform vec4 u_clusterTextureSizes;             // Inverse index texture size and inverse light count
+uniform vec4 u_clusterTileParameters;           // Viewport offset and inverse tile size in pixels
+uniform vec4 u_clusterGridSize;                 // Tiles across, tiles down and depth slices
+uniform vec4 u_clusterDepthParameters;          // Near plane and logarithmic slice scale
+
+#ifndef CLUSTER_MAX_LIGHTS
+#define CLUSTER_MAX_LIGHTS 64
+#endif
+
+vec3 getClusteredLight(vec3 normalVector)
+{
+    // Find the cluster of the pixel.
+    vec2 tile = min(floor((gl_FragCoord.xy - u_clusterTileParameters.xy) * u_clusterTileParameters.zw), u_clusterGridSize.xy - 1.0);
+    float depth = max(-v_positionViewSpace.z, u_clusterDepthParameters.x);
+    float slice = min(floor(log(depth / u_clusterDepthParameters.x) * u_clusterDepthParameters.y), u_clusterGridSize.z - 1.0);
+    vec2 gridCoord = (vec2(tile.x, tile.y + slice * u_clusterGridSize.y) + 0.5) / vec2(u_clusterGridSize.x, u_clusterGridSize.y * u_clusterGridSize.z);
+    vec4 cluster = texture2D(u_clusterGridTexture, gridCoord);
+
+    #if defined(SPECULAR)
+    vec3 cameraDirection = normalize(-v_positionViewSpace);
+    #endif
+
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < CLUSTER_MAX_LIGHTS; ++i)
+    {
+        if (float(i) >= cluster.y)
+            break;
+
+        // Fetch the light index, four of which are packed in each texel.
+        float index = cluster.x + float(i);
+        float texel = floor(index * 0.25);
+        vec2 indexCoord = vec2(mod(texel, 1.0 / u_clusterTextureSizes.x) + 0.5, floor(texel * u_clusterTextureSizes.x) + 0.5) * u_clusterTextureSizes.xy;
+        vec4 indices = texture2D(u_clusterIndexTexture, indexCoord);
+        float light = dot(indices, vec4(equal(vec4(index - texel * 4.0), vec4(0.0, 1.0, 2.0, 3.0))));
+
+        float lightCoord = (light + 0.5) * u_clusterTextureSizes.z;
+        vec4 positionRange = texture2D(u_clusterLightTexture, vec2(0.5 / 3.0, lightCoord));
+        vec4 colorOuter = texture2D(u_clusterLightTexture, vec2(1.5 / 3.0, lightCoord));
+        vec4 directionInner = texture2D(u_clusterLightTexture, vec2(2.5 / 3.0, lightCoord));
+
+        // Attenuate with distance and, for spot lights, with the angle to the light direction.
+        vec3 lightVector = positionRange.xyz - v_positionViewSpace;
+        vec3 scaledLightVector = lightVector * positionRange.w;
+        float attenuation = clamp(1.0 - dot(scaledLightVector, scaledLightVector), 0.0, 1.0);
+        vec3 lightDirection = normalize(lightVector);
+        // A spot light with equal inner and outer angles has a hard edge.
+        float angleCos = dot(directionInner.xyz, -lightDirection);
+        attenuation *= clamp((angleCos - colorOuter.w) / max(directionInner.w - colorOuter.w, 0.0001), 0.0, 1.0);
+
+        float diffuseIntensity = max(0.0, dot(normalVector, lightDirection)) * attenuation;
+        color += colorOuter.rgb * _baseColor.rgb * diffuseIntensity;
+
+        #if defined(SPECULAR)
+        vec3 halfVector = normalize(lightDirection + cameraDirection);
+        float specularIntensity = attenuation * max(0.0, pow(max(0.0, dot(normalVector, halfVector)), u_specularExponent));
+        color += colorOuter.rgb * _baseColor.rgb * specularIntensity;
+        #endif
+    }
+    return color;
+}
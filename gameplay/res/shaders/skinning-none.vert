@@ -1,25 +1,45 @@
+#if defined(INSTANCING)
+attribute mat4 a_instanceMatrix;							// Instance matrix, relative to the node the material is bound to
+#endif
+
 vec4 getPosition()
 {
-    return a_position;    
+#if defined(INSTANCING)
+    return a_instanceMatrix * a_position;
+#else
+    return a_position;
+#endif
 }
 
 #if defined(LIGHTING)
 
 vec3 getNormal()
 {
+#if defined(INSTANCING)
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_normal;
+#else
     return a_normal;
+#endif
 }
 
 #if defined(BUMPED)
 
 vec3 getTangent()
 {
+#if defined(INSTANCING)
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_tangent;
+#else
     return a_tangent;
+#endif
 }
 
 vec3 getBinormal()
 {
+#if defined(INSTANCING)
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz) * a_binormal;
+#else
     return a_binormal;
+#endif
 }
 
 #endif
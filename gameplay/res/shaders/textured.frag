@@ -35,6 +35,9 @@ varying vec3 v_lightDirection;					// Direction of light in tangent space.
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;                 // Camera direction
 #endif
+#if defined(CLUSTERED_LIGHTING)
+varying vec3 v_positionViewSpace;               // Position in view space
+#endif
 
 // Lighting 
 #include "lighting.frag"
@@ -48,6 +51,9 @@ uniform vec3 u_spotLightDirection;              // Direction of a spot light sou
 #else
 #include "lighting-directional.frag"
 #endif
+#if defined(CLUSTERED_LIGHTING)
+#include "lighting-clustered.frag"
+#endif
 
 
 void main()
@@ -62,6 +68,9 @@ void main()
         discard;
     #endif
     gl_FragColor.rgb = getLitPixel();
+    #if defined(CLUSTERED_LIGHTING)
+    gl_FragColor.rgb += getClusteredLight(normalize(v_normalVector));
+    #endif
 	
 	// Global color modulation
 	#if defined(MODULATE_COLOR)
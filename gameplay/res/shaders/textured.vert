@@ -12,7 +12,7 @@ attribute vec4 a_blendIndices;								// Vertex blend index int u_matrixPalette
 // Uniforms
 uniform mat4 u_worldViewProjectionMatrix;					// Matrix to transform a position to clip space
 uniform mat4 u_inverseTransposeWorldViewMatrix;				// Matrix to transform a normal to view space
-#if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT)
+#if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT) || defined(CLUSTERED_LIGHTING)
 uniform mat4 u_worldViewMatrix;								// Matrix to tranform a position to view space
 #endif
 #if defined(SKINNING)
@@ -43,6 +43,9 @@ varying vec2 v_texCoord;									// Texture coordinate
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;								// Direction the camera is looking at in tangent space
 #endif
+#if defined(CLUSTERED_LIGHTING)
+varying vec3 v_positionViewSpace;							// Position in view space
+#endif
 #if defined(POINT_LIGHT)
 varying vec3 v_vertexToPointLightDirection;					// Direction of point light w.r.t current vertex in tangent space
 varying float v_pointLightAttenuation;						// Attenuation of point light
@@ -80,6 +83,9 @@ void main()
 
     // Apply light.
     applyLight(position);
+    #if defined(CLUSTERED_LIGHTING)
+    v_positionViewSpace = (u_worldViewMatrix * position).xyz;
+    #endif
 
     // Texture transformation
     v_texCoord = a_texCoord;
@@ -95,6 +95,7 @@ void AIController::sendMessage(AIMessage* message, float delay)
 
 void AIController::update(float elapsedTime)
 {
+    GP_PROFILE_ZONE("AIController::update");
     if (_paused)
         return;
 
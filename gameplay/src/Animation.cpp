@@ -281,6 +281,10 @@ void Animation::createClips(Properties* animationProperties, unsigned int frameC
 
         clip->setLoopBlendTime(pClip->getFloat("loopBlendTime")); // returns zero if not specified
 
+        int bakeRate = pClip->getInt("bakeRate"); // returns zero if not specified
+        if (bakeRate > 0)
+            clip->bake((unsigned int)bakeRate);
+
         pClip = animationProperties->getNextNamespace();
     }
 }
@@ -4,6 +4,8 @@
 #include "AnimationTarget.h"
 #include "Game.h"
 #include "Quaternion.h"
+#include "Transform.h"
+#include "Node.h"
 #include "ScriptController.h"
 
 namespace gameplay
@@ -13,7 +15,9 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _loopBlendTime(0), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _lastCurrentTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), 
-      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL), _locomotionClip(false),
+      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL), _bakedFrames(NULL), _bakedValues(NULL),
+      _bakedFrameCount(0), _bakedStride(0), _bakedSampleRate(0), _scheduleIndex(-1), _lodNode(NULL), _lodSkipped(false),
+      _lodInterval(0.0f), _lodElapsed(0.0f), _lodPoses(NULL), _lodPoseValid(false), _locomotionClip(false),
 	  _synchronized(false), _restart(false), m_lastMin(-1), m_lastMax(-1), m_lastIndex(-1)
 {
     GP_ASSERT(_animation);
@@ -37,6 +41,10 @@ AnimationClip::~AnimationClip()
     }
     _values.clear();
 
+    SAFE_DELETE_ARRAY(_bakedFrames);
+    SAFE_DELETE_ARRAY(_bakedValues);
+    SAFE_DELETE_ARRAY(_lodPoses);
+    SAFE_RELEASE(_lodNode);
     SAFE_RELEASE(_crossFadeToClip);
     SAFE_DELETE(_beginListeners);
     SAFE_DELETE(_endListeners);
@@ -183,6 +191,117 @@ float AnimationClip::getLoopBlendTime() const
     return _loopBlendTime;
 }
 
+void AnimationClip::bake(unsigned int sampleRate)
+{
+    GP_ASSERT(_animation);
+    GP_ASSERT(sampleRate > 0);
+
+    SAFE_DELETE_ARRAY(_bakedFrames);
+    SAFE_DELETE_ARRAY(_bakedValues);
+    _bakedSampleRate = sampleRate;
+    layoutValues();
+    size_t channelCount = _animation->_channels.size();
+
+    // One frame per sample period, always including both end points of the clip.
+    _bakedFrameCount = (unsigned int)((_duration * sampleRate + 999) / 1000) + 1;
+    _bakedFrames = new float[_bakedFrameCount * _bakedStride];
+    _bakedValues = new float[_bakedStride];
+
+    float percentageStart = (float)_startTime / (float)_animation->_duration;
+    float percentageEnd = (float)_endTime / (float)_animation->_duration;
+    for (unsigned int frame = 0; frame < _bakedFrameCount; frame++)
+    {
+        float percentComplete = _bakedFrameCount > 1 ? (float)frame / (float)(_bakedFrameCount - 1) : 1.0f;
+        float* row = _bakedFrames + frame * _bakedStride;
+        for (size_t i = 0; i < channelCount; i++)
+        {
+            _animation->_channels[i]->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, 0.0f, row + _bakedOffsets[i]);
+        }
+
+        // Keep each quaternion in the same hemisphere as in the previous frame so that
+        // interpolating between two frames always takes the shortest path.
+        if (frame > 0)
+        {
+            for (size_t i = 0, count = _bakedRotations.size(); i < count; i++)
+            {
+                float* q = row + _bakedRotations[i];
+                const float* p = q - _bakedStride;
+                if (p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3] < 0.0f)
+                {
+                    q[0] = -q[0];
+                    q[1] = -q[1];
+                    q[2] = -q[2];
+                    q[3] = -q[3];
+                }
+            }
+        }
+    }
+}
+
+void AnimationClip::layoutValues()
+{
+    _bakedOffsets.clear();
+    _bakedRotations.clear();
+
+    // The LOD poses have the same layout and are reallocated when it changes.
+    SAFE_DELETE_ARRAY(_lodPoses);
+    _lodPoseValid = false;
+
+    // Lay out the values of every channel one after another within a frame.
+    size_t channelCount = _animation->_channels.size();
+    _bakedStride = 0;
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel);
+        GP_ASSERT(channel->_target);
+        GP_ASSERT(channel->getCurve());
+
+        _bakedOffsets.push_back(_bakedStride);
+
+        // Remember where the quaternions are so they can be kept normalized.
+        if (channel->_target->_targetType == AnimationTarget::TRANSFORM)
+        {
+            switch (channel->_propertyId)
+            {
+                case Transform::ANIMATE_ROTATE:
+                case Transform::ANIMATE_ROTATE_TRANSLATE:
+                    _bakedRotations.push_back(_bakedStride);
+                    break;
+                case Transform::ANIMATE_SCALE_ROTATE:
+                case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+                    _bakedRotations.push_back(_bakedStride + 3);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        _bakedStride += channel->getCurve()->getComponentCount();
+    }
+}
+
+bool AnimationClip::isBaked() const
+{
+    return _bakedSampleRate > 0;
+}
+
+void AnimationClip::setLodNode(Node* node)
+{
+    if (_lodNode != node)
+    {
+        SAFE_RELEASE(_lodNode);
+        _lodNode = node;
+        if (_lodNode)
+            _lodNode->addRef();
+    }
+}
+
+Node* AnimationClip::getLodNode() const
+{
+    return _lodNode;
+}
+
 bool AnimationClip::isPlaying() const
 {
     return (isClipStateBitSet(CLIP_IS_PLAYING_BIT) && !isClipStateBitSet(CLIP_IS_PAUSED_BIT));
@@ -535,29 +654,53 @@ bool AnimationClip::update(float elapsedTime)
         }
     }
     
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
-    size_t channelCount = _animation->_channels.size();
-    float percentageStart = (float)_startTime / (float)_animation->_duration;
-    float percentageEnd = (float)_endTime / (float)_animation->_duration;
-    float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
-    for (size_t i = 0; i < channelCount; i++)
-    {
-        channel = _animation->_channels[i];
-        GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
-        value = _values[i];
-        GP_ASSERT(value);
+    // The AnimationController may reduce the update rate of the clip for LOD. The clip is
+    // always evaluated when it ends so that its targets are left at its final values.
+    bool ending = isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT);
+    if (_lodInterval <= 0.0f || ending)
+        _lodPoseValid = false;
 
-        // Evaluate the point on Curve
-        GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value, &m_lastMin, &m_lastMax, &m_lastIndex);
+    if (_lodInterval > 0.0f && !ending)
+    {
+        updateLod(percentComplete, elapsedTime);
+    }
+    else if (!_lodSkipped || ending)
+    {
+        // Evaluate this clip.
+        Animation::Channel* channel = NULL;
+        AnimationValue* value = NULL;
+        AnimationTarget* target = NULL;
+        size_t channelCount = _animation->_channels.size();
+        float percentageStart = (float)_startTime / (float)_animation->_duration;
+        float percentageEnd = (float)_endTime / (float)_animation->_duration;
+        float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
+        if (_bakedSampleRate > 0)
+        {
+            // Channels may have been added since the clip was baked (ie: when the animation is cloned).
+            if (!_bakedFrames || _bakedOffsets.size() != channelCount)
+                bake(_bakedSampleRate);
 
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+            updateBaked(percentComplete);
+        }
+        else
+        {
+            for (size_t i = 0; i < channelCount; i++)
+            {
+                channel = _animation->_channels[i];
+                GP_ASSERT(channel);
+                target = channel->_target;
+                GP_ASSERT(target);
+                value = _values[i];
+                GP_ASSERT(value);
+
+                // Evaluate the point on Curve
+                GP_ASSERT(channel->getCurve());
+                channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value, &m_lastMin, &m_lastMax, &m_lastIndex);
+
+                // Set the animation value on the target property.
+                target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+            }
+        }
     }
 
     // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
@@ -570,6 +713,207 @@ bool AnimationClip::update(float elapsedTime)
     return false;
 }
 
+void AnimationClip::updateBaked(float percentComplete)
+{
+    GP_ASSERT(_bakedValues);
+    sampleBaked(percentComplete, _bakedValues);
+    applyValues(_bakedValues);
+}
+
+void AnimationClip::sampleBaked(float percentComplete, float* dst) const
+{
+    GP_ASSERT(_bakedFrames && dst);
+    GP_ASSERT(_bakedFrameCount > 0);
+
+    // Find the two frames to interpolate between.
+    const float* from = NULL;
+    const float* to = NULL;
+    float t = 0.0f;
+    bool loopBlend = false;
+    if (percentComplete > 1.0f && _loopBlendTime > 0)
+    {
+        // Past the end of the clip, blend the last frame back into the first.
+        from = _bakedFrames + (_bakedFrameCount - 1) * _bakedStride;
+        to = _bakedFrames;
+        t = _duration == 0 ? 1.0f : (percentComplete - 1.0f) * (float)_duration / (float)_loopBlendTime;
+        loopBlend = true;
+    }
+    else
+    {
+        float frame = MATH_CLAMP(percentComplete, 0.0f, 1.0f) * (float)(_bakedFrameCount - 1);
+        unsigned int index = (unsigned int)frame;
+        if (index >= _bakedFrameCount - 1)
+            index = _bakedFrameCount - 1;
+        from = _bakedFrames + index * _bakedStride;
+        to = index + 1 < _bakedFrameCount ? from + _bakedStride : from;
+        t = frame - (float)index;
+    }
+    t = MATH_CLAMP(t, 0.0f, 1.0f);
+
+    // Interpolate all the channels in one pass.
+    for (unsigned int i = 0; i < _bakedStride; i++)
+    {
+        dst[i] = from[i] + (to[i] - from[i]) * t;
+    }
+
+    // The first and last frames are not hemisphere aligned with each other.
+    if (loopBlend)
+    {
+        for (size_t i = 0, count = _bakedRotations.size(); i < count; i++)
+        {
+            unsigned int offset = _bakedRotations[i];
+            float* q = dst + offset;
+            const float* p0 = from + offset;
+            const float* p1 = to + offset;
+            float sign = (p0[0] * p1[0] + p0[1] * p1[1] + p0[2] * p1[2] + p0[3] * p1[3]) < 0.0f ? -1.0f : 1.0f;
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                q[j] = p0[j] + (sign * p1[j] - p0[j]) * t;
+            }
+        }
+    }
+    normalizeRotations(dst);
+}
+
+void AnimationClip::normalizeRotations(float* values) const
+{
+    for (size_t i = 0, count = _bakedRotations.size(); i < count; i++)
+    {
+        float* q = values + _bakedRotations[i];
+        float n = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+        if (n > MATH_EPSILON)
+        {
+            n = 1.0f / sqrt(n);
+            q[0] *= n;
+            q[1] *= n;
+            q[2] *= n;
+            q[3] *= n;
+        }
+    }
+}
+
+void AnimationClip::applyValues(const float* values)
+{
+    // Apply the values, writing transforms directly to skip the virtual dispatch.
+    for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        AnimationTarget* target = channel->_target;
+        const float* value = values + _bakedOffsets[i];
+        if (target->_targetType == AnimationTarget::TRANSFORM)
+        {
+            static_cast<Transform*>(target)->applyAnimationValue(channel->_propertyId, value, _blendWeight);
+        }
+        else
+        {
+            AnimationValue* animationValue = _values[i];
+            GP_ASSERT(animationValue);
+            memcpy(animationValue->_value, value, animationValue->_componentSize);
+            target->setAnimationPropertyValue(channel->_propertyId, animationValue, _blendWeight);
+        }
+    }
+}
+
+void AnimationClip::evaluateValues(float percentComplete, float* dst) const
+{
+    if (_bakedSampleRate > 0)
+    {
+        sampleBaked(percentComplete, dst);
+        return;
+    }
+
+    float percentageStart = (float)_startTime / (float)_animation->_duration;
+    float percentageEnd = (float)_endTime / (float)_animation->_duration;
+    float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
+    for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel && channel->getCurve());
+        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, dst + _bakedOffsets[i]);
+    }
+}
+
+float AnimationClip::getPercentComplete(float elapsedTime) const
+{
+    // Same as in update(), without notifying listeners.
+    float currentTime;
+    if (_repeatCount != REPEAT_INDEFINITE && ((_speed >= 0.0f && elapsedTime >= _activeDuration) || (_speed <= 0.0f && elapsedTime <= 0.0f)))
+    {
+        currentTime = _speed < 0.0f ? 0.0f : _duration;
+    }
+    else if (_duration == 0)
+    {
+        currentTime = 0.0f;
+    }
+    else
+    {
+        currentTime = fmodf(elapsedTime, _duration + _loopBlendTime);
+        if (currentTime < 0.0f)
+            currentTime += _duration + _loopBlendTime;
+    }
+
+    float percentComplete = _duration == 0 ? 1 : currentTime / (float)_duration;
+    if (_loopBlendTime == 0.0f)
+        percentComplete = MATH_CLAMP(percentComplete, 0.0f, 1.0f);
+    return percentComplete;
+}
+
+void AnimationClip::updateLod(float percentComplete, float elapsedTime)
+{
+    GP_ASSERT(_lodInterval > 0.0f);
+
+    // Channels may have been added since the values were laid out (ie: when the animation is cloned).
+    size_t channelCount = _animation->_channels.size();
+    if (_bakedSampleRate > 0 && (!_bakedFrames || _bakedOffsets.size() != channelCount))
+        bake(_bakedSampleRate);
+    else if (_bakedOffsets.size() != channelCount)
+        layoutValues();
+    if (_lodPoses == NULL)
+        _lodPoses = new float[_bakedStride * 3];
+
+    float* from = _lodPoses;
+    float* to = from + _bakedStride;
+    float* pose = to + _bakedStride;
+    if (!_lodSkipped || !_lodPoseValid)
+    {
+        // On an LOD update, evaluate the clip where it will be at the next update and blend
+        // toward it from the pose applied now, so the targets keep moving in between.
+        if (_lodPoseValid)
+            memcpy(from, pose, _bakedStride * sizeof(float));
+        else
+            evaluateValues(percentComplete, from);
+        evaluateValues(getPercentComplete(_elapsedTime + _lodInterval * _speed), to);
+        _lodElapsed = 0.0f;
+        _lodPoseValid = true;
+
+        // Blend each rotation along the shortest path.
+        for (size_t i = 0, count = _bakedRotations.size(); i < count; i++)
+        {
+            const float* p = from + _bakedRotations[i];
+            float* q = to + _bakedRotations[i];
+            if (p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3] < 0.0f)
+            {
+                q[0] = -q[0];
+                q[1] = -q[1];
+                q[2] = -q[2];
+                q[3] = -q[3];
+            }
+        }
+    }
+    else
+    {
+        _lodElapsed += elapsedTime;
+    }
+
+    float t = MATH_CLAMP(_lodElapsed / _lodInterval, 0.0f, 1.0f);
+    for (unsigned int i = 0; i < _bakedStride; i++)
+    {
+        pose[i] = from[i] + (to[i] - from[i]) * t;
+    }
+    normalizeRotations(pose);
+    applyValues(pose);
+}
+
 void AnimationClip::onBegin()
 {
     addRef();
@@ -651,6 +995,9 @@ AnimationClip* AnimationClip::clone(Animation* animation) const
     newClip->setSpeed(getSpeed());
     newClip->setRepeatCount(getRepeatCount());
     newClip->setBlendWeight(getBlendWeight());
+
+    // The clone is baked on its first update, once all of its channels have been added.
+    newClip->_bakedSampleRate = _bakedSampleRate;
     
     size_t size = _values.size();
     newClip->_values.resize(size, NULL);
@@ -11,6 +11,7 @@ namespace gameplay
 
 class Animation;
 class AnimationValue;
+class Node;
 class ScriptListener;
 
 /**
@@ -194,6 +195,50 @@ public:
      */
     float getLoopBlendTime() const;
 
+    /**
+     * Bakes the clip's channels into a single sample buffer for faster playback.
+     *
+     * Every channel's curve is sampled at a uniform rate over the clip and stored frame
+     * by frame in one contiguous buffer. A baked clip is evaluated by interpolating the
+     * two nearest frames for all channels in a single pass, and transform channels are
+     * written directly into the target Transform rather than through the virtual
+     * AnimationTarget::setAnimationPropertyValue.
+     *
+     * Curves that are not linear (including step curves) are approximated at the
+     * resolution of the sample rate. Rotations are normalized after interpolation.
+     *
+     * Baking can also be requested from an .animation file with the 'bakeRate' clip property.
+     *
+     * @param sampleRate The number of samples to take per second of the clip.
+     */
+    void bake(unsigned int sampleRate = 30);
+
+    /**
+     * Checks if the AnimationClip has been baked.
+     *
+     * @return true if the clip is evaluated from baked samples; false otherwise.
+     */
+    bool isBaked() const;
+
+    /**
+     * Sets the node used by the AnimationController to compute the LOD of this clip.
+     *
+     * When the AnimationController has an LOD camera, a clip with an LOD node is evaluated
+     * at a reduced rate while the node's bounding sphere is off-screen or far from the camera.
+     * Far clips are interpolated between the sparse evaluations, while off-screen clips hold
+     * their last pose. For skeletal animation this is typically the node holding the skinned model.
+     *
+     * @param node The node to compute LOD from, or NULL to always evaluate the clip at full rate.
+     */
+    void setLodNode(Node* node);
+
+    /**
+     * Gets the node used by the AnimationController to compute the LOD of this clip.
+     *
+     * @return The LOD node, or NULL if LOD is not used for this clip.
+     */
+    Node* getLodNode() const;
+
     /**
      * Checks if the AnimationClip is playing.
      *
@@ -406,6 +451,49 @@ private:
      */
     AnimationClip* clone(Animation* animation) const;
 
+    /**
+     * Computes the layout of the values of all channels within a frame (see _bakedOffsets).
+     */
+    void layoutValues();
+
+    /**
+     * Evaluates all channels of a baked clip at the given percentage and applies them to their targets.
+     */
+    void updateBaked(float percentComplete);
+
+    /**
+     * Interpolates the values of all channels of a baked clip at the given percentage.
+     */
+    void sampleBaked(float percentComplete, float* dst) const;
+
+    /**
+     * Evaluates the values of all channels at the given percentage, without applying them.
+     */
+    void evaluateValues(float percentComplete, float* dst) const;
+
+    /**
+     * Normalizes the rotations within a frame of values.
+     */
+    void normalizeRotations(float* values) const;
+
+    /**
+     * Applies a frame of values to the targets of all channels.
+     */
+    void applyValues(const float* values);
+
+    /**
+     * Gets the percentage complete of the current loop at the given elapsed time of the clip.
+     */
+    float getPercentComplete(float elapsedTime) const;
+
+    /**
+     * Updates a clip that the AnimationController evaluates at a reduced rate for LOD.
+     *
+     * The clip is evaluated once per LOD interval, at the time of the next LOD update, and the
+     * frames in between blend toward that pose from the pose applied at the last LOD update.
+     */
+    void updateLod(float percentComplete, float elapsedTime);
+
     std::string _id;                                    // AnimationClip ID.
     Animation* _animation;                              // The Animation this clip is created from.
     unsigned long _startTime;                           // Start time of the clip.
@@ -429,6 +517,20 @@ private:
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
     std::list<ListenerEvent*>::iterator* _listenerItr;  // Iterator that points to the next listener event to be triggered.
     std::vector<ScriptListener*>* _scriptListeners;     // Collection of listeners that are bound to Lua script functions.
+    float* _bakedFrames;                                // Baked channel values, one row of _bakedStride floats per frame.
+    float* _bakedValues;                                // Row holding the interpolated values of the current frame.
+    unsigned int _bakedFrameCount;                      // The number of baked frames.
+    unsigned int _bakedStride;                          // The number of floats in one baked frame.
+    unsigned int _bakedSampleRate;                      // The number of baked frames per second.
+    std::vector<unsigned int> _bakedOffsets;            // Offset of each channel's values within a baked frame or LOD pose.
+    std::vector<unsigned int> _bakedRotations;          // Offset of each quaternion within a baked frame or LOD pose.
+    int _scheduleIndex;                                 // Index of the clip in the AnimationController's running clips, or -1 when not scheduled.
+    Node* _lodNode;                                     // The node used to compute the LOD of the clip.
+    bool _lodSkipped;                                   // Whether the AnimationController skips evaluating the clip this frame for LOD.
+    float _lodInterval;                                 // Time between LOD updates when the clip is interpolated in between, or 0.
+    float _lodElapsed;                                  // Time elapsed since the last LOD update.
+    float* _lodPoses;                                   // The poses blended from and to between LOD updates, and the blended pose.
+    bool _lodPoseValid;                                 // Whether _lodPoses holds the poses of the last LOD update.
 
 	bool _synchronized;
 	bool _restart;
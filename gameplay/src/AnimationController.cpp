@@ -2,31 +2,70 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "Camera.h"
+#include "Node.h"
+
+// Default animation LOD settings
+#define ANIMATION_LOD_DISTANCE 50.0f
+#define ANIMATION_LOD_DISTANT_RATE 10.0f
+#define ANIMATION_LOD_HIDDEN_RATE 2.0f
 
 namespace gameplay
 {
 
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _runningClipCount(0), _lodCamera(NULL), _lodDistance(ANIMATION_LOD_DISTANCE),
+      _lodDistantRate(ANIMATION_LOD_DISTANT_RATE), _lodHiddenRate(ANIMATION_LOD_HIDDEN_RATE), _lodTime(0)
 {
 }
 
 AnimationController::~AnimationController()
 {
+    SAFE_RELEASE(_lodCamera);
 }
 
 void AnimationController::stopAllAnimations() 
 {
-    std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
-    while (clipIter != _runningClips.end())
+    for (size_t i = 0, count = _runningClips.size(); i < count; i++)
+    {
+        AnimationClip* clip = _runningClips[i];
+        if (clip)
+            clip->stop();
+    }
+}
+
+void AnimationController::setLodCamera(Camera* camera)
+{
+    if (_lodCamera != camera)
     {
-        AnimationClip* clip = *clipIter;
-        GP_ASSERT(clip);
-        clip->stop();
-        clipIter++;
+        SAFE_RELEASE(_lodCamera);
+        _lodCamera = camera;
+        if (_lodCamera)
+            _lodCamera->addRef();
     }
 }
 
+Camera* AnimationController::getLodCamera() const
+{
+    return _lodCamera;
+}
+
+void AnimationController::setLodDistance(float distance)
+{
+    _lodDistance = distance;
+}
+
+float AnimationController::getLodDistance() const
+{
+    return _lodDistance;
+}
+
+void AnimationController::setLodUpdateRates(float distantRate, float hiddenRate)
+{
+    _lodDistantRate = distantRate;
+    _lodHiddenRate = hiddenRate;
+}
+
 AnimationController::State AnimationController::getState() const
 {
     return _state;
@@ -34,24 +73,40 @@ AnimationController::State AnimationController::getState() const
 
 void AnimationController::initialize()
 {
+    Properties* config = Game::getInstance()->getConfig();
+    if (config && (config = config->getNamespace("animation", true)) != NULL)
+    {
+        if (config->exists("lodDistance"))
+            _lodDistance = config->getFloat("lodDistance");
+        if (config->exists("lodDistantRate"))
+            _lodDistantRate = config->getFloat("lodDistantRate");
+        if (config->exists("lodHiddenRate"))
+            _lodHiddenRate = config->getFloat("lodHiddenRate");
+    }
+
     _state = IDLE;
 }
 
 void AnimationController::finalize()
 {
-    std::list<AnimationClip*>::iterator itr = _runningClips.begin();
-    for ( ; itr != _runningClips.end(); itr++)
+    for (size_t i = 0, count = _runningClips.size(); i < count; i++)
     {
-        AnimationClip* clip = *itr;
-        SAFE_RELEASE(clip);
+        AnimationClip* clip = _runningClips[i];
+        if (clip)
+        {
+            clip->_scheduleIndex = -1;
+            SAFE_RELEASE(clip);
+        }
     }
     _runningClips.clear();
+    _runningClipCount = 0;
+    SAFE_RELEASE(_lodCamera);
     _state = STOPPED;
 }
 
 void AnimationController::resume()
 {
-    if (_runningClips.empty())
+    if (_runningClipCount == 0)
         _state = IDLE;
     else
         _state = RUNNING;
@@ -64,110 +119,188 @@ void AnimationController::pause()
 
 void AnimationController::schedule(AnimationClip* clip)
 {
-    if (_runningClips.empty())
+    GP_ASSERT(clip);
+    if (clip->_scheduleIndex >= 0)
+    {
+        // Already running.
+        GP_ASSERT(_runningClips[clip->_scheduleIndex] == clip);
+        return;
+    }
+
+    if (_runningClipCount == 0)
     {
         _state = RUNNING;
     }
 
-    GP_ASSERT(clip);
     clip->addRef();
+    clip->_scheduleIndex = (int)_runningClips.size();
     _runningClips.push_back(clip);
+    _runningClipCount++;
 }
 
 void AnimationController::unschedule(AnimationClip* clip)
 {
-    std::list<AnimationClip*>::iterator clipItr = _runningClips.begin();
-    while (clipItr != _runningClips.end())
-    {
-        AnimationClip* rClip = (*clipItr);
-        if (rClip == clip)
-        {
-            _runningClips.erase(clipItr);
-            SAFE_RELEASE(clip);
-            break;
-        }
-        clipItr++;
-    }
+    GP_ASSERT(clip);
+    if (clip->_scheduleIndex < 0)
+        return;
 
-    if (_runningClips.empty())
+    GP_ASSERT(clip->_scheduleIndex < (int)_runningClips.size() && _runningClips[clip->_scheduleIndex] == clip);
+    _runningClips[clip->_scheduleIndex] = NULL;
+    clip->_scheduleIndex = -1;
+    _runningClipCount--;
+    SAFE_RELEASE(clip);
+
+    if (_runningClipCount == 0)
         _state = IDLE;
 }
 
 void AnimationController::update(float elapsedTime)
 {
+    GP_PROFILE_ZONE("AnimationController::update");
     if (_state != RUNNING)
         return;
     
     Transform::suspendTransformChanged();
 
+    _lodTime += elapsedTime;
+    Vector3 cameraPosition;
+    if (_lodCamera && _lodCamera->getNode())
+        cameraPosition = _lodCamera->getNode()->getTranslationWorld();
+
     // Loop through running clips and call update() on them.
-    std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
-    while (clipIter != _runningClips.end())
+    // Clips scheduled during the loop are appended and updated in this same pass,
+    // so the size is re-read on every iteration.
+    bool endSynchronized = false;
+    for (size_t i = 0; i < _runningClips.size(); i++)
     {
-        AnimationClip* clip = (*clipIter);
-        GP_ASSERT(clip);
+        AnimationClip* clip = _runningClips[i];
+        if (clip == NULL)
+            continue;
+
         clip->addRef();
+        clip->_lodSkipped = isLodSkipped(clip, cameraPosition, elapsedTime, &clip->_lodInterval);
         if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
         {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
-            // move it from where it is in the running clips list to the back.
+            // move it from where it is in the running clips to the back.
             clip->onEnd();
             clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
+            _runningClips[i] = NULL;
+            clip->_scheduleIndex = (int)_runningClips.size();
             _runningClips.push_back(clip);
-            clipIter = _runningClips.erase(clipIter);
         }
         else if (clip->update(elapsedTime))
         {
-			if (clip->_locomotionClip)
-			{
-				std::list<AnimationClip*>::iterator clipIter2 = _runningClips.begin();
-				while (clipIter2 != _runningClips.end())
-				{
-					AnimationClip* clipSynch = (*clipIter2);
-					GP_ASSERT(clipSynch);
-		
-					if (clipSynch->_synchronized)
-					{
-						clipSynch->onEnd();
-
-						AnimationClip *cftc = clipSynch->_crossFadeToClip;
-						if (cftc) {
-							cftc->_blendWeight = 1.0f;
-							cftc->resetClipStateBit(AnimationClip::CLIP_IS_MARKED_FOR_REMOVAL_BIT);
-						}
-
-						clipSynch->release();
-						clipIter2 = _runningClips.erase(clipIter2);
-					}
-
-					clipIter2++;
-				}
-			}
-
-			short count = 0;
-			AnimationClip *cftc = clip->_crossFadeToClip;
-			while (cftc) {
-				cftc->_blendWeight = 1.0f;
-				cftc->resetClipStateBit(AnimationClip::CLIP_IS_MARKED_FOR_REMOVAL_BIT);
-				cftc = cftc->_crossFadeToClip;
-				if (++count > 2) {
-					break;
-				}
-			}
-
-			clip->release();
-			clipIter = _runningClips.erase(clipIter);
-        }
-        else
-        {
-            clipIter++;
+            // Synchronized clips are ended in a single pass once all clips have been updated.
+            if (clip->_locomotionClip)
+                endSynchronized = true;
+
+            // Hand the crossfade over to the clips this clip was fading into.
+            short count = 0;
+            AnimationClip* cftc = clip->_crossFadeToClip;
+            while (cftc)
+            {
+                cftc->_blendWeight = 1.0f;
+                cftc->resetClipStateBit(AnimationClip::CLIP_IS_MARKED_FOR_REMOVAL_BIT);
+                cftc = cftc->_crossFadeToClip;
+                if (++count > 2)
+                    break;
+            }
+
+            unschedule(clip);
         }
         clip->release();
     }
 
+    if (endSynchronized)
+        endSynchronizedClips();
+
+    compactRunningClips();
+
     Transform::resumeTransformChanged();
 
-    if (_runningClips.empty())
+    if (_runningClipCount == 0)
         _state = IDLE;
 }
 
+bool AnimationController::isLodSkipped(AnimationClip* clip, const Vector3& cameraPosition, float elapsedTime, float* interval) const
+{
+    GP_ASSERT(clip && interval);
+    *interval = 0.0f;
+    Node* node = clip->_lodNode;
+    if (node == NULL || _lodCamera == NULL || _lodCamera->getNode() == NULL)
+        return false;
+
+    // Off-screen clips hold their last pose between updates, while distant clips that are
+    // visible are interpolated between updates so they do not visibly stutter.
+    float rate;
+    bool interpolated;
+    const BoundingSphere& sphere = node->getBoundingSphere();
+    if (!_lodCamera->getFrustum().intersects(sphere))
+    {
+        rate = _lodHiddenRate;
+        interpolated = false;
+    }
+    else if (sphere.center.distance(cameraPosition) - sphere.radius > _lodDistance)
+    {
+        rate = _lodDistantRate;
+        interpolated = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (rate <= 0.0f)
+        return true;
+
+    // Evaluate once per interval. All clips on the same node share the same phase so blended
+    // clips are evaluated together, and the phase is offset per node to spread the work of
+    // many distant characters over several frames.
+    double period = 1000.0 / rate;
+    double phase = (double)(((size_t)node >> 4) & 15) * period / 16.0;
+    if (interpolated)
+        *interval = (float)period;
+    return floor((_lodTime + phase) / period) == floor((_lodTime - elapsedTime + phase) / period);
+}
+
+void AnimationController::endSynchronizedClips()
+{
+    for (size_t i = 0, count = _runningClips.size(); i < count; i++)
+    {
+        AnimationClip* clip = _runningClips[i];
+        if (clip == NULL || !clip->_synchronized)
+            continue;
+
+        clip->onEnd();
+
+        AnimationClip* cftc = clip->_crossFadeToClip;
+        if (cftc)
+        {
+            cftc->_blendWeight = 1.0f;
+            cftc->resetClipStateBit(AnimationClip::CLIP_IS_MARKED_FOR_REMOVAL_BIT);
+        }
+
+        unschedule(clip);
+    }
+}
+
+void AnimationController::compactRunningClips()
+{
+    if (_runningClipCount == _runningClips.size())
+        return;
+
+    size_t count = 0;
+    for (size_t i = 0, size = _runningClips.size(); i < size; i++)
+    {
+        AnimationClip* clip = _runningClips[i];
+        if (clip)
+        {
+            clip->_scheduleIndex = (int)count;
+            _runningClips[count++] = clip;
+        }
+    }
+    GP_ASSERT(count == _runningClipCount);
+    _runningClips.resize(count);
+}
+
 }
@@ -9,8 +9,27 @@
 namespace gameplay
 {
 
+class Camera;
+
 /**
  * Defines a class for controlling game animation.
+ *
+ * The controller can reduce the update rate of clips that animate distant or
+ * off-screen objects (animation LOD). Distant clips are interpolated between
+ * their updates, and off-screen clips hold their last pose. LOD is enabled by
+ * setting the camera to measure against with setLodCamera(), and applies to
+ * clips that have an LOD node set with AnimationClip::setLodNode(). The
+ * defaults can be specified in the game config file using the 'animation'
+ * namespace:
+ *
+ * @code
+ * animation
+ * {
+ *     lodDistance = 50       // Distance beyond which clips are updated at the distant rate
+ *     lodDistantRate = 10    // Updates per second for distant clips
+ *     lodHiddenRate = 2      // Updates per second for off-screen clips (0 to stop updating them)
+ * }
+ * @endcode
  */
 class AnimationController
 {
@@ -25,6 +44,50 @@ public:
      * Stops all AnimationClips currently playing on the AnimationController.
      */
     void stopAllAnimations();
+
+    /**
+     * Sets the camera used to compute animation LOD.
+     *
+     * @param camera The camera to measure clips against, or NULL to update all clips at full rate.
+     */
+    void setLodCamera(Camera* camera);
+
+    /**
+     * Gets the camera used to compute animation LOD.
+     *
+     * @return The LOD camera, or NULL if animation LOD is disabled.
+     */
+    Camera* getLodCamera() const;
+
+    /**
+     * Sets the distance from the LOD camera beyond which clips are updated at the distant rate.
+     *
+     * The distance is measured to the surface of the bounding sphere of the clip's LOD node.
+     *
+     * @param distance The LOD distance.
+     */
+    void setLodDistance(float distance);
+
+    /**
+     * Gets the distance from the LOD camera beyond which clips are updated at the distant rate.
+     *
+     * @return The LOD distance.
+     */
+    float getLodDistance() const;
+
+    /**
+     * Sets the rates at which distant and off-screen clips are evaluated.
+     *
+     * The time of a clip always advances at the full rate, and its listeners are
+     * still notified; only the evaluation of the clip's channels is skipped. In
+     * between evaluations, distant clips blend toward the pose of their next
+     * evaluation, while off-screen clips hold their last pose.
+     *
+     * @param distantRate The number of updates per second for clips beyond the LOD distance.
+     * @param hiddenRate The number of updates per second for clips outside of the camera's frustum,
+     *      or zero to stop evaluating them until they are visible again.
+     */
+    void setLodUpdateRates(float distantRate, float hiddenRate);
        
 private:
 
@@ -83,11 +146,17 @@ private:
 
     /**
      * Schedules an AnimationClip to run.
+     *
+     * The clip is appended to the running clips. When called during update(),
+     * the clip is updated later in the same pass.
      */
     void schedule(AnimationClip* clip);
 
     /**
      * Unschedules an AnimationClip.
+     *
+     * The clip's slot is cleared using the index stored on the clip, and the
+     * running clips are compacted on the next update.
      */
     void unschedule(AnimationClip* clip);
     
@@ -95,9 +164,33 @@ private:
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
+
+    /**
+     * Determines whether the evaluation of a clip should be skipped this frame because of animation LOD.
+     *
+     * @param interval Receives the time between the LOD updates of a clip that is interpolated
+     *      in between, or 0 if the clip is evaluated every frame or holds its pose.
+     */
+    bool isLodSkipped(AnimationClip* clip, const Vector3& cameraPosition, float elapsedTime, float* interval) const;
+
+    /**
+     * Ends all synchronized clips after a locomotion clip has ended.
+     */
+    void endSynchronizedClips();
+
+    /**
+     * Removes the cleared slots from the running clips, preserving the order of the remaining clips.
+     */
+    void compactRunningClips();
     
     State _state;                                 // The current state of the AnimationController.
-    std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    std::vector<AnimationClip*> _runningClips;    // The running AnimationClips, in update order. Unscheduled slots are NULL until compacted.
+    unsigned int _runningClipCount;               // The number of non NULL running clips.
+    Camera* _lodCamera;                           // The camera used to compute animation LOD.
+    float _lodDistance;                           // Distance beyond which clips are updated at the distant rate.
+    float _lodDistantRate;                        // Updates per second for clips beyond the LOD distance.
+    float _lodHiddenRate;                         // Updates per second for off-screen clips.
+    double _lodTime;                              // Time accumulated by the controller, used to schedule LOD updates.
 };
 
 }
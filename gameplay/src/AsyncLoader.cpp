@@ -0,0 +1,727 @@
+#include "Base.h"
+#include "AsyncLoader.h"
+#include "Game.h"
+#include "Bundle.h"
+#include "Effect.h"
+#include "Image.h"
+#include "FileSystem.h"
+#include "SceneLoader.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Default time the main thread spends completing requests each frame, in milliseconds.
+#define ASYNCLOADER_FRAME_BUDGET        4.0f
+
+// Share of the progress of a scene request spent reading the scene file.
+#define ASYNCLOADER_SCENE_FILE_PROGRESS 0.1f
+
+// Progress of a scene request once the textures of its materials are decoded.
+#define ASYNCLOADER_SCENE_TEXTURE_PROGRESS 0.5f
+
+// Share of the progress of an effects request spent reading the manifest and program cache.
+#define ASYNCLOADER_EFFECTS_FILE_PROGRESS 0.1f
+
+namespace gameplay
+{
+
+#ifdef WIN32
+
+struct AsyncLoader::SyncData
+{
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE requestAvailable;
+    HANDLE thread;
+};
+
+#define LOADER_LOCK(s)          EnterCriticalSection(&(s)->lock)
+#define LOADER_UNLOCK(s)        LeaveCriticalSection(&(s)->lock)
+#define LOADER_WAIT(s, cond)    SleepConditionVariableCS(&(s)->cond, &(s)->lock, INFINITE)
+#define LOADER_SIGNAL(s, cond)  WakeConditionVariable(&(s)->cond)
+
+#else
+
+struct AsyncLoader::SyncData
+{
+    pthread_mutex_t lock;
+    pthread_cond_t requestAvailable;
+    pthread_t thread;
+    bool threadCreated;
+};
+
+#define LOADER_LOCK(s)          pthread_mutex_lock(&(s)->lock)
+#define LOADER_UNLOCK(s)        pthread_mutex_unlock(&(s)->lock)
+#define LOADER_WAIT(s, cond)    pthread_cond_wait(&(s)->cond, &(s)->lock)
+#define LOADER_SIGNAL(s, cond)  pthread_cond_signal(&(s)->cond)
+
+#endif
+
+static bool hasExtension(const char* path, const char* extension)
+{
+    const char* ext = strrchr(path, '.');
+    if (ext == NULL || strlen(ext) != strlen(extension))
+        return false;
+    for (; *ext; ++ext, ++extension)
+    {
+        if (tolower(*ext) != tolower(*extension))
+            return false;
+    }
+    return true;
+}
+
+AsyncLoader::AsyncLoader()
+    : _sync(NULL), _frameBudget(ASYNCLOADER_FRAME_BUDGET), _shutdown(false)
+{
+    _sync = new SyncData();
+
+#ifdef WIN32
+    InitializeCriticalSection(&_sync->lock);
+    InitializeConditionVariable(&_sync->requestAvailable);
+    _sync->thread = CreateThread(NULL, 0, &AsyncLoader::threadFunc, this, 0, NULL);
+    if (_sync->thread == NULL)
+    {
+        GP_WARN("Failed to create the loading thread; requests are read on the main thread.");
+    }
+#else
+    pthread_mutex_init(&_sync->lock, NULL);
+    pthread_cond_init(&_sync->requestAvailable, NULL);
+    _sync->threadCreated = pthread_create(&_sync->thread, NULL, &AsyncLoader::threadFunc, this) == 0;
+    if (!_sync->threadCreated)
+    {
+        GP_WARN("Failed to create the loading thread; requests are read on the main thread.");
+    }
+#endif
+}
+
+AsyncLoader::~AsyncLoader()
+{
+    LOADER_LOCK(_sync);
+    _shutdown = true;
+    LOADER_UNLOCK(_sync);
+#ifdef WIN32
+    WakeAllConditionVariable(&_sync->requestAvailable);
+    if (_sync->thread)
+    {
+        WaitForSingleObject(_sync->thread, INFINITE);
+        CloseHandle(_sync->thread);
+    }
+    DeleteCriticalSection(&_sync->lock);
+#else
+    pthread_cond_broadcast(&_sync->requestAvailable);
+    if (_sync->threadCreated)
+    {
+        pthread_join(_sync->thread, NULL);
+    }
+    pthread_cond_destroy(&_sync->requestAvailable);
+    pthread_mutex_destroy(&_sync->lock);
+#endif
+    SAFE_DELETE(_sync);
+
+    // Cancel the pending requests; the game may still hold references to them.
+    for (std::list<Request*>::iterator itr = _requests.begin(); itr != _requests.end(); ++itr)
+    {
+        Request* request = *itr;
+        request->_loader = NULL;
+        request->_state = CANCELLED;
+        SAFE_RELEASE(request);
+    }
+    _requests.clear();
+    _queue.clear();
+}
+
+#ifdef WIN32
+unsigned long __stdcall AsyncLoader::threadFunc(void* arg)
+{
+    static_cast<AsyncLoader*>(arg)->threadMain();
+    return 0;
+}
+#else
+void* AsyncLoader::threadFunc(void* arg)
+{
+    static_cast<AsyncLoader*>(arg)->threadMain();
+    return NULL;
+}
+#endif
+
+void AsyncLoader::threadMain()
+{
+    while (true)
+    {
+        LOADER_LOCK(_sync);
+        while (!_shutdown && _queue.empty())
+        {
+            LOADER_WAIT(_sync, requestAvailable);
+        }
+        if (_shutdown)
+        {
+            LOADER_UNLOCK(_sync);
+            break;
+        }
+        Request* request = _queue.front();
+        _queue.pop_front();
+        request->_state = LOADING;
+        bool cancelled = request->_cancelled;
+        LOADER_UNLOCK(_sync);
+
+        bool succeeded = !cancelled && request->read();
+
+        LOADER_LOCK(_sync);
+        request->_readSucceeded = succeeded;
+        request->_state = LOADED;
+        LOADER_UNLOCK(_sync);
+    }
+}
+
+AsyncLoader::Request* AsyncLoader::loadScene(const char* url, Listener* listener, bool keepData)
+{
+    GP_ASSERT(url);
+
+    Request* request = new Request(this, Request::SCENE, url, listener);
+    request->_keepData = keepData;
+    return submit(request);
+}
+
+AsyncLoader::Request* AsyncLoader::loadBundle(const char* path, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    return submit(new Request(this, Request::BUNDLE, path, listener));
+}
+
+AsyncLoader::Request* AsyncLoader::loadTexture(const char* path, bool generateMipmaps, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    Request* request = new Request(this, Request::TEXTURE, path, listener);
+    request->_generateMipmaps = generateMipmaps;
+    return submit(request);
+}
+
+AsyncLoader::Request* AsyncLoader::loadProperties(const char* url, Listener* listener)
+{
+    GP_ASSERT(url);
+
+    return submit(new Request(this, Request::PROPERTIES, url, listener));
+}
+
+AsyncLoader::Request* AsyncLoader::loadEffects(const char* url, Listener* listener)
+{
+    GP_ASSERT(url);
+
+    // The driver strings are read here since GL can only be called from the main thread.
+    Request* request = new Request(this, Request::EFFECTS, url, listener);
+    ProgramCache::getFileToRead(&request->_programCachePath, &request->_driverHash);
+    return submit(request);
+}
+
+AsyncLoader::Request* AsyncLoader::submit(Request* request)
+{
+    GP_ASSERT(request);
+
+    // The loader holds a reference until the request is done; the caller owns the other one.
+    request->addRef();
+    _requests.push_back(request);
+
+#ifdef WIN32
+    bool threaded = _sync->thread != NULL;
+#else
+    bool threaded = _sync->threadCreated;
+#endif
+
+    // Textures that are already loaded and requests that cannot be read in the
+    // background are completed by the next update.
+    if (!threaded || (request->_type == Request::TEXTURE && Texture::getCache().find(request->_url.c_str())))
+    {
+        request->_readSucceeded = threaded || request->read();
+        request->_state = LOADED;
+        return request;
+    }
+
+    LOADER_LOCK(_sync);
+    _queue.push_back(request);
+    LOADER_UNLOCK(_sync);
+    LOADER_SIGNAL(_sync, requestAvailable);
+
+    return request;
+}
+
+void AsyncLoader::update()
+{
+    GP_PROFILE_ZONE("AsyncLoader::update");
+
+    double startTime = Game::getAbsoluteTime();
+    bool finishing = true;
+    std::list<Request*>::iterator itr = _requests.begin();
+    while (itr != _requests.end())
+    {
+        Request* request = *itr;
+
+        LOADER_LOCK(_sync);
+        State state = request->_state;
+        float progress = request->_progress;
+        bool cancelled = request->_cancelled;
+        if (cancelled && state == QUEUED)
+        {
+            _queue.remove(request);
+        }
+        LOADER_UNLOCK(_sync);
+
+        if (cancelled && state != LOADING)
+        {
+            // Drop cancelled requests once the loading thread is done with them.
+            request->_state = CANCELLED;
+            itr = _requests.erase(itr);
+            SAFE_RELEASE(request);
+            continue;
+        }
+
+        if (state == LOADED && finishing)
+        {
+            bool done = true;
+            bool succeeded = request->_readSucceeded && request->finish(startTime + _frameBudget, &done);
+            if (Game::getAbsoluteTime() - startTime >= _frameBudget)
+            {
+                finishing = false;
+            }
+
+            if (done)
+            {
+                LOADER_LOCK(_sync);
+                request->_state = succeeded ? COMPLETE : FAILED;
+                request->_progress = 1.0f;
+                LOADER_UNLOCK(_sync);
+
+                itr = _requests.erase(itr);
+                if (request->_listener)
+                {
+                    if (succeeded && request->_notifiedProgress < 1.0f)
+                    {
+                        request->_notifiedProgress = 1.0f;
+                        request->_listener->loadProgress(request, 1.0f);
+                    }
+                    request->_listener->loadComplete(request);
+                }
+                SAFE_RELEASE(request);
+                continue;
+            }
+
+            // The request continues in the next frame.
+            progress = request->getProgress();
+        }
+
+        if (request->_listener && progress != request->_notifiedProgress)
+        {
+            request->_notifiedProgress = progress;
+            request->_listener->loadProgress(request, progress);
+        }
+        ++itr;
+    }
+}
+
+unsigned int AsyncLoader::getPendingCount() const
+{
+    return (unsigned int)_requests.size();
+}
+
+float AsyncLoader::getFrameBudget() const
+{
+    return _frameBudget;
+}
+
+void AsyncLoader::setFrameBudget(float budget)
+{
+    _frameBudget = budget;
+}
+
+AsyncLoader::Request::Request(AsyncLoader* loader, Type type, const char* url, Listener* listener)
+    : _loader(loader), _type(type), _url(url), _listener(listener), _generateMipmaps(false), _keepData(false),
+    _state(QUEUED), _progress(0.0f), _notifiedProgress(0.0f), _cancelled(false), _readSucceeded(false),
+    _properties(NULL), _sceneLoader(NULL), _sceneTexturesCreated(0), _bundle(NULL), _image(NULL), _scene(NULL), _texture(NULL),
+    _driverHash(0)
+{
+}
+
+AsyncLoader::Request::~Request()
+{
+    SAFE_DELETE(_properties);
+    SAFE_DELETE(_sceneLoader);
+    for (size_t i = 0, count = _sceneTextures.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_sceneTextures[i].image);
+        SAFE_RELEASE(_sceneTextures[i].texture);
+    }
+    SAFE_RELEASE(_bundle);
+    SAFE_RELEASE(_image);
+    SAFE_RELEASE(_scene);
+    SAFE_RELEASE(_texture);
+    for (size_t i = 0, count = _effects.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_effects[i]);
+    }
+}
+
+const char* AsyncLoader::Request::getUrl() const
+{
+    return _url.c_str();
+}
+
+AsyncLoader::State AsyncLoader::Request::getState() const
+{
+    if (_loader == NULL)
+        return _state;
+
+    LOADER_LOCK(_loader->_sync);
+    State state = _state;
+    LOADER_UNLOCK(_loader->_sync);
+    return state;
+}
+
+bool AsyncLoader::Request::isDone() const
+{
+    State state = getState();
+    return state == COMPLETE || state == FAILED || state == CANCELLED;
+}
+
+float AsyncLoader::Request::getProgress() const
+{
+    if (_loader == NULL)
+        return _progress;
+
+    LOADER_LOCK(_loader->_sync);
+    float progress = _progress;
+    LOADER_UNLOCK(_loader->_sync);
+    return progress;
+}
+
+void AsyncLoader::Request::cancel()
+{
+    if (_loader == NULL)
+        return;
+
+    LOADER_LOCK(_loader->_sync);
+    _cancelled = true;
+    LOADER_UNLOCK(_loader->_sync);
+}
+
+Scene* AsyncLoader::Request::getScene() const
+{
+    return _state == COMPLETE ? _scene : NULL;
+}
+
+Bundle* AsyncLoader::Request::getBundle() const
+{
+    return _state == COMPLETE && _type == BUNDLE ? _bundle : NULL;
+}
+
+Texture* AsyncLoader::Request::getTexture() const
+{
+    return _state == COMPLETE ? _texture : NULL;
+}
+
+Properties* AsyncLoader::Request::getProperties() const
+{
+    return _state == COMPLETE && _type == PROPERTIES ? _properties : NULL;
+}
+
+Properties* AsyncLoader::Request::takeProperties()
+{
+    Properties* properties = getProperties();
+    if (properties)
+        _properties = NULL;
+    return properties;
+}
+
+unsigned int AsyncLoader::Request::getEffectCount() const
+{
+    return _state == COMPLETE ? (unsigned int)_effects.size() : 0;
+}
+
+Effect* AsyncLoader::Request::getEffect(unsigned int index) const
+{
+    GP_ASSERT(index < getEffectCount());
+    return _effects[index];
+}
+
+void AsyncLoader::Request::setProgress(float progress)
+{
+    LOADER_LOCK(_loader->_sync);
+    _progress = progress;
+    LOADER_UNLOCK(_loader->_sync);
+}
+
+bool AsyncLoader::Request::isCancelled() const
+{
+    LOADER_LOCK(_loader->_sync);
+    bool cancelled = _cancelled;
+    LOADER_UNLOCK(_loader->_sync);
+    return cancelled;
+}
+
+bool AsyncLoader::Request::read()
+{
+    GP_PROFILE_ZONE("AsyncLoader::Request::read");
+
+    const char* url = _url.c_str();
+    switch (_type)
+    {
+    case SCENE:
+        {
+            if (hasExtension(url, ".gpb"))
+            {
+                _bundle = readBundle(url, 0.0f, 1.0f);
+                return _bundle != NULL;
+            }
+
+            // Read the scene file and the material and other files it references.
+            _sceneLoader = new SceneLoader();
+            if (!_sceneLoader->read(url))
+            {
+                return false;
+            }
+            setProgress(ASYNCLOADER_SCENE_FILE_PROGRESS);
+            readSceneTextures(ASYNCLOADER_SCENE_FILE_PROGRESS, ASYNCLOADER_SCENE_TEXTURE_PROGRESS);
+
+            // Open the main bundle of the scene. Errors are reported by the scene loader.
+            if (!_sceneLoader->_gpbPath.empty() && !isCancelled())
+            {
+                _bundle = readBundle(_sceneLoader->_gpbPath.c_str(), ASYNCLOADER_SCENE_TEXTURE_PROGRESS, 1.0f);
+            }
+            return true;
+        }
+
+    case BUNDLE:
+        _bundle = readBundle(url, 0.0f, 1.0f);
+        return _bundle != NULL;
+
+    case TEXTURE:
+        // Compressed textures are read when the texture is created.
+        if (hasExtension(FileSystem::resolvePath(url), ".png"))
+        {
+            _image = Image::create(url);
+            return _image != NULL;
+        }
+        return true;
+
+    case PROPERTIES:
+        _properties = Properties::create(url);
+        return _properties != NULL;
+
+    case EFFECTS:
+        {
+            Properties* properties = Properties::create(url);
+            if (properties == NULL)
+            {
+                GP_WARN("Failed to load effect manifest '%s'.", url);
+                return false;
+            }
+
+            Properties* effects = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+            if (effects == NULL || strcmp(effects->getNamespace(), "effects") != 0)
+            {
+                GP_WARN("Effect manifest '%s' has no 'effects' namespace.", url);
+                SAFE_DELETE(properties);
+                return false;
+            }
+
+            Properties* effect;
+            while ((effect = effects->getNextNamespace()) != NULL)
+            {
+                const char* vshPath = effect->getString("vertexShader");
+                const char* fshPath = effect->getString("fragmentShader");
+                if (strcmp(effect->getNamespace(), "effect") != 0 || vshPath == NULL || fshPath == NULL)
+                {
+                    GP_WARN("Ignoring invalid effect '%s' in effect manifest '%s'.", effect->getNamespace(), url);
+                    continue;
+                }
+
+                EffectSource source;
+                source.vshPath = vshPath;
+                source.fshPath = fshPath;
+                const char* defines = effect->getString("defines");
+                if (defines)
+                {
+                    source.defines = defines;
+                }
+                _effectSources.push_back(source);
+            }
+            SAFE_DELETE(properties);
+
+            if (!_programCachePath.empty())
+            {
+                ProgramCache::readFile(_programCachePath.c_str(), _driverHash, _programBinaries);
+            }
+            setProgress(ASYNCLOADER_EFFECTS_FILE_PROGRESS);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Bundle* AsyncLoader::Request::readBundle(const char* path, float progressBegin, float progressEnd)
+{
+    Bundle* bundle = Bundle::open(path);
+    if (bundle == NULL)
+    {
+        return NULL;
+    }
+
+    unsigned int objectCount = bundle->getObjectCount();
+    for (unsigned int i = 0; i < objectCount; ++i)
+    {
+        if (isCancelled() || !bundle->preloadMeshData(i))
+        {
+            SAFE_RELEASE(bundle);
+            return NULL;
+        }
+        setProgress(progressBegin + (progressEnd - progressBegin) * (i + 1) / objectCount);
+    }
+
+    return bundle;
+}
+
+void AsyncLoader::Request::readSceneTextures(float progressBegin, float progressEnd)
+{
+    std::map<std::string, bool> textures;
+    _sceneLoader->findMaterialTextures(textures);
+
+    // Compressed textures, and images that fail to decode, are left to the materials.
+    unsigned int textureIndex = 0;
+    for (std::map<std::string, bool>::const_iterator itr = textures.begin(); itr != textures.end(); ++itr, ++textureIndex)
+    {
+        if (isCancelled())
+            return;
+
+        const char* path = itr->first.c_str();
+        Image* image = hasExtension(FileSystem::resolvePath(path), ".png") ? Image::create(path) : NULL;
+        if (image)
+        {
+            SceneTexture texture;
+            texture.path = path;
+            texture.generateMipmaps = itr->second;
+            texture.image = image;
+            texture.texture = NULL;
+            _sceneTextures.push_back(texture);
+        }
+        setProgress(progressBegin + (progressEnd - progressBegin) * (textureIndex + 1) / textures.size());
+    }
+}
+
+Texture* AsyncLoader::Request::createTexture(const char* path, Image* image, bool generateMipmaps)
+{
+    Texture* texture = Texture::getCache().find(path);
+    if (texture)
+    {
+        if (generateMipmaps)
+        {
+            texture->generateMipmaps();
+        }
+        texture->addRef();
+    }
+    else if (image)
+    {
+        texture = Texture::create(image, generateMipmaps);
+        if (texture)
+        {
+            Texture::addToCache(texture, path);
+        }
+    }
+    else
+    {
+        texture = Texture::create(path, generateMipmaps);
+    }
+    return texture;
+}
+
+bool AsyncLoader::Request::finish(double endTime, bool* done)
+{
+    GP_PROFILE_ZONE("AsyncLoader::Request::finish");
+
+    const char* url = _url.c_str();
+    switch (_type)
+    {
+    case SCENE:
+        if (_sceneLoader)
+        {
+            // Create the textures of the materials first, over as many frames as needed, so
+            // that the materials find them in the texture cache when the scene is built.
+            unsigned int textureCount = (unsigned int)_sceneTextures.size();
+            while (_sceneTexturesCreated < textureCount)
+            {
+                SceneTexture& texture = _sceneTextures[_sceneTexturesCreated++];
+                texture.texture = createTexture(texture.path.c_str(), texture.image, texture.generateMipmaps);
+                SAFE_RELEASE(texture.image);
+                if (Game::getAbsoluteTime() >= endTime)
+                {
+                    *done = false;
+                    return true;
+                }
+            }
+
+            _scene = _sceneLoader->create(_bundle, _keepData);
+            SAFE_DELETE(_sceneLoader);
+        }
+        else if (_bundle)
+        {
+            _scene = _bundle->loadScene(NULL, _keepData);
+        }
+        SAFE_RELEASE(_bundle);
+
+        // The materials reference the textures they use.
+        for (size_t i = 0, count = _sceneTextures.size(); i < count; ++i)
+        {
+            SAFE_RELEASE(_sceneTextures[i].texture);
+        }
+        _sceneTextures.clear();
+        return _scene != NULL;
+
+    case BUNDLE:
+        return _bundle != NULL;
+
+    case TEXTURE:
+        _texture = createTexture(url, _image, _generateMipmaps);
+        SAFE_RELEASE(_image);
+        return _texture != NULL;
+
+    case PROPERTIES:
+        return _properties != NULL;
+
+    case EFFECTS:
+        {
+            if (!_programCachePath.empty())
+            {
+                ProgramCache::addBinaries(_programBinaries);
+                _programCachePath.clear();
+            }
+
+            // Create at least one effect each frame so the request always progresses.
+            size_t effectCount = _effectSources.size();
+            for (size_t i = _effects.size(); i < effectCount; ++i)
+            {
+                const EffectSource& source = _effectSources[i];
+                Effect* effect = Effect::createFromFile(source.vshPath.c_str(), source.fshPath.c_str(),
+                    source.defines.empty() ? NULL : source.defines.c_str());
+                if (effect == NULL)
+                {
+                    return false;
+                }
+                _effects.push_back(effect);
+
+                setProgress(ASYNCLOADER_EFFECTS_FILE_PROGRESS + (1.0f - ASYNCLOADER_EFFECTS_FILE_PROGRESS) * (i + 1) / effectCount);
+                if (i + 1 < effectCount && Game::getAbsoluteTime() >= endTime)
+                {
+                    *done = false;
+                    return true;
+                }
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,479 @@
+#ifndef ASYNCLOADER_H_
+#define ASYNCLOADER_H_
+
+#include "Ref.h"
+#include "ProgramCache.h"
+
+namespace gameplay
+{
+
+class Bundle;
+class Effect;
+class Image;
+class Properties;
+class Scene;
+class SceneLoader;
+class Texture;
+
+/**
+ * Defines a loader that reads scenes, bundles, textures and properties, and warms up
+ * effects, in the background.
+ *
+ * The loader is owned by the Game and runs a single loading thread. Each request is
+ * carried out in two steps:
+ *
+ * - The loading thread reads the files of the request: it parses Properties files
+ *   (for scenes, also the files they reference, such as materials), decodes PNG
+ *   images (for scenes, the textures of their materials) and opens bundles, reading
+ *   the vertex and index data of all of their meshes.
+ * - The main thread then creates the GL objects from the data that was read (textures,
+ *   vertex and index buffers, effects and materials) and builds the scene graph.
+ *
+ * The second step runs at the start of each frame, within a time budget, so the game
+ * keeps updating and rendering while content streams in. At least one request is
+ * completed each frame that has a request ready, so a request that takes longer than
+ * the budget still completes (in a longer frame).
+ *
+ * Listeners are notified from the main thread, during Game::frame().
+ *
+ * @script{ignore}
+ */
+class AsyncLoader
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines the states of a load request.
+     */
+    enum State
+    {
+        QUEUED,         // Waiting for the loading thread.
+        LOADING,        // Being read by the loading thread.
+        LOADED,         // Waiting for the main thread to create its GL objects.
+        COMPLETE,       // Loaded successfully.
+        FAILED,         // Failed to load.
+        CANCELLED       // Cancelled before it completed.
+    };
+
+    class Request;
+
+    /**
+     * Defines an interface for being notified of the progress of load requests.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() { }
+
+        /**
+         * Called when the progress of a request changed.
+         *
+         * @param request The request.
+         * @param progress The progress of the request, from 0 to 1.
+         */
+        virtual void loadProgress(Request* request, float progress) { }
+
+        /**
+         * Called when a request completed or failed.
+         *
+         * @param request The request, in the COMPLETE or FAILED state.
+         */
+        virtual void loadComplete(Request* request) = 0;
+    };
+
+    /**
+     * Defines a handle to an asynchronous load.
+     */
+    class Request : public Ref
+    {
+        friend class AsyncLoader;
+
+    public:
+
+        /**
+         * Returns the URL being loaded.
+         *
+         * @return The URL.
+         */
+        const char* getUrl() const;
+
+        /**
+         * Returns the state of this request.
+         *
+         * @return The state.
+         */
+        State getState() const;
+
+        /**
+         * Returns whether this request completed, failed or was cancelled.
+         *
+         * @return true if the request is done, false otherwise.
+         */
+        bool isDone() const;
+
+        /**
+         * Returns the progress of this request.
+         *
+         * @return The progress, from 0 to 1.
+         */
+        float getProgress() const;
+
+        /**
+         * Cancels this request. Its listener is not notified.
+         */
+        void cancel();
+
+        /**
+         * Returns the scene loaded by a loadScene() request.
+         *
+         * The scene is released with the request; call addRef() to keep it.
+         *
+         * @return The scene, or NULL if the request did not complete.
+         */
+        Scene* getScene() const;
+
+        /**
+         * Returns the bundle opened by a loadBundle() request.
+         *
+         * The bundle is released with the request; call addRef() to keep it.
+         *
+         * @return The bundle, or NULL if the request did not complete.
+         */
+        Bundle* getBundle() const;
+
+        /**
+         * Returns the texture loaded by a loadTexture() request.
+         *
+         * The texture is released with the request; call addRef() to keep it.
+         *
+         * @return The texture, or NULL if the request did not complete.
+         */
+        Texture* getTexture() const;
+
+        /**
+         * Returns the properties loaded by a loadProperties() request.
+         *
+         * The properties are deleted with the request, unless they are taken with takeProperties().
+         *
+         * @return The properties, or NULL if the request did not complete.
+         */
+        Properties* getProperties() const;
+
+        /**
+         * Takes ownership of the properties loaded by a loadProperties() request.
+         *
+         * @return The properties, which must be deleted by the caller, or NULL.
+         */
+        Properties* takeProperties();
+
+        /**
+         * Returns the number of effects created by a loadEffects() request.
+         *
+         * @return The number of effects.
+         */
+        unsigned int getEffectCount() const;
+
+        /**
+         * Returns an effect created by a loadEffects() request.
+         *
+         * The effects are released with the request; call addRef() to keep them.
+         *
+         * @param index The index of the effect.
+         *
+         * @return The effect.
+         */
+        Effect* getEffect(unsigned int index) const;
+
+    private:
+
+        /**
+         * Defines the kinds of requests.
+         */
+        enum Type
+        {
+            SCENE,
+            BUNDLE,
+            TEXTURE,
+            PROPERTIES,
+            EFFECTS
+        };
+
+        /**
+         * The shaders and defines of an effect of an effect manifest.
+         */
+        struct EffectSource
+        {
+            std::string vshPath;
+            std::string fshPath;
+            std::string defines;
+        };
+
+        /**
+         * A texture of a material of a scene.
+         */
+        struct SceneTexture
+        {
+            std::string path;
+            bool generateMipmaps;
+            Image* image;                            // The decoded image, released once the texture is created.
+            Texture* texture;                        // The created texture, or NULL.
+        };
+
+        /**
+         * Constructor.
+         */
+        Request(AsyncLoader* loader, Type type, const char* url, Listener* listener);
+
+        /**
+         * Hidden copy constructor.
+         */
+        Request(const Request& copy);
+
+        /**
+         * Destructor.
+         */
+        ~Request();
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Request& operator=(const Request&);
+
+        /**
+         * Reads the files of the request. Called from the loading thread.
+         *
+         * @return true if the files were read, false otherwise.
+         */
+        bool read();
+
+        /**
+         * Opens a bundle and reads the data of its meshes. Called from the loading thread.
+         */
+        Bundle* readBundle(const char* path, float progressBegin, float progressEnd);
+
+        /**
+         * Decodes the PNG textures of the materials of a scene. Called from the loading thread.
+         */
+        void readSceneTextures(float progressBegin, float progressEnd);
+
+        /**
+         * Creates a texture from an image decoded by the loading thread, or finds it in the texture cache.
+         */
+        static Texture* createTexture(const char* path, Image* image, bool generateMipmaps);
+
+        /**
+         * Creates the objects of the request from the data that was read. Called from the main thread.
+         *
+         * Requests that create many objects stop once endTime is reached, leaving done set
+         * to false, and continue the next time they are finished.
+         *
+         * @param endTime The absolute time at which to stop, in milliseconds (see Game::getAbsoluteTime()).
+         * @param done Set to whether all objects were created.
+         *
+         * @return true if the objects were created, false otherwise.
+         */
+        bool finish(double endTime, bool* done);
+
+        /**
+         * Sets the progress of the request. Called from the loading thread.
+         */
+        void setProgress(float progress);
+
+        /**
+         * Returns whether the request was cancelled. Called from the loading thread.
+         */
+        bool isCancelled() const;
+
+        AsyncLoader* _loader;                        // The loader that owns the loading thread.
+        Type _type;                                  // The kind of request.
+        std::string _url;                            // The URL to load.
+        Listener* _listener;                         // The listener to notify, or NULL.
+        bool _generateMipmaps;                       // Whether to generate the mipmaps of a texture.
+        bool _keepData;                              // Whether to keep the vertex data of a scene.
+        State _state;                                // Guarded by the loader's lock.
+        float _progress;                             // Guarded by the loader's lock.
+        float _notifiedProgress;                     // Progress last reported to the listener.
+        bool _cancelled;                             // Guarded by the loader's lock.
+        bool _readSucceeded;                         // Whether the loading thread read the files of the request.
+        Properties* _properties;                     // The properties file that was read.
+        SceneLoader* _sceneLoader;                   // The scene file that was read, and the files it references.
+        std::vector<SceneTexture> _sceneTextures;    // The textures of the materials of the scene.
+        unsigned int _sceneTexturesCreated;          // The number of scene textures created.
+        Bundle* _bundle;                             // The bundle that was opened.
+        Image* _image;                               // The image that was decoded.
+        Scene* _scene;                               // The loaded scene.
+        Texture* _texture;                           // The loaded texture.
+        std::vector<EffectSource> _effectSources;    // The effects of an effect manifest.
+        std::vector<Effect*> _effects;               // The created effects.
+        std::string _programCachePath;               // The program cache file to read, or empty.
+        unsigned long long _driverHash;              // The driver the program cache file must match.
+        ProgramCache::BinaryMap _programBinaries;    // The binaries read from the program cache file.
+    };
+
+    /**
+     * Loads a scene in the background.
+     *
+     * The URL names either a .scene file or a .gpb bundle, as with Scene::load(). The
+     * textures of the materials of a .scene file are created over several frames before
+     * the scene is built, and are shared with Texture::create().
+     *
+     * @param url The URL of the scene.
+     * @param listener The listener to notify, or NULL.
+     * @param keepData Whether to keep the vertex data of the meshes of the scene.
+     *
+     * @return The new request. It must be released when no longer needed.
+     */
+    Request* loadScene(const char* url, Listener* listener = NULL, bool keepData = false);
+
+    /**
+     * Opens a bundle in the background, reading the data of all of its meshes.
+     *
+     * The bundle is not shared with Bundle::create().
+     *
+     * @param path The path of the bundle.
+     * @param listener The listener to notify, or NULL.
+     *
+     * @return The new request. It must be released when no longer needed.
+     */
+    Request* loadBundle(const char* path, Listener* listener = NULL);
+
+    /**
+     * Loads a texture in the background.
+     *
+     * PNG images are decoded by the loading thread; compressed textures are read by the
+     * main thread. The texture is shared with Texture::create().
+     *
+     * @param path The path of the texture.
+     * @param generateMipmaps Whether to generate a full mipmap chain.
+     * @param listener The listener to notify, or NULL.
+     *
+     * @return The new request. It must be released when no longer needed.
+     */
+    Request* loadTexture(const char* path, bool generateMipmaps = false, Listener* listener = NULL);
+
+    /**
+     * Reads a properties file in the background.
+     *
+     * @param url The URL of the properties.
+     * @param listener The listener to notify, or NULL.
+     *
+     * @return The new request. It must be released when no longer needed.
+     */
+    Request* loadProperties(const char* url, Listener* listener = NULL);
+
+    /**
+     * Creates the effects listed in a manifest, spreading their compilation over frames.
+     *
+     * The loading thread reads the manifest and the program binary cache (see ProgramCache).
+     * Shaders must be compiled on the main thread, which owns the GL context, so the
+     * effects are created at the start of each frame until the frame budget is used.
+     * With a warm program cache, most effects are created from their binaries.
+     *
+     * The manifest lists the shaders and defines of each effect, as in a material pass:
+     * <pre>
+     * effects
+     * {
+     *     effect
+     *     {
+     *         vertexShader = res/shaders/textured.vert
+     *         fragmentShader = res/shaders/textured.frag
+     *         defines = SKINNING;SKINNING_JOINT_COUNT 32
+     *     }
+     * }
+     * </pre>
+     *
+     * The effects are shared with Effect::createFromFile() while the request references them.
+     *
+     * @param url The URL of the manifest.
+     * @param listener The listener to notify, or NULL.
+     *
+     * @return The new request. It must be released when no longer needed.
+     */
+    Request* loadEffects(const char* url, Listener* listener = NULL);
+
+    /**
+     * Returns the number of requests that are not done.
+     *
+     * @return The number of pending requests.
+     */
+    unsigned int getPendingCount() const;
+
+    /**
+     * Returns the time the main thread may spend completing requests each frame.
+     *
+     * @return The time budget, in milliseconds.
+     */
+    float getFrameBudget() const;
+
+    /**
+     * Sets the time the main thread may spend completing requests each frame.
+     *
+     * @param budget The time budget, in milliseconds.
+     */
+    void setFrameBudget(float budget);
+
+private:
+
+    /**
+     * Platform synchronization data (defined in the implementation).
+     */
+    struct SyncData;
+
+    /**
+     * Constructor.
+     */
+    AsyncLoader();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AsyncLoader(const AsyncLoader& copy);
+
+    /**
+     * Destructor. Stops the loading thread and releases the pending requests.
+     */
+    ~AsyncLoader();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AsyncLoader& operator=(const AsyncLoader&);
+
+    /**
+     * Queues a request for the loading thread.
+     */
+    Request* submit(Request* request);
+
+    /**
+     * Reports progress and completes the loaded requests, within the frame budget.
+     * Called by the game at the start of each frame.
+     */
+    void update();
+
+    /**
+     * Entry point of the loading thread.
+     */
+    void threadMain();
+
+#ifdef WIN32
+    static unsigned long __stdcall threadFunc(void* arg);
+#else
+    static void* threadFunc(void* arg);
+#endif
+
+    SyncData* _sync;                        // Lock and loading thread.
+    std::list<Request*> _queue;             // Requests waiting for the loading thread.
+    std::list<Request*> _requests;          // Requests that are not done, in submission order.
+    float _frameBudget;                     // Time budget of update(), in milliseconds.
+    bool _shutdown;                         // Whether the loading thread must exit.
+};
+
+}
+
+#endif
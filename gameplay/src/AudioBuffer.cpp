@@ -343,13 +343,7 @@ bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer)
 
     stream->rewind();
 
-    ov_callbacks callbacks;
-    callbacks.read_func = readStream;
-    callbacks.seek_func = seekStream;
-    callbacks.close_func = closeStream;
-    callbacks.tell_func = tellStream;
-
-    if ((result = ov_open_callbacks(stream, &ogg_file, NULL, 0, callbacks)) < 0)
+    if (!openOgg(stream, &ogg_file))
     {
         GP_ERROR("Failed to open ogg file.");
         return false;
@@ -400,4 +394,17 @@ bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer)
     return true;
 }
 
+bool AudioBuffer::openOgg(Stream* stream, OggVorbis_File* file)
+{
+    GP_ASSERT(stream && file);
+
+    ov_callbacks callbacks;
+    callbacks.read_func = readStream;
+    callbacks.seek_func = seekStream;
+    callbacks.close_func = closeStream;
+    callbacks.tell_func = tellStream;
+
+    return ov_open_callbacks(stream, file, NULL, 0, callbacks) >= 0;
+}
+
 }
@@ -17,6 +17,7 @@ class AudioSource;
 class AudioBuffer : public Ref
 {
     friend class AudioSource;
+    friend class AudioStream;
 
 private:
     
@@ -48,6 +49,13 @@ private:
     
     static bool loadOgg(Stream* stream, ALuint buffer);
 
+    /**
+     * Opens an Ogg Vorbis file read from a stream. The stream is closed by ov_clear().
+     *
+     * @return true if the file was opened, false otherwise.
+     */
+    static bool openOgg(Stream* stream, OggVorbis_File* file);
+
     std::string _filePath;
     ALuint _alBuffer;
 };
@@ -3,6 +3,7 @@
 #include "AudioListener.h"
 #include "AudioBuffer.h"
 #include "AudioSource.h"
+#include "AudioStream.h"
 
 namespace gameplay
 {
@@ -18,6 +19,8 @@ AudioController::~AudioController()
 
 void AudioController::initialize()
 {
+    AudioStream::initializeDecoder();
+
     _alcDevice = alcOpenDevice(NULL);
     if (!_alcDevice)
     {
@@ -44,6 +47,8 @@ void AudioController::initialize()
 
 void AudioController::finalize()
 {
+    AudioStream::finalizeDecoder();
+
     alcMakeContextCurrent(NULL);
     if (_alcContext)
     {
@@ -93,6 +98,7 @@ void AudioController::resume()
 
 void AudioController::update(float elapsedTime)
 {
+    GP_PROFILE_ZONE("AudioController::update");
     AudioListener* listener = AudioListener::getInstance();
     if (listener)
     {
@@ -101,6 +107,9 @@ void AudioController::update(float elapsedTime)
         AL_CHECK( alListenerfv(AL_VELOCITY, (ALfloat*)&listener->getVelocity()) );
         AL_CHECK( alListenerfv(AL_POSITION, (ALfloat*)&listener->getPosition()) );
     }
+
+    // Queue the chunks decoded for streamed sources.
+    AudioStream::updateStreams();
 }
 
 }
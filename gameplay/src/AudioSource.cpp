@@ -3,6 +3,7 @@
 #include "AudioBuffer.h"
 #include "AudioController.h"
 #include "AudioSource.h"
+#include "AudioStream.h"
 #include "Game.h"
 #include "Node.h"
 
@@ -10,7 +11,7 @@ namespace gameplay
 {
 
 AudioSource::AudioSource(AudioBuffer* buffer, ALuint source) 
-    : _alSource(source), _buffer(buffer), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL)
+    : _alSource(source), _buffer(buffer), _stream(NULL), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL)
 {
     GP_ASSERT(buffer);
     AL_CHECK( alSourcei(_alSource, AL_BUFFER, buffer->_alBuffer) );
@@ -20,8 +21,20 @@ AudioSource::AudioSource(AudioBuffer* buffer, ALuint source)
     AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
 }
 
+AudioSource::AudioSource(AudioStream* stream, ALuint source) 
+    : _alSource(source), _buffer(NULL), _stream(stream), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL)
+{
+    GP_ASSERT(stream);
+    _stream->setSource(_alSource);
+    AL_CHECK( alSourcef(_alSource, AL_PITCH, _pitch) );
+    AL_CHECK( alSourcef(_alSource, AL_GAIN, _gain) );
+    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
+}
+
 AudioSource::~AudioSource()
 {
+    // The stream unqueues its buffers from the source.
+    SAFE_DELETE(_stream);
     if (_alSource)
     {
         AL_CHECK( alDeleteSources(1, &_alSource) );
@@ -30,7 +43,7 @@ AudioSource::~AudioSource()
     SAFE_RELEASE(_buffer);
 }
 
-AudioSource* AudioSource::create(const char* url)
+AudioSource* AudioSource::create(const char* url, bool streamed)
 {
     // Load from a .audio file.
     std::string pathStr = url;
@@ -48,10 +61,23 @@ AudioSource* AudioSource::create(const char* url)
         return audioSource;
     }
 
-    // Create an audio buffer from this URL.
-    AudioBuffer* buffer = AudioBuffer::create(url);
-    if (buffer == NULL)
-        return NULL;
+    // Open a stream from this URL, or create an audio buffer from it.
+    AudioStream* stream = NULL;
+    AudioBuffer* buffer = NULL;
+    if (streamed)
+    {
+        stream = AudioStream::create(url);
+        if (stream == NULL)
+        {
+            GP_WARN("Audio file '%s' cannot be streamed; loading it whole instead.", url);
+        }
+    }
+    if (stream == NULL)
+    {
+        buffer = AudioBuffer::create(url);
+        if (buffer == NULL)
+            return NULL;
+    }
 
     // Load the audio source.
     ALuint alSource = 0;
@@ -60,10 +86,13 @@ AudioSource* AudioSource::create(const char* url)
     if (AL_LAST_ERROR())
     {
         SAFE_RELEASE(buffer);
+        SAFE_DELETE(stream);
         GP_ERROR("Error generating audio source.");
         return NULL;
     }
     
+    if (stream)
+        return new AudioSource(stream, alSource);
     return new AudioSource(buffer, alSource);
 }
 
@@ -85,7 +114,7 @@ AudioSource* AudioSource::create(Properties* properties)
     }
 
     // Create the audio source.
-    AudioSource* audio = AudioSource::create(path.c_str());
+    AudioSource* audio = AudioSource::create(path.c_str(), properties->getBool("streamed"));
     if (audio == NULL)
     {
         GP_ERROR("Audio file '%s' failed to load properly.", path.c_str());
@@ -116,6 +145,10 @@ AudioSource* AudioSource::create(Properties* properties)
 
 AudioSource::State AudioSource::getState() const
 {
+    // A stream is playing while it waits for chunks to be decoded.
+    if (_stream && _stream->isPlaying())
+        return PLAYING;
+
     ALint state;
     AL_CHECK( alGetSourcei(_alSource, AL_SOURCE_STATE, &state) );
 
@@ -135,7 +168,14 @@ AudioSource::State AudioSource::getState() const
 
 void AudioSource::play()
 {
-    AL_CHECK( alSourcePlay(_alSource) );
+    if (_stream)
+    {
+        _stream->play();
+    }
+    else
+    {
+        AL_CHECK( alSourcePlay(_alSource) );
+    }
 
     // Add the source to the controller's list of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
@@ -146,7 +186,14 @@ void AudioSource::play()
 
 void AudioSource::pause()
 {
-    AL_CHECK( alSourcePause(_alSource) );
+    if (_stream)
+    {
+        _stream->pause();
+    }
+    else
+    {
+        AL_CHECK( alSourcePause(_alSource) );
+    }
 
     // Remove the source from the controller's set of currently playing sources
     // if the source is being paused by the user and not the controller itself.
@@ -170,7 +217,14 @@ void AudioSource::resume()
 
 void AudioSource::stop()
 {
-    AL_CHECK( alSourceStop(_alSource) );
+    if (_stream)
+    {
+        _stream->stop();
+    }
+    else
+    {
+        AL_CHECK( alSourceStop(_alSource) );
+    }
 
     // Remove the source from the controller's set of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
@@ -182,6 +236,10 @@ void AudioSource::stop()
 
 void AudioSource::rewind()
 {
+    if (_stream)
+    {
+        _stream->stop();
+    }
     AL_CHECK( alSourceRewind(_alSource) );
 }
 
@@ -192,10 +250,18 @@ bool AudioSource::isLooped() const
 
 void AudioSource::setLooped(bool looped)
 {
-    AL_CHECK( alSourcei(_alSource, AL_LOOPING, (looped) ? AL_TRUE : AL_FALSE) );
-    if (AL_LAST_ERROR())
+    // A stream loops by decoding the start of the file again.
+    if (_stream)
     {
-        GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        _stream->setLooped(looped);
+    }
+    else
+    {
+        AL_CHECK( alSourcei(_alSource, AL_LOOPING, (looped) ? AL_TRUE : AL_FALSE) );
+        if (AL_LAST_ERROR())
+        {
+            GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        }
     }
     _looped = looped;
 }
@@ -250,6 +316,9 @@ void AudioSource::setVelocity(float x, float y, float z)
 
 int AudioSource::getPositionInSample() const
 {
+	if (_stream)
+		return (int)_stream->getPosition();
+
 	ALint pos;
     AL_CHECK( alGetSourcei(_alSource, AL_SAMPLE_OFFSET, &pos) );
 	return pos;
@@ -257,11 +326,26 @@ int AudioSource::getPositionInSample() const
 
 float AudioSource::getPositionInSec() const
 {
+	if (_stream)
+		return (float)_stream->getPosition() / _stream->getFrequency();
+
 	ALfloat pos;
     AL_CHECK( alGetSourcef(_alSource, AL_SEC_OFFSET, &pos) );
 	return pos;
 }
 
+void AudioSource::setPositionInSec(float seconds)
+{
+    if (_stream)
+    {
+        _stream->seek((long long)(seconds * _stream->getFrequency()));
+    }
+    else
+    {
+        AL_CHECK( alSourcef(_alSource, AL_SEC_OFFSET, seconds) );
+    }
+}
+
 Node* AudioSource::getNode() const
 {
     return _node;
@@ -300,7 +384,7 @@ void AudioSource::transformChanged(Transform* transform, long cookie)
 
 AudioSource* AudioSource::clone(NodeCloneContext &context) const
 {
-    GP_ASSERT(_buffer);
+    GP_ASSERT(_buffer || _stream);
 
     ALuint alSource = 0;
     AL_CHECK( alGenSources(1, &alSource) );
@@ -309,9 +393,25 @@ AudioSource* AudioSource::clone(NodeCloneContext &context) const
         GP_ERROR("Error generating audio source.");
         return NULL;
     }
-    AudioSource* audioClone = new AudioSource(_buffer, alSource);
 
-    _buffer->addRef();
+    // Streams are not shared, so the clone streams the file again.
+    AudioSource* audioClone;
+    if (_stream)
+    {
+        AudioStream* stream = AudioStream::create(_stream->_path.c_str());
+        if (stream == NULL)
+        {
+            GP_ERROR("Failed to stream audio file '%s'.", _stream->_path.c_str());
+            AL_CHECK( alDeleteSources(1, &alSource) );
+            return NULL;
+        }
+        audioClone = new AudioSource(stream, alSource);
+    }
+    else
+    {
+        audioClone = new AudioSource(_buffer, alSource);
+        _buffer->addRef();
+    }
     audioClone->setLooped(isLooped());
     audioClone->setGain(getGain());
     audioClone->setPitch(getPitch());
@@ -9,6 +9,7 @@ namespace gameplay
 {
 
 class AudioBuffer;
+class AudioStream;
 class Node;
 class NodeCloneContext;
 
@@ -38,15 +39,31 @@ public:
      * Alternately, a URL specifying a Properties object that defines an audio source can be used (where the URL is of the format
      * "<file-path>.<extension>#<namespace-id>/<namespace-id>/.../<namespace-id>" and "#<namespace-id>/<namespace-id>/.../<namespace-id>" is optional).
      * 
+     * An Ogg Vorbis file can be streamed: it is then decoded a little ahead of playback by a
+     * decoding thread, instead of being decoded whole when the source is created. Streaming suits
+     * long sounds such as music. Streamed sources do not share their data, unlike other sources.
+     * 
      * @param url The relative location on disk of the sound file or a URL specifying a Properties object defining an audio source.
+     * @param streamed Whether to stream the sound file. Sound files other than Ogg Vorbis files are never streamed.
      * @return The newly created audio source, or NULL if an audio source cannot be created.
      * @script{create}
      */
-    static AudioSource* create(const char* url);
+    static AudioSource* create(const char* url, bool streamed = false);
 
     /**
      * Create an audio source from the given properties object.
      * 
+     * The 'streamed' property selects whether the sound file is streamed (see create(const char*, bool)):
+     * 
+     * @code
+     * audio music
+     * {
+     *     path = res/music.ogg
+     *     looped = true
+     *     streamed = true
+     * }
+     * @endcode
+     * 
      * @param properties The properties object defining the audio source (must have namespace equal to 'audio').
      * @return The newly created audio source, or <code>NULL</code> if the audio source failed to load.
      * @script{create}
@@ -156,6 +173,13 @@ public:
     int getPositionInSample() const;
     float getPositionInSec() const;
 
+    /**
+     * Moves the audio source to a position in its sound.
+     *
+     * @param seconds The position, in seconds from the start of the sound.
+     */
+    void setPositionInSec(float seconds);
+
     /**
      * Gets the node that this source is attached to.
      * 
@@ -170,6 +194,11 @@ private:
      */
     AudioSource(AudioBuffer* buffer, ALuint source);
 
+    /**
+     * Constructor that takes an AudioStream.
+     */
+    AudioSource(AudioStream* stream, ALuint source);
+
     /**
      * Destructor.
      */
@@ -201,6 +230,7 @@ private:
 
     ALuint _alSource;
     AudioBuffer* _buffer;
+    AudioStream* _stream;
     bool _looped;
     float _gain;
     float _pitch;
@@ -0,0 +1,529 @@
+#include "Base.h"
+#include "AudioStream.h"
+#include "AudioBuffer.h"
+#include "FileSystem.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Number of chunks decoded ahead of playback, and of buffers queued on the source.
+#define AUDIOSTREAM_BUFFER_COUNT        4
+
+// Size of a chunk, in bytes (about 0.37 seconds of 44.1 kHz 16-bit stereo samples).
+#define AUDIOSTREAM_CHUNK_SIZE          65536
+
+namespace gameplay
+{
+
+#ifdef WIN32
+
+struct DecoderSyncData
+{
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE decodeRequested;
+    CONDITION_VARIABLE decodeDone;
+    HANDLE thread;
+    bool threadCreated;
+};
+
+#define DECODER_LOCK(s)             EnterCriticalSection(&(s)->lock)
+#define DECODER_UNLOCK(s)           LeaveCriticalSection(&(s)->lock)
+#define DECODER_WAIT(s, cond)       SleepConditionVariableCS(&(s)->cond, &(s)->lock, INFINITE)
+#define DECODER_SIGNAL(s, cond)     WakeConditionVariable(&(s)->cond)
+#define DECODER_BROADCAST(s, cond)  WakeAllConditionVariable(&(s)->cond)
+
+#else
+
+struct DecoderSyncData
+{
+    pthread_mutex_t lock;
+    pthread_cond_t decodeRequested;
+    pthread_cond_t decodeDone;
+    pthread_t thread;
+    bool threadCreated;
+};
+
+#define DECODER_LOCK(s)             pthread_mutex_lock(&(s)->lock)
+#define DECODER_UNLOCK(s)           pthread_mutex_unlock(&(s)->lock)
+#define DECODER_WAIT(s, cond)       pthread_cond_wait(&(s)->cond, &(s)->lock)
+#define DECODER_SIGNAL(s, cond)     pthread_cond_signal(&(s)->cond)
+#define DECODER_BROADCAST(s, cond)  pthread_cond_broadcast(&(s)->cond)
+
+#endif
+
+// The decoding thread, or NULL when the audio controller is not initialized.
+static DecoderSyncData* __sync = NULL;
+
+// The streams, in creation order. Changed by the main thread with the decoder lock held.
+static std::vector<AudioStream*> __streams;
+
+// The stream being decoded by the decoding thread, or NULL. Guarded by the decoder lock.
+static AudioStream* __decodingStream = NULL;
+
+// The stream the decoding thread looks at first, so streams take turns. Guarded by the decoder lock.
+static unsigned int __nextStream = 0;
+
+// Whether the decoding thread must exit. Guarded by the decoder lock.
+static bool __shutdown = false;
+
+// The decoder lock is not needed when there is no decoding thread.
+static void lockDecoder()
+{
+    if (__sync)
+        DECODER_LOCK(__sync);
+}
+
+static void unlockDecoder()
+{
+    if (__sync)
+        DECODER_UNLOCK(__sync);
+}
+
+#ifdef WIN32
+unsigned long __stdcall AudioStream::threadFunc(void* arg)
+#else
+void* AudioStream::threadFunc(void* arg)
+#endif
+{
+    DecoderSyncData* sync = static_cast<DecoderSyncData*>(arg);
+    DECODER_LOCK(sync);
+    while (!__shutdown)
+    {
+        // Find a stream that has room for a chunk.
+        AudioStream* stream = NULL;
+        unsigned int streamCount = (unsigned int)__streams.size();
+        for (unsigned int i = 0; i < streamCount && stream == NULL; ++i)
+        {
+            unsigned int index = (__nextStream + i) % streamCount;
+            if (__streams[index]->needsDecode())
+            {
+                stream = __streams[index];
+                __nextStream = index + 1;
+            }
+        }
+        if (stream == NULL)
+        {
+            DECODER_WAIT(sync, decodeRequested);
+            continue;
+        }
+
+        __decodingStream = stream;
+        stream->decode();
+        __decodingStream = NULL;
+        DECODER_BROADCAST(sync, decodeDone);
+    }
+    DECODER_UNLOCK(sync);
+#ifdef WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+AudioStream::AudioStream(const char* path, Stream* stream, OggVorbis_File* file)
+    : _path(path), _stream(stream), _file(file), _format(AL_FORMAT_STEREO16), _frequency(0), _sampleCount(0), _source(0),
+      _buffers(NULL), _bufferSamples(NULL), _firstQueued(0), _queuedCount(0), _playing(false), _data(NULL), _chunks(NULL),
+      _firstDecoded(0), _decodedCount(0), _decodeSample(0), _seekPending(false), _ended(false), _looped(false), _generation(0)
+{
+    GP_ASSERT(stream && file);
+
+    vorbis_info* info = ov_info(_file, -1);
+    GP_ASSERT(info);
+    _format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    _frequency = info->rate;
+    _sampleCount = ov_pcm_total(_file, -1);
+    if (_sampleCount < 0)
+        _sampleCount = 0;
+
+    _buffers = new ALuint[AUDIOSTREAM_BUFFER_COUNT];
+    _bufferSamples = new long long[AUDIOSTREAM_BUFFER_COUNT];
+    AL_CHECK( alGenBuffers(AUDIOSTREAM_BUFFER_COUNT, _buffers) );
+
+    _data = new char[AUDIOSTREAM_BUFFER_COUNT * AUDIOSTREAM_CHUNK_SIZE];
+    _chunks = new Chunk[AUDIOSTREAM_BUFFER_COUNT];
+    for (unsigned int i = 0; i < AUDIOSTREAM_BUFFER_COUNT; ++i)
+    {
+        _bufferSamples[i] = 0;
+        _chunks[i].data = _data + i * AUDIOSTREAM_CHUNK_SIZE;
+        _chunks[i].size = 0;
+        _chunks[i].sample = 0;
+    }
+}
+
+AudioStream::~AudioStream()
+{
+    // Wait for the decoding thread to be done with the stream.
+    lockDecoder();
+    std::vector<AudioStream*>::iterator itr = std::find(__streams.begin(), __streams.end(), this);
+    if (itr != __streams.end())
+    {
+        __streams.erase(itr);
+    }
+    while (__sync && __decodingStream == this)
+    {
+        DECODER_WAIT(__sync, decodeDone);
+    }
+    unlockDecoder();
+
+    // Buffers cannot be deleted while they are queued.
+    if (_source)
+    {
+        AL_CHECK( alSourceStop(_source) );
+        AL_CHECK( alSourcei(_source, AL_BUFFER, 0) );
+    }
+    AL_CHECK( alDeleteBuffers(AUDIOSTREAM_BUFFER_COUNT, _buffers) );
+
+    ov_clear(_file);
+    SAFE_DELETE(_file);
+    SAFE_DELETE(_stream);
+    SAFE_DELETE_ARRAY(_buffers);
+    SAFE_DELETE_ARRAY(_bufferSamples);
+    SAFE_DELETE_ARRAY(_chunks);
+    SAFE_DELETE_ARRAY(_data);
+}
+
+AudioStream* AudioStream::create(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Only Ogg Vorbis files are streamed.
+    Stream* stream = FileSystem::open(path);
+    char header[4];
+    if (stream == NULL || !stream->canRead() || stream->read(header, 1, 4) != 4 || memcmp(header, "OggS", 4) != 0)
+    {
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+    stream->rewind();
+
+    OggVorbis_File* file = new OggVorbis_File();
+    if (!AudioBuffer::openOgg(stream, file))
+    {
+        SAFE_DELETE(file);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+
+    // Decode the first chunks now, so the stream can start playing at once.
+    AudioStream* audioStream = new AudioStream(path, stream, file);
+    lockDecoder();
+    while (audioStream->needsDecode())
+    {
+        audioStream->decode();
+    }
+    __streams.push_back(audioStream);
+    unlockDecoder();
+
+    return audioStream;
+}
+
+void AudioStream::initializeDecoder()
+{
+    GP_ASSERT(__sync == NULL);
+    __shutdown = false;
+    __sync = new DecoderSyncData();
+
+#ifdef WIN32
+    InitializeCriticalSection(&__sync->lock);
+    InitializeConditionVariable(&__sync->decodeRequested);
+    InitializeConditionVariable(&__sync->decodeDone);
+    __sync->thread = CreateThread(NULL, 0, &AudioStream::threadFunc, __sync, 0, NULL);
+    __sync->threadCreated = __sync->thread != NULL;
+#else
+    pthread_mutex_init(&__sync->lock, NULL);
+    pthread_cond_init(&__sync->decodeRequested, NULL);
+    pthread_cond_init(&__sync->decodeDone, NULL);
+    __sync->threadCreated = pthread_create(&__sync->thread, NULL, &AudioStream::threadFunc, __sync) == 0;
+#endif
+    if (!__sync->threadCreated)
+    {
+        GP_WARN("Failed to create the audio decoding thread; streams are decoded on the main thread.");
+    }
+}
+
+void AudioStream::finalizeDecoder()
+{
+    if (__sync == NULL)
+        return;
+
+    DECODER_LOCK(__sync);
+    __shutdown = true;
+    DECODER_UNLOCK(__sync);
+#ifdef WIN32
+    WakeAllConditionVariable(&__sync->decodeRequested);
+    if (__sync->threadCreated)
+    {
+        WaitForSingleObject(__sync->thread, INFINITE);
+        CloseHandle(__sync->thread);
+    }
+    DeleteCriticalSection(&__sync->lock);
+#else
+    pthread_cond_broadcast(&__sync->decodeRequested);
+    if (__sync->threadCreated)
+    {
+        pthread_join(__sync->thread, NULL);
+    }
+    pthread_cond_destroy(&__sync->decodeDone);
+    pthread_cond_destroy(&__sync->decodeRequested);
+    pthread_mutex_destroy(&__sync->lock);
+#endif
+    SAFE_DELETE(__sync);
+}
+
+void AudioStream::updateStreams()
+{
+    // Without a decoding thread, decode the chunks here.
+    if (__sync == NULL || !__sync->threadCreated)
+    {
+        lockDecoder();
+        for (size_t i = 0, count = __streams.size(); i < count; ++i)
+        {
+            while (__streams[i]->needsDecode())
+            {
+                __streams[i]->decode();
+            }
+        }
+        unlockDecoder();
+    }
+
+    // Only the main thread changes the list, so it can be read without the lock.
+    for (size_t i = 0, count = __streams.size(); i < count; ++i)
+    {
+        __streams[i]->update();
+    }
+}
+
+void AudioStream::setSource(ALuint source)
+{
+    _source = source;
+    AL_CHECK( alSourcei(_source, AL_LOOPING, AL_FALSE) );
+}
+
+void AudioStream::play()
+{
+    // update() starts the source once chunks are queued.
+    _playing = true;
+    update();
+}
+
+void AudioStream::pause()
+{
+    _playing = false;
+    if (_source)
+    {
+        AL_CHECK( alSourcePause(_source) );
+    }
+}
+
+void AudioStream::stop()
+{
+    _playing = false;
+    seek(0);
+}
+
+void AudioStream::seek(long long sample)
+{
+    // Drop the queued buffers and the decoded chunks.
+    if (_source)
+    {
+        AL_CHECK( alSourceStop(_source) );
+        AL_CHECK( alSourcei(_source, AL_BUFFER, 0) );
+    }
+    _firstQueued = 0;
+    _queuedCount = 0;
+
+    lockDecoder();
+    _firstDecoded = 0;
+    _decodedCount = 0;
+    _decodeSample = sample < 0 ? 0 : (sample > _sampleCount ? _sampleCount : sample);
+    _seekPending = true;
+    _ended = false;
+    ++_generation;
+    if (__sync)
+    {
+        DECODER_SIGNAL(__sync, decodeRequested);
+    }
+    unlockDecoder();
+}
+
+void AudioStream::setLooped(bool looped)
+{
+    lockDecoder();
+    _looped = looped;
+
+    // Decode the start of the file again if the end was reached.
+    if (looped && _ended)
+    {
+        _ended = false;
+        if (__sync)
+        {
+            DECODER_SIGNAL(__sync, decodeRequested);
+        }
+    }
+    unlockDecoder();
+}
+
+bool AudioStream::isPlaying() const
+{
+    return _playing;
+}
+
+long long AudioStream::getPosition() const
+{
+    long long sample;
+    if (_queuedCount > 0)
+    {
+        // The offset is from the start of the first buffer that is still queued.
+        ALint offset = 0;
+        AL_CHECK( alGetSourcei(_source, AL_SAMPLE_OFFSET, &offset) );
+        sample = _bufferSamples[_firstQueued] + offset;
+    }
+    else
+    {
+        lockDecoder();
+        sample = _decodedCount > 0 ? _chunks[_firstDecoded].sample : _decodeSample;
+        unlockDecoder();
+    }
+
+    // The last chunk of a looped stream can wrap around to the start of the file.
+    return _sampleCount > 0 ? sample % _sampleCount : sample;
+}
+
+long AudioStream::getFrequency() const
+{
+    return _frequency;
+}
+
+void AudioStream::update()
+{
+    if (_source == 0)
+        return;
+
+    // Move the buffers the source has played back to the ring.
+    ALint processed = 0;
+    AL_CHECK( alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed) );
+    for (; processed > 0 && _queuedCount > 0; --processed)
+    {
+        ALuint buffer;
+        AL_CHECK( alSourceUnqueueBuffers(_source, 1, &buffer) );
+        GP_ASSERT(buffer == _buffers[_firstQueued]);
+        _firstQueued = (_firstQueued + 1) % AUDIOSTREAM_BUFFER_COUNT;
+        --_queuedCount;
+    }
+
+    // Only the decoding thread adds chunks, so the decoded chunks can be read without the lock.
+    lockDecoder();
+    unsigned int firstDecoded = _firstDecoded;
+    unsigned int decodedCount = _decodedCount;
+    bool ended = _ended;
+    unlockDecoder();
+
+    // Queue the decoded chunks in the free buffers.
+    unsigned int queued = 0;
+    for (; queued < decodedCount && _queuedCount < AUDIOSTREAM_BUFFER_COUNT; ++queued)
+    {
+        const Chunk& chunk = _chunks[(firstDecoded + queued) % AUDIOSTREAM_BUFFER_COUNT];
+        unsigned int index = (_firstQueued + _queuedCount) % AUDIOSTREAM_BUFFER_COUNT;
+        AL_CHECK( alBufferData(_buffers[index], _format, chunk.data, chunk.size, _frequency) );
+        AL_CHECK( alSourceQueueBuffers(_source, 1, &_buffers[index]) );
+        _bufferSamples[index] = chunk.sample;
+        ++_queuedCount;
+    }
+    if (queued > 0)
+    {
+        lockDecoder();
+        _firstDecoded = (_firstDecoded + queued) % AUDIOSTREAM_BUFFER_COUNT;
+        _decodedCount -= queued;
+        if (__sync)
+        {
+            DECODER_SIGNAL(__sync, decodeRequested);
+        }
+        unlockDecoder();
+    }
+
+    if (_playing)
+    {
+        ALint state;
+        AL_CHECK( alGetSourcei(_source, AL_SOURCE_STATE, &state) );
+        if (state != AL_PLAYING)
+        {
+            if (_queuedCount > 0)
+            {
+                // Start the source, or restart it if it ran out of buffers before the decoder caught up.
+                AL_CHECK( alSourcePlay(_source) );
+            }
+            else if (ended && queued == decodedCount)
+            {
+                // The end of the file was played; go back to the start for the next play().
+                _playing = false;
+                seek(0);
+            }
+        }
+    }
+}
+
+bool AudioStream::needsDecode() const
+{
+    return _seekPending || (!_ended && _decodedCount < AUDIOSTREAM_BUFFER_COUNT);
+}
+
+void AudioStream::decode()
+{
+    // The chunk after the decoded chunks is not read by the main thread until it is counted.
+    unsigned int generation = _generation;
+    Chunk& chunk = _chunks[(_firstDecoded + _decodedCount) % AUDIOSTREAM_BUFFER_COUNT];
+    bool seekPending = _seekPending;
+    long long sample = _decodeSample;
+    bool looped = _looped;
+    _seekPending = false;
+    unlockDecoder();
+
+    bool ended = false;
+    if (seekPending && ov_pcm_seek(_file, sample) != 0)
+    {
+        GP_WARN("Failed to seek to sample %lld of ogg file %s.", sample, _path.c_str());
+        ended = true;
+    }
+
+    unsigned int size = 0;
+    while (!ended && size < AUDIOSTREAM_CHUNK_SIZE)
+    {
+        int section;
+        long result = ov_read(_file, chunk.data + size, AUDIOSTREAM_CHUNK_SIZE - size, 0, 2, 1, &section);
+        if (result > 0)
+        {
+            size += (unsigned int)result;
+        }
+        else if (result == 0)
+        {
+            // End of the file: wrap around to the start when looped.
+            if (!looped || _sampleCount == 0 || ov_pcm_seek(_file, 0) != 0)
+                ended = true;
+        }
+        else if (result != OV_HOLE)
+        {
+            GP_WARN("Failed to read ogg file %s (error %ld).", _path.c_str(), result);
+            ended = true;
+        }
+    }
+    long long nextSample = ov_pcm_tell(_file);
+
+    // Drop the chunk if the stream was moved while it was decoded.
+    lockDecoder();
+    if (generation == _generation)
+    {
+        chunk.size = size;
+        chunk.sample = sample;
+        if (size > 0)
+        {
+            ++_decodedCount;
+        }
+        _decodeSample = nextSample;
+        _ended = ended;
+    }
+}
+
+}
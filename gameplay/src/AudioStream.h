@@ -0,0 +1,184 @@
+#ifndef AUDIOSTREAM_H_
+#define AUDIOSTREAM_H_
+
+#include "Stream.h"
+
+namespace gameplay
+{
+
+class AudioController;
+class AudioSource;
+
+/**
+ * Streams an Ogg Vorbis file to an audio source.
+ *
+ * Instead of decoding the whole file into one buffer, the file is decoded a few chunks
+ * ahead of playback by a decoding thread, and the main thread queues the decoded chunks
+ * on the source in a small ring of OpenAL buffers (from AudioController::update()). This
+ * keeps long music tracks from costing tens of megabytes and a long stall at load.
+ *
+ * Looping is done by the decoder, which wraps around to the start of the file, so the
+ * source itself is never set to loop. Seeking drops the queued chunks and decodes again
+ * from the new position.
+ *
+ * A stream is owned by a single audio source; sources do not share streams.
+ */
+class AudioStream
+{
+    friend class AudioController;
+    friend class AudioSource;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    AudioStream(const char* path, Stream* stream, OggVorbis_File* file);
+
+    /**
+     * Destructor.
+     */
+    ~AudioStream();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AudioStream(const AudioStream& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AudioStream& operator=(const AudioStream&);
+
+    /**
+     * Opens an Ogg Vorbis file for streaming and decodes its first chunks.
+     *
+     * @param path The path of the file.
+     *
+     * @return The stream, or NULL if the file is not an Ogg Vorbis file.
+     */
+    static AudioStream* create(const char* path);
+
+    /**
+     * Starts the decoding thread. Called when the audio controller is initialized.
+     */
+    static void initializeDecoder();
+
+    /**
+     * Stops the decoding thread. Called when the audio controller is finalized.
+     */
+    static void finalizeDecoder();
+
+    /**
+     * Queues the decoded chunks of all the streams on their sources. Called by
+     * AudioController::update() on the main thread.
+     */
+    static void updateStreams();
+
+    /**
+     * Sets the source the stream is queued on.
+     */
+    void setSource(ALuint source);
+
+    /**
+     * Starts or resumes playing the source.
+     */
+    void play();
+
+    /**
+     * Pauses the source.
+     */
+    void pause();
+
+    /**
+     * Stops the source and goes back to the start of the file.
+     */
+    void stop();
+
+    /**
+     * Moves to a sample of the file, and keeps playing if the source was playing.
+     *
+     * @param sample The sample to play next.
+     */
+    void seek(long long sample);
+
+    /**
+     * Sets whether the decoder wraps around to the start of the file.
+     */
+    void setLooped(bool looped);
+
+    /**
+     * Returns true if the source plays, or is waiting for chunks to play.
+     */
+    bool isPlaying() const;
+
+    /**
+     * Returns the sample of the file being played.
+     */
+    long long getPosition() const;
+
+    /**
+     * Returns the number of samples per second.
+     */
+    long getFrequency() const;
+
+    /**
+     * Moves the processed buffers of the source back to the ring, and queues the decoded chunks.
+     */
+    void update();
+
+    /**
+     * Returns true if the decoder should decode a chunk. The decoder lock must be held.
+     */
+    bool needsDecode() const;
+
+    /**
+     * Decodes the next chunk. The decoder lock must be held; it is released while decoding.
+     */
+    void decode();
+
+    /**
+     * Entry point of the decoding thread.
+     */
+#ifdef WIN32
+    static unsigned long __stdcall threadFunc(void* arg);
+#else
+    static void* threadFunc(void* arg);
+#endif
+
+    /**
+     * A chunk of decoded samples.
+     */
+    struct Chunk
+    {
+        char* data;                             // The 16-bit samples.
+        unsigned int size;                      // The size of the samples, in bytes.
+        long long sample;                       // The sample of the file the chunk starts at.
+    };
+
+    std::string _path;                          // The path of the file.
+    Stream* _stream;                            // The file.
+    OggVorbis_File* _file;                      // The decoder, used by one thread at a time.
+    ALenum _format;                             // The format of the samples.
+    long _frequency;                            // The number of samples per second.
+    long long _sampleCount;                     // The number of samples of the file.
+    ALuint _source;                             // The source the chunks are queued on, or 0.
+    ALuint* _buffers;                           // The ring of buffers.
+    long long* _bufferSamples;                  // The sample each buffer of the ring starts at.
+    unsigned int _firstQueued;                  // The first buffer of the ring queued on the source.
+    unsigned int _queuedCount;                  // The number of buffers queued on the source.
+    bool _playing;                              // Whether the source should be playing.
+    char* _data;                                // The samples of the chunks.
+    Chunk* _chunks;                             // The ring of decoded chunks.
+    unsigned int _firstDecoded;                 // The first decoded chunk. Guarded by the decoder lock.
+    unsigned int _decodedCount;                 // The number of decoded chunks. Guarded by the decoder lock.
+    long long _decodeSample;                    // The sample the next chunk starts at. Guarded by the decoder lock.
+    bool _seekPending;                          // Whether the decoder must seek to _decodeSample. Guarded by the decoder lock.
+    bool _ended;                                // Whether the decoder reached the end of the file. Guarded by the decoder lock.
+    bool _looped;                               // Whether the decoder wraps around. Guarded by the decoder lock.
+    unsigned int _generation;                   // Incremented on seeks to drop the chunk being decoded. Guarded by the decoder lock.
+};
+
+}
+
+#endif
@@ -113,6 +113,9 @@ extern void print(const char* format, ...);
 // Debug new for memory leak detection
 #include "DebugNew.h"
 
+// Scoped CPU profiling zones
+#include "Profiler.h"
+
 // Object deletion macro
 #define SAFE_DELETE(x) \
     { \
@@ -235,9 +238,14 @@ using std::va_list;
     extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays;
     extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays;
     extern PFNGLISVERTEXARRAYOESPROC glIsVertexArray;
+    extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary;
+    extern PFNGLPROGRAMBINARYOESPROC glProgramBinary;
+    #define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
+    #define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
     #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
     #define glClearDepth glClearDepthf
     #define OPENGL_ES
+    #define USE_PROGRAM_BINARY
     #define USE_PVRTC
     #ifdef __arm__
         #define USE_NEON
@@ -250,18 +258,30 @@ using std::va_list;
     extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays;
     extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays;
     extern PFNGLISVERTEXARRAYOESPROC glIsVertexArray;
+    extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary;
+    extern PFNGLPROGRAMBINARYOESPROC glProgramBinary;
+    #define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
+    #define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
     #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
     #define glClearDepth glClearDepthf
     #define OPENGL_ES
+    #define USE_PROGRAM_BINARY
+    #if defined(__arm__) && defined(__ARM_NEON__)
+        #define USE_NEON
+    #endif
 #elif WIN32
     #define WIN32_LEAN_AND_MEAN
     #define GLEW_STATIC
     #include <GL/glew.h>
     #define USE_VAO
+    #define USE_INSTANCING
+    #define USE_PROGRAM_BINARY
 #elif __linux__
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define USE_VAO
+        #define USE_INSTANCING
+        #define USE_PROGRAM_BINARY
 #elif __APPLE__
     #include "TargetConditionals.h"
     #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
@@ -271,10 +291,14 @@ using std::va_list;
         #define glDeleteVertexArrays glDeleteVertexArraysOES
         #define glGenVertexArrays glGenVertexArraysOES
         #define glIsVertexArray glIsVertexArrayOES
+        #define glVertexAttribDivisor glVertexAttribDivisorEXT
+        #define glDrawArraysInstanced glDrawArraysInstancedEXT
+        #define glDrawElementsInstanced glDrawElementsInstancedEXT
         #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
         #define glClearDepth glClearDepthf
         #define OPENGL_ES
         #define USE_VAO
+        #define USE_INSTANCING
         #ifdef __arm__
             #define USE_NEON
         #endif
@@ -285,12 +309,21 @@ using std::va_list;
         #define glDeleteVertexArrays glDeleteVertexArraysAPPLE
         #define glGenVertexArrays glGenVertexArraysAPPLE
         #define glIsVertexArray glIsVertexArrayAPPLE
+        #define glVertexAttribDivisor glVertexAttribDivisorARB
+        #define glDrawArraysInstanced glDrawArraysInstancedARB
+        #define glDrawElementsInstanced glDrawElementsInstancedARB
         #define USE_VAO
+        #define USE_INSTANCING
     #else
         #error "Unsupported Apple Device"
     #endif
 #endif
 
+// Use the SSE math backend on x86 targets unless disabled with GP_NO_SSE
+#if !defined(USE_NEON) && !defined(GP_NO_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define USE_SSE
+#endif
+
 // Graphics (GLSL)
 #define VERTEX_ATTRIBUTE_POSITION_NAME              "a_position"
 #define VERTEX_ATTRIBUTE_NORMAL_NAME                "a_normal"
@@ -0,0 +1,484 @@
+#include "Base.h"
+#include "BoundingVolumeTree.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+// Margin added around the bounding sphere of a leaf, relative to its radius.
+#define BVH_FAT_MARGIN_SCALE        0.25f
+// Minimum margin added around the bounding sphere of a leaf.
+#define BVH_FAT_MARGIN_MIN          0.01f
+// Number of tree nodes allocated when the pool is first used.
+#define BVH_INITIAL_CAPACITY        64
+
+namespace gameplay
+{
+
+static float getSurfaceArea(const BoundingBox& box)
+{
+    float dx = box.max.x - box.min.x;
+    float dy = box.max.y - box.min.y;
+    float dz = box.max.z - box.min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static float getMergedSurfaceArea(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox box(a);
+    box.merge(b);
+    return getSurfaceArea(box);
+}
+
+static bool contains(const BoundingBox& box, const BoundingBox& inner)
+{
+    return box.min.x <= inner.min.x && box.min.y <= inner.min.y && box.min.z <= inner.min.z &&
+           box.max.x >= inner.max.x && box.max.y >= inner.max.y && box.max.z >= inner.max.z;
+}
+
+BoundingVolumeTree::BoundingVolumeTree()
+    : _root(-1), _freeList(-1), _proxyCount(0)
+{
+}
+
+BoundingVolumeTree::~BoundingVolumeTree()
+{
+}
+
+int BoundingVolumeTree::allocateNode()
+{
+    if (_freeList == -1)
+    {
+        // Grow the pool and chain the new tree nodes into the free list.
+        int start = (int)_nodes.size();
+        int capacity = start > 0 ? start * 2 : BVH_INITIAL_CAPACITY;
+        _nodes.resize(capacity);
+        for (int i = start; i < capacity; ++i)
+        {
+            _nodes[i].parent = i + 1 < capacity ? i + 1 : -1;
+            _nodes[i].height = -1;
+        }
+        _freeList = start;
+    }
+
+    int index = _freeList;
+    TreeNode& node = _nodes[index];
+    _freeList = node.parent;
+    node.node = NULL;
+    node.parent = -1;
+    node.child1 = -1;
+    node.child2 = -1;
+    node.height = 0;
+    return index;
+}
+
+void BoundingVolumeTree::freeNode(int index)
+{
+    GP_ASSERT(index >= 0 && index < (int)_nodes.size());
+
+    TreeNode& node = _nodes[index];
+    node.node = NULL;
+    node.parent = _freeList;
+    node.height = -1;
+    _freeList = index;
+}
+
+void BoundingVolumeTree::setFatBox(TreeNode& leaf)
+{
+    const Vector3& center = leaf.sphere.center;
+    float extent = leaf.sphere.radius + max(leaf.sphere.radius * BVH_FAT_MARGIN_SCALE, BVH_FAT_MARGIN_MIN);
+    leaf.box.set(center.x - extent, center.y - extent, center.z - extent, center.x + extent, center.y + extent, center.z + extent);
+}
+
+int BoundingVolumeTree::insert(Node* node, const BoundingSphere& sphere)
+{
+    GP_ASSERT(node);
+
+    int proxy = allocateNode();
+    TreeNode& leaf = _nodes[proxy];
+    leaf.node = node;
+    leaf.sphere = sphere;
+    setFatBox(leaf);
+    insertLeaf(proxy);
+    ++_proxyCount;
+    return proxy;
+}
+
+void BoundingVolumeTree::remove(int proxy)
+{
+    GP_ASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].height == 0);
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_proxyCount;
+}
+
+bool BoundingVolumeTree::update(int proxy, const BoundingSphere& sphere)
+{
+    GP_ASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].height == 0);
+
+    TreeNode& leaf = _nodes[proxy];
+    leaf.sphere = sphere;
+
+    // Keep the leaf in place while the sphere stays within its enlarged box.
+    const Vector3& center = sphere.center;
+    BoundingBox box(center.x - sphere.radius, center.y - sphere.radius, center.z - sphere.radius,
+                    center.x + sphere.radius, center.y + sphere.radius, center.z + sphere.radius);
+    if (contains(leaf.box, box))
+        return false;
+
+    removeLeaf(proxy);
+    setFatBox(_nodes[proxy]);
+    insertLeaf(proxy);
+    return true;
+}
+
+void BoundingVolumeTree::clear()
+{
+    _nodes.clear();
+    _root = -1;
+    _freeList = -1;
+    _proxyCount = 0;
+}
+
+Node* BoundingVolumeTree::getNode(int proxy) const
+{
+    GP_ASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].height == 0);
+
+    return _nodes[proxy].node;
+}
+
+unsigned int BoundingVolumeTree::getProxyCount() const
+{
+    return _proxyCount;
+}
+
+int BoundingVolumeTree::getHeight() const
+{
+    return _root == -1 ? -1 : _nodes[_root].height;
+}
+
+void BoundingVolumeTree::insertLeaf(int leaf)
+{
+    if (_root == -1)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = -1;
+        return;
+    }
+
+    // Descend towards the sibling whose union with the leaf adds the least surface area
+    // to the tree, stopping where making the leaf a sibling of the subtree is cheaper.
+    const BoundingBox leafBox = _nodes[leaf].box;
+    int index = _root;
+    while (_nodes[index].child1 != -1)
+    {
+        const TreeNode& node = _nodes[index];
+        float area = getSurfaceArea(node.box);
+        float mergedArea = getMergedSurfaceArea(node.box, leafBox);
+
+        // Cost of creating a new parent for this node and the leaf, and the
+        // minimum cost of pushing the leaf further down the tree.
+        float cost = 2.0f * mergedArea;
+        float inheritanceCost = 2.0f * (mergedArea - area);
+
+        const TreeNode& child1 = _nodes[node.child1];
+        float cost1 = getMergedSurfaceArea(child1.box, leafBox) + inheritanceCost;
+        if (child1.child1 != -1)
+            cost1 -= getSurfaceArea(child1.box);
+
+        const TreeNode& child2 = _nodes[node.child2];
+        float cost2 = getMergedSurfaceArea(child2.box, leafBox) + inheritanceCost;
+        if (child2.child1 != -1)
+            cost2 -= getSurfaceArea(child2.box);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    int sibling = index;
+
+    // Create a new parent for the sibling and the leaf.
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode();
+    TreeNode& parent = _nodes[newParent];
+    parent.parent = oldParent;
+    parent.box = leafBox;
+    parent.box.merge(_nodes[sibling].box);
+    parent.height = _nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != -1)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    refit(_nodes[leaf].parent);
+}
+
+void BoundingVolumeTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = -1;
+        return;
+    }
+
+    // Replace the parent of the leaf with the leaf's sibling.
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != -1)
+    {
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refit(grandParent);
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = -1;
+        freeNode(parent);
+    }
+}
+
+void BoundingVolumeTree::refit(int index)
+{
+    while (index != -1)
+    {
+        index = balance(index);
+
+        TreeNode& node = _nodes[index];
+        const TreeNode& child1 = _nodes[node.child1];
+        const TreeNode& child2 = _nodes[node.child2];
+        node.height = 1 + max(child1.height, child2.height);
+        node.box = child1.box;
+        node.box.merge(child2.box);
+
+        index = node.parent;
+    }
+}
+
+int BoundingVolumeTree::balance(int a)
+{
+    GP_ASSERT(a != -1);
+
+    TreeNode& nodeA = _nodes[a];
+    if (nodeA.child1 == -1 || nodeA.height < 2)
+        return a;
+
+    int b = nodeA.child1;
+    int c = nodeA.child2;
+    int difference = _nodes[c].height - _nodes[b].height;
+
+    // Promote the taller child when the subtree leans by more than one level. Written as
+    // parent(child1, child2), with f the taller child of c:
+    //
+    //     a(b, c(f, g))  =>  c(a(b, g), f)
+    //
+    // (or the mirror image, with the roles of b and c swapped).
+    if (difference > 1 || difference < -1)
+    {
+        int up = difference > 1 ? c : b;
+        int down = difference > 1 ? b : c;
+        TreeNode& nodeUp = _nodes[up];
+        int f = nodeUp.child1;
+        int g = nodeUp.child2;
+
+        // Swap a and the promoted child.
+        nodeUp.child1 = a;
+        nodeUp.parent = nodeA.parent;
+        nodeA.parent = up;
+        if (nodeUp.parent != -1)
+        {
+            if (_nodes[nodeUp.parent].child1 == a)
+                _nodes[nodeUp.parent].child1 = up;
+            else
+                _nodes[nodeUp.parent].child2 = up;
+        }
+        else
+        {
+            _root = up;
+        }
+
+        // Keep the taller grandchild under the promoted child and give the other one to a.
+        if (_nodes[f].height < _nodes[g].height)
+        {
+            int t = f;
+            f = g;
+            g = t;
+        }
+        nodeUp.child2 = f;
+        if (difference > 1)
+        {
+            nodeA.child1 = down;
+            nodeA.child2 = g;
+        }
+        else
+        {
+            nodeA.child1 = g;
+            nodeA.child2 = down;
+        }
+        _nodes[g].parent = a;
+
+        nodeA.box = _nodes[down].box;
+        nodeA.box.merge(_nodes[g].box);
+        nodeA.height = 1 + max(_nodes[down].height, _nodes[g].height);
+        nodeUp.box = nodeA.box;
+        nodeUp.box.merge(_nodes[f].box);
+        nodeUp.height = 1 + max(nodeA.height, _nodes[f].height);
+
+        return up;
+    }
+
+    return a;
+}
+
+unsigned int BoundingVolumeTree::findNodes(const Frustum& frustum, std::vector<Node*>& nodes) const
+{
+    if (_root == -1)
+        return 0;
+
+    // Each entry of the stack holds a tree node index and, in its low bits, the mask of
+    // the frustum planes its parent intersects. Children only test the planes in that
+    // mask, so subtrees entirely inside the frustum are gathered without further tests.
+    size_t count = nodes.size();
+    _stack.clear();
+    _stack.push_back((_root << 6) | Frustum::PLANE_MASK_ALL);
+    while (!_stack.empty())
+    {
+        int index = _stack.back() >> 6;
+        unsigned int planeMask = _stack.back() & Frustum::PLANE_MASK_ALL;
+        _stack.pop_back();
+
+        const TreeNode& node = _nodes[index];
+        if (planeMask && frustum.classify(node.box, &planeMask) == Plane::INTERSECTS_BACK)
+            continue;
+
+        if (node.child1 == -1)
+        {
+            if (!planeMask || frustum.classify(node.sphere, &planeMask) != Plane::INTERSECTS_BACK)
+                nodes.push_back(node.node);
+        }
+        else
+        {
+            _stack.push_back((node.child1 << 6) | planeMask);
+            _stack.push_back((node.child2 << 6) | planeMask);
+        }
+    }
+    return (unsigned int)(nodes.size() - count);
+}
+
+unsigned int BoundingVolumeTree::findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes) const
+{
+    if (_root == -1)
+        return 0;
+
+    size_t count = nodes.size();
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const TreeNode& node = _nodes[_stack.back()];
+        _stack.pop_back();
+        if (!sphere.intersects(node.box))
+            continue;
+
+        if (node.child1 == -1)
+        {
+            if (sphere.intersects(node.sphere))
+                nodes.push_back(node.node);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    return (unsigned int)(nodes.size() - count);
+}
+
+unsigned int BoundingVolumeTree::findNodes(const BoundingBox& box, std::vector<Node*>& nodes) const
+{
+    if (_root == -1)
+        return 0;
+
+    size_t count = nodes.size();
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const TreeNode& node = _nodes[_stack.back()];
+        _stack.pop_back();
+        if (!box.intersects(node.box))
+            continue;
+
+        if (node.child1 == -1)
+        {
+            if (node.sphere.intersects(box))
+                nodes.push_back(node.node);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+    return (unsigned int)(nodes.size() - count);
+}
+
+Node* BoundingVolumeTree::pickNode(const Ray& ray, float* distance) const
+{
+    Node* closest = NULL;
+    float closestDistance = 0.0f;
+    if (_root != -1)
+    {
+        _stack.clear();
+        _stack.push_back(_root);
+        while (!_stack.empty())
+        {
+            const TreeNode& node = _nodes[_stack.back()];
+            _stack.pop_back();
+
+            // Skip subtrees that are missed or only hit beyond the closest hit so far.
+            float boxDistance = ray.intersects(node.box);
+            if (boxDistance == Ray::INTERSECTS_NONE || (closest && boxDistance > closestDistance))
+                continue;
+
+            if (node.child1 == -1)
+            {
+                float d = ray.intersects(node.sphere);
+                if (d != Ray::INTERSECTS_NONE && d >= 0.0f && (closest == NULL || d < closestDistance))
+                {
+                    closest = node.node;
+                    closestDistance = d;
+                }
+            }
+            else
+            {
+                _stack.push_back(node.child1);
+                _stack.push_back(node.child2);
+            }
+        }
+    }
+
+    if (distance)
+        *distance = closestDistance;
+    return closest;
+}
+
+}
@@ -0,0 +1,210 @@
+#ifndef BOUNDINGVOLUMETREE_H_
+#define BOUNDINGVOLUMETREE_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+
+namespace gameplay
+{
+
+class Frustum;
+class Node;
+class Ray;
+
+/**
+ * Defines a dynamic bounding volume hierarchy of nodes.
+ *
+ * Each node inserted into the tree is stored in a leaf (a proxy) that holds the node's
+ * bounding sphere and an axis-aligned box enlarged by a margin around it. Moving a node
+ * only restructures the tree once its sphere leaves that enlarged box, so nodes that
+ * move by small amounts every frame are cheap to update. Leaves are inserted next to
+ * the sibling that least increases the surface area of the tree and the tree is kept
+ * balanced with tree rotations, so queries stay logarithmic as nodes are added,
+ * moved and removed.
+ *
+ * Queries are not thread safe: they share a traversal stack owned by the tree.
+ *
+ * @script{ignore}
+ */
+class BoundingVolumeTree
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    BoundingVolumeTree();
+
+    /**
+     * Destructor.
+     */
+    ~BoundingVolumeTree();
+
+    /**
+     * Inserts a node into the tree.
+     *
+     * @param node The node to insert. It is not referenced by the tree.
+     * @param sphere The world space bounding sphere of the node.
+     *
+     * @return The proxy of the node in the tree.
+     */
+    int insert(Node* node, const BoundingSphere& sphere);
+
+    /**
+     * Removes a proxy from the tree.
+     *
+     * @param proxy The proxy to remove.
+     */
+    void remove(int proxy);
+
+    /**
+     * Updates the bounding sphere of a proxy.
+     *
+     * @param proxy The proxy to update.
+     * @param sphere The new world space bounding sphere of the node.
+     *
+     * @return true if the proxy had to be reinserted into the tree, false otherwise.
+     */
+    bool update(int proxy, const BoundingSphere& sphere);
+
+    /**
+     * Removes all proxies from the tree.
+     */
+    void clear();
+
+    /**
+     * Returns the node of a proxy.
+     *
+     * @param proxy The proxy.
+     *
+     * @return The node.
+     */
+    Node* getNode(int proxy) const;
+
+    /**
+     * Returns the number of proxies in the tree.
+     *
+     * @return The number of proxies.
+     */
+    unsigned int getProxyCount() const;
+
+    /**
+     * Returns the height of the tree.
+     *
+     * @return The number of levels below the root, or -1 if the tree is empty.
+     */
+    int getHeight() const;
+
+    /**
+     * Finds the nodes whose bounding spheres intersect a frustum.
+     *
+     * @param frustum The frustum.
+     * @param nodes The vector the nodes are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const Frustum& frustum, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the nodes whose bounding spheres intersect a sphere.
+     *
+     * @param sphere The sphere.
+     * @param nodes The vector the nodes are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the nodes whose bounding spheres intersect a box.
+     *
+     * @param box The box.
+     * @param nodes The vector the nodes are appended to.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int findNodes(const BoundingBox& box, std::vector<Node*>& nodes) const;
+
+    /**
+     * Finds the node whose bounding sphere is hit first by a ray.
+     *
+     * @param ray The ray.
+     * @param distance Set to the distance along the ray to the hit sphere, if not NULL.
+     *
+     * @return The node hit first, or NULL if the ray hits no node.
+     */
+    Node* pickNode(const Ray& ray, float* distance = NULL) const;
+
+private:
+
+    /**
+     * A node of the tree. Leaves hold a proxy; internal nodes always have two children.
+     */
+    struct TreeNode
+    {
+        BoundingBox box;            // The enlarged box of a leaf, or the union of the children's boxes.
+        BoundingSphere sphere;      // The bounding sphere of the proxy (leaves only).
+        Node* node;                 // The node of the proxy (leaves only).
+        int parent;                 // The parent, or the next free tree node when unused.
+        int child1;                 // The first child, or -1 for leaves.
+        int child2;                 // The second child, or -1 for leaves.
+        int height;                 // 0 for leaves, -1 when unused.
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    BoundingVolumeTree(const BoundingVolumeTree& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    BoundingVolumeTree& operator=(const BoundingVolumeTree&);
+
+    /**
+     * Returns an unused tree node, growing the pool if needed.
+     */
+    int allocateNode();
+
+    /**
+     * Returns a tree node to the free list.
+     */
+    void freeNode(int index);
+
+    /**
+     * Links a leaf into the tree.
+     */
+    void insertLeaf(int leaf);
+
+    /**
+     * Unlinks a leaf from the tree.
+     */
+    void removeLeaf(int leaf);
+
+    /**
+     * Recomputes the boxes and heights of the ancestors of a tree node, rebalancing them.
+     */
+    void refit(int index);
+
+    /**
+     * Rotates the subtree below a tree node if it is unbalanced.
+     *
+     * @return The tree node now at the root of the subtree.
+     */
+    int balance(int index);
+
+    /**
+     * Sets the enlarged box of a leaf from its bounding sphere.
+     */
+    static void setFatBox(TreeNode& leaf);
+
+    std::vector<TreeNode> _nodes;           // Pool of tree nodes.
+    int _root;                              // The root tree node, or -1 if the tree is empty.
+    int _freeList;                          // The first unused tree node, or -1.
+    unsigned int _proxyCount;               // Number of leaves.
+    mutable std::vector<int> _stack;        // Traversal stack shared by queries.
+};
+
+}
+
+#endif
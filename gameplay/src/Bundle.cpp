@@ -29,10 +29,10 @@
 namespace gameplay
 {
 
-static std::vector<Bundle*> __bundleCache;
+static ResourceCache<Bundle> __bundleCache;
 
 Bundle::Bundle(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _trackedNodes(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _mappedData(NULL), _trackedNodes(NULL)
 {
 }
 
@@ -41,14 +41,15 @@ Bundle::~Bundle()
     clearLoadSession();
 
     // Remove this Bundle from the cache.
-    std::vector<Bundle*>::iterator itr = std::find(__bundleCache.begin(), __bundleCache.end(), this);
-    if (itr != __bundleCache.end())
-    {
-        __bundleCache.erase(itr);
-    }
+    __bundleCache.remove(this);
 
     SAFE_DELETE_ARRAY(_references);
 
+    for (std::map<std::string, MeshData*>::iterator itr = _preloadedMeshData.begin(); itr != _preloadedMeshData.end(); ++itr)
+    {
+        SAFE_DELETE(itr->second);
+    }
+
     if (_stream)
     {
         SAFE_DELETE(_stream);
@@ -127,6 +128,57 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
+template <class T>
+bool Bundle::readArray(unsigned int* length, const T** values, std::vector<T>* storage)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(values);
+    GP_ASSERT(storage);
+    GP_ASSERT(_stream);
+
+    *values = NULL;
+    if (!read(length))
+    {
+        GP_ERROR("Failed to read the length of an array of data (to be read in place).");
+        return false;
+    }
+    if (*length > 0)
+    {
+        *values = (const T*)readMappedData(sizeof(T), *length);
+        if (*values == NULL)
+        {
+            storage->resize(*length);
+            if (_stream->read(&(*storage)[0], sizeof(T), *length) != *length)
+            {
+                GP_ERROR("Failed to read an array of data from bundle (to be read in place).");
+                return false;
+            }
+            *values = &(*storage)[0];
+        }
+    }
+    return true;
+}
+
+const unsigned char* Bundle::readMappedData(size_t size, size_t count)
+{
+    GP_ASSERT(size > 0);
+
+    if (_mappedData == NULL)
+        return NULL;
+
+    long position = _stream->position();
+    if (position < 0 || count > (_stream->length() - (size_t)position) / size)
+        return NULL;
+
+    // Values are only used in place when they are aligned, since some CPUs fault on
+    // misaligned loads. GL uploads read bytes, so they accept any alignment.
+    const unsigned char* data = _mappedData + position;
+    if (((size_t)data % size) != 0 || !_stream->seek((long)(size * count), SEEK_CUR))
+        return NULL;
+
+    return data;
+}
+
 static std::string readString(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -154,25 +206,42 @@ static std::string readString(Stream* stream)
     return str;
 }
 
+static void touchPages(const unsigned char* data, size_t size)
+{
+    // Read a byte of each page of the data so the system loads it.
+    volatile unsigned char sum = 0;
+    for (size_t offset = 0; offset < size; offset += 4096)
+    {
+        sum += data[offset];
+    }
+    if (size > 0)
+    {
+        sum += data[size - 1];
+    }
+}
+
 Bundle* Bundle::create(const char* path)
 {
     GP_ASSERT(path);
 
     // Search the cache for this bundle.
-    for (size_t i = 0, count = __bundleCache.size(); i < count; ++i)
+    Bundle* p = __bundleCache.find(path);
+    if (p)
     {
-        Bundle* p = __bundleCache[i];
-        GP_ASSERT(p);
-        if (p->_path == path)
-        {
-            // Found a match
-            p->addRef();
-            return p;
-        }
+        // Found a match
+        p->addRef();
+        return p;
     }
 
-    // Open the bundle.
-    Stream* stream = FileSystem::open(path);
+    return open(path);
+}
+
+Bundle* Bundle::open(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Open the bundle, mapping it in memory so mesh and animation data can be used in place.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
     if (!stream)
     {
         GP_ERROR("Failed to open file '%s'.", path);
@@ -232,6 +301,7 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->_mappedData = (const unsigned char*)stream->getMappedData();
 
     return bundle;
 }
@@ -1269,11 +1339,17 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
-    std::vector<unsigned int> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned int> interpolation;
+    // The keys point into the mapped bundle file when possible; the vectors hold them otherwise.
+    const unsigned int* keyTimes;
+    const float* values;
+    const float* tangentsIn;
+    const float* tangentsOut;
+    const unsigned int* interpolation;
+    std::vector<unsigned int> keyTimesStorage;
+    std::vector<float> valuesStorage;
+    std::vector<float> tangentsInStorage;
+    std::vector<float> tangentsOutStorage;
+    std::vector<unsigned int> interpolationStorage;
 
     // Length of the arrays.
     unsigned int keyTimesCount;
@@ -1283,35 +1359,35 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     unsigned int interpolationCount;
 
     // Read key times.
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    if (!readArray(&keyTimesCount, &keyTimes, &keyTimesStorage))
     {
         GP_ERROR("Failed to read key times for animation '%s'.", id);
         return NULL;
     }
 
     // Read key values.
-    if (!readArray(&valuesCount, &values))
+    if (!readArray(&valuesCount, &values, &valuesStorage))
     {
         GP_ERROR("Failed to read key values for animation '%s'.", id);
         return NULL;
     }
 
     // Read in-tangents.
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    if (!readArray(&tangentsInCount, &tangentsIn, &tangentsInStorage))
     {
         GP_ERROR("Failed to read in tangents for animation '%s'.", id);
         return NULL;
     }
 
     // Read out-tangents.
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+    if (!readArray(&tangentsOutCount, &tangentsOut, &tangentsOutStorage))
     {
         GP_ERROR("Failed to read out tangents for animation '%s'.", id);
         return NULL;
     }
 
     // Read interpolations.
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    if (!readArray(&interpolationCount, &interpolation, &interpolationStorage))
     {
         GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
         return NULL;
@@ -1320,15 +1396,19 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
     if (targetAttribute > 0)
     {
         GP_ASSERT(target);
-        GP_ASSERT(keyTimes.size() > 0 && values.size() > 0);
+        GP_ASSERT(keyTimes && values);
+
+        // The curves copy the keys, so they can be passed straight from the mapped file.
+        unsigned int* curveKeyTimes = const_cast<unsigned int*>(keyTimes);
+        float* curveValues = const_cast<float*>(values);
         if (animation == NULL)
         {
             // TODO: This code currently assumes LINEAR only.
-            animation = target->createAnimation(id, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation = target->createAnimation(id, targetAttribute, keyTimesCount, curveKeyTimes, curveValues, Curve::LINEAR);
         }
         else
         {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            animation->createChannel(target, targetAttribute, keyTimesCount, curveKeyTimes, curveValues, Curve::LINEAR);
         }
     }
 
@@ -1361,8 +1441,18 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId, bool keepData)
         return NULL;
     }
 
-    // Read mesh data.
-    MeshData* meshData = readMeshData();
+    // Read mesh data, unless it was read ahead of time.
+    MeshData* meshData = NULL;
+    std::map<std::string, MeshData*>::iterator itr = _preloadedMeshData.find(id);
+    if (itr != _preloadedMeshData.end())
+    {
+        meshData = itr->second;
+        _preloadedMeshData.erase(itr);
+    }
+    else
+    {
+        meshData = readMeshData();
+    }
     if (meshData == NULL)
     {
         GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
@@ -1382,7 +1472,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId, bool keepData)
     mesh->_url += "#";
     mesh->_url += id;
 
-    mesh->setVertexData((float*)meshData->vertexData, 0, meshData->vertexCount, keepData);
+    mesh->setVertexData((const float*)meshData->vertexData, 0, meshData->vertexCount, keepData);
 
     mesh->_boundingBox.set(meshData->boundingBox);
     mesh->_boundingSphere.set(meshData->boundingSphere);
@@ -1415,7 +1505,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId, bool keepData)
     return mesh;
 }
 
-Bundle::MeshData* Bundle::readMeshData()
+Bundle::MeshData* Bundle::readMeshData(bool useMappedData)
 {
     // Read vertex format/elements.
     unsigned int vertexElementCount;
@@ -1471,12 +1561,28 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    meshData->mapped = useMappedData && _mappedData;
+    if (meshData->mapped)
     {
-        GP_ERROR("Failed to load vertex data.");
-        SAFE_DELETE(meshData);
-        return NULL;
+        // Point into the mapped file; the data is only read when it is uploaded to GL.
+        meshData->vertexData = readMappedData(1, vertexByteCount);
+        if (meshData->vertexData == NULL)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
+    }
+    else
+    {
+        unsigned char* vertexData = new unsigned char[vertexByteCount];
+        meshData->vertexData = vertexData;
+        if (_stream->read(vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
     }
 
     // Read mesh bounds (bounding box and bounding sphere).
@@ -1550,8 +1656,20 @@ Bundle::MeshData* Bundle::readMeshData()
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        if (meshData->mapped)
+        {
+            partData->indexData = readMappedData(1, iByteCount);
+        }
+        else
+        {
+            unsigned char* indexData = new unsigned char[iByteCount];
+            partData->indexData = indexData;
+            if (_stream->read(indexData, 1, iByteCount) != iByteCount)
+            {
+                SAFE_DELETE_ARRAY(partData->indexData);
+            }
+        }
+        if (partData->indexData == NULL)
         {
             GP_ERROR("Failed to read index data for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
@@ -1562,6 +1680,49 @@ Bundle::MeshData* Bundle::readMeshData()
     return meshData;
 }
 
+bool Bundle::preloadMeshData(unsigned int index)
+{
+    GP_ASSERT(_references);
+    GP_ASSERT(_stream);
+
+    if (index >= _referenceCount || _references[index].type != BUNDLE_TYPE_MESH)
+        return true;
+
+    Reference* ref = &_references[index];
+    if (_preloadedMeshData.find(ref->id) != _preloadedMeshData.end())
+        return true;
+
+    if (_stream->seek(ref->offset, SEEK_SET) == false)
+    {
+        GP_ERROR("Failed to seek to mesh '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+        return false;
+    }
+
+    MeshData* meshData = readMeshData();
+    if (meshData == NULL)
+    {
+        GP_ERROR("Failed to read mesh data for mesh '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+        return false;
+    }
+    _preloadedMeshData[ref->id] = meshData;
+
+    // Fault the pages of mapped data in now, so the main thread does not wait on the
+    // disk when it uploads the data.
+    if (meshData->mapped)
+    {
+        unsigned int vertexByteCount = meshData->vertexCount * meshData->vertexFormat.getVertexSize();
+        touchPages(meshData->vertexData, vertexByteCount);
+        for (unsigned int i = 0; i < meshData->parts.size(); ++i)
+        {
+            MeshPartData* partData = meshData->parts[i];
+            unsigned int indexSize = partData->indexFormat == Mesh::INDEX32 ? 4 : (partData->indexFormat == Mesh::INDEX16 ? 2 : 1);
+            touchPages(partData->indexData, partData->indexCount * indexSize);
+        }
+    }
+
+    return true;
+}
+
 Bundle::MeshData* Bundle::readMeshData(const char* url)
 {
     GP_ASSERT(url);
@@ -1601,8 +1762,8 @@ Bundle::MeshData* Bundle::readMeshData(const char* url)
         return NULL;
     }
 
-    // Read mesh data from current file position.
-    MeshData* meshData = bundle->readMeshData();
+    // Read mesh data from current file position, copying it since the bundle is released.
+    MeshData* meshData = bundle->readMeshData(false);
 
     SAFE_RELEASE(bundle);
 
@@ -1785,16 +1946,24 @@ Bundle::MeshPartData::~MeshPartData()
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), mapped(false)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
-    SAFE_DELETE_ARRAY(vertexData);
+    if (!mapped)
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+    }
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
+        // Mapped index data belongs to the bundle file.
+        if (mapped)
+        {
+            parts[i]->indexData = NULL;
+        }
         SAFE_DELETE(parts[i]);
     }
 }
@@ -17,6 +17,7 @@ class Bundle : public Ref
 {
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AsyncLoader;
 
 public:
 
@@ -132,7 +133,7 @@ private:
         Mesh::PrimitiveType primitiveType;
         Mesh::IndexFormat indexFormat;
         unsigned int indexCount;
-        unsigned char* indexData;
+        const unsigned char* indexData;
     };
 
     struct MeshData
@@ -142,11 +143,12 @@ private:
 
         VertexFormat vertexFormat;
         unsigned int vertexCount;
-        unsigned char* vertexData;
+        const unsigned char* vertexData;
         BoundingBox boundingBox;
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
         std::vector<MeshPartData*> parts;
+        bool mapped;    // Whether the vertex and index data point into the mapped bundle file.
     };
 
     Bundle(const char* path);
@@ -161,6 +163,11 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Opens a bundle file and reads its reference table, without searching the bundle cache.
+     */
+    static Bundle* open(const char* path);
+
     /**
      * Finds a reference by ID.
      */
@@ -298,6 +305,31 @@ private:
      */
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
+
+    /**
+     * Reads an array of values and the array length from the current file position,
+     * pointing into the mapped bundle file instead of copying the values when possible.
+     * 
+     * @param length A pointer to where the length of the array will be copied to.
+     * @param values Set to the values, either in the mapped file or in storage.
+     * @param storage The vector the values are copied to when the file is not mapped or
+     *                the values are not aligned.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool readArray(unsigned int* length, const T** values, std::vector<T>* storage);
+
+    /**
+     * Returns the data at the current file position in the mapped bundle file and skips it.
+     * 
+     * @param size The size of each value, which the data must be aligned on.
+     * @param count The number of values.
+     * 
+     * @return The data, or NULL if the file is not mapped, the data is not aligned or
+     *         it extends past the end of the file. The file position is then unchanged.
+     */
+    const unsigned char* readMappedData(size_t size, size_t count);
     
     /**
      * Reads 16 floats from the current file position.
@@ -348,8 +380,24 @@ private:
 
     /**
      * Reads mesh data from the current file position.
+     *
+     * @param useMappedData Whether the vertex and index data may point into the mapped
+     *        bundle file, in which case they are only valid while the bundle is loaded.
+     */
+    MeshData* readMeshData(bool useMappedData = true);
+
+    /**
+     * Reads the mesh data of the object at the specified index ahead of loading it, if the
+     * object is a mesh. loadMesh() then only creates the mesh from the data already read.
+     *
+     * This does not touch GL state, so it can be called from a worker thread as long as
+     * the bundle is not used by any other thread.
+     *
+     * @param index The index of the object.
+     *
+     * @return false if the object is a mesh whose data could not be read, true otherwise.
      */
-    MeshData* readMeshData();
+    bool preloadMeshData(unsigned int index);
 
     /**
      * Reads mesh data for the specified URL.
@@ -438,9 +486,11 @@ private:
     unsigned int _referenceCount;
     Reference* _references;
     Stream* _stream;
+    const unsigned char* _mappedData;
 
     std::vector<MeshSkinData*> _meshSkins;
     std::map<std::string, Node*>* _trackedNodes;
+    std::map<std::string, MeshData*> _preloadedMeshData;
 };
 
 }
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Effect.h"
 #include "FileSystem.h"
+#include "ProgramCache.h"
 
 #define OPENGL_ES_DEFINE  "#define OPENGL_ES\n"
 
@@ -8,8 +9,12 @@ namespace gameplay
 {
 
 // Cache of unique effects.
-static std::map<std::string, Effect*> __effectCache;
+static ResourceCache<Effect> __effectCache;
 static Effect* __currentEffect = NULL;
+static unsigned int __uniformUploadCount = 0;
+static unsigned int __uniformUploadSkippedCount = 0;
+static unsigned int __uniformUploadCountLast = 0;
+static unsigned int __uniformUploadSkippedCountLast = 0;
 
 Effect::Effect() : _program(0)
 {
@@ -18,7 +23,7 @@ Effect::Effect() : _program(0)
 Effect::~Effect()
 {
     // Remove this effect from the cache.
-    __effectCache.erase(_id);
+    __effectCache.remove(this);
 
     // Free uniforms.
 #if !REPLACE_UNIFORMS_MAP
@@ -58,13 +63,12 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         uniqueId += defines;
     }
-    std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
-    if (itr != __effectCache.end())
+    Effect* cached = __effectCache.find(uniqueId.c_str());
+    if (cached)
     {
         // Found an exiting effect with this id, so increase its ref count and return it.
-        GP_ASSERT(itr->second);
-        itr->second->addRef();
-        return itr->second;
+        cached->addRef();
+        return cached;
     }
 
     // Read source from file.
@@ -95,7 +99,7 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     {
         // Store this effect in the cache.
         effect->_id = uniqueId;
-        __effectCache[uniqueId] = effect;
+        __effectCache.insert(uniqueId.c_str(), effect);
     }
 
     return effect;
@@ -230,11 +234,8 @@ struct pair_uniform_str_less
 };
 #endif
     
-Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+GLuint Effect::compileProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
 {
-    GP_ASSERT(vshSource);
-    GP_ASSERT(fshSource);
-
     const unsigned int SHADER_SOURCE_LENGTH = 3;
     const GLchar* shaderSource[SHADER_SOURCE_LENGTH];
     char* infoLog = NULL;
@@ -244,23 +245,9 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GLint length;
     GLint success;
 
-    // Replace all comma separated definitions with #define prefix and \n suffix
-    std::string definesStr = "";
-    replaceDefines(defines, definesStr);
-    
-    shaderSource[0] = definesStr.c_str();
+    shaderSource[0] = defines;
     shaderSource[1] = "\n";
-    std::string vshSourceStr = "";
-    if (vshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(vshPath, vshSource, vshSourceStr);
-        if (vshSource && strlen(vshSource) != 0)
-            vshSourceStr += "\n";
-            
-        //writeShaderToErrorFile(vshPath, vshSourceStr.c_str());   // Debugging
-    }
-    shaderSource[2] = vshPath ? vshSourceStr.c_str() :  vshSource;
+    shaderSource[2] = vshSource;
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
@@ -289,21 +276,11 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Compile the fragment shader.
-    std::string fshSourceStr;
-    if (fshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshPath, fshSource, fshSourceStr);
-        if (fshSource && strlen(fshSource) != 0)
-            fshSourceStr += "\n";
-
-        //writeShaderToErrorFile(fshPath, fshSourceStr.c_str()); // Debugging
-    }
-    shaderSource[2] = fshPath ? fshSourceStr.c_str() : fshSource;
+    shaderSource[2] = fshSource;
     GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
     GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(fragmentShader) );
@@ -333,13 +310,14 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         GL_ASSERT( glDeleteShader(vertexShader) );
         GL_ASSERT( glDeleteShader(fragmentShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Link program.
     GL_ASSERT( program = glCreateProgram() );
     GL_ASSERT( glAttachShader(program, vertexShader) );
     GL_ASSERT( glAttachShader(program, fragmentShader) );
+    ProgramCache::prepareProgram(program);
     GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
@@ -367,7 +345,58 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteProgram(program) );
 
-        return NULL;
+        return 0;
+    }
+
+    return program;
+}
+
+Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+{
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    GLint length;
+
+    // Replace all comma separated definitions with #define prefix and \n suffix
+    std::string definesStr = "";
+    replaceDefines(defines, definesStr);
+
+    std::string vshSourceStr = "";
+    if (vshPath)
+    {
+        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+        replaceIncludes(vshPath, vshSource, vshSourceStr);
+        if (vshSource && strlen(vshSource) != 0)
+            vshSourceStr += "\n";
+            
+        //writeShaderToErrorFile(vshPath, vshSourceStr.c_str());   // Debugging
+        vshSource = vshSourceStr.c_str();
+    }
+
+    std::string fshSourceStr;
+    if (fshPath)
+    {
+        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+        replaceIncludes(fshPath, fshSource, fshSourceStr);
+        if (fshSource && strlen(fshSource) != 0)
+            fshSourceStr += "\n";
+
+        //writeShaderToErrorFile(fshPath, fshSourceStr.c_str()); // Debugging
+        fshSource = fshSourceStr.c_str();
+    }
+
+    // Create the program from the binary saved by a previous run, or compile it.
+    unsigned long long programKey = ProgramCache::getKey(definesStr.c_str(), vshSource, fshSource);
+    GLuint program = ProgramCache::loadProgram(programKey);
+    if (program == 0)
+    {
+        program = compileProgram(vshPath, vshSource, fshPath, fshSource, definesStr.c_str());
+        if (program == 0)
+        {
+            return NULL;
+        }
+        ProgramCache::saveProgram(programKey, program);
     }
 
     // Create and return the new Effect.
@@ -558,79 +587,91 @@ unsigned int Effect::getUniformCount() const
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(float)))
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(float) * count))
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(int)))
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(int) * count))
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->updateValue(value.m, sizeof(float) * 16))
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 16 * count))
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 2))
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 2 * count))
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 3))
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 3 * count))
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->updateValue(&value.x, sizeof(float) * 4))
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(float) * 4 * count))
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -644,7 +685,9 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<Texture::Sampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    GLint unit = uniform->_index;
+    if (uniform->updateValue(&unit, sizeof(GLint)))
+        GL_ASSERT( glUniform1i(uniform->_location, unit) );
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
@@ -666,7 +709,8 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
     }
 
     // Pass texture unit array to GL
-    GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    if (uniform->updateValue(units, sizeof(GLint) * count))
+        GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
 }
 
 void Effect::bind()
@@ -683,14 +727,58 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+unsigned int Effect::getUniformUploadCount()
+{
+    return __uniformUploadCountLast;
+}
+
+unsigned int Effect::getUniformUploadSkippedCount()
+{
+    return __uniformUploadSkippedCountLast;
+}
+
+ResourceCache<Effect>& Effect::getCache()
+{
+    return __effectCache;
+}
+
+void Effect::resetUniformStatistics()
+{
+    __uniformUploadCountLast = __uniformUploadCount;
+    __uniformUploadSkippedCountLast = __uniformUploadSkippedCount;
+    __uniformUploadCount = 0;
+    __uniformUploadSkippedCount = 0;
+}
+
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0)
+    _location(-1), _type(0), _index(0), _value(NULL), _valueSize(0)
 {
 }
 
 Uniform::~Uniform()
 {
-    // hidden
+    SAFE_DELETE_ARRAY(_value);
+}
+
+bool Uniform::updateValue(const void* value, unsigned int size)
+{
+    // Uniform values are kept by the program, so an upload can be skipped when it
+    // writes the same bytes as the previous upload to this uniform.
+    if (size <= _valueSize && memcmp(_value, value, size) == 0)
+    {
+        ++__uniformUploadSkippedCount;
+        return false;
+    }
+
+    if (size > _valueSize)
+    {
+        SAFE_DELETE_ARRAY(_value);
+        _value = new unsigned char[size];
+        _valueSize = size;
+    }
+    memcpy(_value, value, size);
+    ++__uniformUploadCount;
+    return true;
 }
 
 Effect* Uniform::getEffect() const
@@ -7,6 +7,7 @@
 #include "Vector4.h"
 #include "Matrix.h"
 #include "Texture.h"
+#include "ResourceCache.h"
 
 #define REPLACE_UNIFORMS_MAP 1
 
@@ -27,6 +28,8 @@ class Uniform;
  */
 class Effect: public Ref
 {
+    friend class Game;
+
 public:
 
     /**
@@ -233,6 +236,33 @@ public:
      */
     static Effect* getCurrentEffect();
 
+    /**
+     * Returns the number of uniform values uploaded to GL during the last frame.
+     *
+     * Each uniform keeps a copy of the last value uploaded to it, and setValue()
+     * skips the upload when the new value is identical.
+     *
+     * @return The number of uniform uploads issued.
+     */
+    static unsigned int getUniformUploadCount();
+
+    /**
+     * Returns the number of uniform uploads skipped during the last frame because
+     * the uniform already held the same value.
+     *
+     * @return The number of uniform uploads skipped.
+     */
+    static unsigned int getUniformUploadSkippedCount();
+
+    /**
+     * Returns the cache of the effects created from shader files, keyed on
+     * their shader paths and defines.
+     *
+     * @return The effect cache.
+     * @script{ignore}
+     */
+    static ResourceCache<Effect>& getCache();
+
 #if REPLACE_UNIFORMS_MAP
     struct UniformPair
     {
@@ -260,6 +290,20 @@ private:
 
     static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Compiles and links the program of preprocessed shader sources.
+     *
+     * @return The linked program, or 0 if compiling or linking failed.
+     */
+    static GLuint compileProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines);
+
+    /**
+     * Moves the uniform upload counters of the current frame to the last frame counters.
+     *
+     * Called by the game at the start of each frame.
+     */
+    static void resetUniformStatistics();
+
     GLuint _program;
     std::string _id;
     std::map<std::string, VertexAttribute> _vertexAttributes;
@@ -323,11 +367,23 @@ private:
      */
     Uniform& operator=(const Uniform&);
 
+    /**
+     * Records a value about to be uploaded to this uniform.
+     *
+     * @param value The value.
+     * @param size The size of the value, in bytes.
+     *
+     * @return true if the value must be uploaded, false if the uniform already holds it.
+     */
+    bool updateValue(const void* value, unsigned int size);
+
     std::string _name;
     GLint _location;
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    unsigned char* _value;      // Copy of the last value uploaded to the uniform.
+    unsigned int _valueSize;    // Size of the last value uploaded, in bytes.
 };
 
 }
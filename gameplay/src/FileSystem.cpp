@@ -2,6 +2,8 @@
 #include "FileSystem.h"
 #include "Properties.h"
 #include "Stream.h"
+#include "MemoryStream.h"
+#include "PackFile.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -17,6 +19,9 @@
     #define __EXT_POSIX2
     #include <libgen.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -90,6 +95,7 @@ static bool androidFileExists(const char* filePath)
 static std::vector<std::string> m_resourcePathList;
 //static std::string __resourcePath("./");
 static std::map<std::string, std::string> __aliases;
+static std::vector<PackFile*> __packs;
 
 /**
  * Gets the fully resolved path.
@@ -144,6 +150,35 @@ private:
     bool _canWrite;
 };
 
+/**
+ * A read-only stream over a file mapped in memory.
+ * 
+ * @script{ignore}
+ */
+class MappedFileStream : public MemoryStream
+{
+public:
+    friend class FileSystem;
+    
+    ~MappedFileStream();
+    virtual void close();
+
+    /**
+     * Maps a file.
+     *
+     * @return The stream, or NULL if the file could not be mapped (empty files cannot be).
+     */
+    static MappedFileStream* create(const char* filePath);
+
+private:
+    MappedFileStream(const unsigned char* data, size_t length);
+
+#ifdef WIN32
+private:
+    HANDLE _mapping;
+#endif
+};
+
 #ifdef __ANDROID__
 
 /**
@@ -168,14 +203,16 @@ public:
     virtual long int position();
     virtual bool seek(long int offset, int origin);
     virtual bool rewind();
+    virtual const void* getMappedData();
 
-    static FileStreamAndroid* create(const char* filePath, const char* mode);
+    static FileStreamAndroid* create(const char* filePath, const char* mode, bool mapped = false);
 
 private:
     FileStreamAndroid(AAsset* asset);
 
 private:
     AAsset* _asset;
+    bool _mapped;
 };
 
 #endif
@@ -259,6 +296,53 @@ const char* FileSystem::resolvePath(const char* path)
     return path;
 }
 
+bool FileSystem::mountPack(const char* path)
+{
+    GP_ASSERT(path);
+
+    PackFile* pack = PackFile::create(path);
+    if (pack == NULL)
+        return false;
+
+    // Mounting a pack again moves it to the front of the search order.
+    unmountPack(path);
+    __packs.push_back(pack);
+    return true;
+}
+
+bool FileSystem::unmountPack(const char* path)
+{
+    GP_ASSERT(path);
+
+    for (std::vector<PackFile*>::iterator itr = __packs.begin(); itr != __packs.end(); ++itr)
+    {
+        if ((*itr)->_path == path)
+        {
+            SAFE_RELEASE(*itr);
+            __packs.erase(itr);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the last mounted pack that contains a file, or NULL.
+ */
+static PackFile* findPack(const char* path)
+{
+    if (__packs.empty() || FileSystem::isAbsolutePath(path))
+        return NULL;
+
+    const char* resolvedPath = FileSystem::resolvePath(path);
+    for (std::vector<PackFile*>::reverse_iterator itr = __packs.rbegin(); itr != __packs.rend(); ++itr)
+    {
+        if ((*itr)->contains(resolvedPath))
+            return *itr;
+    }
+    return NULL;
+}
+
 bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
 {
 #ifdef WIN32
@@ -354,6 +438,9 @@ bool FileSystem::listFiles(const char* dirPath, std::vector<std::string>& files)
 bool FileSystem::fileExists(const char* filePath)
 {
     GP_ASSERT(filePath);
+	if (findPack(filePath))
+		return true;
+
 	bool bFound = false;
 	for (std::vector<std::string>::const_iterator cit = m_resourcePathList.begin(); cit != m_resourcePathList.end(); ++cit) {
 
@@ -390,6 +477,13 @@ bool FileSystem::fileExists(const char* filePath)
 
 Stream* FileSystem::open(const char* path, size_t mode)
 {
+    if ((mode & WRITE) == 0)
+    {
+        PackFile* pack = findPack(path);
+        if (pack)
+            return pack->open(resolvePath(path));
+    }
+
     char modeStr[] = "rb";
     if ((mode & WRITE) != 0) {
         modeStr[0] = 'w';
@@ -417,7 +511,7 @@ Stream* FileSystem::open(const char* path, size_t mode)
     else
     {
 		std::string fullPath = FileSystem::resolvePath(path);
-		Stream *a_stream = FileStreamAndroid::create(fullPath.c_str(), modeStr);
+		Stream *a_stream = FileStreamAndroid::create(fullPath.c_str(), modeStr, (mode & MAP) != 0);
 		if (!a_stream) {
 			bool bFound = false;
 			for (std::vector<std::string>::const_iterator cit = m_resourcePathList.begin(); cit != m_resourcePathList.end(); ++cit) {
@@ -430,7 +524,10 @@ Stream* FileSystem::open(const char* path, size_t mode)
 					break;
 				}
 			}
-			if (bFound) {
+			if (bFound && (mode & MAP) != 0) {
+				a_stream = MappedFileStream::create(fullPath.c_str());
+			}
+			if (bFound && !a_stream) {
 				a_stream = FileStream::create(fullPath.c_str(), modeStr);
 			}
 		}
@@ -476,6 +573,12 @@ Stream* FileSystem::open(const char* path, size_t mode)
         }
     }
 #endif
+    if ((mode & MAP) != 0 && (mode & WRITE) == 0)
+    {
+        MappedFileStream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -828,10 +931,91 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+MappedFileStream::MappedFileStream(const unsigned char* data, size_t length)
+    : MemoryStream(data, length)
+#ifdef WIN32
+    , _mapping(NULL)
+#endif
+{
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    if (_data)
+    {
+        close();
+    }
+}
+
+MappedFileStream* MappedFileStream::create(const char* filePath)
+{
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (unsigned long long)size.QuadPart <= (size_t)-1)
+    {
+        mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    // The mapping keeps the file open.
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+
+    const unsigned char* data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        return NULL;
+    }
+
+    MappedFileStream* stream = new MappedFileStream(data, (size_t)size.QuadPart);
+    stream->_mapping = mapping;
+    return stream;
+#else
+    int file = ::open(filePath, O_RDONLY);
+    if (file == -1)
+        return NULL;
+
+    struct stat s;
+    void* data = MAP_FAILED;
+    if (fstat(file, &s) == 0 && s.st_size > 0)
+    {
+        data = mmap(NULL, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // The mapping keeps the file open.
+    ::close(file);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    return new MappedFileStream((const unsigned char*)data, (size_t)s.st_size);
+#endif
+}
+
+void MappedFileStream::close()
+{
+    if (_data)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        _mapping = NULL;
+#else
+        munmap((void*)_data, _length);
+#endif
+    }
+    MemoryStream::close();
+}
+
+////////////////////////////////
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
-    : _asset(asset)
+    : _asset(asset), _mapped(false)
 {
 }
 
@@ -841,12 +1025,14 @@ FileStreamAndroid::~FileStreamAndroid()
         close();
 }
 
-FileStreamAndroid* FileStreamAndroid::create(const char* filePath, const char* mode)
+FileStreamAndroid* FileStreamAndroid::create(const char* filePath, const char* mode, bool mapped)
 {
-    AAsset* asset = AAssetManager_open(__assetManager, filePath, AASSET_MODE_RANDOM);
+    // Uncompressed assets opened for buffer access are mapped from the APK.
+    AAsset* asset = AAssetManager_open(__assetManager, filePath, mapped ? AASSET_MODE_BUFFER : AASSET_MODE_RANDOM);
     if (asset)
     {
         FileStreamAndroid* stream = new FileStreamAndroid(asset);
+        stream->_mapped = mapped;
         return stream;
     }
     return NULL;
@@ -973,6 +1159,13 @@ bool FileStreamAndroid::rewind()
     return false;
 }
 
+const void* FileStreamAndroid::getMappedData()
+{
+    if (!_asset || !_mapped)
+        return NULL;
+    return AAsset_getBuffer(_asset);
+}
+
 #endif
 
 }
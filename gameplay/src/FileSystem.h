@@ -23,7 +23,8 @@ public:
     enum StreamMode
     {
         READ = 1,
-        WRITE = 2
+        WRITE = 2,
+        MAP = 4     // Map the file in memory for reading when possible (see Stream::getMappedData()).
     };
 
     /**
@@ -99,6 +100,37 @@ public:
      */
     static const char* resolvePath(const char* path);
 
+    /**
+     * Mounts a pack file (see PackFile).
+     *
+     * The files of mounted packs are found before the files of the resource paths, and
+     * the last mounted pack is searched first, so a patch pack overrides the packs mounted
+     * before it. Files are looked up in packs by their path after aliases are resolved.
+     * open(), readAll() and fileExists() find packed files; openFile() and listFiles() do not.
+     *
+     * Packs should be mounted and unmounted while no other thread is opening files.
+     *
+     * @param path The path of the pack file.
+     *
+     * @return true if the pack was mounted, false if it could not be read.
+     *
+     * @script{ignore}
+     */
+    static bool mountPack(const char* path);
+
+    /**
+     * Unmounts a pack file mounted with mountPack().
+     *
+     * Streams opened from the pack remain valid until they are closed.
+     *
+     * @param path The path the pack file was mounted with.
+     *
+     * @return true if the pack was unmounted, false if it was not mounted.
+     *
+     * @script{ignore}
+     */
+    static bool unmountPack(const char* path);
+
     /**
      * Lists the files in the specified directory and adds the files to the vector. Excludes directories.
      * 
@@ -127,7 +159,9 @@ public:
      * resource path.
      *
      * @param path The path to the resource to be opened, relative to the currently set resource path.
-     * @param mode The mode used to open the file.
+     * @param mode The mode used to open the file. When MAP is set with READ, the file is
+     *             mapped in memory if the platform supports it; otherwise it is opened
+     *             as with READ alone.
      * 
      * @return A stream that can be used to read or write to the file depending on the mode.
      *         Returns NULL if there was an error. (Request mode not supported).
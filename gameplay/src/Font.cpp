@@ -11,7 +11,7 @@
 namespace gameplay
 {
 
-static std::vector<Font*> __fontCache;
+static ResourceCache<Font> __fontCache;
 
 static Effect* __fontEffect = NULL;
 
@@ -23,11 +23,7 @@ Font::Font() :
 Font::~Font()
 {
     // Remove this Font from the font cache.
-    std::vector<Font*>::iterator itr = std::find(__fontCache.begin(), __fontCache.end(), this);
-    if (itr != __fontCache.end())
-    {
-        __fontCache.erase(itr);
-    }
+    __fontCache.remove(this);
 
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
@@ -38,17 +34,20 @@ Font* Font::create(const char* path, const char* id)
 {
     GP_ASSERT(path);
 
-    // Search the font cache for a font with the given path and ID.
-    for (size_t i = 0, count = __fontCache.size(); i < count; ++i)
+    // Search the font cache for a font with the given path and ID. Fonts
+    // loaded without an ID are cached with the path alone.
+    std::string key = path;
+    if (id)
     {
-        Font* f = __fontCache[i];
-        GP_ASSERT(f);
-        if (f->_path == path && (id == NULL || f->_id == id))
-        {
-            // Found a match.
-            f->addRef();
-            return f;
-        }
+        key += '#';
+        key += id;
+    }
+    Font* f = __fontCache.find(key.c_str());
+    if (f)
+    {
+        // Found a match.
+        f->addRef();
+        return f;
     }
 
     // Load the bundle.
@@ -82,7 +81,7 @@ Font* Font::create(const char* path, const char* id)
     if (font)
     {
         // Add this font to the cache.
-        __fontCache.push_back(font);
+        __fontCache.insert(key.c_str(), font);
     }
 
     SAFE_RELEASE(bundle);
@@ -1857,6 +1856,11 @@ SpriteBatch* Font::getSpriteBatch() const
     return _batch;
 }
 
+ResourceCache<Font>& Font::getCache()
+{
+    return __fontCache;
+}
+
 Font::Justify Font::getJustify(const char* justify)
 {
     if (!justify)
@@ -2,6 +2,7 @@
 #define FONT_H_
 
 #include "SpriteBatch.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -250,6 +251,14 @@ public:
      */
     static Justify getJustify(const char* justify);
 
+    /**
+     * Returns the cache of the fonts loaded with create(const char*, const char*).
+     *
+     * @return The font cache.
+     * @script{ignore}
+     */
+    static ResourceCache<Font>& getCache();
+
 	int findGlyphIndex(int unicode);
 
 private:
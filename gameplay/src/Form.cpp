@@ -589,6 +589,7 @@ const char* Form::getType() const
 
 void Form::updateInternal(float elapsedTime)
 {
+    GP_PROFILE_ZONE("Form::updateInternal");
     size_t size = __forms.size();
     for (size_t i = 0; i < size; ++i)
     {
@@ -2,6 +2,7 @@
 #include "Frustum.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -130,6 +131,81 @@ float Frustum::intersects(const Ray& ray) const
     return ray.intersects(*this);
 }
 
+float Frustum::classify(const BoundingSphere& sphere, unsigned int* planeMask) const
+{
+    GP_ASSERT(planeMask);
+
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        if (!(*planeMask & (1 << i)))
+            continue;
+
+        float d = planes[i]->distance(sphere.center);
+        if (d < -sphere.radius)
+            return Plane::INTERSECTS_BACK;
+
+        // The sphere is entirely inside this plane, so its contents need not test it again.
+        if (d >= sphere.radius)
+            *planeMask &= ~(1 << i);
+    }
+    return *planeMask ? Plane::INTERSECTS_INTERSECTING : Plane::INTERSECTS_FRONT;
+}
+
+float Frustum::classify(const BoundingBox& box, unsigned int* planeMask) const
+{
+    GP_ASSERT(planeMask);
+
+    Vector3 center = box.getCenter();
+    Vector3 extent = (box.max - box.min) * 0.5f;
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        if (!(*planeMask & (1 << i)))
+            continue;
+
+        const Vector3& normal = planes[i]->getNormal();
+        float d = planes[i]->distance(center);
+        float r = fabs(normal.x) * extent.x + fabs(normal.y) * extent.y + fabs(normal.z) * extent.z;
+        if (d < -r)
+            return Plane::INTERSECTS_BACK;
+
+        if (d >= r)
+            *planeMask &= ~(1 << i);
+    }
+    return *planeMask ? Plane::INTERSECTS_INTERSECTING : Plane::INTERSECTS_FRONT;
+}
+
+unsigned int Frustum::cullSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, unsigned int count,
+                                  unsigned int* visibility, unsigned char* planeCache, unsigned int planeMask) const
+{
+    GP_ASSERT(visibility);
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    if (count == 0)
+        return 0;
+
+    GP_ASSERT(centerX && centerY && centerZ && radius);
+
+    float planes[24];
+    getPlanes(planes);
+    return MathUtil::cullSpheres(planes, planeMask, centerX, centerY, centerZ, radius, count, visibility, planeCache);
+}
+
+unsigned int Frustum::cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                                unsigned int count, unsigned int* visibility, unsigned char* planeCache, unsigned int planeMask) const
+{
+    GP_ASSERT(visibility);
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    if (count == 0)
+        return 0;
+
+    GP_ASSERT(minX && minY && minZ && maxX && maxY && maxZ);
+
+    float planes[24];
+    getPlanes(planes);
+    return MathUtil::cullBoxes(planes, planeMask, minX, minY, minZ, maxX, maxY, maxZ, count, visibility, planeCache);
+}
+
 void Frustum::set(const Frustum& frustum)
 {
     _near = frustum._near;
@@ -151,6 +227,21 @@ void Frustum::updatePlanes()
     _right.set(Vector3(_matrix.m[3] - _matrix.m[0], _matrix.m[7] - _matrix.m[4], _matrix.m[11] - _matrix.m[8]), _matrix.m[15] - _matrix.m[12]);
 }
 
+void Frustum::getPlanes(float* planes) const
+{
+    GP_ASSERT(planes);
+
+    const Plane* source[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        const Vector3& normal = source[i]->getNormal();
+        planes[i] = normal.x;
+        planes[6 + i] = normal.y;
+        planes[12 + i] = normal.z;
+        planes[18 + i] = source[i]->getDistance();
+    }
+}
+
 void Frustum::set(const Matrix& matrix)
 {
     _matrix.set(matrix);
@@ -29,6 +29,13 @@ class Frustum
 {
 public:
 
+    /**
+     * Mask of all six planes for classify(), cullSpheres() and cullBoxes().
+     *
+     * Bit 0 selects the near plane, followed by the far, left, right, bottom and top planes.
+     */
+    static const unsigned int PLANE_MASK_ALL = 0x3F;
+
     /**
      * Constructs the default frustum (corresponds to the identity matrix).
      */
@@ -193,6 +200,91 @@ public:
      */
     float intersects(const Ray& ray) const;
 
+    /**
+     * Classifies a bounding sphere against the planes of this frustum selected by a plane mask.
+     *
+     * On return, the mask only selects the planes the sphere intersects. Passing it to the
+     * classification of the children of a bounding volume hierarchy skips the planes their
+     * parent was found to be entirely inside of.
+     *
+     * @param sphere The bounding sphere to classify.
+     * @param planeMask The planes to test against (see PLANE_MASK_ALL), updated on return.
+     *
+     * @return Plane::INTERSECTS_BACK if the sphere is outside of this frustum, Plane::INTERSECTS_FRONT
+     *  if it is inside all selected planes, and Plane::INTERSECTS_INTERSECTING otherwise.
+     * @script{ignore}
+     */
+    float classify(const BoundingSphere& sphere, unsigned int* planeMask) const;
+
+    /**
+     * Classifies a bounding box against the planes of this frustum selected by a plane mask.
+     *
+     * On return, the mask only selects the planes the box intersects. Passing it to the
+     * classification of the children of a bounding volume hierarchy skips the planes their
+     * parent was found to be entirely inside of.
+     *
+     * @param box The bounding box to classify.
+     * @param planeMask The planes to test against (see PLANE_MASK_ALL), updated on return.
+     *
+     * @return Plane::INTERSECTS_BACK if the box is outside of this frustum, Plane::INTERSECTS_FRONT
+     *  if it is inside all selected planes, and Plane::INTERSECTS_INTERSECTING otherwise.
+     * @script{ignore}
+     */
+    float classify(const BoundingBox& box, unsigned int* planeMask) const;
+
+    /**
+     * Tests an array of bounding spheres against this frustum.
+     *
+     * The spheres are given as separate arrays of center coordinates and radii and are
+     * tested several at a time using the SIMD instructions of the platform, if any.
+     * Bit (i % 32) of visibility[i / 32] is set for each sphere i that intersects the frustum.
+     *
+     * An optional plane cache holds one byte per sphere, initialized to zero by the caller.
+     * The plane that rejected each sphere is stored in it and tested first on the next call,
+     * which usually rejects an object that was outside of the frustum the previous frame
+     * with a single plane test.
+     *
+     * @param centerX The x coordinates of the centers of the spheres.
+     * @param centerY The y coordinates of the centers of the spheres.
+     * @param centerZ The z coordinates of the centers of the spheres.
+     * @param radius The radii of the spheres.
+     * @param count The number of spheres.
+     * @param visibility The visibility bitmask, of at least (count + 31) / 32 words. It is cleared first.
+     * @param planeCache The plane cache, of at least count bytes, or NULL.
+     * @param planeMask The planes to test against, such as a mask returned by classify() for
+     *  a bounding volume containing all the spheres.
+     *
+     * @return The number of spheres that intersect the frustum.
+     * @script{ignore}
+     */
+    unsigned int cullSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, unsigned int count,
+                             unsigned int* visibility, unsigned char* planeCache = NULL, unsigned int planeMask = PLANE_MASK_ALL) const;
+
+    /**
+     * Tests an array of axis-aligned bounding boxes against this frustum.
+     *
+     * The boxes are given as separate arrays of minimum and maximum coordinates and are
+     * tested several at a time using the SIMD instructions of the platform, if any.
+     * Bit (i % 32) of visibility[i / 32] is set for each box i that intersects the frustum.
+     * The plane cache and plane mask are used as in cullSpheres().
+     *
+     * @param minX The minimum x coordinates of the boxes.
+     * @param minY The minimum y coordinates of the boxes.
+     * @param minZ The minimum z coordinates of the boxes.
+     * @param maxX The maximum x coordinates of the boxes.
+     * @param maxY The maximum y coordinates of the boxes.
+     * @param maxZ The maximum z coordinates of the boxes.
+     * @param count The number of boxes.
+     * @param visibility The visibility bitmask, of at least (count + 31) / 32 words. It is cleared first.
+     * @param planeCache The plane cache, of at least count bytes, or NULL.
+     * @param planeMask The planes to test against.
+     *
+     * @return The number of boxes that intersect the frustum.
+     * @script{ignore}
+     */
+    unsigned int cullBoxes(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                           unsigned int count, unsigned int* visibility, unsigned char* planeCache = NULL, unsigned int planeMask = PLANE_MASK_ALL) const;
+
     /**
      * Sets this frustum to the specified frustum.
      *
@@ -214,6 +306,14 @@ private:
      */
     void updatePlanes();
 
+    /**
+     * Copies the planes into arrays of normal x, normal y, normal z and distance
+     * coefficients, in the order of the bits of a plane mask.
+     *
+     * @param planes The array (of at least size 24) to store the planes in.
+     */
+    void getPlanes(float* planes) const;
+
     Plane _near;
     Plane _far;
     Plane _bottom;
@@ -4,9 +4,15 @@
 #include "RenderState.h"
 #include "FileSystem.h"
 #include "FrameBuffer.h"
+#include "ProgramCache.h"
 #include "SceneLoader.h"
 #include "InAppPurchase.h"
 
+// Default simulation rates
+#define GAME_UPDATE_RATE                30.0f
+#define GAME_MAX_UPDATES_PER_FRAME      3
+#define GAME_MAX_FRAME_TIME             250.0f
+
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
 /** @script{ignore} */
@@ -22,15 +28,22 @@ double Game::_elapsedTime = 0.0;
 
 Game::Game()
     : _initialized(false), _state(UNINITIALIZED), _pausedCount(0),
-      _frameLastFPS(0), _frameCount(0), _frameRate(0),
+      _frameLastFPS(0), _frameCount(0), _frameRate(0), _lastFrameTime(0.0),
+      _fixedTimestep(true), _updateRate(GAME_UPDATE_RATE), _maxUpdatesPerFrame(GAME_MAX_UPDATES_PER_FRAME),
+      _maxFrameTime(GAME_MAX_FRAME_TIME), _accumulatedTime(0.0), _interpolationAlpha(1.0f), _droppedUpdateCount(0),
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
-      _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
+      _physicsController(NULL), _aiController(NULL), _threadPool(NULL), _asyncLoader(NULL), _audioListener(NULL),
       _timeEvents(NULL), _scriptController(NULL), _scriptListeners(NULL),
 	  _preConfigCallback(NULL), _postConfigCallback(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
     __gameInstance = this;
+    for (unsigned int i = 0; i < SUBSYSTEM_COUNT; ++i)
+    {
+        _subsystemRates[i] = 0.0f;
+        _subsystemTime[i] = 0.0;
+    }
     _timeEvents = new std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >();
     InAppPurchaseWrapper::GetUniqueInstance();
 }
@@ -108,6 +121,34 @@ bool Game::startup()
     RenderState::initialize();
     FrameBuffer::initialize();
 
+    // Cache linked shader programs on disk unless the config sets an empty path.
+    std::string programCachePath = "program.cache";
+    if (_properties)
+    {
+        Properties* programCache = _properties->getNamespace("programCache", true);
+        if (programCache && programCache->exists("path"))
+        {
+            const char* path = programCache->getString("path");
+            programCachePath = path ? path : "";
+        }
+    }
+    ProgramCache::initialize(programCachePath.c_str());
+
+    // Create the worker threads, leaving one processor for the main thread by default.
+    unsigned int workerCount = ThreadPool::getProcessorCount() - 1;
+    if (_properties)
+    {
+        Properties* threads = _properties->getNamespace("threads", true);
+        if (threads && threads->exists("workers"))
+        {
+            workerCount = (unsigned int)max(threads->getInt("workers"), 0);
+        }
+    }
+    _threadPool = new ThreadPool(workerCount);
+    _asyncLoader = new AsyncLoader();
+
+    loadTimeConfig();
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -185,6 +226,9 @@ void Game::shutdown()
 		}
 		_scriptController->finalize();
 
+        // Stop the loading thread and release the objects of pending loads while the subsystems still exist.
+        SAFE_DELETE(_asyncLoader);
+
         unsigned int gamepadCount = Gamepad::getGamepadCount();
         for (unsigned int i = 0; i < gamepadCount; i++)
         {
@@ -203,11 +247,15 @@ void Game::shutdown()
         _aiController->finalize();
         SAFE_DELETE(_aiController);
 
+        SAFE_DELETE(_threadPool);
+
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
 
         SAFE_DELETE(_audioListener);
 
+        ResourceCacheBase::finalize();
+        ProgramCache::finalize();
         FrameBuffer::finalize();
         RenderState::finalize();
 
@@ -286,6 +334,11 @@ void Game::exit()
 
 void Game::frame()
 {
+    GP_PROFILE_FRAME();
+    GP_PROFILE_ZONE("Game::frame");
+
+    Effect::resetUniformStatistics();
+
     if (!_initialized)
     {
         // Perform lazy first time initialization
@@ -295,36 +348,33 @@ void Game::frame()
 
         // Fire first game resize event
         Platform::resizeEventInternal(_width, _height);
+
+        _lastFrameTime = getGameTime();
     }
 
-	static double lastFrameTime = Game::getGameTime();
-	double frameTime = getGameTime();
+    double frameTime = getGameTime();
 
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
 
-    float elapsedTime = 1000.0f/30.0f;
-    if (frameTime > lastFrameTime) {
-        // Update Time.
-        elapsedTime = float(frameTime - lastFrameTime);
+    // Update Time.
+    float elapsedTime = 0.0f;
+    if (frameTime > _lastFrameTime)
+    {
+        elapsedTime = (float)(frameTime - _lastFrameTime);
     }
-	lastFrameTime = frameTime;
-	// MALEK: Limit frame time explosion.
-	if (elapsedTime > 250.0f)
-		elapsedTime = 250.0f;
-
-#define USE_ACCUMULATOR 1
-
-#if USE_ACCUMULATOR 
-	// MALEK : Fixed Time Update
-	static const double FRAME_RATE = 60.0;
-	static const double UPDATE_RATE = 30.0;
-	static const double MS_PER_FRAME = 1000.0/FRAME_RATE;
-	static const double MS_PER_UPDATE = 1000.0/UPDATE_RATE;
-	static const int MAX_LOOP = 3;
-#endif
+    _lastFrameTime = frameTime;
 
-	_elapsedTime = elapsedTime;
+    // Limit the frame time fed to the simulation after long stalls (such as loading or debugging).
+    if (_maxFrameTime > 0.0f && elapsedTime > _maxFrameTime)
+    {
+        elapsedTime = _maxFrameTime;
+    }
+
+    _elapsedTime = elapsedTime;
+
+    // Complete the background loads whose files were read.
+    _asyncLoader->update();
 
     if (_state == Game::RUNNING)
     {
@@ -333,100 +383,49 @@ void Game::frame()
         GP_ASSERT(_physicsController);
         GP_ASSERT(_aiController);
 
-#if USE_ACCUMULATOR
-		// MALEK: --->
-		// catchup accumulators
-		static double accumulatedFrame = 0.0;
-		static double accumulatedUpdate = 0.0;
-
-		float realElapsedTime = elapsedTime;
-		accumulatedFrame += elapsedTime;
-		accumulatedUpdate += elapsedTime;
-		int frameloop = 0;
-		int updateloop = 0;
-
-		// Update gamepads.
-		Gamepad::updateInternal(realElapsedTime);
-
-		// Update forms.
-		Form::updateInternal(realElapsedTime);
-
-		// animation & physics should be updated at 60 fps
-		//if (accumulatedFrame >= MS_PER_FRAME*0.5)
-		{
-			//while (accumulatedFrame >= MS_PER_FRAME && frameloop < MAX_LOOP)
-			{
-				// Update the scheduled and running animations.
-				//_animationController->update(MS_PER_FRAME);
-
-				// Update the physics.
-				//_physicsController->update(MS_PER_FRAME);
-
-
-				++frameloop;
-				accumulatedFrame -= MS_PER_FRAME;
-
-
-
-			updateloop = 0;
-
-			elapsedTime = (float)MS_PER_UPDATE;
-
-			while (accumulatedUpdate >= MS_PER_UPDATE && updateloop < MAX_LOOP)
-			{
-
-		// MALEK <---
-#else		
-			// Update gamepads.
-			Gamepad::updateInternal(elapsedTime);
-
-			// Update forms.
-			Form::updateInternal(elapsedTime);
-#endif
-			// Update the scheduled and running animations.
-			_animationController->update(elapsedTime);
-
-			// Update the physics.
-			_physicsController->update(elapsedTime);
-
-			// Update AI.
-			_aiController->update(elapsedTime);
-
-			// Update gamepads.
-			//Gamepad::updateInternal(elapsedTime);
-
-			// Application Update.
-			update(elapsedTime);
-
-			// Update forms.
-			//Form::updateInternal(elapsedTime);
-
-			// Run script update.
-			_scriptController->update(elapsedTime);
-
-			// Audio Rendering.
-			_audioController->update(elapsedTime);
-
-#if USE_ACCUMULATOR
-			++updateloop;
-			accumulatedUpdate -= MS_PER_UPDATE;
+        // Update gamepads.
+        Gamepad::updateInternal(elapsedTime);
 
-			}
+        // Update forms.
+        Form::updateInternal(elapsedTime);
 
+        if (_fixedTimestep)
+        {
+            // Run as many fixed steps as needed to catch up with the frame time.
+            const double step = 1000.0 / _updateRate;
+            _accumulatedTime += elapsedTime;
+            unsigned int updateCount = 0;
+            while (_accumulatedTime >= step && updateCount < _maxUpdatesPerFrame)
+            {
+                updateSimulation((float)step);
+                _accumulatedTime -= step;
+                ++updateCount;
+            }
 
-			}
-		}
-//#if FORCE_FIXED_RENDERING
-		//else {
-		//	return false;
-		//}
-//#endif
-		elapsedTime = realElapsedTime;
-#endif
+            // Drop the whole steps we could not afford this frame rather than carrying
+            // them over, otherwise a slow frame would make every following frame slower.
+            if (_accumulatedTime >= step)
+            {
+                unsigned int dropped = (unsigned int)(_accumulatedTime / step);
+                _droppedUpdateCount += dropped;
+                _accumulatedTime -= dropped * step;
+            }
+            _interpolationAlpha = (float)(_accumulatedTime / step);
+        }
+        else
+        {
+            updateSimulation(elapsedTime);
+            _interpolationAlpha = 1.0f;
+        }
 
+        // Audio Rendering.
+        _audioController->update(elapsedTime);
 
 		// Graphics Rendering.
-		render(elapsedTime);
+		{
+			GP_PROFILE_ZONE("Game::render");
+			render(elapsedTime);
+		}
 
 		// Run script render.
 		_scriptController->render(elapsedTime);
@@ -468,6 +467,114 @@ void Game::frame()
     }
 }
 
+void Game::updateSimulation(float elapsedTime)
+{
+    float step;
+
+    // Update the scheduled and running animations.
+    for (unsigned int i = getSubsystemSteps(SUBSYSTEM_ANIMATION, elapsedTime, &step); i > 0; --i)
+        _animationController->update(step);
+
+    // Update the physics.
+    for (unsigned int i = getSubsystemSteps(SUBSYSTEM_PHYSICS, elapsedTime, &step); i > 0; --i)
+        _physicsController->update(step);
+
+    // Update AI.
+    for (unsigned int i = getSubsystemSteps(SUBSYSTEM_AI, elapsedTime, &step); i > 0; --i)
+        _aiController->update(step);
+
+    // Application Update.
+    {
+        GP_PROFILE_ZONE("Game::update");
+        update(elapsedTime);
+    }
+
+    // Run script update.
+    for (unsigned int i = getSubsystemSteps(SUBSYSTEM_SCRIPT, elapsedTime, &step); i > 0; --i)
+        _scriptController->update(step);
+}
+
+unsigned int Game::getSubsystemSteps(Subsystem subsystem, float elapsedTime, float* step)
+{
+    GP_ASSERT(step);
+
+    float rate = _subsystemRates[subsystem];
+    if (rate <= 0.0f)
+    {
+        *step = elapsedTime;
+        return 1;
+    }
+
+    double period = 1000.0 / rate;
+    _subsystemTime[subsystem] += elapsedTime;
+    unsigned int count = (unsigned int)(_subsystemTime[subsystem] / period);
+    _subsystemTime[subsystem] -= count * period;
+    *step = (float)period;
+    return count;
+}
+
+void Game::setWorkerThreadCount(unsigned int workerCount)
+{
+    // Deleting the pool finishes its queued jobs and joins its workers.
+    SAFE_DELETE(_threadPool);
+    _threadPool = new ThreadPool(workerCount);
+}
+
+void Game::setUpdateRate(float rate)
+{
+    GP_ASSERT(rate > 0.0f);
+    _updateRate = rate;
+    _accumulatedTime = 0.0;
+}
+
+void Game::setFixedTimestep(bool fixed)
+{
+    _fixedTimestep = fixed;
+    _accumulatedTime = 0.0;
+    _interpolationAlpha = 1.0f;
+}
+
+void Game::setMaxUpdatesPerFrame(unsigned int count)
+{
+    _maxUpdatesPerFrame = max(count, 1u);
+}
+
+void Game::setSubsystemUpdateRate(Subsystem subsystem, float rate)
+{
+    GP_ASSERT(subsystem < SUBSYSTEM_COUNT);
+    _subsystemRates[subsystem] = max(rate, 0.0f);
+    _subsystemTime[subsystem] = 0.0;
+}
+
+void Game::loadTimeConfig()
+{
+    Properties* time = _properties ? _properties->getNamespace("time", true) : NULL;
+    if (time == NULL)
+        return;
+
+    if (time->exists("fixedTimestep"))
+        setFixedTimestep(time->getBool("fixedTimestep"));
+    if (time->exists("updateRate"))
+    {
+        float rate = time->getFloat("updateRate");
+        if (rate > 0.0f)
+            setUpdateRate(rate);
+        else
+            GP_WARN("Invalid update rate '%f' in game config; using %f.", rate, _updateRate);
+    }
+    if (time->exists("maxUpdatesPerFrame"))
+        setMaxUpdatesPerFrame((unsigned int)max(time->getInt("maxUpdatesPerFrame"), 1));
+    if (time->exists("maxFrameTime"))
+        _maxFrameTime = max(time->getFloat("maxFrameTime"), 0.0f);
+
+    static const char* rateNames[SUBSYSTEM_COUNT] = { "animationRate", "physicsRate", "aiRate", "scriptRate" };
+    for (unsigned int i = 0; i < SUBSYSTEM_COUNT; ++i)
+    {
+        if (time->exists(rateNames[i]))
+            setSubsystemUpdateRate((Subsystem)i, time->getFloat(rateNames[i]));
+    }
+}
+
 void Game::renderOnce(const char* function)
 {
     _scriptController->executeFunction<void>(function, NULL);
@@ -722,6 +829,16 @@ void Game::loadConfig()
             {
                 FileSystem::loadResourceAliases(aliases);
             }
+
+            // Mount pack files, in order, so later packs override earlier ones.
+            Properties* packs = _properties->getNamespace("packs", true);
+            if (packs)
+            {
+                while (packs->getNextProperty() != NULL)
+                {
+                    FileSystem::mountPack(packs->getString());
+                }
+            }
         }
         else
         {
@@ -10,6 +10,8 @@
 #include "AnimationController.h"
 #include "PhysicsController.h"
 #include "AIController.h"
+#include "ThreadPool.h"
+#include "AsyncLoader.h"
 #include "AudioListener.h"
 #include "Rectangle.h"
 #include "Vector4.h"
@@ -56,6 +58,19 @@ public:
         CLEAR_COLOR_DEPTH_STENCIL = CLEAR_COLOR | CLEAR_DEPTH | CLEAR_STENCIL
     };
 
+    /**
+     * The engine subsystems that the simulation loop can update at their own rate.
+     */
+    enum Subsystem
+    {
+        SUBSYSTEM_ANIMATION,
+        SUBSYSTEM_PHYSICS,
+        SUBSYSTEM_AI,
+        SUBSYSTEM_SCRIPT,
+        SUBSYSTEM_COUNT
+    };
+
+
     /**
      * Destructor.
      */
@@ -177,6 +192,118 @@ public:
      */
     inline unsigned int getFrameRate() const;
 
+    /**
+     * Sets the number of simulation updates per second.
+     *
+     * When the game uses a fixed timestep, frame() calls update() and updates the
+     * engine subsystems in steps of exactly 1000 / rate milliseconds, running as many
+     * steps as needed to catch up with the elapsed frame time. The default rate is 30,
+     * and can be changed in the 'time' namespace of the game config file:
+     *
+     * @code
+     * time
+     * {
+     *     fixedTimestep = true
+     *     updateRate = 30
+     *     maxUpdatesPerFrame = 3
+     *     maxFrameTime = 250
+     *     animationRate = 0
+     *     physicsRate = 60
+     *     aiRate = 0
+     *     scriptRate = 0
+     * }
+     * @endcode
+     *
+     * @param rate The number of updates per second (must be greater than zero).
+     */
+    void setUpdateRate(float rate);
+
+    /**
+     * Gets the number of simulation updates per second.
+     *
+     * @return The number of updates per second.
+     */
+    inline float getUpdateRate() const;
+
+    /**
+     * Sets whether the simulation is updated with a fixed timestep.
+     *
+     * When disabled, update() and the engine subsystems are called once per frame
+     * with the elapsed frame time.
+     *
+     * @param fixed true to use a fixed timestep, false to use the frame time.
+     */
+    void setFixedTimestep(bool fixed);
+
+    /**
+     * Determines if the simulation is updated with a fixed timestep.
+     *
+     * @return true if a fixed timestep is used, false otherwise.
+     */
+    inline bool isFixedTimestep() const;
+
+    /**
+     * Sets the maximum number of simulation updates run in a single frame.
+     *
+     * When a frame takes too long for the simulation to catch up within this many
+     * updates, the remaining whole updates are dropped rather than carried over to
+     * the next frame, so a slow frame cannot make every following frame slower.
+     * Dropped updates are counted by getDroppedUpdateCount().
+     *
+     * @param count The maximum number of updates per frame (at least one).
+     */
+    void setMaxUpdatesPerFrame(unsigned int count);
+
+    /**
+     * Gets the maximum number of simulation updates run in a single frame.
+     *
+     * @return The maximum number of updates per frame.
+     */
+    inline unsigned int getMaxUpdatesPerFrame() const;
+
+    /**
+     * Sets the update rate of an engine subsystem.
+     *
+     * A subsystem with a rate of zero is updated with every simulation update. Otherwise
+     * it is updated in steps of exactly 1000 / rate milliseconds, which may be more or
+     * less often than the simulation update (for example, physics at 60 updates per second
+     * with a simulation rate of 30).
+     *
+     * @param subsystem The subsystem.
+     * @param rate The number of updates per second, or zero to update with the simulation.
+     */
+    void setSubsystemUpdateRate(Subsystem subsystem, float rate);
+
+    /**
+     * Gets the update rate of an engine subsystem.
+     *
+     * @param subsystem The subsystem.
+     *
+     * @return The number of updates per second, or zero if the subsystem is updated with the simulation.
+     */
+    inline float getSubsystemUpdateRate(Subsystem subsystem) const;
+
+    /**
+     * Gets how far the current frame is between the last simulation update and the next one.
+     *
+     * Render code can use this value to interpolate between the previous and the current
+     * simulated state, so that rendering at a higher rate than the simulation stays smooth.
+     * A value of 0 means the frame is exactly at the last update and 1 means a full update
+     * step later. Without a fixed timestep the value is always 1.
+     *
+     * @return The interpolation factor, between 0 and 1.
+     */
+    inline float getInterpolationAlpha() const;
+
+    /**
+     * Gets the number of simulation updates dropped since the game started because
+     * frames took longer than getMaxUpdatesPerFrame() updates.
+     *
+     * @return The number of dropped updates.
+     */
+    inline unsigned int getDroppedUpdateCount() const;
+
+
 	inline void setFullScreen(bool flag) { _fullscreen = flag; }
 	inline bool isFullScreen() const { return _fullscreen; }
 
@@ -280,6 +407,35 @@ public:
      */
     inline ScriptController* getScriptController() const;
 
+    /**
+     * Gets the thread pool used by the engine to run parallel jobs
+     * (such as computing skinning matrix palettes).
+     *
+     * @return The thread pool for this game.
+     * @script{ignore}
+     */
+    inline ThreadPool* getThreadPool() const;
+
+    /**
+     * Replaces the thread pool with one that has the specified number of worker threads.
+     *
+     * This must be called from the main thread while no jobs are running, such as from update().
+     *
+     * @param workerCount The number of worker threads, not counting the thread that waits for the jobs.
+     * @script{ignore}
+     */
+    void setWorkerThreadCount(unsigned int workerCount);
+
+    /**
+     * Gets the loader used to load scenes, bundles, textures and properties
+     * in the background.
+     *
+     * @return The asynchronous loader for this game.
+     * @script{ignore}
+     */
+    inline AsyncLoader* getAsyncLoader() const;
+
+
     /**
      * Gets the audio listener for 3D audio.
      * 
@@ -759,6 +915,30 @@ private:
      */
     void fireTimeEvents(double frameTime);
 
+    /**
+     * Runs one simulation update: updates the engine subsystems that are due and calls update().
+     *
+     * @param elapsedTime The simulated time of the update (in milliseconds).
+     */
+    void updateSimulation(float elapsedTime);
+
+    /**
+     * Advances the clock of a subsystem and returns the number of steps it should be updated by.
+     *
+     * @param subsystem The subsystem.
+     * @param elapsedTime The simulated time that has passed (in milliseconds).
+     * @param step Receives the length of each step (in milliseconds).
+     *
+     * @return The number of steps to update the subsystem by.
+     */
+    unsigned int getSubsystemSteps(Subsystem subsystem, float elapsedTime, float* step);
+
+    /**
+     * Loads the simulation rates from the configuration file.
+     */
+    void loadTimeConfig();
+
+
     /**
      * Loads the game configuration.
      */
@@ -779,6 +959,16 @@ private:
     double _frameLastFPS;                       // The last time the frame count was updated.
     unsigned int _frameCount;                   // The current frame count.
     unsigned int _frameRate;                    // The current frame rate.
+    double _lastFrameTime;                      // The game time of the previous frame.
+    bool _fixedTimestep;                        // If the simulation is updated with a fixed timestep.
+    float _updateRate;                          // The number of simulation updates per second.
+    unsigned int _maxUpdatesPerFrame;           // The maximum number of simulation updates in a frame.
+    float _maxFrameTime;                        // The longest frame time fed to the simulation.
+    double _accumulatedTime;                    // Frame time not yet consumed by simulation updates.
+    float _interpolationAlpha;                  // Fraction of an update step since the last update.
+    unsigned int _droppedUpdateCount;           // Number of simulation updates dropped so far.
+    float _subsystemRates[SUBSYSTEM_COUNT];     // Update rate of each subsystem, or zero to follow the simulation.
+    double _subsystemTime[SUBSYSTEM_COUNT];     // Time accumulated by each subsystem since its last step.
     unsigned int _width;                        // The game's display width.
     unsigned int _height;                       // The game's display height.
     Rectangle _viewport;                        // the games's current viewport.
@@ -790,6 +980,8 @@ private:
     AudioController* _audioController;          // Controls audio sources that are playing in the game.
     PhysicsController* _physicsController;      // Controls the simulation of a physics scene and entities.
     AIController* _aiController;                // Controls AI simulation.
+    ThreadPool* _threadPool;                    // Worker threads for parallel engine jobs.
+    AsyncLoader* _asyncLoader;                  // Loading thread for background loads.
     AudioListener* _audioListener;              // The audio listener in 3D space.
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;            // Controls the scripting engine.
@@ -19,6 +19,37 @@ inline unsigned int Game::getFrameRate() const
     return _frameRate;
 }
 
+inline float Game::getUpdateRate() const
+{
+    return _updateRate;
+}
+
+inline bool Game::isFixedTimestep() const
+{
+    return _fixedTimestep;
+}
+
+inline unsigned int Game::getMaxUpdatesPerFrame() const
+{
+    return _maxUpdatesPerFrame;
+}
+
+inline float Game::getSubsystemUpdateRate(Subsystem subsystem) const
+{
+    GP_ASSERT(subsystem < SUBSYSTEM_COUNT);
+    return _subsystemRates[subsystem];
+}
+
+inline float Game::getInterpolationAlpha() const
+{
+    return _interpolationAlpha;
+}
+
+inline unsigned int Game::getDroppedUpdateCount() const
+{
+    return _droppedUpdateCount;
+}
+
 inline unsigned int Game::getWidth() const
 {
     return _width;
@@ -63,6 +94,16 @@ inline AIController* Game::getAIController() const
     return _aiController;
 }
 
+inline ThreadPool* Game::getThreadPool() const
+{
+    return _threadPool;
+}
+
+inline AsyncLoader* Game::getAsyncLoader() const
+{
+    return _asyncLoader;
+}
+
 template <class T>
 void Game::renderOnce(T* instance, void (T::*method)(void*), void* cookie)
 {
@@ -282,6 +282,7 @@ void Gamepad::update(float elapsedTime)
 
 void Gamepad::updateInternal(float elapsedTime)
 {
+    GP_PROFILE_ZONE("Gamepad::updateInternal");
     unsigned int size = __gamepads.size();
     for (unsigned int i = 0; i < size; ++i)
     {
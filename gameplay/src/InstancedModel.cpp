@@ -0,0 +1,521 @@
+#include "Base.h"
+#include "InstancedModel.h"
+#include "Camera.h"
+#include "MeshBatch.h"
+#include "MeshPart.h"
+#include "Node.h"
+#include "Scene.h"
+
+// Name of the per-instance matrix attribute of the built-in shaders.
+#define INSTANCE_MATRIX_ATTRIBUTE "a_instanceMatrix"
+// Largest number of vertices a mesh batch can address with 16-bit indices.
+#define INSTANCE_BATCH_MAX_VERTICES 65536
+
+namespace gameplay
+{
+
+InstancedModel::InstancedModel(Mesh* mesh, Material* material)
+    : _mesh(mesh), _material(material), _node(NULL), _mode(MODE_SINGLE),
+      _instanceBuffer(0), _instanceBufferCapacity(0), _batch(NULL)
+{
+    _mesh->addRef();
+    _material->addRef();
+}
+
+InstancedModel::~InstancedModel()
+{
+    removeAllInstances();
+    if (_instanceBuffer)
+    {
+        glDeleteBuffers(1, &_instanceBuffer);
+        _instanceBuffer = 0;
+    }
+    SAFE_DELETE(_batch);
+    SAFE_RELEASE(_node);
+    SAFE_RELEASE(_material);
+    SAFE_RELEASE(_mesh);
+}
+
+InstancedModel* InstancedModel::create(Mesh* mesh, Material* material)
+{
+    GP_ASSERT(mesh);
+    GP_ASSERT(material);
+
+    InstancedModel* model = new InstancedModel(mesh, material);
+
+    if (isInstancingSupported())
+    {
+        model->_mode = MODE_INSTANCED;
+    }
+    else if (model->createBatch())
+    {
+        // The mesh batch hooks up its own vertex attribute bindings.
+        model->_mode = MODE_BATCHED;
+        return model;
+    }
+    else
+    {
+        model->_mode = MODE_SINGLE;
+    }
+
+    // Hookup vertex attribute bindings for all passes of the material.
+    for (unsigned int i = 0, tCount = material->getTechniqueCount(); i < tCount; ++i)
+    {
+        Technique* t = material->getTechniqueByIndex(i);
+        GP_ASSERT(t);
+        for (unsigned int j = 0, pCount = t->getPassCount(); j < pCount; ++j)
+        {
+            Pass* p = t->getPassByIndex(j);
+            GP_ASSERT(p);
+            VertexAttributeBinding* b = VertexAttributeBinding::create(mesh, p->getEffect());
+            p->setVertexAttributeBinding(b);
+            SAFE_RELEASE(b);
+        }
+    }
+
+    return model;
+}
+
+bool InstancedModel::isInstancingSupported()
+{
+#ifdef USE_INSTANCING
+#ifdef GLEW_STATIC
+    static bool supported = GLEW_VERSION_3_3 || (GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced);
+#else
+    static bool supported = strstr((const char*)glGetString(GL_EXTENSIONS), "_instanced_arrays") != NULL;
+#endif
+    return supported;
+#else
+    return false;
+#endif
+}
+
+Mesh* InstancedModel::getMesh() const
+{
+    return _mesh;
+}
+
+Material* InstancedModel::getMaterial() const
+{
+    return _material;
+}
+
+void InstancedModel::setNode(Node* node)
+{
+    if (_node != node)
+    {
+        SAFE_RELEASE(_node);
+        _node = node;
+        if (_node)
+        {
+            _node->addRef();
+            setMaterialNodeBinding(_node);
+        }
+    }
+}
+
+Node* InstancedModel::getNode() const
+{
+    return _node;
+}
+
+void InstancedModel::addInstance(Node* node)
+{
+    GP_ASSERT(node);
+
+    node->addRef();
+    _instances.push_back(node);
+}
+
+void InstancedModel::removeInstance(Node* node)
+{
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        if (_instances[i] == node)
+        {
+            _instances.erase(_instances.begin() + i);
+            SAFE_RELEASE(node);
+            return;
+        }
+    }
+}
+
+void InstancedModel::removeAllInstances()
+{
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_instances[i]);
+    }
+    _instances.clear();
+}
+
+unsigned int InstancedModel::getInstanceCount() const
+{
+    return (unsigned int)_instances.size();
+}
+
+Node* InstancedModel::getInstance(unsigned int index) const
+{
+    GP_ASSERT(index < _instances.size());
+
+    return _instances[index];
+}
+
+bool InstancedModel::createBatch()
+{
+    const VertexFormat& vertexFormat = _mesh->getVertexFormat();
+    unsigned int vertexCount = _mesh->getVertexCount();
+    unsigned int vertexFloats = vertexFormat.getVertexSize() / sizeof(float);
+    if (vertexCount == 0 || vertexCount > INSTANCE_BATCH_MAX_VERTICES || _mesh->getVertexBufferData().size() < vertexCount * vertexFloats)
+        return false;
+
+    // Merge the indices of all parts; strips are joined with degenerate triangles.
+    Mesh::PrimitiveType primitiveType = _mesh->getPrimitiveType();
+    unsigned int partCount = _mesh->getPartCount();
+    if (partCount == 0)
+    {
+        _batchIndices.resize(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; ++i)
+        {
+            _batchIndices[i] = (unsigned short)i;
+        }
+    }
+    else
+    {
+        primitiveType = _mesh->getPart(0)->getPrimitiveType();
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            MeshPart* part = _mesh->getPart(i);
+            GP_ASSERT(part);
+            const std::vector<int>& indices = part->getIndexBufferData();
+            unsigned int indexCount = part->getIndexCount();
+            if (part->getPrimitiveType() != primitiveType || indexCount == 0 || indices.size() < indexCount)
+            {
+                _batchIndices.clear();
+                return false;
+            }
+            if (primitiveType == Mesh::TRIANGLE_STRIP && !_batchIndices.empty())
+            {
+                _batchIndices.push_back(_batchIndices.back());
+                _batchIndices.push_back((unsigned short)indices[0]);
+            }
+            for (unsigned int j = 0; j < indexCount; ++j)
+            {
+                _batchIndices.push_back((unsigned short)indices[j]);
+            }
+        }
+    }
+
+    // Line strips of separate instances cannot be joined.
+    if (primitiveType == Mesh::LINE_STRIP)
+    {
+        _batchIndices.clear();
+        return false;
+    }
+
+    // The batch capacity is expressed in primitives.
+    unsigned int capacity = (unsigned int)_batchIndices.size();
+    if (primitiveType == Mesh::TRIANGLES)
+        capacity /= 3;
+    else if (primitiveType == Mesh::LINES)
+        capacity /= 2;
+
+    _batchVertices.resize(vertexCount * vertexFloats);
+    _batch = MeshBatch::create(vertexFormat, primitiveType, _material, true, max(capacity, 1u), max(capacity, 1u));
+    return _batch != NULL;
+}
+
+void InstancedModel::setMaterialNodeBinding(Node* node)
+{
+    _material->setNodeBinding(node);
+
+    for (unsigned int i = 0, tCount = _material->getTechniqueCount(); i < tCount; ++i)
+    {
+        Technique* technique = _material->getTechniqueByIndex(i);
+        GP_ASSERT(technique);
+        technique->setNodeBinding(node);
+
+        for (unsigned int j = 0, pCount = technique->getPassCount(); j < pCount; ++j)
+        {
+            Pass* pass = technique->getPassByIndex(j);
+            GP_ASSERT(pass);
+            pass->setNodeBinding(node);
+        }
+    }
+}
+
+void InstancedModel::updateInstanceMatrices()
+{
+    GP_ASSERT(_node);
+
+    _matrices.clear();
+    _visibleInstances.clear();
+
+    Scene* scene = _node->getScene();
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+
+    // Express the instances relative to the node the material is bound to, so that
+    // the node's world matrix applied by the auto-bindings yields their world matrix.
+    Matrix inverseWorld;
+    if (!_node->getWorldMatrix().invert(&inverseWorld))
+        inverseWorld.setIdentity();
+
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        const Matrix& world = _instances[i]->getWorldMatrix();
+        if (camera)
+        {
+            BoundingSphere sphere(_mesh->getBoundingSphere());
+            sphere.transform(world);
+            if (!camera->getFrustum().intersects(sphere))
+                continue;
+        }
+
+        _visibleInstances.push_back(_instances[i]);
+        _matrices.push_back(Matrix());
+        Matrix::multiply(inverseWorld, world, &_matrices.back());
+    }
+}
+
+void InstancedModel::setIdentityInstanceMatrix(Pass* pass)
+{
+    GP_ASSERT(pass);
+    GP_ASSERT(pass->getEffect());
+
+    // Effects built with INSTANCING read the instance matrix from an attribute; when it
+    // is not backed by an array it must be set to identity (it defaults to (0, 0, 0, 1)).
+    VertexAttribute attribute = pass->getEffect()->getVertexAttribute(INSTANCE_MATRIX_ATTRIBUTE);
+    if (attribute == -1)
+        return;
+
+    for (int column = 0; column < 4; ++column)
+    {
+        GL_ASSERT( glVertexAttrib4f(attribute + column, column == 0 ? 1.0f : 0.0f, column == 1 ? 1.0f : 0.0f, column == 2 ? 1.0f : 0.0f, column == 3 ? 1.0f : 0.0f) );
+    }
+}
+
+unsigned int InstancedModel::draw()
+{
+    GP_PROFILE_ZONE("InstancedModel::draw");
+
+    if (_node == NULL)
+        return 0;
+
+    updateInstanceMatrices();
+    if (_matrices.empty())
+        return 0;
+
+    switch (_mode)
+    {
+    case MODE_INSTANCED:
+        drawInstanced();
+        break;
+    case MODE_BATCHED:
+        drawBatched();
+        break;
+    default:
+        drawSingle();
+        break;
+    }
+
+    return (unsigned int)_matrices.size();
+}
+
+void InstancedModel::drawInstanced()
+{
+#ifdef USE_INSTANCING
+    unsigned int instanceCount = (unsigned int)_matrices.size();
+
+    // Upload the instance matrices, growing the buffer when needed.
+    if (_instanceBuffer == 0)
+    {
+        GL_ASSERT( glGenBuffers(1, &_instanceBuffer) );
+    }
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+    if (instanceCount > _instanceBufferCapacity)
+    {
+        _instanceBufferCapacity = max(instanceCount, _instanceBufferCapacity * 2);
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _instanceBufferCapacity * sizeof(Matrix), NULL, GL_DYNAMIC_DRAW) );
+    }
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(Matrix), &_matrices[0]) );
+
+    Technique* technique = _material->getTechnique();
+    GP_ASSERT(technique);
+    unsigned int partCount = _mesh->getPartCount();
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        pass->bind();
+
+        // Feed one column of the instance matrix per attribute location, advancing once per instance.
+        VertexAttribute attribute = pass->getEffect()->getVertexAttribute(INSTANCE_MATRIX_ATTRIBUTE);
+        if (attribute != -1)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+            for (int column = 0; column < 4; ++column)
+            {
+                GL_ASSERT( glVertexAttribPointer(attribute + column, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix), (const GLvoid*)(column * 4 * sizeof(float))) );
+                GL_ASSERT( glEnableVertexAttribArray(attribute + column) );
+                GL_ASSERT( glVertexAttribDivisor(attribute + column, 1) );
+            }
+        }
+        else
+        {
+            GP_WARN("Effect of instanced model does not define '%s'; was it built with INSTANCING?", INSTANCE_MATRIX_ATTRIBUTE);
+        }
+
+        if (partCount == 0)
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+            GL_ASSERT( glDrawArraysInstanced(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount(), instanceCount) );
+        }
+        else
+        {
+            for (unsigned int j = 0; j < partCount; ++j)
+            {
+                MeshPart* part = _mesh->getPart(j);
+                GP_ASSERT(part);
+                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer()) );
+                GL_ASSERT( glDrawElementsInstanced(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0, instanceCount) );
+            }
+        }
+
+        // Vertex array objects are shared with models drawing the same mesh and effect,
+        // so restore the instance attributes before unbinding.
+        if (attribute != -1)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                GL_ASSERT( glVertexAttribDivisor(attribute + column, 0) );
+                GL_ASSERT( glDisableVertexAttribArray(attribute + column) );
+            }
+        }
+        pass->unbind();
+    }
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+#endif
+}
+
+void InstancedModel::drawBatched()
+{
+    GP_ASSERT(_batch);
+
+    const VertexFormat& vertexFormat = _mesh->getVertexFormat();
+    unsigned int vertexCount = _mesh->getVertexCount();
+    unsigned int vertexFloats = vertexFormat.getVertexSize() / sizeof(float);
+    const float* source = &_mesh->getVertexBufferData()[0];
+
+    // Find the elements that must be transformed with each instance.
+    int positionOffset = -1;
+    int vectorOffsets[3];
+    unsigned int vectorCount = 0;
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = vertexFormat.getElement(i);
+        if (element.size >= 3)
+        {
+            if (element.usage == VertexFormat::POSITION)
+                positionOffset = (int)offset;
+            else if (element.usage == VertexFormat::NORMAL || element.usage == VertexFormat::TANGENT || element.usage == VertexFormat::BINORMAL)
+                vectorOffsets[vectorCount++] = (int)offset;
+        }
+        offset += element.size;
+    }
+
+    unsigned int batchVertexCount = 0;
+    _batch->start();
+    for (size_t i = 0, count = _matrices.size(); i < count; ++i)
+    {
+        // Flush the batch before its indices overflow.
+        if (batchVertexCount + vertexCount > INSTANCE_BATCH_MAX_VERTICES)
+        {
+            _batch->finish();
+            _batch->draw();
+            _batch->start();
+            batchVertexCount = 0;
+        }
+
+        const Matrix& matrix = _matrices[i];
+        memcpy(&_batchVertices[0], source, vertexCount * vertexFloats * sizeof(float));
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            float* vertex = &_batchVertices[v * vertexFloats];
+            if (positionOffset >= 0)
+            {
+                Vector3 position(vertex + positionOffset);
+                matrix.transformPoint(&position);
+                vertex[positionOffset] = position.x;
+                vertex[positionOffset + 1] = position.y;
+                vertex[positionOffset + 2] = position.z;
+            }
+            for (unsigned int k = 0; k < vectorCount; ++k)
+            {
+                Vector3 vector(vertex + vectorOffsets[k]);
+                matrix.transformVector(&vector);
+                vector.normalize();
+                vertex[vectorOffsets[k]] = vector.x;
+                vertex[vectorOffsets[k] + 1] = vector.y;
+                vertex[vectorOffsets[k] + 2] = vector.z;
+            }
+        }
+        _batch->add(&_batchVertices[0], vertexCount, &_batchIndices[0], (unsigned int)_batchIndices.size());
+        batchVertexCount += vertexCount;
+    }
+    _batch->finish();
+
+    // The vertices are already transformed, so any instance matrix attribute must be identity.
+    Technique* technique = _material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        setIdentityInstanceMatrix(technique->getPassByIndex(i));
+    }
+    _batch->draw();
+}
+
+void InstancedModel::drawSingle()
+{
+    Technique* technique = _material->getTechnique();
+    GP_ASSERT(technique);
+    unsigned int partCount = _mesh->getPartCount();
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        setIdentityInstanceMatrix(pass);
+    }
+
+    // Bind the material to each instance node in turn; auto-bindings then resolve
+    // to the instance's own world matrix.
+    for (size_t n = 0, count = _visibleInstances.size(); n < count; ++n)
+    {
+        setMaterialNodeBinding(_visibleInstances[n]);
+        for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+        {
+            Pass* pass = technique->getPassByIndex(i);
+            GP_ASSERT(pass);
+            pass->bind();
+            if (partCount == 0)
+            {
+                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+                GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+            }
+            else
+            {
+                for (unsigned int j = 0; j < partCount; ++j)
+                {
+                    MeshPart* part = _mesh->getPart(j);
+                    GP_ASSERT(part);
+                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer()) );
+                    GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+                }
+            }
+            pass->unbind();
+        }
+    }
+    setMaterialNodeBinding(_node);
+}
+
+}
@@ -0,0 +1,215 @@
+#ifndef INSTANCEDMODEL_H_
+#define INSTANCEDMODEL_H_
+
+#include "Mesh.h"
+#include "Material.h"
+
+namespace gameplay
+{
+
+class MeshBatch;
+class Node;
+
+/**
+ * Defines a mesh that is drawn many times with the same material, once per instance node.
+ *
+ * The world matrices of all instances are gathered and the mesh is drawn in as few
+ * draw calls as the hardware allows:
+ *
+ * - When hardware instancing is supported, the matrices are uploaded to a per-instance
+ *   vertex buffer and each mesh part is drawn once with an instanced draw call. The
+ *   effect of the material must be built with the INSTANCING define, which makes the
+ *   built-in shaders read the per-instance "a_instanceMatrix" attribute.
+ * - Otherwise, if the mesh keeps its vertex and index data on the CPU (see
+ *   Mesh::setVertexData() and MeshPart::setIndexData()), the instances are transformed
+ *   and merged into a MeshBatch.
+ * - Otherwise, the mesh is drawn once per instance.
+ *
+ * The material is bound to the node set with setNode() and the instance matrices are
+ * expressed relative to that node, so the WORLD_MATRIX (and derived) auto-bindings of
+ * the material place every instance correctly in all three paths.
+ *
+ * Instance nodes are referenced by the model and may be moved freely between draws.
+ * Instances whose bounds lie outside the view frustum of the active camera of the
+ * scene are not drawn.
+ *
+ * @script{ignore}
+ */
+class InstancedModel : public Ref
+{
+public:
+
+    /**
+     * Creates a new instanced model.
+     *
+     * @param mesh The mesh to draw for each instance.
+     * @param material The material to draw the mesh with.
+     *
+     * @return The new instanced model.
+     */
+    static InstancedModel* create(Mesh* mesh, Material* material);
+
+    /**
+     * Returns whether hardware instancing is supported on this device.
+     *
+     * @return true if instanced draw calls can be used, false otherwise.
+     */
+    static bool isInstancingSupported();
+
+    /**
+     * Returns the mesh of this instanced model.
+     *
+     * @return The mesh.
+     */
+    Mesh* getMesh() const;
+
+    /**
+     * Returns the material of this instanced model.
+     *
+     * @return The material.
+     */
+    Material* getMaterial() const;
+
+    /**
+     * Sets the node the material of this instanced model is bound to.
+     *
+     * This is typically the root node of the instances, but may be any node in the
+     * same scene. The instanced model is not drawn until a node is set.
+     *
+     * @param node The node to bind the material to.
+     */
+    void setNode(Node* node);
+
+    /**
+     * Returns the node the material of this instanced model is bound to.
+     *
+     * @return The node, or NULL if no node is set.
+     */
+    Node* getNode() const;
+
+    /**
+     * Adds an instance of the mesh, placed at the world transform of the given node.
+     *
+     * @param node The node of the instance.
+     */
+    void addInstance(Node* node);
+
+    /**
+     * Removes an instance from this instanced model.
+     *
+     * @param node The node of the instance to remove.
+     */
+    void removeInstance(Node* node);
+
+    /**
+     * Removes all instances from this instanced model.
+     */
+    void removeAllInstances();
+
+    /**
+     * Returns the number of instances of this instanced model.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Returns the instance node at the specified index.
+     *
+     * @param index The index of the instance.
+     *
+     * @return The node of the instance.
+     */
+    Node* getInstance(unsigned int index) const;
+
+    /**
+     * Draws the visible instances of this instanced model.
+     *
+     * @return The number of instances drawn.
+     */
+    unsigned int draw();
+
+private:
+
+    /**
+     * The way instances are drawn.
+     */
+    enum Mode
+    {
+        MODE_INSTANCED,
+        MODE_BATCHED,
+        MODE_SINGLE
+    };
+
+    /**
+     * Constructor.
+     */
+    InstancedModel(Mesh* mesh, Material* material);
+
+    /**
+     * Hidden copy constructor.
+     */
+    InstancedModel(const InstancedModel& copy);
+
+    /**
+     * Destructor.
+     */
+    ~InstancedModel();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    InstancedModel& operator=(const InstancedModel&);
+
+    /**
+     * Creates the mesh batch and its merged indices if the mesh keeps its data on the CPU.
+     */
+    bool createBatch();
+
+    /**
+     * Binds the material, its techniques and passes to the given node.
+     */
+    void setMaterialNodeBinding(Node* node);
+
+    /**
+     * Gathers the visible instances and their matrices relative to the model node.
+     */
+    void updateInstanceMatrices();
+
+    /**
+     * Sets the instance matrix attribute of the current effect to a constant identity matrix.
+     */
+    void setIdentityInstanceMatrix(Pass* pass);
+
+    /**
+     * Draws the visible instances with one instanced draw call per mesh part and pass.
+     */
+    void drawInstanced();
+
+    /**
+     * Draws the visible instances merged into the mesh batch.
+     */
+    void drawBatched();
+
+    /**
+     * Draws the visible instances one at a time.
+     */
+    void drawSingle();
+
+    Mesh* _mesh;                                // The mesh drawn for each instance.
+    Material* _material;                        // The material the mesh is drawn with.
+    Node* _node;                                // The node the material is bound to (referenced).
+    Mode _mode;                                 // The way instances are drawn.
+    std::vector<Node*> _instances;              // The instance nodes.
+    std::vector<Node*> _visibleInstances;       // The instance nodes inside the view frustum.
+    std::vector<Matrix> _matrices;              // Matrices of the visible instances, relative to _node.
+    VertexBufferHandle _instanceBuffer;         // Per-instance vertex buffer (MODE_INSTANCED).
+    unsigned int _instanceBufferCapacity;       // Number of matrices the instance buffer holds.
+    MeshBatch* _batch;                          // The merged instances (MODE_BATCHED).
+    std::vector<float> _batchVertices;          // Scratch space for the transformed vertices of an instance.
+    std::vector<unsigned short> _batchIndices;  // The indices of all mesh parts.
+};
+
+}
+
+#endif
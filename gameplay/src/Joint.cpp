@@ -59,6 +59,15 @@ void Joint::transformChanged()
 {
     Node::transformChanged();
     _jointMatrixDirty = true;
+    setSkinsDirty();
+}
+
+void Joint::setSkinsDirty()
+{
+    for (SkinReference* ref = &_skin; ref && ref->skin; ref = ref->next)
+    {
+        ref->skin->_matrixPaletteDirty = true;
+    }
 }
 
 void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
@@ -71,7 +80,9 @@ void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
     {
         _jointMatrixDirty = false;
 
-        static Matrix t;
+        // Note: this must not use shared/static storage since matrix palettes
+        // may be computed concurrently on worker threads (see Scene::updateMatrixPalettes).
+        Matrix t;
         Matrix::multiply(Node::getWorldMatrix(), getInverseBindPose(), &t);
         Matrix::multiply(t, bindShape, &t);
 
@@ -91,6 +102,7 @@ void Joint::setInverseBindPose(const Matrix& m)
 {
     _bindPose = m;
     _jointMatrixDirty = true;
+    setSkinsDirty();
 }
 
 void Joint::addSkin(MeshSkin* skin)
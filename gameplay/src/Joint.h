@@ -116,6 +116,11 @@ private:
 
     void removeSkin(MeshSkin* skin);
 
+    /**
+     * Marks the matrix palettes of all skins referencing this joint as dirty.
+     */
+    void setSkinsDirty();
+
     /** 
      * The Matrix representation of the Joint's bind pose.
      */
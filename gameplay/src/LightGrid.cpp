@@ -0,0 +1,458 @@
+#include "Base.h"
+#include "LightGrid.h"
+#include "Game.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Node.h"
+#include "RenderState.h"
+#include "Scene.h"
+
+// Width of the light index texture, in texels of four indices.
+#define LIGHTGRID_INDEX_TEXTURE_WIDTH   256
+// Width of the light data texture: position, color and direction texels.
+#define LIGHTGRID_LIGHT_TEXTURE_WIDTH   3
+
+// Internal format of the floating point textures.
+#ifdef OPENGL_ES
+#define LIGHTGRID_TEXTURE_FORMAT        GL_RGBA
+#else
+#define LIGHTGRID_TEXTURE_FORMAT        GL_RGBA32F_ARB
+#endif
+
+namespace gameplay
+{
+
+class LightGrid::BinJob : public ThreadPool::Job
+{
+public:
+
+    BinJob() : grid(NULL), sliceBegin(0), sliceEnd(0) { }
+
+    void execute()
+    {
+        grid->binSlices(sliceBegin, sliceEnd);
+    }
+
+    LightGrid* grid;
+    unsigned int sliceBegin;
+    unsigned int sliceEnd;
+};
+
+// Returns the point at a view space depth on the line through two unprojected points.
+static Vector3 getPointAtDepth(const Vector3& nearPoint, const Vector3& farPoint, float depth)
+{
+    float t = (depth + nearPoint.z) / (nearPoint.z - farPoint.z);
+    return nearPoint + (farPoint - nearPoint) * t;
+}
+
+// Transforms a point in normalized device coordinates back to view space.
+static Vector3 unproject(const Matrix& inverseProjection, float x, float y, float z)
+{
+    Vector4 point;
+    inverseProjection.transformVector(Vector4(x, y, z, 1.0f), &point);
+    return Vector3(point.x / point.w, point.y / point.w, point.z / point.w);
+}
+
+static unsigned int clampIndex(float value, unsigned int count)
+{
+    if (value <= 0.0f)
+        return 0;
+    if (value >= (float)(count - 1))
+        return count - 1;
+    return (unsigned int)value;
+}
+
+LightGrid::LightGrid(unsigned int tilesX, unsigned int tilesY, unsigned int sliceCount, unsigned int maxLights)
+    : _tilesX(tilesX), _tilesY(tilesY), _sliceCount(sliceCount), _maxLights(maxLights), _nearPlane(0.0f), _sliceScale(0.0f),
+    _indexCount(0), _indexTextureHeight(0), _gridSampler(NULL), _indexSampler(NULL), _lightSampler(NULL)
+{
+}
+
+LightGrid::~LightGrid()
+{
+    SAFE_RELEASE(_gridSampler);
+    SAFE_RELEASE(_indexSampler);
+    SAFE_RELEASE(_lightSampler);
+}
+
+LightGrid* LightGrid::create(unsigned int tilesX, unsigned int tilesY, unsigned int sliceCount, unsigned int maxLights)
+{
+    GP_ASSERT(tilesX > 0 && tilesY > 0 && sliceCount > 0 && maxLights > 0 && maxLights <= 65536);
+
+    if (!isSupported())
+    {
+        GP_WARN("Clustered lighting requires floating point texture support.");
+        return NULL;
+    }
+
+    // Every cluster may list up to MAX_LIGHTS_PER_CLUSTER lights, so size the index
+    // texture for the worst case and never reallocate it.
+    unsigned int clusterCount = tilesX * tilesY * sliceCount;
+    unsigned int indexTexels = (clusterCount * MAX_LIGHTS_PER_CLUSTER + 3) / 4;
+    unsigned int indexTextureHeight = (indexTexels + LIGHTGRID_INDEX_TEXTURE_WIDTH - 1) / LIGHTGRID_INDEX_TEXTURE_WIDTH;
+
+    // The lights are rows of the light texture, and the slices are stacked down the grid texture.
+    GLint maxTextureSize;
+    GL_ASSERT( glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize) );
+    if (tilesX > (unsigned int)maxTextureSize || tilesY * sliceCount > (unsigned int)maxTextureSize || indexTextureHeight > (unsigned int)maxTextureSize)
+    {
+        GP_WARN("Light grid of %u x %u x %u clusters exceeds the maximum texture size (%d).", tilesX, tilesY, sliceCount, maxTextureSize);
+        return NULL;
+    }
+    if (maxLights > (unsigned int)maxTextureSize)
+    {
+        GP_WARN("Clamping the light grid to %d lights, the maximum texture size.", maxTextureSize);
+        maxLights = maxTextureSize;
+    }
+
+    LightGrid* grid = new LightGrid(tilesX, tilesY, sliceCount, maxLights);
+    grid->_indexTextureHeight = indexTextureHeight;
+
+    grid->_clusterBounds.resize(clusterCount);
+    grid->_clusterLights.resize(clusterCount * MAX_LIGHTS_PER_CLUSTER);
+    grid->_clusterCounts.resize(clusterCount, 0);
+    grid->_gridData.resize(clusterCount * 4, 0.0f);
+    grid->_indexData.resize(grid->_indexTextureHeight * LIGHTGRID_INDEX_TEXTURE_WIDTH * 4, 0.0f);
+    grid->_lights.reserve(maxLights);
+    grid->_lightData.reserve(maxLights * LIGHTGRID_LIGHT_TEXTURE_WIDTH * 4);
+    grid->_gridSize.set((float)tilesX, (float)tilesY, (float)sliceCount, 0.0f);
+
+    grid->_gridSampler = createSampler(tilesX, tilesY * sliceCount);
+    grid->_indexSampler = createSampler(LIGHTGRID_INDEX_TEXTURE_WIDTH, grid->_indexTextureHeight);
+    grid->_lightSampler = createSampler(LIGHTGRID_LIGHT_TEXTURE_WIDTH, maxLights);
+
+    return grid;
+}
+
+bool LightGrid::isSupported()
+{
+#ifdef GLEW_STATIC
+    static bool supported = GLEW_VERSION_3_0 || GLEW_ARB_texture_float;
+#else
+    static bool supported = strstr((const char*)glGetString(GL_EXTENSIONS), "_texture_float") != NULL;
+#endif
+    return supported;
+}
+
+Texture::Sampler* LightGrid::createSampler(unsigned int width, unsigned int height)
+{
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
+    GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, LIGHTGRID_TEXTURE_FORMAT, width, height, 0, GL_RGBA, GL_FLOAT, NULL) );
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, 0) );
+
+    Texture* texture = Texture::create(textureId, width, height, Texture::RGBA);
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    SAFE_RELEASE(texture);
+
+    // The textures hold exact values that must be read back without filtering.
+    sampler->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    return sampler;
+}
+
+void LightGrid::update(Scene* scene)
+{
+    GP_ASSERT(scene);
+
+    Camera* camera = scene->getActiveCamera();
+    if (camera)
+    {
+        update(scene, camera, Game::getInstance()->getViewport());
+    }
+}
+
+void LightGrid::update(Scene* scene, Camera* camera, const Rectangle& viewport)
+{
+    GP_PROFILE_ZONE("LightGrid::update");
+    GP_ASSERT(scene);
+    GP_ASSERT(camera);
+
+    updateClusters(camera, viewport);
+    gatherLights(scene, camera);
+
+    ThreadPool* threadPool = Game::getInstance()->getThreadPool();
+    unsigned int jobCount = threadPool ? std::min(threadPool->getThreadCount() + 1, _sliceCount) : 1;
+    if (jobCount > 1 && !_lights.empty())
+    {
+        // Each job owns a contiguous range of slices, so the jobs write to disjoint clusters.
+        std::vector<BinJob> jobs(jobCount);
+        std::vector<ThreadPool::Job*> jobPointers(jobCount);
+        for (unsigned int i = 0; i < jobCount; ++i)
+        {
+            jobs[i].grid = this;
+            jobs[i].sliceBegin = _sliceCount * i / jobCount;
+            jobs[i].sliceEnd = _sliceCount * (i + 1) / jobCount;
+            jobPointers[i] = &jobs[i];
+        }
+        threadPool->run(&jobPointers[0], jobCount);
+    }
+    else
+    {
+        binSlices(0, _sliceCount);
+    }
+
+    upload();
+}
+
+void LightGrid::updateClusters(Camera* camera, const Rectangle& viewport)
+{
+    const Matrix& projection = camera->getProjectionMatrix();
+    if (_nearPlane > 0.0f && memcmp(projection.m, _projection.m, sizeof(_projection.m)) == 0 &&
+        viewport.x == _viewport.x && viewport.y == _viewport.y && viewport.width == _viewport.width && viewport.height == _viewport.height)
+    {
+        return;
+    }
+
+    _projection = projection;
+    _viewport = viewport;
+
+    // Tiles are a whole number of pixels; the last row and column may extend past the viewport.
+    float tileWidth = ceil(viewport.width / _tilesX);
+    float tileHeight = ceil(viewport.height / _tilesY);
+    _tileParameters.set(viewport.x, viewport.y, 1.0f / tileWidth, 1.0f / tileHeight);
+
+    // Slices are spaced exponentially so that clusters stay roughly cubic with distance.
+    float nearPlane = camera->getNearPlane();
+    float farPlane = camera->getFarPlane();
+    GP_ASSERT(nearPlane > 0.0f && farPlane > nearPlane);
+    _nearPlane = nearPlane;
+    _sliceScale = _sliceCount / log(farPlane / nearPlane);
+    _depthParameters.set(nearPlane, _sliceScale, 0.0f, 0.0f);
+
+    // Find the view space lines through the corners of the tiles.
+    Matrix inverseProjection;
+    projection.invert(&inverseProjection);
+    unsigned int cornersX = _tilesX + 1;
+    unsigned int cornersY = _tilesY + 1;
+    std::vector<Vector3> nearPoints(cornersX * cornersY);
+    std::vector<Vector3> farPoints(cornersX * cornersY);
+    for (unsigned int y = 0; y < cornersY; ++y)
+    {
+        float ndcY = -1.0f + 2.0f * y * tileHeight / viewport.height;
+        for (unsigned int x = 0; x < cornersX; ++x)
+        {
+            float ndcX = -1.0f + 2.0f * x * tileWidth / viewport.width;
+            nearPoints[y * cornersX + x] = unproject(inverseProjection, ndcX, ndcY, -1.0f);
+            farPoints[y * cornersX + x] = unproject(inverseProjection, ndcX, ndcY, 1.0f);
+        }
+    }
+
+    // Bound each cluster by the corners of its tile at the depths of its slice.
+    for (unsigned int slice = 0; slice < _sliceCount; ++slice)
+    {
+        float depths[2];
+        depths[0] = nearPlane * pow(farPlane / nearPlane, (float)slice / _sliceCount);
+        depths[1] = nearPlane * pow(farPlane / nearPlane, (float)(slice + 1) / _sliceCount);
+        for (unsigned int y = 0; y < _tilesY; ++y)
+        {
+            for (unsigned int x = 0; x < _tilesX; ++x)
+            {
+                BoundingBox& bounds = _clusterBounds[(slice * _tilesY + y) * _tilesX + x];
+                for (unsigned int i = 0; i < 8; ++i)
+                {
+                    unsigned int corner = (y + ((i >> 1) & 1)) * cornersX + x + (i & 1);
+                    Vector3 point = getPointAtDepth(nearPoints[corner], farPoints[corner], depths[i >> 2]);
+                    if (i == 0)
+                    {
+                        bounds.set(point, point);
+                    }
+                    else
+                    {
+                        bounds.min.set(std::min(bounds.min.x, point.x), std::min(bounds.min.y, point.y), std::min(bounds.min.z, point.z));
+                        bounds.max.set(std::max(bounds.max.x, point.x), std::max(bounds.max.y, point.y), std::max(bounds.max.z, point.z));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightGrid::gatherLights(Scene* scene, Camera* camera)
+{
+    _lights.clear();
+    _lightData.clear();
+    _visibleNodes.clear();
+    scene->findVisibleNodes(camera->getFrustum(), _visibleNodes);
+
+    const Matrix& view = camera->getViewMatrix();
+    float tilesAcross = _viewport.width * _tileParameters.z;
+    float tilesDown = _viewport.height * _tileParameters.w;
+    for (size_t i = 0, count = _visibleNodes.size(); i < count && _lights.size() < _maxLights; ++i)
+    {
+        Node* node = _visibleNodes[i];
+        Light* light = node->getLight();
+        if (!light || light->getLightType() == Light::DIRECTIONAL)
+            continue;
+
+        // Bound the light itself rather than the node and its children (see Node::getContentBounds()).
+        BoundingSphere sphere;
+        if (!node->getContentBounds(&sphere))
+            continue;
+        view.transformPoint(&sphere.center);
+        float minDepth = std::max(-sphere.center.z - sphere.radius, _nearPlane);
+        float maxDepth = -sphere.center.z + sphere.radius;
+        if (maxDepth < _nearPlane)
+            continue;
+
+        BinnedLight binned;
+        binned.sphere = sphere;
+        binned.sliceMin = clampIndex(floor(log(minDepth / _nearPlane) * _sliceScale), _sliceCount);
+        binned.sliceMax = clampIndex(floor(log(maxDepth / _nearPlane) * _sliceScale), _sliceCount);
+
+        // Project the corners of the sphere's box, clipped to the near plane, to find the tiles it covers.
+        float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+        for (unsigned int j = 0; j < 8; ++j)
+        {
+            Vector4 corner(sphere.center.x + ((j & 1) ? sphere.radius : -sphere.radius),
+                           sphere.center.y + ((j & 2) ? sphere.radius : -sphere.radius),
+                           std::min(sphere.center.z + ((j & 4) ? sphere.radius : -sphere.radius), -_nearPlane), 1.0f);
+            _projection.transformVector(&corner);
+            float x = corner.x / corner.w;
+            float y = corner.y / corner.w;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+        binned.tileMinX = clampIndex(floor((minX * 0.5f + 0.5f) * tilesAcross), _tilesX);
+        binned.tileMinY = clampIndex(floor((minY * 0.5f + 0.5f) * tilesDown), _tilesY);
+        binned.tileMaxX = clampIndex(floor((maxX * 0.5f + 0.5f) * tilesAcross), _tilesX);
+        binned.tileMaxY = clampIndex(floor((maxY * 0.5f + 0.5f) * tilesDown), _tilesY);
+        _lights.push_back(binned);
+
+        // Texel 0: view space position and inverse range.
+        Vector3 position;
+        view.transformPoint(node->getTranslationWorld(), &position);
+        _lightData.push_back(position.x);
+        _lightData.push_back(position.y);
+        _lightData.push_back(position.z);
+        _lightData.push_back(light->getRangeInverse());
+
+        // Texels 1 and 2: color, view space direction and the cone angle cosines. Point
+        // lights use cosines that put every direction inside the inner cone.
+        const Vector3& color = light->getColor();
+        Vector3 direction;
+        view.transformVector(node->getForwardVectorWorld(), &direction);
+        direction.normalize();
+        bool spot = light->getLightType() == Light::SPOT;
+        _lightData.push_back(color.x);
+        _lightData.push_back(color.y);
+        _lightData.push_back(color.z);
+        _lightData.push_back(spot ? light->getOuterAngleCos() : -2.0f);
+        _lightData.push_back(direction.x);
+        _lightData.push_back(direction.y);
+        _lightData.push_back(direction.z);
+        _lightData.push_back(spot ? light->getInnerAngleCos() : -1.0f);
+    }
+}
+
+void LightGrid::binSlices(unsigned int sliceBegin, unsigned int sliceEnd)
+{
+    unsigned int clusterBegin = sliceBegin * _tilesY * _tilesX;
+    unsigned int clusterEnd = sliceEnd * _tilesY * _tilesX;
+    std::fill(_clusterCounts.begin() + clusterBegin, _clusterCounts.begin() + clusterEnd, 0);
+
+    for (unsigned int i = 0, count = (unsigned int)_lights.size(); i < count; ++i)
+    {
+        const BinnedLight& light = _lights[i];
+        unsigned int first = std::max(light.sliceMin, sliceBegin);
+        unsigned int last = std::min(light.sliceMax + 1, sliceEnd);
+        for (unsigned int slice = first; slice < last; ++slice)
+        {
+            for (unsigned int y = light.tileMinY; y <= light.tileMaxY; ++y)
+            {
+                unsigned int cluster = (slice * _tilesY + y) * _tilesX + light.tileMinX;
+                for (unsigned int x = light.tileMinX; x <= light.tileMaxX; ++x, ++cluster)
+                {
+                    unsigned int& lightCount = _clusterCounts[cluster];
+                    if (lightCount < MAX_LIGHTS_PER_CLUSTER && light.sphere.intersects(_clusterBounds[cluster]))
+                    {
+                        _clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER + lightCount++] = (unsigned short)i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightGrid::upload()
+{
+    // Compact the cluster lists into a single index list.
+    _indexCount = 0;
+    for (unsigned int cluster = 0, clusterCount = (unsigned int)_clusterCounts.size(); cluster < clusterCount; ++cluster)
+    {
+        unsigned int lightCount = _clusterCounts[cluster];
+        _gridData[cluster * 4] = (float)_indexCount;
+        _gridData[cluster * 4 + 1] = (float)lightCount;
+
+        const unsigned short* lights = &_clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER];
+        for (unsigned int i = 0; i < lightCount; ++i)
+        {
+            _indexData[_indexCount++] = (float)lights[i];
+        }
+    }
+
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _gridSampler->getTexture()->getHandle()) );
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _tilesX, _tilesY * _sliceCount, GL_RGBA, GL_FLOAT, &_gridData[0]) );
+
+    // Only upload the rows of the index and light textures that are in use.
+    unsigned int indexRows = ((_indexCount + 3) / 4 + LIGHTGRID_INDEX_TEXTURE_WIDTH - 1) / LIGHTGRID_INDEX_TEXTURE_WIDTH;
+    if (indexRows > 0)
+    {
+        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _indexSampler->getTexture()->getHandle()) );
+        GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHTGRID_INDEX_TEXTURE_WIDTH, indexRows, GL_RGBA, GL_FLOAT, &_indexData[0]) );
+    }
+    if (!_lights.empty())
+    {
+        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _lightSampler->getTexture()->getHandle()) );
+        GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHTGRID_LIGHT_TEXTURE_WIDTH, (GLsizei)_lights.size(), GL_RGBA, GL_FLOAT, &_lightData[0]) );
+    }
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, 0) );
+}
+
+void LightGrid::bind(RenderState* renderState)
+{
+    GP_ASSERT(renderState);
+
+    renderState->getParameter("u_clusterGridTexture")->setValue(_gridSampler);
+    renderState->getParameter("u_clusterIndexTexture")->setValue(_indexSampler);
+    renderState->getParameter("u_clusterLightTexture")->setValue(_lightSampler);
+    renderState->getParameter("u_clusterTextureSizes")->setValue(Vector4(1.0f / LIGHTGRID_INDEX_TEXTURE_WIDTH, 1.0f / _indexTextureHeight, 1.0f / _maxLights, 0.0f));
+    renderState->getParameter("u_clusterTileParameters")->bindValue(this, &LightGrid::getTileParameters);
+    renderState->getParameter("u_clusterGridSize")->bindValue(this, &LightGrid::getGridSize);
+    renderState->getParameter("u_clusterDepthParameters")->bindValue(this, &LightGrid::getDepthParameters);
+}
+
+unsigned int LightGrid::getLightCount() const
+{
+    return (unsigned int)_lights.size();
+}
+
+unsigned int LightGrid::getClusterCount() const
+{
+    return _tilesX * _tilesY * _sliceCount;
+}
+
+unsigned int LightGrid::getIndexCount() const
+{
+    return _indexCount;
+}
+
+const Vector4& LightGrid::getTileParameters() const
+{
+    return _tileParameters;
+}
+
+const Vector4& LightGrid::getGridSize() const
+{
+    return _gridSize;
+}
+
+const Vector4& LightGrid::getDepthParameters() const
+{
+    return _depthParameters;
+}
+
+}
@@ -0,0 +1,223 @@
+#ifndef LIGHTGRID_H_
+#define LIGHTGRID_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+class Camera;
+class Node;
+class RenderState;
+class Scene;
+
+/**
+ * Defines a grid of view space clusters that the point and spot lights of a scene are
+ * binned into for forward shading.
+ *
+ * The view frustum of a camera is divided into screen space tiles and into depth slices
+ * that grow exponentially with the distance to the camera. Each frame, update() finds
+ * the point and spot light nodes of the scene that intersect the view frustum and lists,
+ * for every cluster, the lights whose bounds intersect it. The depth slices are binned in
+ * parallel on the game's thread pool.
+ *
+ * The lights and the cluster lists are uploaded to floating point textures. Materials
+ * bound with bind() and built with the CLUSTERED_LIGHTING define then shade each pixel
+ * with the lights of its cluster only, in addition to their ambient and directional
+ * light. This lets a single effect permutation be lit by hundreds of lights.
+ *
+ * At most MAX_LIGHTS_PER_CLUSTER lights are kept per cluster; the built-in shaders loop
+ * over at most CLUSTER_MAX_LIGHTS lights, which defaults to the same value.
+ *
+ * @script{ignore}
+ */
+class LightGrid : public Ref
+{
+public:
+
+    /**
+     * The maximum number of lights listed in a single cluster.
+     */
+    static const unsigned int MAX_LIGHTS_PER_CLUSTER = 64;
+
+    /**
+     * Creates a new light grid.
+     *
+     * @param tilesX The number of tiles across the viewport.
+     * @param tilesY The number of tiles down the viewport.
+     * @param sliceCount The number of depth slices between the near and far planes of the camera.
+     * @param maxLights The maximum number of lights binned per update, clamped to the maximum texture size.
+     *
+     * @return The new light grid, or NULL if floating point textures are not supported or
+     *      the grid does not fit in the maximum texture size.
+     */
+    static LightGrid* create(unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int sliceCount = 24, unsigned int maxLights = 256);
+
+    /**
+     * Returns whether clustered lighting is supported on this device.
+     *
+     * @return true if floating point textures are supported, false otherwise.
+     */
+    static bool isSupported();
+
+    /**
+     * Bins the lights of a scene for its active camera and the game viewport.
+     *
+     * @param scene The scene whose lights are binned.
+     */
+    void update(Scene* scene);
+
+    /**
+     * Bins the lights of a scene for a camera and viewport.
+     *
+     * @param scene The scene whose lights are binned.
+     * @param camera The camera the scene is drawn with.
+     * @param viewport The viewport the scene is drawn to.
+     */
+    void update(Scene* scene, Camera* camera, const Rectangle& viewport);
+
+    /**
+     * Binds the clustered lighting parameters of a render state to this light grid.
+     *
+     * This is typically called once per material. The light grid must outlive
+     * the render state.
+     *
+     * @param renderState The render state (material, technique or pass) to bind.
+     */
+    void bind(RenderState* renderState);
+
+    /**
+     * Returns the number of lights binned by the last update.
+     *
+     * @return The number of lights.
+     */
+    unsigned int getLightCount() const;
+
+    /**
+     * Returns the number of clusters of this light grid.
+     *
+     * @return The number of clusters.
+     */
+    unsigned int getClusterCount() const;
+
+    /**
+     * Returns the total length of the cluster light lists built by the last update.
+     *
+     * @return The number of light indices.
+     */
+    unsigned int getIndexCount() const;
+
+private:
+
+    /**
+     * Job that bins the lights into a range of depth slices.
+     */
+    class BinJob;
+
+    /**
+     * A light binned by the last update.
+     */
+    struct BinnedLight
+    {
+        BoundingSphere sphere;      // The bounding sphere of the light, in view space.
+        unsigned int tileMinX;      // The range of tiles and slices the sphere overlaps.
+        unsigned int tileMinY;
+        unsigned int tileMaxX;
+        unsigned int tileMaxY;
+        unsigned int sliceMin;
+        unsigned int sliceMax;
+    };
+
+    /**
+     * Constructor.
+     */
+    LightGrid(unsigned int tilesX, unsigned int tilesY, unsigned int sliceCount, unsigned int maxLights);
+
+    /**
+     * Hidden copy constructor.
+     */
+    LightGrid(const LightGrid& copy);
+
+    /**
+     * Destructor.
+     */
+    ~LightGrid();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    LightGrid& operator=(const LightGrid&);
+
+    /**
+     * Creates a floating point RGBA texture and a nearest, clamped sampler for it.
+     */
+    static Texture::Sampler* createSampler(unsigned int width, unsigned int height);
+
+    /**
+     * Recomputes the view space bounds of the clusters if the projection or viewport changed.
+     */
+    void updateClusters(Camera* camera, const Rectangle& viewport);
+
+    /**
+     * Gathers the visible point and spot lights of a scene and the clusters they may overlap.
+     */
+    void gatherLights(Scene* scene, Camera* camera);
+
+    /**
+     * Bins the lights into the clusters of a range of depth slices.
+     */
+    void binSlices(unsigned int sliceBegin, unsigned int sliceEnd);
+
+    /**
+     * Compacts the cluster lists and uploads the textures.
+     */
+    void upload();
+
+    /**
+     * Returns the viewport offset and the inverse size of a tile in pixels.
+     */
+    const Vector4& getTileParameters() const;
+
+    /**
+     * Returns the number of tiles across, down and the number of slices.
+     */
+    const Vector4& getGridSize() const;
+
+    /**
+     * Returns the near plane distance and the slice scale of the logarithmic depth.
+     */
+    const Vector4& getDepthParameters() const;
+
+    unsigned int _tilesX;                           // Number of tiles across the viewport.
+    unsigned int _tilesY;                           // Number of tiles down the viewport.
+    unsigned int _sliceCount;                       // Number of depth slices.
+    unsigned int _maxLights;                        // Maximum number of lights per update.
+    Matrix _projection;                             // Projection the cluster bounds were computed for.
+    Rectangle _viewport;                            // Viewport the cluster bounds were computed for.
+    float _nearPlane;                               // Near plane distance of the camera.
+    float _sliceScale;                              // Slice count over the log of the far to near plane ratio.
+    Vector4 _tileParameters;                        // See getTileParameters().
+    Vector4 _gridSize;                              // See getGridSize().
+    Vector4 _depthParameters;                       // See getDepthParameters().
+    std::vector<BoundingBox> _clusterBounds;        // View space bounds of each cluster.
+    std::vector<BinnedLight> _lights;               // Lights binned by the last update.
+    std::vector<float> _lightData;                  // Position, color and direction texels of each light.
+    std::vector<unsigned short> _clusterLights;     // MAX_LIGHTS_PER_CLUSTER light slots per cluster.
+    std::vector<unsigned int> _clusterCounts;       // Number of lights in each cluster.
+    std::vector<float> _gridData;                   // Offset and count texel of each cluster.
+    std::vector<float> _indexData;                  // Light indices, four per texel.
+    std::vector<Node*> _visibleNodes;               // Scratch space for the visible nodes of a scene.
+    unsigned int _indexCount;                       // Number of light indices of the last update.
+    unsigned int _indexTextureHeight;               // Height of the light index texture.
+    Texture::Sampler* _gridSampler;                 // Cluster offset and count texture.
+    Texture::Sampler* _indexSampler;                // Light index texture.
+    Texture::Sampler* _lightSampler;                // Light data texture.
+};
+
+}
+
+#endif
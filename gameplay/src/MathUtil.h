@@ -8,6 +8,7 @@ namespace gameplay
  */
 class MathUtil
 {
+    friend class Frustum;
     friend class Matrix;
     friend class Vector3;
 
@@ -54,6 +55,8 @@ private:
 
     inline static void multiplyMatrix(const float* m1, const float* m2, float* dst);
 
+    inline static void multiplyMatrices(const float* m, const float* matrices, unsigned int count, float* dst);
+
     inline static void negateMatrix(const float* m, float* dst);
 
     inline static void transposeMatrix(const float* m, float* dst);
@@ -62,8 +65,16 @@ private:
 
     inline static void transformVector4(const float* m, const float* v, float* dst);
 
+    inline static void transformPoints(const float* m, const float* points, unsigned int count, float* dst);
+
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+    inline static unsigned int cullSpheres(const float* planes, unsigned int planeMask, const float* x, const float* y, const float* z, const float* radius,
+                                           unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+
+    inline static unsigned int cullBoxes(const float* planes, unsigned int planeMask, const float* minX, const float* minY, const float* minZ,
+                                         const float* maxX, const float* maxY, const float* maxZ, unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+
     MathUtil();
 };
 
@@ -71,8 +82,10 @@ private:
 
 #define MATRIX_SIZE ( sizeof(float) * 16)
 
-#ifdef USE_NEON
+#if defined(USE_NEON)
 #include "MathUtilNeon.inl"
+#elif defined(USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -109,6 +109,14 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
     memcpy(dst, product, MATRIX_SIZE);
 }
 
+inline void MathUtil::multiplyMatrices(const float* m, const float* matrices, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m, &matrices[i * 16], &dst[i * 16]);
+    }
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
     dst[0]  = -m[0];
@@ -161,6 +169,14 @@ inline void MathUtil::transformVector4(const float* m, const float* v, float* ds
     dst[3] = w;
 }
 
+inline void MathUtil::transformPoints(const float* m, const float* points, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        transformVector4(m, points[i * 3], points[i * 3 + 1], points[i * 3 + 2], 1.0f, &dst[i * 3]);
+    }
+}
+
 inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 {
     float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
@@ -172,6 +188,76 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+// The culling functions take the six frustum planes as arrays of normal x, normal y,
+// normal z and distance (planes[0-5], planes[6-11], planes[12-17], planes[18-23]).
+// An object is rejected when it lies entirely in the negative half-space of a plane.
+
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* x, const float* y, const float* z, const float* radius,
+                                          unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    unsigned int visibleCount = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float r = -radius[i];
+        bool visible = true;
+        if (planeCache)
+        {
+            // Try the plane that rejected the sphere last time first.
+            unsigned int p = planeCache[i];
+            visible = planes[p] * x[i] + planes[6 + p] * y[i] + planes[12 + p] * z[i] + planes[18 + p] >= r;
+        }
+        for (unsigned int p = 0; visible && p < 6; ++p)
+        {
+            if ((planeMask & (1 << p)) && planes[p] * x[i] + planes[6 + p] * y[i] + planes[12 + p] * z[i] + planes[18 + p] < r)
+            {
+                visible = false;
+                if (planeCache)
+                    planeCache[i] = (unsigned char)p;
+            }
+        }
+        if (visible)
+        {
+            visibility[i >> 5] |= 1u << (i & 31);
+            ++visibleCount;
+        }
+    }
+    return visibleCount;
+}
+
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* minX, const float* minY, const float* minZ,
+                                        const float* maxX, const float* maxY, const float* maxZ, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    unsigned int visibleCount = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        // Test the corner of the box furthest along the normal of each plane.
+        bool visible = true;
+        if (planeCache)
+        {
+            unsigned int p = planeCache[i];
+            visible = planes[p] * (planes[p] >= 0.0f ? maxX[i] : minX[i]) + planes[6 + p] * (planes[6 + p] >= 0.0f ? maxY[i] : minY[i]) +
+                      planes[12 + p] * (planes[12 + p] >= 0.0f ? maxZ[i] : minZ[i]) + planes[18 + p] >= 0.0f;
+        }
+        for (unsigned int p = 0; visible && p < 6; ++p)
+        {
+            if ((planeMask & (1 << p)) &&
+                planes[p] * (planes[p] >= 0.0f ? maxX[i] : minX[i]) + planes[6 + p] * (planes[6 + p] >= 0.0f ? maxY[i] : minY[i]) +
+                planes[12 + p] * (planes[12 + p] >= 0.0f ? maxZ[i] : minZ[i]) + planes[18 + p] < 0.0f)
+            {
+                visible = false;
+                if (planeCache)
+                    planeCache[i] = (unsigned char)p;
+            }
+        }
+        if (visible)
+        {
+            visibility[i >> 5] |= 1u << (i & 31);
+            ++visibleCount;
+        }
+    }
+    return visibleCount;
+}
+
 }
 
 
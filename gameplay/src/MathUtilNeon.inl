@@ -1,3 +1,6 @@
+#include <arm_neon.h>
+#include "MathUtilSimd.inl"
+
 namespace gameplay
 {
 
@@ -123,6 +126,14 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
     );
 }
 
+inline void MathUtil::multiplyMatrices(const float* m, const float* matrices, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m, &matrices[i * 16], &dst[i * 16]);
+    }
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
     asm volatile(
@@ -201,6 +212,14 @@ inline void MathUtil::transformVector4(const float* m, const float* v, float* ds
     );
 }
 
+inline void MathUtil::transformPoints(const float* m, const float* points, unsigned int count, float* dst)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        transformVector4(m, points[i * 3], points[i * 3 + 1], points[i * 3 + 2], 1.0f, &dst[i * 3]);
+    }
+}
+
 inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 {
     asm volatile(
@@ -226,4 +245,135 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
     );
 }
 
+// Packs the sign of each lane of a comparison result into a 4-bit mask.
+inline static int neonMoveMask(uint32x4_t v)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t masked = vandq_u32(v, vld1q_u32(bits));
+    uint32x2_t sum = vpadd_u32(vget_low_u32(masked), vget_high_u32(masked));
+    return (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+
+// Gathers the coefficients of the cached plane of each of four lanes.
+inline static void neonGatherPlanes(const float* planes, const unsigned char* cache, float32x4_t* nx, float32x4_t* ny, float32x4_t* nz, float32x4_t* d)
+{
+    float gathered[16];
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        gathered[lane] = planes[cache[lane]];
+        gathered[4 + lane] = planes[6 + cache[lane]];
+        gathered[8 + lane] = planes[12 + cache[lane]];
+        gathered[12 + lane] = planes[18 + cache[lane]];
+    }
+    *nx = vld1q_f32(gathered);
+    *ny = vld1q_f32(gathered + 4);
+    *nz = vld1q_f32(gathered + 8);
+    *d = vld1q_f32(gathered + 12);
+}
+
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* x, const float* y, const float* z, const float* radius,
+                                          unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    float padded[4][4];
+    unsigned int visibleCount = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        SimdCullGroup group(i, count, planeCache);
+        const float* gx = group.load(x, padded[0]);
+        const float* gy = group.load(y, padded[1]);
+        const float* gz = group.load(z, padded[2]);
+        const float* gr = group.load(radius, padded[3]);
+
+        float32x4_t cx = vld1q_f32(gx);
+        float32x4_t cy = vld1q_f32(gy);
+        float32x4_t cz = vld1q_f32(gz);
+        float32x4_t r = vnegq_f32(vld1q_f32(gr));
+
+        int rejected = 0;
+        if (group.cache)
+        {
+            // Try the plane that rejected each sphere last time first.
+            float32x4_t nx, ny, nz, d;
+            neonGatherPlanes(planes, group.cache, &nx, &ny, &nz, &d);
+            float32x4_t dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(d, nx, cx), ny, cy), nz, cz);
+            rejected = neonMoveMask(vcltq_f32(dist, r));
+        }
+        for (unsigned int p = 0; rejected != 0xF && p < 6; ++p)
+        {
+            if (!(planeMask & (1 << p)))
+                continue;
+
+            float32x4_t dist = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(planes[18 + p]), cx, planes[p]), cy, planes[6 + p]), cz, planes[12 + p]);
+            int outside = neonMoveMask(vcltq_f32(dist, r)) & ~rejected;
+            if (outside)
+            {
+                rejected |= outside;
+                group.cachePlane(outside, p);
+            }
+        }
+
+        visibleCount += group.finish(rejected, visibility);
+    }
+    return visibleCount;
+}
+
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* minX, const float* minY, const float* minZ,
+                                        const float* maxX, const float* maxY, const float* maxZ, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    float padded[6][4];
+    unsigned int visibleCount = 0;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        SimdCullGroup group(i, count, planeCache);
+        const float* gminX = group.load(minX, padded[0]);
+        const float* gminY = group.load(minY, padded[1]);
+        const float* gminZ = group.load(minZ, padded[2]);
+        const float* gmaxX = group.load(maxX, padded[3]);
+        const float* gmaxY = group.load(maxY, padded[4]);
+        const float* gmaxZ = group.load(maxZ, padded[5]);
+
+        // Test the centers against the planes, offset by the extents projected onto the normals.
+        float32x4_t bminX = vld1q_f32(gminX);
+        float32x4_t bminY = vld1q_f32(gminY);
+        float32x4_t bminZ = vld1q_f32(gminZ);
+        float32x4_t bmaxX = vld1q_f32(gmaxX);
+        float32x4_t bmaxY = vld1q_f32(gmaxY);
+        float32x4_t bmaxZ = vld1q_f32(gmaxZ);
+        float32x4_t cx = vmulq_n_f32(vaddq_f32(bminX, bmaxX), 0.5f);
+        float32x4_t cy = vmulq_n_f32(vaddq_f32(bminY, bmaxY), 0.5f);
+        float32x4_t cz = vmulq_n_f32(vaddq_f32(bminZ, bmaxZ), 0.5f);
+        float32x4_t ex = vmulq_n_f32(vsubq_f32(bmaxX, bminX), 0.5f);
+        float32x4_t ey = vmulq_n_f32(vsubq_f32(bmaxY, bminY), 0.5f);
+        float32x4_t ez = vmulq_n_f32(vsubq_f32(bmaxZ, bminZ), 0.5f);
+
+        int rejected = 0;
+        if (group.cache)
+        {
+            float32x4_t nx, ny, nz, d;
+            neonGatherPlanes(planes, group.cache, &nx, &ny, &nz, &d);
+            float32x4_t dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(d, nx, cx), ny, cy), nz, cz);
+            dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(dist, vabsq_f32(nx), ex), vabsq_f32(ny), ey), vabsq_f32(nz), ez);
+            rejected = neonMoveMask(vcltq_f32(dist, zero));
+        }
+        for (unsigned int p = 0; rejected != 0xF && p < 6; ++p)
+        {
+            if (!(planeMask & (1 << p)))
+                continue;
+
+            float32x4_t dist = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(planes[18 + p]), cx, planes[p]), cy, planes[6 + p]), cz, planes[12 + p]);
+            dist = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(dist, ex, fabsf(planes[p])), ey, fabsf(planes[6 + p])), ez, fabsf(planes[12 + p]));
+            int outside = neonMoveMask(vcltq_f32(dist, zero)) & ~rejected;
+            if (outside)
+            {
+                rejected |= outside;
+                group.cachePlane(outside, p);
+            }
+        }
+
+        visibleCount += group.finish(rejected, visibility);
+    }
+    return visibleCount;
+}
+
 }
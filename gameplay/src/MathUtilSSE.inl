@@ -0,0 +1,303 @@
+#include <emmintrin.h>
+#include "MathUtilSimd.inl"
+
+namespace gameplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    __m128 c0 = _mm_add_ps(_mm_loadu_ps(&m[0]), s);
+    __m128 c1 = _mm_add_ps(_mm_loadu_ps(&m[4]), s);
+    __m128 c2 = _mm_add_ps(_mm_loadu_ps(&m[8]), s);
+    __m128 c3 = _mm_add_ps(_mm_loadu_ps(&m[12]), s);
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_add_ps(_mm_loadu_ps(&m1[0]), _mm_loadu_ps(&m2[0]));
+    __m128 c1 = _mm_add_ps(_mm_loadu_ps(&m1[4]), _mm_loadu_ps(&m2[4]));
+    __m128 c2 = _mm_add_ps(_mm_loadu_ps(&m1[8]), _mm_loadu_ps(&m2[8]));
+    __m128 c3 = _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12]));
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_sub_ps(_mm_loadu_ps(&m1[0]), _mm_loadu_ps(&m2[0]));
+    __m128 c1 = _mm_sub_ps(_mm_loadu_ps(&m1[4]), _mm_loadu_ps(&m2[4]));
+    __m128 c2 = _mm_sub_ps(_mm_loadu_ps(&m1[8]), _mm_loadu_ps(&m2[8]));
+    __m128 c3 = _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12]));
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    __m128 c0 = _mm_mul_ps(_mm_loadu_ps(&m[0]), s);
+    __m128 c1 = _mm_mul_ps(_mm_loadu_ps(&m[4]), s);
+    __m128 c2 = _mm_mul_ps(_mm_loadu_ps(&m[8]), s);
+    __m128 c3 = _mm_mul_ps(_mm_loadu_ps(&m[12]), s);
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+// Multiplies the column-major matrix held in columns a0-a3 by the column (b[0], b[1], b[2], b[3]).
+inline static __m128 sseTransformColumn(__m128 a0, __m128 a1, __m128 a2, __m128 a3, const float* b)
+{
+    __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[2])));
+    return _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[3])));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 a0 = _mm_loadu_ps(&m1[0]);
+    __m128 a1 = _mm_loadu_ps(&m1[4]);
+    __m128 a2 = _mm_loadu_ps(&m1[8]);
+    __m128 a3 = _mm_loadu_ps(&m1[12]);
+
+    // Support the case where m1 or m2 is the same array as dst.
+    __m128 c0 = sseTransformColumn(a0, a1, a2, a3, &m2[0]);
+    __m128 c1 = sseTransformColumn(a0, a1, a2, a3, &m2[4]);
+    __m128 c2 = sseTransformColumn(a0, a1, a2, a3, &m2[8]);
+    __m128 c3 = sseTransformColumn(a0, a1, a2, a3, &m2[12]);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::multiplyMatrices(const float* m, const float* matrices, unsigned int count, float* dst)
+{
+    // Keep m in registers for the whole array.
+    __m128 a0 = _mm_loadu_ps(&m[0]);
+    __m128 a1 = _mm_loadu_ps(&m[4]);
+    __m128 a2 = _mm_loadu_ps(&m[8]);
+    __m128 a3 = _mm_loadu_ps(&m[12]);
+
+    for (unsigned int i = 0; i < count; ++i, matrices += 16, dst += 16)
+    {
+        __m128 c0 = sseTransformColumn(a0, a1, a2, a3, &matrices[0]);
+        __m128 c1 = sseTransformColumn(a0, a1, a2, a3, &matrices[4]);
+        __m128 c2 = sseTransformColumn(a0, a1, a2, a3, &matrices[8]);
+        __m128 c3 = sseTransformColumn(a0, a1, a2, a3, &matrices[12]);
+
+        _mm_storeu_ps(&dst[0], c0);
+        _mm_storeu_ps(&dst[4], c1);
+        _mm_storeu_ps(&dst[8], c2);
+        _mm_storeu_ps(&dst[12], c3);
+    }
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 c0 = _mm_sub_ps(zero, _mm_loadu_ps(&m[0]));
+    __m128 c1 = _mm_sub_ps(zero, _mm_loadu_ps(&m[4]));
+    __m128 c2 = _mm_sub_ps(zero, _mm_loadu_ps(&m[8]));
+    __m128 c3 = _mm_sub_ps(zero, _mm_loadu_ps(&m[12]));
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+// Stores the x, y and z components of v.
+inline static void sseStoreVector3(__m128 v, float* dst)
+{
+    _mm_storel_pi((__m64*)dst, v);
+    _mm_store_ss(&dst[2], _mm_movehl_ps(v, v));
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w)));
+    sseStoreVector3(r, dst);
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    // Handle case where v == dst.
+    __m128 r = sseTransformColumn(_mm_loadu_ps(&m[0]), _mm_loadu_ps(&m[4]), _mm_loadu_ps(&m[8]), _mm_loadu_ps(&m[12]), v);
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::transformPoints(const float* m, const float* points, unsigned int count, float* dst)
+{
+    // Keep m in registers for the whole array.
+    __m128 a0 = _mm_loadu_ps(&m[0]);
+    __m128 a1 = _mm_loadu_ps(&m[4]);
+    __m128 a2 = _mm_loadu_ps(&m[8]);
+    __m128 a3 = _mm_loadu_ps(&m[12]);
+
+    for (unsigned int i = 0; i < count; ++i, points += 3, dst += 3)
+    {
+        __m128 r = _mm_add_ps(a3, _mm_mul_ps(a0, _mm_set1_ps(points[0])));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(points[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(points[2])));
+        sseStoreVector3(r, dst);
+    }
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+// Gathers the coefficients of the cached plane of each of four lanes.
+inline static void sseGatherPlanes(const float* planes, const unsigned char* cache, __m128* nx, __m128* ny, __m128* nz, __m128* d)
+{
+    *nx = _mm_setr_ps(planes[cache[0]], planes[cache[1]], planes[cache[2]], planes[cache[3]]);
+    *ny = _mm_setr_ps(planes[6 + cache[0]], planes[6 + cache[1]], planes[6 + cache[2]], planes[6 + cache[3]]);
+    *nz = _mm_setr_ps(planes[12 + cache[0]], planes[12 + cache[1]], planes[12 + cache[2]], planes[12 + cache[3]]);
+    *d = _mm_setr_ps(planes[18 + cache[0]], planes[18 + cache[1]], planes[18 + cache[2]], planes[18 + cache[3]]);
+}
+
+inline unsigned int MathUtil::cullSpheres(const float* planes, unsigned int planeMask, const float* x, const float* y, const float* z, const float* radius,
+                                          unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    float padded[4][4];
+    unsigned int visibleCount = 0;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        SimdCullGroup group(i, count, planeCache);
+        const float* gx = group.load(x, padded[0]);
+        const float* gy = group.load(y, padded[1]);
+        const float* gz = group.load(z, padded[2]);
+        const float* gr = group.load(radius, padded[3]);
+
+        __m128 cx = _mm_loadu_ps(gx);
+        __m128 cy = _mm_loadu_ps(gy);
+        __m128 cz = _mm_loadu_ps(gz);
+        __m128 r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(gr));
+
+        int rejected = 0;
+        if (group.cache)
+        {
+            // Try the plane that rejected each sphere last time first.
+            __m128 nx, ny, nz, d;
+            sseGatherPlanes(planes, group.cache, &nx, &ny, &nz, &d);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), d));
+            rejected = _mm_movemask_ps(_mm_cmplt_ps(dist, r));
+        }
+        for (unsigned int p = 0; rejected != 0xF && p < 6; ++p)
+        {
+            if (!(planeMask & (1 << p)))
+                continue;
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p]), cx), _mm_mul_ps(_mm_set1_ps(planes[6 + p]), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[12 + p]), cz), _mm_set1_ps(planes[18 + p])));
+            int outside = _mm_movemask_ps(_mm_cmplt_ps(dist, r)) & ~rejected;
+            if (outside)
+            {
+                rejected |= outside;
+                group.cachePlane(outside, p);
+            }
+        }
+
+        visibleCount += group.finish(rejected, visibility);
+    }
+    return visibleCount;
+}
+
+inline unsigned int MathUtil::cullBoxes(const float* planes, unsigned int planeMask, const float* minX, const float* minY, const float* minZ,
+                                        const float* maxX, const float* maxY, const float* maxZ, unsigned int count, unsigned int* visibility, unsigned char* planeCache)
+{
+    float padded[6][4];
+    unsigned int visibleCount = 0;
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        SimdCullGroup group(i, count, planeCache);
+        const float* gminX = group.load(minX, padded[0]);
+        const float* gminY = group.load(minY, padded[1]);
+        const float* gminZ = group.load(minZ, padded[2]);
+        const float* gmaxX = group.load(maxX, padded[3]);
+        const float* gmaxY = group.load(maxY, padded[4]);
+        const float* gmaxZ = group.load(maxZ, padded[5]);
+
+        // Test the centers against the planes, offset by the extents projected onto the normals.
+        __m128 bminX = _mm_loadu_ps(gminX);
+        __m128 bminY = _mm_loadu_ps(gminY);
+        __m128 bminZ = _mm_loadu_ps(gminZ);
+        __m128 bmaxX = _mm_loadu_ps(gmaxX);
+        __m128 bmaxY = _mm_loadu_ps(gmaxY);
+        __m128 bmaxZ = _mm_loadu_ps(gmaxZ);
+        __m128 cx = _mm_mul_ps(_mm_add_ps(bminX, bmaxX), half);
+        __m128 cy = _mm_mul_ps(_mm_add_ps(bminY, bmaxY), half);
+        __m128 cz = _mm_mul_ps(_mm_add_ps(bminZ, bmaxZ), half);
+        __m128 ex = _mm_mul_ps(_mm_sub_ps(bmaxX, bminX), half);
+        __m128 ey = _mm_mul_ps(_mm_sub_ps(bmaxY, bminY), half);
+        __m128 ez = _mm_mul_ps(_mm_sub_ps(bmaxZ, bminZ), half);
+
+        int rejected = 0;
+        if (group.cache)
+        {
+            __m128 nx, ny, nz, d;
+            sseGatherPlanes(planes, group.cache, &nx, &ny, &nz, &d);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), d));
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+                                       _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+            rejected = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, extent), _mm_setzero_ps()));
+        }
+        for (unsigned int p = 0; rejected != 0xF && p < 6; ++p)
+        {
+            if (!(planeMask & (1 << p)))
+                continue;
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p]), cx), _mm_mul_ps(_mm_set1_ps(planes[6 + p]), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[12 + p]), cz), _mm_set1_ps(planes[18 + p])));
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(planes[p])), ex), _mm_mul_ps(_mm_set1_ps(fabsf(planes[6 + p])), ey)),
+                                       _mm_mul_ps(_mm_set1_ps(fabsf(planes[12 + p])), ez));
+            int outside = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, extent), _mm_setzero_ps())) & ~rejected;
+            if (outside)
+            {
+                rejected |= outside;
+                group.cachePlane(outside, p);
+            }
+        }
+
+        visibleCount += group.finish(rejected, visibility);
+    }
+    return visibleCount;
+}
+
+}
@@ -0,0 +1,75 @@
+namespace gameplay
+{
+
+// The culling functions of the SIMD backends take the six frustum planes as arrays of
+// normal x, normal y, normal z and distance (planes[0-5], planes[6-11], planes[12-17],
+// planes[18-23]). Objects are tested four at a time; a group stops testing planes as soon
+// as all four objects are rejected.
+
+// Number of bits set in each 4-bit lane mask.
+static const unsigned char SIMD_LANE_COUNT[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// A group of four objects tested by a culling function. The last group of an array is
+// padded to four lanes by repeating its last object, and tests a copy of its cached planes.
+class SimdCullGroup
+{
+public:
+
+    SimdCullGroup(unsigned int first, unsigned int count, unsigned char* planeCache)
+        : cache(planeCache ? planeCache + first : NULL), _cache(cache), _first(first), _count(count - first < 4 ? count - first : 4)
+    {
+        if (cache && _count < 4)
+        {
+            for (unsigned int i = 0; i < 4; ++i)
+                _paddedCache[i] = cache[i < _count ? i : _count - 1];
+            cache = _paddedCache;
+        }
+    }
+
+    // Returns the four values of the group in an array, copied into padded for the last group.
+    const float* load(const float* values, float* padded) const
+    {
+        values += _first;
+        if (_count == 4)
+            return values;
+        for (unsigned int i = 0; i < 4; ++i)
+            padded[i] = values[i < _count ? i : _count - 1];
+        return padded;
+    }
+
+    // Records the plane that rejected the lanes in mask.
+    void cachePlane(int mask, unsigned int plane)
+    {
+        if (!cache)
+            return;
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (mask & (1 << lane))
+                cache[lane] = (unsigned char)plane;
+        }
+    }
+
+    // Sets the visibility bits of the lanes that were not rejected, and returns their number.
+    unsigned int finish(int rejected, unsigned int* visibility)
+    {
+        if (cache == _paddedCache)
+        {
+            for (unsigned int i = 0; i < _count; ++i)
+                _cache[i] = _paddedCache[i];
+        }
+        int visible = ~rejected & ((1 << _count) - 1);
+        visibility[_first >> 5] |= (unsigned int)visible << (_first & 31);
+        return SIMD_LANE_COUNT[visible];
+    }
+
+    unsigned char* cache;               // The cached planes of the group, or NULL.
+
+private:
+
+    unsigned char* _cache;              // The cached planes of the group in the array, or NULL.
+    unsigned int _first;                // The index of the first object of the group.
+    unsigned int _count;                // The number of objects of the group.
+    unsigned char _paddedCache[4];      // The cached planes of the last group.
+};
+
+}
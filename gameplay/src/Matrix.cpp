@@ -727,6 +727,17 @@ void Matrix::multiply(const Matrix& m1, const Matrix& m2, Matrix* dst)
     MathUtil::multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
+void Matrix::multiply(const Matrix& m, const Matrix* matrices, unsigned int count, Matrix* dst)
+{
+    if (count == 0)
+        return;
+
+    GP_ASSERT(matrices);
+    GP_ASSERT(dst);
+
+    MathUtil::multiplyMatrices(m.m, matrices->m, count, dst->m);
+}
+
 void Matrix::negate()
 {
     negate(this);
@@ -896,6 +907,17 @@ void Matrix::transformPoint(const Vector3& point, Vector3* dst) const
     transformVector(point.x, point.y, point.z, 1.0f, dst);
 }
 
+void Matrix::transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const
+{
+    if (count == 0)
+        return;
+
+    GP_ASSERT(points);
+    GP_ASSERT(dst);
+
+    MathUtil::transformPoints(m, &points->x, count, &dst->x);
+}
+
 void Matrix::transformVector(Vector3* vector) const
 {
     GP_ASSERT(vector);
@@ -515,6 +515,19 @@ public:
      */
     static void multiply(const Matrix& m1, const Matrix& m2, Matrix* dst);
 
+    /**
+     * Multiplies m by each matrix of an array and stores the results in dst.
+     *
+     * This is faster than multiplying the matrices one at a time since m
+     * is only loaded once.
+     *
+     * @param m The matrix to multiply by each matrix of the array.
+     * @param matrices The array of matrices to multiply.
+     * @param count The number of matrices in the array.
+     * @param dst An array of at least count matrices to store the results in (may be the same as matrices).
+     */
+    static void multiply(const Matrix& m, const Matrix* matrices, unsigned int count, Matrix* dst);
+
     /**
      * Negates this matrix.
      */
@@ -750,6 +763,16 @@ public:
      */
     void transformPoint(const Vector3& point, Vector3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, and stores
+     * the results in dst.
+     *
+     * @param points The array of points to transform.
+     * @param count The number of points in the array.
+     * @param dst An array of at least count vectors to store the transformed points in (may be the same as points).
+     */
+    void transformPoints(const Vector3* points, unsigned int count, Vector3* dst) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -0,0 +1,123 @@
+#include "Base.h"
+#include "MemoryStream.h"
+
+namespace gameplay
+{
+
+MemoryStream::MemoryStream(const unsigned char* data, size_t length)
+    : _data(data), _length(length), _position(0)
+{
+}
+
+bool MemoryStream::canRead()
+{
+    return _data != NULL;
+}
+
+bool MemoryStream::canWrite()
+{
+    return false;
+}
+
+bool MemoryStream::canSeek()
+{
+    return _data != NULL;
+}
+
+void MemoryStream::close()
+{
+    _data = NULL;
+    _length = 0;
+    _position = 0;
+}
+
+size_t MemoryStream::read(void* ptr, size_t size, size_t count)
+{
+    if (!_data || size == 0)
+        return 0;
+    size_t available = (_length - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* MemoryStream::readLine(char* str, int num)
+{
+    if (!_data || num <= 0 || _position >= _length)
+        return NULL;
+
+    // Same as fgets(): stop after a newline or num - 1 characters.
+    int i = 0;
+    while (i < num - 1 && _position < _length)
+    {
+        char c = (char)_data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t MemoryStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool MemoryStream::eof()
+{
+    return _position >= _length;
+}
+
+size_t MemoryStream::length()
+{
+    return _length;
+}
+
+long int MemoryStream::position()
+{
+    if (!_data)
+        return -1;
+    return (long int)_position;
+}
+
+bool MemoryStream::seek(long int offset, int origin)
+{
+    if (!_data)
+        return false;
+
+    long int base;
+    switch (origin)
+    {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = (long int)_position;
+        break;
+    case SEEK_END:
+        base = (long int)_length;
+        break;
+    default:
+        return false;
+    }
+    if (offset < -base || offset > (long int)_length - base)
+        return false;
+
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool MemoryStream::rewind()
+{
+    return seek(0, SEEK_SET);
+}
+
+const void* MemoryStream::getMappedData()
+{
+    return _data;
+}
+
+}
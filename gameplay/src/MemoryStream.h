@@ -0,0 +1,65 @@
+#ifndef MEMORYSTREAM_H_
+#define MEMORYSTREAM_H_
+
+#include "Stream.h"
+
+namespace gameplay
+{
+
+/**
+ * A read-only stream over bytes held in memory.
+ *
+ * Reads are copies from memory rather than system calls, and getMappedData() lets
+ * readers use the bytes in place. Derived streams own the memory: they release it
+ * in close(), then call MemoryStream::close().
+ *
+ * @script{ignore}
+ */
+class MemoryStream : public Stream
+{
+public:
+
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const void* getMappedData();
+
+protected:
+
+    /**
+     * Constructor.
+     *
+     * @param data The bytes, which must not be NULL while the stream is open.
+     * @param length The number of bytes.
+     */
+    MemoryStream(const unsigned char* data, size_t length);
+
+    const unsigned char* _data;         // The bytes, or NULL once the stream is closed.
+    size_t _length;                     // The number of bytes.
+    size_t _position;                   // The read position.
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    MemoryStream(const MemoryStream& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    MemoryStream& operator=(const MemoryStream&);
+};
+
+}
+
+#endif
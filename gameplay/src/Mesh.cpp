@@ -355,9 +355,13 @@ void Mesh::setVertexData(const float* vertexData, unsigned int vertexStart, unsi
     //save VertexBuffer Array
     if (keepData)
     {
-        for (unsigned int i = 0; i < vertexCount*_vertexFormat.getVertexSize()/4; i++)
+        // Copy the bytes rather than the floats: the data may be misaligned in a mapped bundle file.
+        size_t floatCount = vertexCount * _vertexFormat.getVertexSize() / 4;
+        if (floatCount > 0)
         {
-            _vertexData.push_back(vertexData[i]);
+            size_t offset = _vertexData.size();
+            _vertexData.resize(offset + floatCount);
+            memcpy(&_vertexData[offset], (const void*)vertexData, floatCount * sizeof(float));
         }
     }
 }
@@ -2,18 +2,193 @@
 #include "MeshBatch.h"
 #include "Material.h"
 
+// Number of batches each streaming buffer holds before it wraps around.
+#define MESHBATCH_STREAM_SEGMENTS       3
+// Time to wait for the device to release a streaming buffer segment before polling again, in nanoseconds.
+#define MESHBATCH_FENCE_TIMEOUT         1000000
+
+// Persistently mapped streaming buffers require buffer storage and base vertex draws,
+// which are only looked up through GLEW.
+#ifdef GLEW_STATIC
+#define MESHBATCH_PERSISTENT_MAPPING
+#endif
+
 namespace gameplay
 {
 
+static bool isPersistentMappingSupported()
+{
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+    static bool supported = GLEW_ARB_buffer_storage && (GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex);
+    return supported;
+#else
+    return false;
+#endif
+}
+
+class MeshBatch::StreamBuffer
+{
+public:
+
+    /**
+     * Allocates the storage of a buffer that is bound to the given target.
+     *
+     * Writes never straddle a segment of the buffer. With persistent mapping, the device
+     * must have finished reading a segment before it is written again.
+     */
+    StreamBuffer(GLenum target, GLuint handle, unsigned int segmentSize, unsigned int segmentCount, unsigned int alignment, bool persistent)
+        : _target(target), _handle(handle), _size(segmentSize * segmentCount), _segmentSize(segmentSize), _alignment(alignment),
+        _offset(0), _mapOffset(0), _mapSize(0), _mapped(NULL)
+    {
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+        _segment = 0;
+        memset(_fences, 0, sizeof(_fences));
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GL_ASSERT( glBufferStorage(_target, _size, NULL, flags) );
+            GL_ASSERT( _mapped = (unsigned char*)glMapBufferRange(_target, 0, _size, flags) );
+            if (_mapped)
+                return;
+            GP_WARN("Failed to map streaming buffer persistently.");
+        }
+#endif
+        GL_ASSERT( glBufferData(_target, _size, NULL, GL_STREAM_DRAW) );
+    }
+
+    ~StreamBuffer()
+    {
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+        for (unsigned int i = 0; i < MESHBATCH_STREAM_SEGMENTS; ++i)
+        {
+            if (_fences[i])
+                glDeleteSync(_fences[i]);
+        }
+        if (_mapped)
+        {
+            GL_ASSERT( glBindBuffer(_target, _handle) );
+            GL_ASSERT( glUnmapBuffer(_target) );
+        }
+#endif
+    }
+
+    /**
+     * Returns memory to write the given number of bytes to, and their offset in the
+     * buffer. The buffer must be bound to its target until unmap() is called.
+     */
+    void* map(unsigned int size, unsigned int* offset)
+    {
+        GP_ASSERT(size <= _segmentSize);
+        GP_ASSERT(offset);
+
+        unsigned int start = (_offset + _alignment - 1) / _alignment * _alignment;
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+        if (_mapped)
+        {
+            unsigned int segment = start / _segmentSize;
+            if (segment < MESHBATCH_STREAM_SEGMENTS && start + size > (segment + 1) * _segmentSize)
+            {
+                ++segment;
+                start = segment * _segmentSize;
+            }
+            if (segment >= MESHBATCH_STREAM_SEGMENTS)
+            {
+                segment = 0;
+                start = 0;
+            }
+            if (segment != _segment)
+            {
+                // All draws that read the segment we are leaving have been issued.
+                _fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                waitSegment(segment);
+                _segment = segment;
+            }
+            _offset = start + size;
+            *offset = start;
+            return _mapped + start;
+        }
+#endif
+        if (start + size > _size)
+        {
+            // Orphan the buffer: the driver keeps the old storage alive for pending draws.
+            GL_ASSERT( glBufferData(_target, _size, NULL, GL_STREAM_DRAW) );
+            start = 0;
+        }
+        _offset = start + size;
+        _mapOffset = start;
+        _mapSize = size;
+        if (_staging.size() < size)
+            _staging.resize(size);
+        *offset = start;
+        return &_staging[0];
+    }
+
+    /**
+     * Completes the write started by map().
+     */
+    void unmap()
+    {
+        if (!_mapped && _mapSize > 0)
+        {
+            GL_ASSERT( glBufferSubData(_target, _mapOffset, _mapSize, &_staging[0]) );
+            _mapSize = 0;
+        }
+    }
+
+    /**
+     * Returns whether the buffer is persistently mapped.
+     */
+    bool isPersistent() const
+    {
+        return _mapped != NULL;
+    }
+
+private:
+
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+    void waitSegment(unsigned int segment)
+    {
+        GLsync fence = _fences[segment];
+        if (fence)
+        {
+            GLenum result;
+            do
+            {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, MESHBATCH_FENCE_TIMEOUT);
+            } while (result == GL_TIMEOUT_EXPIRED);
+            glDeleteSync(fence);
+            _fences[segment] = 0;
+        }
+    }
+#endif
+
+    GLenum _target;                                 // The target the buffer is bound to.
+    GLuint _handle;                                 // The buffer (not owned).
+    unsigned int _size;                             // Size of the buffer, in bytes.
+    unsigned int _segmentSize;                      // Size of a segment, in bytes.
+    unsigned int _alignment;                        // Alignment of the writes, in bytes.
+    unsigned int _offset;                           // End of the last write.
+    unsigned int _mapOffset;                        // Offset of the pending staged write.
+    unsigned int _mapSize;                          // Size of the pending staged write.
+    unsigned char* _mapped;                         // The persistently mapped buffer, or NULL.
+    std::vector<unsigned char> _staging;            // Staging memory of buffers that are not mapped.
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+    unsigned int _segment;                          // The segment being written.
+    GLsync _fences[MESHBATCH_STREAM_SEGMENTS];      // Fences of the segments the device may still read.
+#endif
+};
+
 MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-      _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL)
+      _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL),
+      _mesh(NULL), _indexBuffer(0), _vertexStream(NULL), _indexStream(NULL)
 {
     resize(initialCapacity);
 }
 
 MeshBatch::~MeshBatch()
 {
+    destroyStreamBuffers();
     SAFE_RELEASE(_material);
     SAFE_DELETE_ARRAY(_vertices);
     SAFE_DELETE_ARRAY(_indices);
@@ -116,7 +291,7 @@ void MeshBatch::updateVertexAttributeBinding()
         {
             Pass* p = t->getPassByIndex(j);
             GP_ASSERT(p);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
+            VertexAttributeBinding* b = VertexAttributeBinding::create(_mesh, p->getEffect());
             p->setVertexAttributeBinding(b);
             SAFE_RELEASE(b);
         }
@@ -211,12 +386,60 @@ bool MeshBatch::resize(unsigned int capacity)
     _vertexCapacity = vertexCapacity;
     _indexCapacity = indexCapacity;
 
-    // Update our vertex attribute bindings now that our client array pointers have changed
+    // Recreate the streaming buffers for the new capacity and bind the material to them.
+    if (!createStreamBuffers())
+        return false;
     updateVertexAttributeBinding();
 
     return true;
 }
 
+bool MeshBatch::createStreamBuffers()
+{
+    destroyStreamBuffers();
+
+    // Without base vertex draws, the streamed indices are offset by the position of the
+    // vertices in the buffer, so the whole vertex buffer must be addressable by them.
+    // Persistently mapped buffers always have MESHBATCH_STREAM_SEGMENTS segments.
+    bool persistent = isPersistentMappingSupported();
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+    unsigned int segmentCount = MESHBATCH_STREAM_SEGMENTS;
+    if (_indexed && !persistent && _vertexCapacity > 0)
+        segmentCount = std::max(1u, std::min(segmentCount, (unsigned int)(USHRT_MAX + 1) / _vertexCapacity));
+
+    _mesh = Mesh::createMesh(_vertexFormat, _vertexCapacity * segmentCount, true);
+    if (_mesh == NULL)
+    {
+        GP_ERROR("Failed to create mesh batch vertex buffer.");
+        return false;
+    }
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
+    _vertexStream = new StreamBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer(), _vertexCapacity * vertexSize, segmentCount, vertexSize, persistent);
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+
+    if (_indexed)
+    {
+        GL_ASSERT( glGenBuffers(1, &_indexBuffer) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+        _indexStream = new StreamBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer, _indexCapacity * sizeof(unsigned short), MESHBATCH_STREAM_SEGMENTS, sizeof(unsigned short), persistent);
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+    }
+
+    return true;
+}
+
+void MeshBatch::destroyStreamBuffers()
+{
+    SAFE_DELETE(_vertexStream);
+    SAFE_DELETE(_indexStream);
+    SAFE_RELEASE(_mesh);
+    if (_indexBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_indexBuffer) );
+        _indexBuffer = 0;
+    }
+}
+
 void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
 {
     add(vertices, sizeof(float), vertexCount, indices, indexCount);
@@ -239,13 +462,20 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-
     GP_ASSERT(_material);
+    GP_ASSERT(_mesh && _vertexStream);
     if (_indexed)
-        GP_ASSERT(_indices);
+        GP_ASSERT(_indices && _indexStream);
+
+    // Stream the vertices to the next free range of the vertex buffer. The vertex attribute
+    // bindings point at the start of the buffer, so the range is addressed by its first vertex.
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+    unsigned int vertexOffset;
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
+    memcpy(_vertexStream->map(_vertexCount * vertexSize, &vertexOffset), _vertices, _vertexCount * vertexSize);
+    _vertexStream->unmap();
+    unsigned int baseVertex = vertexOffset / vertexSize;
+    unsigned int indexOffset = 0;
 
     // Bind the material.
     Technique* technique = _material->getTechnique();
@@ -259,15 +489,48 @@ void MeshBatch::draw()
 
         if (_indexed)
         {
-            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
+            // Bind the index buffer once the pass is bound, since it is part of the vertex array state.
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+            if (i == 0)
+            {
+                unsigned short* indices = (unsigned short*)_indexStream->map(_indexCount * sizeof(unsigned short), &indexOffset);
+                if (_vertexStream->isPersistent())
+                {
+                    memcpy(indices, _indices, _indexCount * sizeof(unsigned short));
+                }
+                else
+                {
+                    for (unsigned int j = 0; j < _indexCount; ++j)
+                    {
+                        indices[j] = _indices[j] + baseVertex;
+                    }
+                }
+                _indexStream->unmap();
+            }
+
+#ifdef MESHBATCH_PERSISTENT_MAPPING
+            if (_vertexStream->isPersistent())
+            {
+                GL_ASSERT( glDrawElementsBaseVertex(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)(size_t)indexOffset, baseVertex) );
+            }
+            else
+#endif
+            {
+                GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)(size_t)indexOffset) );
+            }
         }
         else
         {
-            GL_ASSERT( glDrawArrays(_primitiveType, 0, _vertexCount) );
+            GL_ASSERT( glDrawArrays(_primitiveType, baseVertex, _vertexCount) );
         }
 
         pass->unbind();
     }
+
+    if (_indexed)
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+    }
 }
     
 
@@ -10,6 +10,17 @@ class Material;
 
 /**
  * Defines a class for rendering multiple mesh into a single draw call on the graphics device.
+ *
+ * Primitives are added to client memory and streamed to a vertex (and index) buffer
+ * each time the batch is drawn. The buffers are used as rings: every draw writes to the
+ * next free range, so drawing the same batch several times per frame never waits for
+ * the graphics device to finish reading the previous draw. When a ring is full, it is
+ * orphaned, or, where buffer storage is supported, persistently mapped rings are reused
+ * once the device has finished reading them.
+ *
+ * A batch created with a grow size of zero has a fixed capacity: its client memory and
+ * streaming buffers are allocated once and never reallocated while drawing, and
+ * primitives that do not fit are dropped.
  */
 class MeshBatch
 {
@@ -23,7 +34,7 @@ public:
      * @param materialPath Path to a material file to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Amount to grow the batch by when it overflows (a value of zero gives the batch a fixed capacity).
      *
      * @return A new mesh batch.
      * @script{create}
@@ -38,7 +49,7 @@ public:
      * @param material Material to be used for drawing the batch.
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
-     * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param growSize Amount to grow the batch by when it overflows (a value of zero gives the batch a fixed capacity).
      *
      * @return A new mesh batch.
      * @script{create}
@@ -60,6 +71,8 @@ public:
     /**
      * Explicitly sets a new capacity for the batch.
      *
+     * This reallocates the client memory and streaming buffers of the batch.
+     *
      * @param capacity The new batch capacity.
      */
     void setCapacity(unsigned int capacity);
@@ -138,6 +151,11 @@ public:
 
 private:
 
+    /**
+     * A vertex or index buffer that is written as a ring.
+     */
+    class StreamBuffer;
+
     /**
      * Constructor.
      */
@@ -159,6 +177,10 @@ private:
 
     bool resize(unsigned int capacity);
 
+    bool createStreamBuffers();
+
+    void destroyStreamBuffers();
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -173,6 +195,10 @@ private:
     unsigned char* _verticesPtr;
     unsigned short* _indices;
     unsigned short* _indicesPtr;
+    Mesh* _mesh;
+    IndexBufferHandle _indexBuffer;
+    StreamBuffer* _vertexStream;
+    StreamBuffer* _indexStream;
 
 };
 
@@ -9,7 +9,7 @@ namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _matrixPaletteDirty(true), _model(NULL)
 {
 }
 
@@ -28,6 +28,7 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _matrixPaletteDirty = true;
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -133,6 +134,7 @@ void MeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
     }
+    _matrixPaletteDirty = true;
 }
 
 void MeshSkin::setJoint(Joint* joint, unsigned int index)
@@ -152,18 +154,37 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
         joint->addRef();
         joint->addSkin(this);
     }
+    _matrixPaletteDirty = true;
 }
 
 Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
+    // Palettes that were already computed this frame by Scene::updateMatrixPalettes()
+    // are returned as is.
+    if (_matrixPaletteDirty)
+    {
+        updateMatrixPalette();
+    }
+    return _matrixPalette;
+}
+
+void MeshSkin::updateMatrixPalette() const
+{
+    GP_ASSERT(_matrixPalette);
+
+    _matrixPaletteDirty = false;
     for (size_t i = 0, count = _joints.size(); i < count; i++)
     {
         GP_ASSERT(_joints[i]);
         _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
     }
-    return _matrixPalette;
+}
+
+bool MeshSkin::isMatrixPaletteDirty() const
+{
+    return _matrixPaletteDirty;
 }
 
 unsigned int MeshSkin::getMatrixPaletteSize() const
@@ -101,6 +101,14 @@ public:
      */
     unsigned int getMatrixPaletteSize() const;
 
+    /**
+     * Determines if any joint influencing this skin has changed since the
+     * matrix palette was last computed.
+     *
+     * @return true if the matrix palette needs to be recomputed, false otherwise.
+     */
+    bool isMatrixPaletteDirty() const;
+
     /**
      * Returns our parent Model.
      */
@@ -170,6 +178,14 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Recomputes the matrix palette from the current joint world matrices.
+     *
+     * This does not use any shared state, so palettes for skins that do not share
+     * joints can be updated concurrently from different threads.
+     */
+    void updateMatrixPalette() const;
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -184,6 +200,9 @@ private:
     // Each 4x3 row-wise matrix is represented as 3 Vector4's.
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
+
+    // Set when a joint influencing this skin changes and cleared when the palette is rebuilt.
+    mutable bool _matrixPaletteDirty;
     Model* _model;
 };
 
@@ -15,6 +15,8 @@
 #define NODE_DIRTY_WORLD 1
 #define NODE_DIRTY_BOUNDS 2
 #define NODE_DIRTY_ALL (NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS)
+// Set while the node is queued for an update of the spatial index of its scene.
+#define NODE_DIRTY_SPATIAL 4
 
 namespace gameplay
 {
@@ -22,7 +24,8 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0),
     _tags(NULL), _camera(NULL), _light(NULL), _model(NULL), _terrain(NULL), _form(NULL), _audioSource(NULL), _particleEmitter(NULL),
-    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL)
+    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL),
+    _spatialProxy(-1)
 {
     if (id)
     {
@@ -125,6 +128,7 @@ void Node::addChild(Node* child)
     child->_parent = this;
 
     ++_childCount;
+    hierarchyRevisionChanged();
 
     setBoundsDirty();
 
@@ -163,6 +167,9 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    Scene* scene = getScene();
+    hierarchyRevisionChanged();
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -189,6 +196,12 @@ void Node::remove()
     _prevSibling = NULL;
     _parent = NULL;
 
+    // Our subtree is leaving the scene, so remove it from the scene's spatial index.
+    if (scene)
+    {
+        scene->removeSpatialProxies(this);
+    }
+
     if (parent && parent->_notifyHierarchyChanged)
     {
         parent->hierarchyChanged();
@@ -376,6 +389,19 @@ unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool rec
     return count;
 }
 
+void Node::hierarchyRevisionChanged()
+{
+    const Node* root = this;
+    while (root->_parent)
+    {
+        root = root->_parent;
+    }
+    if (root->_scene)
+    {
+        ++root->_scene->_hierarchyRevision;
+    }
+}
+
 Scene* Node::getScene() const
 {
     if (_scene)
@@ -441,6 +467,28 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
+void Node::updateWorldMatrix() const
+{
+    if (_dirtyBits & NODE_DIRTY_WORLD)
+    {
+        _dirtyBits &= ~NODE_DIRTY_WORLD;
+
+        if (!isStatic())
+        {
+            Node* parent = getParent();
+            if (parent && (!_collisionObject || _collisionObject->isKinematic()))
+            {
+                GP_ASSERT(!(parent->_dirtyBits & NODE_DIRTY_WORLD));
+                Matrix::multiply(parent->_world, getMatrix(), &_world);
+            }
+            else
+            {
+                _world = getMatrix();
+            }
+        }
+    }
+}
+
 const Matrix& Node::getWorldViewMatrix() const
 {
     static Matrix worldView;
@@ -639,6 +687,7 @@ void Node::transformChanged()
 {
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    setSpatialDirty();
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -665,12 +714,62 @@ void Node::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
     _dirtyBits |= NODE_DIRTY_BOUNDS;
+    setSpatialDirty();
 
     // Mark our parent bounds as dirty as well
     if (_parent)
         _parent->setBoundsDirty();
 }
 
+void Node::updateSpatialProxy(BoundingVolumeTree* tree)
+{
+    GP_ASSERT(tree);
+
+    if (!(_dirtyBits & NODE_DIRTY_SPATIAL))
+        return;
+    _dirtyBits &= ~NODE_DIRTY_SPATIAL;
+
+    BoundingSphere sphere;
+    if (getContentBounds(&sphere))
+    {
+        if (_spatialProxy < 0)
+            _spatialProxy = tree->insert(this, sphere);
+        else
+            tree->update(_spatialProxy, sphere);
+    }
+    else if (_spatialProxy >= 0)
+    {
+        tree->remove(_spatialProxy);
+        _spatialProxy = -1;
+    }
+}
+
+void Node::removeSpatialProxy(BoundingVolumeTree* tree)
+{
+    GP_ASSERT(tree);
+
+    _dirtyBits &= ~NODE_DIRTY_SPATIAL;
+    if (_spatialProxy >= 0)
+    {
+        tree->remove(_spatialProxy);
+        _spatialProxy = -1;
+    }
+}
+
+void Node::setSpatialDirty()
+{
+    // Only nodes with a bounding volume of their own (or a proxy to remove) are indexed.
+    if ((_dirtyBits & NODE_DIRTY_SPATIAL) || (_spatialProxy < 0 && !_model && !_terrain && !_light))
+        return;
+
+    Scene* scene = getScene();
+    if (scene)
+    {
+        _dirtyBits |= NODE_DIRTY_SPATIAL;
+        scene->spatialChanged(this);
+    }
+}
+
 Animation* Node::getAnimation(const char* id) const
 {
     Animation* animation = ((AnimationTarget*)this)->getAnimation(id);
@@ -805,6 +904,8 @@ void Node::setModel(Model* model)
             _model->addRef();
             _model->setNode(this);
         }
+
+        setBoundsDirty();
     }
 }
 
@@ -860,91 +961,124 @@ void Node::setForm(Form* form)
     }
 }
 
-const BoundingSphere& Node::getBoundingSphere() const
+bool Node::getContentBounds(BoundingSphere* sphere) const
 {
-    if (_dirtyBits & NODE_DIRTY_BOUNDS)
-    {
-        _dirtyBits &= ~NODE_DIRTY_BOUNDS;
+    GP_ASSERT(sphere);
 
-        const Matrix& worldMatrix = getWorldMatrix();
-
-        // Start with our local bounding sphere
-        // TODO: Incorporate bounds from entities other than mesh (i.e. emitters, audiosource, etc)
-        bool empty = true;
-        if (_terrain)
+    // Start with our local bounding sphere
+    // TODO: Incorporate bounds from entities other than mesh (i.e. emitters, audiosource, etc)
+    bool empty = true;
+    if (_terrain)
+    {
+        sphere->set(_terrain->getBoundingBox());
+        empty = false;
+    }
+    if (_model && _model->getMesh())
+    {
+        if (empty)
         {
-            _bounds.set(_terrain->getBoundingBox());
+            sphere->set(_model->getMesh()->getBoundingSphere());
             empty = false;
         }
-        if (_model && _model->getMesh())
+        else
         {
+            sphere->merge(_model->getMesh()->getBoundingSphere());
+        }
+    }
+    if (_light)
+    {
+        switch (_light->getLightType())
+        {
+        case Light::POINT:
             if (empty)
             {
-                _bounds.set(_model->getMesh()->getBoundingSphere());
+                sphere->set(Vector3::zero(), _light->getRange());
                 empty = false;
             }
             else
             {
-                _bounds.merge(_model->getMesh()->getBoundingSphere());
+                sphere->merge(BoundingSphere(Vector3::zero(), _light->getRange()));
             }
-        }
-        if (_light)
-        {
-            switch (_light->getLightType())
+            break;
+        case Light::SPOT:
             {
-            case Light::POINT:
+                // Bound the cone of the light, which points down the negative z axis.
+                float range = _light->getRange();
+                float angle = _light->getOuterAngle();
+                BoundingSphere cone;
+                if (angle >= MATH_PIOVER2)
+                {
+                    cone.set(Vector3::zero(), range);
+                }
+                else if (angle >= MATH_PIOVER4)
+                {
+                    cone.set(Vector3(0, 0, -range * cos(angle)), range * sin(angle));
+                }
+                else
+                {
+                    float radius = range / (2.0f * cos(angle));
+                    cone.set(Vector3(0, 0, -radius), radius);
+                }
                 if (empty)
                 {
-                    _bounds.set(Vector3::zero(), _light->getRange());
+                    sphere->set(cone.center, cone.radius);
                     empty = false;
                 }
                 else
                 {
-                    _bounds.merge(BoundingSphere(Vector3::zero(), _light->getRange()));
+                    sphere->merge(cone);
                 }
-                break;
-            case Light::SPOT:
-                // TODO: Implement spot light bounds
-                break;
             }
+            break;
         }
-        if (empty)
+    }
+    if (empty)
+        return false;
+
+    // Transform the sphere into world space.
+    bool applyWorldTransform = true;
+    if (_model && _model->getSkin())
+    {
+        // Special case: If the root joint of our mesh skin is parented by any nodes, 
+        // multiply the world matrix of the root joint's parent by this node's
+        // world matrix. This computes a final world matrix used for transforming this
+        // node's bounding volume. This allows us to store a much smaller bounding
+        // volume approximation than would otherwise be possible for skinned meshes,
+        // since joint parent nodes that are not in the matrix palette do not need to
+        // be considered as directly transforming vertices on the GPU (they can instead
+        // be applied directly to the bounding volume transformation below).
+        GP_ASSERT(_model->getSkin()->getRootJoint());
+        Node* jointParent = _model->getSkin()->getRootJoint()->getParent();
+        if (jointParent)
         {
-            // Empty bounding sphere, set the world translation with zero radius
-            worldMatrix.getTranslation(&_bounds.center);
-            _bounds.radius = 0;
+            // TODO: Should we protect against the case where joints are nested directly
+            // in the node hierachy of the model (this is normally not the case)?
+            Matrix boundsMatrix;
+            Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
+            sphere->transform(boundsMatrix);
+            applyWorldTransform = false;
         }
+    }
+    if (applyWorldTransform)
+    {
+        sphere->transform(getWorldMatrix());
+    }
 
-        // Transform the sphere (if not empty) into world space.
-        if (!empty)
+    return true;
+}
+
+const BoundingSphere& Node::getBoundingSphere() const
+{
+    if (_dirtyBits & NODE_DIRTY_BOUNDS)
+    {
+        _dirtyBits &= ~NODE_DIRTY_BOUNDS;
+
+        bool empty = !getContentBounds(&_bounds);
+        if (empty)
         {
-            bool applyWorldTransform = true;
-            if (_model && _model->getSkin())
-            {
-                // Special case: If the root joint of our mesh skin is parented by any nodes, 
-                // multiply the world matrix of the root joint's parent by this node's
-                // world matrix. This computes a final world matrix used for transforming this
-                // node's bounding volume. This allows us to store a much smaller bounding
-                // volume approximation than would otherwise be possible for skinned meshes,
-                // since joint parent nodes that are not in the matrix palette do not need to
-                // be considered as directly transforming vertices on the GPU (they can instead
-                // be applied directly to the bounding volume transformation below).
-                GP_ASSERT(_model->getSkin()->getRootJoint());
-                Node* jointParent = _model->getSkin()->getRootJoint()->getParent();
-                if (jointParent)
-                {
-                    // TODO: Should we protect against the case where joints are nested directly
-                    // in the node hierachy of the model (this is normally not the case)?
-                    Matrix boundsMatrix;
-                    Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
-                    _bounds.transform(boundsMatrix);
-                    applyWorldTransform = false;
-                }
-            }
-            if (applyWorldTransform)
-            {
-                _bounds.transform(getWorldMatrix());
-            }
+            // Empty bounding sphere, set the world translation with zero radius
+            getWorldMatrix().getTranslation(&_bounds.center);
+            _bounds.radius = 0;
         }
 
         // Merge this world-space bounding sphere with our childrens' bounding volumes.
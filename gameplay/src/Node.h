@@ -17,6 +17,7 @@ namespace gameplay
 
 class AudioSource;
 class Bundle;
+class BoundingVolumeTree;
 class Scene;
 class Form;
 class Terrain;
@@ -30,6 +31,7 @@ class Node : public Transform, public Ref
     friend class Bundle;
     friend class MeshSkin;
     friend class Light;
+    friend class LightGrid;
 
 public:
 
@@ -721,6 +723,14 @@ protected:
      */
     void remove();
 
+    /**
+     * Increments the hierarchy revision of the scene the node's hierarchy is attached to.
+     *
+     * Unlike getScene(), this follows the node's parents only, so joints count
+     * toward the scene that holds their hierarchy.
+     */
+    void hierarchyRevisionChanged();
+
     /**
      * Called when this Node's transform changes.
      */
@@ -736,6 +746,40 @@ protected:
      */
     void setBoundsDirty();
 
+    /**
+     * Queues this node for an update of the spatial index of its scene.
+     */
+    void setSpatialDirty();
+
+    /**
+     * Computes the world space bounding sphere of the model, terrain and light attached
+     * to this node, excluding its children.
+     *
+     * @param sphere Set to the bounding sphere.
+     *
+     * @return false if nothing with bounds is attached to this node, true otherwise.
+     */
+    bool getContentBounds(BoundingSphere* sphere) const;
+
+    /**
+     * Inserts, moves or removes the proxy of this node in a spatial index if it is queued.
+     */
+    void updateSpatialProxy(BoundingVolumeTree* tree);
+
+    /**
+     * Removes the proxy of this node from a spatial index and unqueues it.
+     */
+    void removeSpatialProxy(BoundingVolumeTree* tree);
+
+    /**
+     * Resolves the world matrix of this node if it is dirty, assuming the world
+     * matrix of its parent is already up to date.
+     *
+     * Unlike getWorldMatrix(), this does not walk up to the parent nor down to the
+     * children of the node. It is used by Scene::updateTransforms().
+     */
+    void updateWorldMatrix() const;
+
 private:
 
     /**
@@ -888,6 +932,11 @@ protected:
      * lowest common ancestor.
      */
     std::vector<Node*> _advertisedDescendants;
+
+    /**
+     * The proxy of this node in the spatial index of its scene, or -1.
+     */
+    int _spatialProxy;
 };
 
 /**
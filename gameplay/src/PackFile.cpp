@@ -0,0 +1,308 @@
+#include "Base.h"
+#include "PackFile.h"
+#include "FileSystem.h"
+#include <zlib.h>
+
+// Identifies a pack file.
+#define PACKFILE_MAGIC          "GPAK"
+
+// Version of the pack file format.
+#define PACKFILE_VERSION        1
+
+// Marks the end of a bucket.
+#define PACKFILE_NO_ENTRY       0xFFFFFFFF
+
+// Ways a file can be stored.
+#define PACKFILE_STORED         0
+#define PACKFILE_ZLIB           1
+
+// Size of the header, of a directory entry and of a bucket, in bytes.
+#define PACKFILE_HEADER_SIZE    24
+#define PACKFILE_ENTRY_SIZE     40
+#define PACKFILE_BUCKET_SIZE    4
+
+namespace gameplay
+{
+
+/**
+ * Returns the path with a leading "./" skipped.
+ */
+static const char* skipCurrentDirectory(const char* path)
+{
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+    {
+        path += 2;
+    }
+    return path;
+}
+
+/**
+ * Returns whether a path of the pack matches a path, treating '\\' as '/'.
+ */
+static bool matchPath(const char* name, unsigned int nameLength, const char* path)
+{
+    for (unsigned int i = 0; i < nameLength; ++i, ++path)
+    {
+        char c = *path == '\\' ? '/' : *path;
+        if (c != name[i])
+            return false;
+    }
+    return *path == '\0';
+}
+
+static unsigned int readUnsignedInt(const unsigned char* data)
+{
+    unsigned int value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static unsigned long long readUnsignedLongLong(const unsigned char* data)
+{
+    unsigned long long value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+PackFile::PackFile(const char* path)
+    : _path(path), _stream(NULL), _mappedData(NULL)
+{
+}
+
+PackFile::~PackFile()
+{
+    SAFE_DELETE(_stream);
+}
+
+PackFile* PackFile::create(const char* path)
+{
+    GP_ASSERT(path);
+
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+    if (stream == NULL)
+    {
+        GP_WARN("Failed to open pack file '%s'.", path);
+        return NULL;
+    }
+
+    // Read the header.
+    unsigned char header[PACKFILE_HEADER_SIZE];
+    if (stream->read(header, 1, PACKFILE_HEADER_SIZE) != PACKFILE_HEADER_SIZE ||
+        memcmp(header, PACKFILE_MAGIC, 4) != 0 || readUnsignedInt(header + 4) != PACKFILE_VERSION)
+    {
+        GP_WARN("Invalid header for pack file '%s'.", path);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+    unsigned int entryCount = readUnsignedInt(header + 8);
+    unsigned int bucketCount = readUnsignedInt(header + 12);
+    unsigned long long directoryOffset = readUnsignedLongLong(header + 16);
+
+    // Read the directory in one go.
+    size_t fileLength = stream->length();
+    if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0 || directoryOffset < PACKFILE_HEADER_SIZE || directoryOffset > fileLength ||
+        ((size_t)bucketCount * PACKFILE_BUCKET_SIZE + (size_t)entryCount * PACKFILE_ENTRY_SIZE) > fileLength - (size_t)directoryOffset ||
+        !stream->seek((long int)directoryOffset, SEEK_SET))
+    {
+        GP_WARN("Invalid directory for pack file '%s'.", path);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+    std::vector<unsigned char> directory(fileLength - (size_t)directoryOffset);
+    if (stream->read(&directory[0], 1, directory.size()) != directory.size())
+    {
+        GP_WARN("Failed to read the directory of pack file '%s'.", path);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+
+    PackFile* pack = new PackFile(path);
+    const unsigned char* data = &directory[0];
+    pack->_buckets.resize(bucketCount);
+    for (unsigned int i = 0; i < bucketCount; ++i, data += PACKFILE_BUCKET_SIZE)
+    {
+        pack->_buckets[i] = readUnsignedInt(data);
+    }
+
+    size_t namesOffset = (size_t)bucketCount * PACKFILE_BUCKET_SIZE + (size_t)entryCount * PACKFILE_ENTRY_SIZE;
+    pack->_names.assign(directory.begin() + namesOffset, directory.end());
+    pack->_entries.resize(entryCount);
+    for (unsigned int i = 0; i < entryCount; ++i, data += PACKFILE_ENTRY_SIZE)
+    {
+        Entry& entry = pack->_entries[i];
+        entry.hash = readUnsignedInt(data);
+        entry.next = readUnsignedInt(data + 4);
+        entry.nameOffset = readUnsignedInt(data + 8);
+        entry.nameLength = readUnsignedInt(data + 12);
+        entry.offset = readUnsignedLongLong(data + 16);
+        entry.size = readUnsignedInt(data + 24);
+        entry.storedSize = readUnsignedInt(data + 28);
+        entry.compression = readUnsignedInt(data + 32);
+
+        if ((entry.next != PACKFILE_NO_ENTRY && entry.next >= entryCount) ||
+            (size_t)entry.nameOffset + entry.nameLength >= pack->_names.size() || pack->_names[entry.nameOffset + entry.nameLength] != '\0' ||
+            entry.offset > directoryOffset || entry.storedSize > directoryOffset - entry.offset ||
+            (entry.compression == PACKFILE_STORED && entry.size != entry.storedSize) || entry.compression > PACKFILE_ZLIB)
+        {
+            GP_WARN("Invalid entry %u in pack file '%s'.", i, path);
+            SAFE_RELEASE(pack);
+            SAFE_DELETE(stream);
+            return NULL;
+        }
+    }
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        if (pack->_buckets[i] != PACKFILE_NO_ENTRY && pack->_buckets[i] >= entryCount)
+        {
+            GP_WARN("Invalid bucket %u in pack file '%s'.", i, path);
+            SAFE_RELEASE(pack);
+            SAFE_DELETE(stream);
+            return NULL;
+        }
+    }
+
+    // Keep a mapped pack open to read files in place; other packs are reopened for each read.
+    pack->_mappedData = (const unsigned char*)stream->getMappedData();
+    if (pack->_mappedData)
+    {
+        pack->_stream = stream;
+    }
+    else
+    {
+        SAFE_DELETE(stream);
+    }
+
+    return pack;
+}
+
+const char* PackFile::getPath() const
+{
+    return _path.c_str();
+}
+
+unsigned int PackFile::getEntryCount() const
+{
+    return (unsigned int)_entries.size();
+}
+
+const char* PackFile::getEntryPath(unsigned int index) const
+{
+    GP_ASSERT(index < _entries.size());
+    return &_names[_entries[index].nameOffset];
+}
+
+bool PackFile::contains(const char* path) const
+{
+    return find(path) >= 0;
+}
+
+Stream* PackFile::open(const char* path)
+{
+    int index = find(path);
+    if (index < 0)
+        return NULL;
+
+    const Entry& entry = _entries[index];
+    if (entry.compression == PACKFILE_STORED)
+    {
+        if (_mappedData)
+        {
+            return new EntryStream(this, _mappedData + entry.offset, entry.size, NULL);
+        }
+
+        unsigned char* buffer = new unsigned char[entry.size > 0 ? entry.size : 1];
+        if (!readStored(entry, buffer))
+        {
+            SAFE_DELETE_ARRAY(buffer);
+            return NULL;
+        }
+        return new EntryStream(this, buffer, entry.size, buffer);
+    }
+
+    // Inflate compressed files, straight from the mapping when there is one.
+    unsigned char* stored = NULL;
+    const unsigned char* source = _mappedData ? _mappedData + entry.offset : NULL;
+    if (source == NULL)
+    {
+        stored = new unsigned char[entry.storedSize > 0 ? entry.storedSize : 1];
+        if (!readStored(entry, stored))
+        {
+            SAFE_DELETE_ARRAY(stored);
+            return NULL;
+        }
+        source = stored;
+    }
+
+    unsigned char* buffer = new unsigned char[entry.size > 0 ? entry.size : 1];
+    uLongf size = entry.size;
+    int result = uncompress(buffer, &size, source, entry.storedSize);
+    SAFE_DELETE_ARRAY(stored);
+    if (result != Z_OK || size != entry.size)
+    {
+        GP_WARN("Failed to inflate '%s' from pack file '%s' (zlib error %d).", path, _path.c_str(), result);
+        SAFE_DELETE_ARRAY(buffer);
+        return NULL;
+    }
+    return new EntryStream(this, buffer, entry.size, buffer);
+}
+
+unsigned int PackFile::hashPath(const char* path)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (path = skipCurrentDirectory(path); *path; ++path)
+    {
+        hash ^= (unsigned char)(*path == '\\' ? '/' : *path);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int PackFile::find(const char* path) const
+{
+    GP_ASSERT(path);
+
+    unsigned int hash = hashPath(path);
+    path = skipCurrentDirectory(path);
+    for (unsigned int index = _buckets[hash & (_buckets.size() - 1)]; index != PACKFILE_NO_ENTRY; index = _entries[index].next)
+    {
+        const Entry& entry = _entries[index];
+        if (entry.hash == hash && matchPath(&_names[entry.nameOffset], entry.nameLength, path))
+            return (int)index;
+    }
+    return -1;
+}
+
+bool PackFile::readStored(const Entry& entry, unsigned char* data)
+{
+    // Each read opens the pack file, so files can be read from several threads at once.
+    std::auto_ptr<Stream> stream(FileSystem::open(_path.c_str()));
+    if (stream.get() == NULL || !stream->seek((long int)entry.offset, SEEK_SET) ||
+        stream->read(data, 1, entry.storedSize) != entry.storedSize)
+    {
+        GP_WARN("Failed to read '%s' from pack file '%s'.", &_names[entry.nameOffset], _path.c_str());
+        return false;
+    }
+    return true;
+}
+
+PackFile::EntryStream::EntryStream(PackFile* pack, const unsigned char* data, size_t length, unsigned char* buffer)
+    : MemoryStream(data, length), _pack(pack), _buffer(buffer)
+{
+    GP_ASSERT(pack);
+    _pack->addRef();
+}
+
+PackFile::EntryStream::~EntryStream()
+{
+    close();
+}
+
+void PackFile::EntryStream::close()
+{
+    SAFE_DELETE_ARRAY(_buffer);
+    SAFE_RELEASE(_pack);
+    MemoryStream::close();
+}
+
+}
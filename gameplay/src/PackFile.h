@@ -0,0 +1,173 @@
+#ifndef PACKFILE_H_
+#define PACKFILE_H_
+
+#include "Ref.h"
+#include "MemoryStream.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a pack file: a single file holding many resource files, with a hashed directory.
+ *
+ * Pack files are built with the gameplay-packer tool and mounted with
+ * FileSystem::mountPack(). Mounted packs are searched before the resource directories,
+ * so opening a packed file costs one hash lookup instead of a stat() call per resource
+ * path. Each file is stored either as is or compressed with zlib.
+ *
+ * The pack file is mapped in memory when the platform supports it. Files stored
+ * uncompressed are then read in place (see Stream::getMappedData()), and compressed
+ * files are inflated into memory when they are opened.
+ *
+ * The format, in native (little endian) byte order, is:
+ * <pre>
+ * header:    char magic[4] "GPAK", u32 version, u32 entryCount, u32 bucketCount, u64 directoryOffset
+ * data:      the stored bytes of each file, aligned on 16 bytes
+ * directory: u32 buckets[bucketCount] (first entry of each bucket, or 0xFFFFFFFF)
+ *            entries[entryCount]: u32 hash, u32 next, u32 nameOffset, u32 nameLength,
+ *                                 u64 offset, u32 size, u32 storedSize, u32 compression, u32 reserved
+ *            names: the zero terminated path of each file
+ * </pre>
+ * Paths use '/' separators and are relative to the resource path. Their hash is the
+ * 32-bit FNV-1a hash of their bytes, and entries are chained in the bucket selected
+ * by the low bits of the hash.
+ *
+ * @script{ignore}
+ */
+class PackFile : public Ref
+{
+    friend class FileSystem;
+
+public:
+
+    /**
+     * Opens a pack file and reads its directory.
+     *
+     * @param path The path of the pack file.
+     *
+     * @return The new pack file, or NULL if it could not be read.
+     */
+    static PackFile* create(const char* path);
+
+    /**
+     * Returns the path of the pack file.
+     *
+     * @return The path.
+     */
+    const char* getPath() const;
+
+    /**
+     * Returns the number of files in the pack.
+     *
+     * @return The number of files.
+     */
+    unsigned int getEntryCount() const;
+
+    /**
+     * Returns the path of a file in the pack.
+     *
+     * @param index The index of the file.
+     *
+     * @return The path of the file.
+     */
+    const char* getEntryPath(unsigned int index) const;
+
+    /**
+     * Returns whether the pack contains a file.
+     *
+     * @param path The path of the file, relative to the resource path.
+     *
+     * @return true if the file is in the pack, false otherwise.
+     */
+    bool contains(const char* path) const;
+
+    /**
+     * Opens a file of the pack for reading.
+     *
+     * @param path The path of the file, relative to the resource path.
+     *
+     * @return The stream, or NULL if the file is not in the pack or could not be read.
+     */
+    Stream* open(const char* path);
+
+private:
+
+    /**
+     * A file in the pack.
+     */
+    struct Entry
+    {
+        unsigned int hash;                  // The hash of the path.
+        unsigned int next;                  // The next entry in the bucket, or PACKFILE_NO_ENTRY.
+        unsigned int nameOffset;            // The offset of the path in the names.
+        unsigned int nameLength;            // The length of the path.
+        unsigned long long offset;          // The offset of the stored bytes in the pack file.
+        unsigned int size;                  // The size of the file.
+        unsigned int storedSize;            // The size of the stored bytes.
+        unsigned int compression;           // How the file is stored.
+    };
+
+    /**
+     * A read-only stream over a file of the pack held in memory.
+     */
+    class EntryStream : public MemoryStream
+    {
+    public:
+
+        EntryStream(PackFile* pack, const unsigned char* data, size_t length, unsigned char* buffer);
+        ~EntryStream();
+        virtual void close();
+
+    private:
+
+        PackFile* _pack;                    // The pack, referenced while the stream is open.
+        unsigned char* _buffer;             // The inflated contents of a compressed file, or NULL.
+    };
+
+    /**
+     * Constructor.
+     */
+    PackFile(const char* path);
+
+    /**
+     * Hidden copy constructor.
+     */
+    PackFile(const PackFile& copy);
+
+    /**
+     * Destructor.
+     */
+    ~PackFile();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    PackFile& operator=(const PackFile&);
+
+    /**
+     * Returns the hash of a path, ignoring a leading "./" and treating '\\' as '/'.
+     */
+    static unsigned int hashPath(const char* path);
+
+    /**
+     * Returns the index of the entry of a file, or -1.
+     */
+    int find(const char* path) const;
+
+    /**
+     * Reads the stored bytes of an entry from the pack file, when it is not mapped.
+     * Opens the pack file for each read, so it can be called from any thread.
+     */
+    bool readStored(const Entry& entry, unsigned char* data);
+
+    std::string _path;                      // The path of the pack file.
+    Stream* _stream;                        // The pack file while it is mapped, or NULL.
+    const unsigned char* _mappedData;       // The mapped pack file, or NULL.
+    std::vector<unsigned int> _buckets;     // The first entry of each bucket.
+    std::vector<Entry> _entries;            // The files of the pack.
+    std::vector<char> _names;               // The paths of the files.
+};
+
+}
+
+#endif
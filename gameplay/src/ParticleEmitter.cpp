@@ -14,7 +14,8 @@ namespace gameplay
 {
 
 ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountMax) :
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleData(NULL),
+    _particleFrames(NULL), _particleVisible(NULL), _randomState(0),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -31,7 +32,10 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
     _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeRunning(0)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+    _particleData = new float[particleCountMax * ATTRIBUTE_COUNT];
+    _particleFrames = new unsigned int[particleCountMax];
+    _particleVisible = new unsigned char[particleCountMax];
+    setRandomSeed((unsigned int)rand());
 
     GP_ASSERT(_spriteBatch);
     GP_ASSERT(_spriteBatch->getStateBlock());
@@ -42,7 +46,9 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particleFrames);
+    SAFE_DELETE_ARRAY(_particleVisible);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
@@ -247,11 +253,12 @@ bool ParticleEmitter::isActive() const
     if (!_node)
         return false;
 
-    GP_ASSERT(_particles);
+    GP_ASSERT(_particleData);
+    const float* energy = getAttribute(ENERGY);
     bool active = false;
     for (unsigned int i = 0; i < _particleCount; i++)
     {
-        if (_particles[i]._energy > 0)
+        if (energy[i] > 0.0f)
         {
             active = true;
             break;
@@ -264,7 +271,7 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
+    GP_ASSERT(_particleData);
 
     // Limit particleCount so as not to go over _particleCountMax.
     if (particleCount + _particleCount > _particleCountMax)
@@ -282,64 +289,96 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[14] = 0.0f;
 
     // Emit the new particles.
+    Vector4 colorStart;
+    Vector4 colorEnd;
+    Vector3 position;
+    Vector3 velocity;
+    Vector3 acceleration;
+    Vector3 rotationAxis;
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
-        p->_visible = true;
+        unsigned int index = _particleCount;
+        _particleVisible[index] = 1;
 
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
+        generateColor(_colorStart, _colorStartVar, &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &colorEnd);
 
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        float energy = (float)generateScalar(_energyMin, _energyMax);
+        float sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
+        float sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        float angle = generateScalar(0.0f, rotationPerParticleSpeed);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
         // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(rotationAxis, &rotationAxis);
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        getAttribute(POSITION_X)[index] = position.x;
+        getAttribute(POSITION_Y)[index] = position.y;
+        getAttribute(POSITION_Z)[index] = position.z;
+        getAttribute(VELOCITY_X)[index] = velocity.x;
+        getAttribute(VELOCITY_Y)[index] = velocity.y;
+        getAttribute(VELOCITY_Z)[index] = velocity.z;
+        getAttribute(ACCELERATION_X)[index] = acceleration.x;
+        getAttribute(ACCELERATION_Y)[index] = acceleration.y;
+        getAttribute(ACCELERATION_Z)[index] = acceleration.z;
+        getAttribute(COLOR_START_R)[index] = getAttribute(COLOR_R)[index] = colorStart.x;
+        getAttribute(COLOR_START_G)[index] = getAttribute(COLOR_G)[index] = colorStart.y;
+        getAttribute(COLOR_START_B)[index] = getAttribute(COLOR_B)[index] = colorStart.z;
+        getAttribute(COLOR_START_A)[index] = getAttribute(COLOR_A)[index] = colorStart.w;
+        getAttribute(COLOR_END_R)[index] = colorEnd.x;
+        getAttribute(COLOR_END_G)[index] = colorEnd.y;
+        getAttribute(COLOR_END_B)[index] = colorEnd.z;
+        getAttribute(COLOR_END_A)[index] = colorEnd.w;
+        getAttribute(ROTATION_AXIS_X)[index] = rotationAxis.x;
+        getAttribute(ROTATION_AXIS_Y)[index] = rotationAxis.y;
+        getAttribute(ROTATION_AXIS_Z)[index] = rotationAxis.z;
+        getAttribute(ROTATION_SPEED)[index] = rotationSpeed;
+        getAttribute(ROTATION_PER_PARTICLE_SPEED)[index] = rotationPerParticleSpeed;
+        getAttribute(ANGLE)[index] = angle;
+        getAttribute(ENERGY_START)[index] = getAttribute(ENERGY)[index] = energy;
+        getAttribute(SIZE_START)[index] = getAttribute(SIZE)[index] = sizeStart;
+        getAttribute(SIZE_END)[index] = sizeEnd;
 
         // Initial sprite frame.
         if (_spriteFrameRandomOffset > 0)
         {
-            p->_frame = rand() % _spriteFrameRandomOffset;
+            _particleFrames[index] = generateRandom() % _spriteFrameRandomOffset;
         }
         else
         {
-            p->_frame = 0;
+            _particleFrames[index] = 0;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+        getAttribute(TIME_ON_CURRENT_FRAME)[index] = 0.0f;
 
         ++_particleCount;
     }
@@ -350,6 +389,12 @@ unsigned int ParticleEmitter::getParticlesCount() const
     return _particleCount;
 }
 
+void ParticleEmitter::setRandomSeed(unsigned int seed)
+{
+    // Xorshift generators must not have a zero state.
+    _randomState = seed ? seed : 0x9E3779B9;
+}
+
 void ParticleEmitter::setEllipsoid(bool ellipsoid)
 {
     _ellipsoid = ellipsoid;
@@ -685,26 +730,78 @@ void ParticleEmitter::setOrbit(bool orbitPosition, bool orbitVelocity, bool orbi
     _orbitAcceleration = orbitAcceleration;
 }
 
-long ParticleEmitter::generateScalar(long min, long max)
+float* ParticleEmitter::getAttribute(ParticleAttribute attribute) const
 {
-    // Note: this is not a very good RNG, but it should be suitable for our purposes.
-    long r = 0;
-    for (unsigned int i = 0; i < sizeof(long)/sizeof(int); i++)
+    return _particleData + attribute * _particleCountMax;
+}
+
+void ParticleEmitter::moveParticle(unsigned int from, unsigned int to)
+{
+    for (unsigned int i = 0; i < ATTRIBUTE_COUNT; i++)
     {
-        r = r << 8; // sizeof(int) * CHAR_BITS
-        r |= rand();
+        float* values = _particleData + i * _particleCountMax;
+        values[to] = values[from];
     }
+    _particleFrames[to] = _particleFrames[from];
+    _particleVisible[to] = _particleVisible[from];
+}
 
-    // Now we have a random long between 0 and MAX_LONG.  We need to clamp it between min and max.
-    r %= max - min;
-    r += min;
+void ParticleEmitter::removeDeadParticles()
+{
+    // Move the particle furthest from the start of the arrays down to take the place
+    // of each dead particle, re-using the slot at the end of the living particles.
+    const float* energy = getAttribute(ENERGY);
+    unsigned int i = 0;
+    while (i < _particleCount)
+    {
+        if (energy[i] > 0.0f)
+        {
+            ++i;
+        }
+        else
+        {
+            --_particleCount;
+            if (i != _particleCount)
+            {
+                moveParticle(_particleCount, i);
+            }
+        }
+    }
+}
+
+unsigned int ParticleEmitter::generateRandom()
+{
+    // Xorshift32: fast, small and good enough for particle properties.
+    unsigned int x = _randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _randomState = x;
+    return x;
+}
+
+float ParticleEmitter::generateRandom0_1()
+{
+    // Use the top 24 bits so the result is exactly representable.
+    return (float)(generateRandom() >> 8) * (1.0f / 16777215.0f);
+}
+
+float ParticleEmitter::generateRandomMinus1_1()
+{
+    return 2.0f * generateRandom0_1() - 1.0f;
+}
+
+long ParticleEmitter::generateScalar(long min, long max)
+{
+    if (max <= min)
+        return min;
 
-    return r;
+    return min + (long)(generateRandom() % (unsigned long)(max - min));
 }
 
 float ParticleEmitter::generateScalar(float min, float max)
 {
-    return min + (max - min) * MATH_RANDOM_0_1();
+    return min + (max - min) * generateRandom0_1();
 }
 
 void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst)
@@ -713,9 +810,9 @@ void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& v
 
     // Scale each component of the variance vector by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1_1();
+    dst->y = base.y + variance.y * generateRandomMinus1_1();
+    dst->z = base.z + variance.z * generateRandomMinus1_1();
 }
 
 void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst)
@@ -725,9 +822,9 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     // Generate a point within a unit cube, then reject if the point is not in a unit sphere.
     do
     {
-        dst->x = MATH_RANDOM_MINUS1_1();
-        dst->y = MATH_RANDOM_MINUS1_1();
-        dst->z = MATH_RANDOM_MINUS1_1();
+        dst->x = generateRandomMinus1_1();
+        dst->y = generateRandomMinus1_1();
+        dst->z = generateRandomMinus1_1();
     } while (dst->length() > 1.0f);
     
     // Scale this point by the scaling vector.
@@ -757,10 +854,10 @@ void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance
 
     // Scale each component of the variance color by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
-    dst->w = base.w + variance.w * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1_1();
+    dst->y = base.y + variance.y * generateRandomMinus1_1();
+    dst->z = base.z + variance.z * generateRandomMinus1_1();
+    dst->w = base.w + variance.w * generateRandomMinus1_1();
 }
 
 ParticleEmitter::TextureBlending ParticleEmitter::getTextureBlendingFromString(const char* str)
@@ -821,94 +918,148 @@ void ParticleEmitter::update(float elapsedTime)
     GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
     const Frustum& frustum = _node->getScene()->getActiveCamera()->getFrustum();
 
-    // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
+    // Age all particles and drop the dead ones so the passes below only touch living particles.
+    GP_ASSERT(_particleData);
+    float* energy = getAttribute(ENERGY);
+    bool anyDead = false;
+    for (unsigned int i = 0; i < _particleCount; ++i)
     {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedTime;
+        energy[i] -= elapsedTime;
+        anyDead |= (energy[i] <= 0.0f);
+    }
+    if (anyDead)
+    {
+        removeDeadParticles();
+    }
 
-        if (p->_energy > 0L)
+    const unsigned int count = _particleCount;
+    float* positionX = getAttribute(POSITION_X);
+    float* positionY = getAttribute(POSITION_Y);
+    float* positionZ = getAttribute(POSITION_Z);
+    float* velocityX = getAttribute(VELOCITY_X);
+    float* velocityY = getAttribute(VELOCITY_Y);
+    float* velocityZ = getAttribute(VELOCITY_Z);
+    float* accelerationX = getAttribute(ACCELERATION_X);
+    float* accelerationY = getAttribute(ACCELERATION_Y);
+    float* accelerationZ = getAttribute(ACCELERATION_Z);
+
+    // Rotate velocity and acceleration about each particle's rotation axis.
+    if (_rotationSpeedMin != 0.0f || _rotationSpeedMax != 0.0f)
+    {
+        const float* rotationAxisX = getAttribute(ROTATION_AXIS_X);
+        const float* rotationAxisY = getAttribute(ROTATION_AXIS_Y);
+        const float* rotationAxisZ = getAttribute(ROTATION_AXIS_Z);
+        const float* rotationSpeed = getAttribute(ROTATION_SPEED);
+        Vector3 axis;
+        Vector3 v;
+        for (unsigned int i = 0; i < count; ++i)
         {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
-
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
-
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
-
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
-
-            if (!frustum.intersects(p->_position))
+            axis.set(rotationAxisX[i], rotationAxisY[i], rotationAxisZ[i]);
+            if (rotationSpeed[i] != 0.0f && !axis.isZero())
             {
-                p->_visible = false;
-                continue;
+                Matrix::createRotation(axis, rotationSpeed[i] * elapsedSecs, &_rotation);
+
+                v.set(velocityX[i], velocityY[i], velocityZ[i]);
+                _rotation.transformPoint(&v);
+                velocityX[i] = v.x;
+                velocityY[i] = v.y;
+                velocityZ[i] = v.z;
+
+                v.set(accelerationX[i], accelerationY[i], accelerationZ[i]);
+                _rotation.transformPoint(&v);
+                accelerationX[i] = v.x;
+                accelerationY[i] = v.y;
+                accelerationZ[i] = v.z;
             }
+        }
+    }
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    // Integrate velocity and position.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        velocityX[i] += accelerationX[i] * elapsedSecs;
+        velocityY[i] += accelerationY[i] * elapsedSecs;
+        velocityZ[i] += accelerationZ[i] * elapsedSecs;
+    }
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        positionX[i] += velocityX[i] * elapsedSecs;
+        positionY[i] += velocityY[i] * elapsedSecs;
+        positionZ[i] += velocityZ[i] * elapsedSecs;
+    }
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+    // Spin each particle in screen space.
+    float* angle = getAttribute(ANGLE);
+    const float* rotationPerParticleSpeed = getAttribute(ROTATION_PER_PARTICLE_SPEED);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        angle[i] += rotationPerParticleSpeed[i] * elapsedSecs;
+    }
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    // Simple linear interpolation of color and size.
+    const float* energyStart = getAttribute(ENERGY_START);
+    float* size = getAttribute(SIZE);
+    const float* sizeStart = getAttribute(SIZE_START);
+    const float* sizeEnd = getAttribute(SIZE_END);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float percent = 1.0f - energy[i] / energyStart[i];
+        size[i] = sizeStart[i] + (sizeEnd[i] - sizeStart[i]) * percent;
+    }
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+        float* color = getAttribute((ParticleAttribute)(COLOR_R + c));
+        const float* colorStart = getAttribute((ParticleAttribute)(COLOR_START_R + c));
+        const float* colorEnd = getAttribute((ParticleAttribute)(COLOR_END_R + c));
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float percent = 1.0f - energy[i] / energyStart[i];
+            color[i] = colorStart[i] + (colorEnd[i] - colorStart[i]) * percent;
+        }
+    }
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+    // Particles outside the view frustum are skipped when drawing.
+    Vector3 position;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        position.set(positionX[i], positionY[i], positionZ[i]);
+        _particleVisible[i] = frustum.intersects(position) ? 1 : 0;
+    }
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        float* timeOnCurrentFrame = getAttribute(TIME_ON_CURRENT_FRAME);
+        if (!_spriteLooped)
+        {
+            // The last frame should finish exactly when the particle dies.
+            for (unsigned int i = 0; i < count; ++i)
             {
-                if (!_spriteLooped)
-                {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
-                }
-                else
+                unsigned int frame = _particleFrames[i];
+                float percent = 1.0f - energy[i] / energyStart[i];
+                timeOnCurrentFrame[i] = percent - frame * _spritePercentPerFrame;
+                if (frame < _spriteFrameCount - 1 && timeOnCurrentFrame[i] >= _spritePercentPerFrame)
                 {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
-                    {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
-                    }
+                    _particleFrames[i] = frame + 1;
                 }
             }
         }
         else
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
+            // _spriteFrameDurationSecs is an absolute time measured in seconds,
+            // and the animation repeats indefinitely.
+            for (unsigned int i = 0; i < count; ++i)
             {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
+                timeOnCurrentFrame[i] += elapsedSecs;
+                if (timeOnCurrentFrame[i] >= _spriteFrameDurationSecs)
+                {
+                    timeOnCurrentFrame[i] -= _spriteFrameDurationSecs;
+                    if (++_particleFrames[i] == _spriteFrameCount)
+                    {
+                        _particleFrames[i] = 0;
+                    }
+                }
             }
-            --_particleCount;
         }
     }
 }
@@ -935,7 +1086,7 @@ void ParticleEmitter::draw(const Vector3 &up, const Vector3 &right)
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
+        GP_ASSERT(_particleData);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -953,15 +1104,28 @@ void ParticleEmitter::draw(const Vector3 &up, const Vector3 &right)
         // 3D Rotation so that particles always face the camera.
         GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
 
+        const float* positionX = getAttribute(POSITION_X);
+        const float* positionY = getAttribute(POSITION_Y);
+        const float* positionZ = getAttribute(POSITION_Z);
+        const float* colorR = getAttribute(COLOR_R);
+        const float* colorG = getAttribute(COLOR_G);
+        const float* colorB = getAttribute(COLOR_B);
+        const float* colorA = getAttribute(COLOR_A);
+        const float* size = getAttribute(SIZE);
+        const float* angle = getAttribute(ANGLE);
+
+        Vector3 position;
+        Vector4 color;
         for (unsigned int i = 0; i < _particleCount; i++)
         {
-            Particle* p = &_particles[i];
-
-            if (p->_visible)
+            if (_particleVisible[i])
             {
-                _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                   _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                   p->_color, pivot, p->_angle);
+                position.set(positionX[i], positionY[i], positionZ[i]);
+                color.set(colorR[i], colorG[i], colorB[i], colorA[i]);
+                const float* texCoords = &_spriteTextureCoords[_particleFrames[i] * 4];
+                _spriteBatch->draw(position, right, up, size[i], size[i],
+                                   texCoords[0], texCoords[1], texCoords[2], texCoords[3],
+                                   color, pivot, angle[i]);
             }
         }
 
@@ -247,6 +247,17 @@ public:
      */
     unsigned int getParticlesCount() const;
 
+    /**
+     * Seeds the random number generator used to generate the properties of newly emitted particles.
+     *
+     * Each emitter has its own generator, so emitters seeded with the same value and
+     * updated with the same elapsed times produce the same particles. By default the
+     * generator is seeded from rand() when the emitter is created.
+     *
+     * @param seed The seed value.
+     */
+    void setRandomSeed(unsigned int seed);
+
     /**
      * Sets whether the positions of newly emitted particles are generated within an ellipsoidal domain.
      *
@@ -651,6 +662,54 @@ private:
      */
     void setNode(Node* node);
 
+    /**
+     * The particle attributes stored as float arrays in the particle data.
+     */
+    enum ParticleAttribute
+    {
+        POSITION_X, POSITION_Y, POSITION_Z,
+        VELOCITY_X, VELOCITY_Y, VELOCITY_Z,
+        ACCELERATION_X, ACCELERATION_Y, ACCELERATION_Z,
+        COLOR_START_R, COLOR_START_G, COLOR_START_B, COLOR_START_A,
+        COLOR_END_R, COLOR_END_G, COLOR_END_B, COLOR_END_A,
+        COLOR_R, COLOR_G, COLOR_B, COLOR_A,
+        ROTATION_AXIS_X, ROTATION_AXIS_Y, ROTATION_AXIS_Z,
+        ROTATION_SPEED,
+        ROTATION_PER_PARTICLE_SPEED,
+        ANGLE,
+        ENERGY_START,
+        ENERGY,
+        SIZE_START,
+        SIZE_END,
+        SIZE,
+        TIME_ON_CURRENT_FRAME,
+        ATTRIBUTE_COUNT
+    };
+
+    /**
+     * Gets the array holding the given attribute for all particles.
+     */
+    float* getAttribute(ParticleAttribute attribute) const;
+
+    /**
+     * Moves the particle at index 'from' to index 'to'.
+     */
+    void moveParticle(unsigned int from, unsigned int to);
+
+    /**
+     * Removes the particles that have run out of energy.
+     */
+    void removeDeadParticles();
+
+    // Returns the next value of the emitter's random number generator.
+    unsigned int generateRandom();
+
+    // Generates a random float between 0 and 1.
+    float generateRandom0_1();
+
+    // Generates a random float between -1 and 1.
+    float generateRandomMinus1_1();
+
     // Generates a scalar within the range defined by min and max.
     float generateScalar(float min, float max);
 
@@ -667,36 +726,12 @@ private:
     // Generates a color within the domain defined by a base vector and its variance.
     void generateColor(const Vector4& base, const Vector4& variance, Vector4* dst);
 
-    /**
-     * Defines the data for a single particle in the system.
-     */
-    class Particle
-    {
-
-    public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
-        bool _visible;
-    };
-
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    float* _particleData;                   // Particle attributes, one array of _particleCountMax floats per ParticleAttribute.
+    unsigned int* _particleFrames;          // Current sprite frame of each particle.
+    unsigned char* _particleVisible;        // Whether each particle is inside the camera's frustum.
+    unsigned int _randomState;              // State of the emitter's random number generator.
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
@@ -0,0 +1,163 @@
+#include "Base.h"
+#include "ParticleSystem.h"
+#include "Game.h"
+#include "Node.h"
+#include "Scene.h"
+
+namespace gameplay
+{
+
+class ParticleSystem::UpdateJob : public ThreadPool::Job
+{
+public:
+
+    UpdateJob() : emitter(NULL), elapsedTime(0.0f) { }
+
+    void execute()
+    {
+        emitter->update(elapsedTime);
+    }
+
+    ParticleEmitter* emitter;
+    float elapsedTime;
+};
+
+ParticleSystem::ParticleSystem(unsigned int seed)
+    : _seed(seed), _emitterSequence(0)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    removeAllEmitters();
+}
+
+ParticleSystem* ParticleSystem::create(unsigned int seed)
+{
+    return new ParticleSystem(seed);
+}
+
+void ParticleSystem::addEmitter(ParticleEmitter* emitter)
+{
+    GP_ASSERT(emitter);
+
+    emitter->addRef();
+    emitter->setRandomSeed(getEmitterSeed(_emitterSequence++));
+    _emitters.push_back(emitter);
+}
+
+void ParticleSystem::removeEmitter(ParticleEmitter* emitter)
+{
+    std::vector<ParticleEmitter*>::iterator itr = std::find(_emitters.begin(), _emitters.end(), emitter);
+    if (itr != _emitters.end())
+    {
+        _emitters.erase(itr);
+        SAFE_RELEASE(emitter);
+    }
+}
+
+void ParticleSystem::removeAllEmitters()
+{
+    for (size_t i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_emitters[i]);
+    }
+    _emitters.clear();
+}
+
+unsigned int ParticleSystem::getEmitterCount() const
+{
+    return (unsigned int)_emitters.size();
+}
+
+ParticleEmitter* ParticleSystem::getEmitter(unsigned int index) const
+{
+    GP_ASSERT(index < _emitters.size());
+    return _emitters[index];
+}
+
+void ParticleSystem::setRandomSeed(unsigned int seed)
+{
+    _seed = seed;
+    _emitterSequence = 0;
+    for (size_t i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        _emitters[i]->setRandomSeed(getEmitterSeed(_emitterSequence++));
+    }
+}
+
+unsigned int ParticleSystem::getRandomSeed() const
+{
+    return _seed;
+}
+
+unsigned int ParticleSystem::getEmitterSeed(unsigned int sequence) const
+{
+    // Mix the system seed with the sequence number so that neighbouring emitters
+    // get unrelated random streams.
+    unsigned int x = _seed + (sequence + 1) * 0x9E3779B9;
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return x;
+}
+
+void ParticleSystem::update(float elapsedTime)
+{
+    GP_PROFILE_ZONE("ParticleSystem::update");
+    size_t emitterCount = _emitters.size();
+    if (emitterCount == 0)
+        return;
+
+    // Emitters read their node's world matrix and the active camera's frustum, both of
+    // which are computed lazily. Resolve them here so the jobs only ever read them.
+    std::vector<UpdateJob> jobs;
+    jobs.reserve(emitterCount);
+    for (size_t i = 0; i < emitterCount; ++i)
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        if (!emitter->isActive())
+            continue;
+
+        Node* node = emitter->getNode();
+        GP_ASSERT(node && node->getScene() && node->getScene()->getActiveCamera());
+        node->getWorldMatrix();
+        node->getScene()->getActiveCamera()->getFrustum();
+
+        jobs.push_back(UpdateJob());
+        jobs.back().emitter = emitter;
+        jobs.back().elapsedTime = elapsedTime;
+    }
+
+    ThreadPool* threadPool = Game::getInstance()->getThreadPool();
+    if (threadPool && jobs.size() > 1)
+    {
+        std::vector<ThreadPool::Job*> jobPointers(jobs.size());
+        for (size_t i = 0, count = jobs.size(); i < count; ++i)
+        {
+            jobPointers[i] = &jobs[i];
+        }
+        threadPool->run(&jobPointers[0], (unsigned int)jobPointers.size());
+    }
+    else
+    {
+        for (size_t i = 0, count = jobs.size(); i < count; ++i)
+        {
+            jobs[i].execute();
+        }
+    }
+}
+
+void ParticleSystem::draw()
+{
+    GP_PROFILE_ZONE("ParticleSystem::draw");
+    // Sprite batches touch GL state, so drawing always happens on the calling thread.
+    for (size_t i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        _emitters[i]->draw();
+    }
+}
+
+}
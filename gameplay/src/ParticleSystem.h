@@ -0,0 +1,145 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include "ParticleEmitter.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a collection of particle emitters that are updated and drawn together.
+ *
+ * The particle system updates its emitters in parallel on the game's thread pool,
+ * one job per emitter, and then draws them serially on the calling thread. Each
+ * emitter uses its own random number generator, and the system seeds those
+ * generators from a single seed, so updating the same emitters with the same
+ * elapsed times always produces the same particles regardless of how the jobs
+ * are scheduled.
+ *
+ * Emitters must be attached to a node in a scene with an active camera before
+ * the system is updated.
+ *
+ * @script{ignore}
+ */
+class ParticleSystem : public Ref
+{
+public:
+
+    /**
+     * Creates an empty particle system.
+     *
+     * @param seed The seed used to seed the random number generators of the emitters.
+     *
+     * @return The new particle system.
+     */
+    static ParticleSystem* create(unsigned int seed = 0);
+
+    /**
+     * Adds an emitter to this particle system.
+     *
+     * This increases the reference count of the emitter and seeds its random number
+     * generator from the system seed and the number of emitters added so far.
+     *
+     * @param emitter The emitter to add.
+     */
+    void addEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Removes an emitter from this particle system.
+     *
+     * This decreases the reference count of the emitter.
+     *
+     * @param emitter The emitter to remove.
+     */
+    void removeEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Removes all emitters from this particle system.
+     */
+    void removeAllEmitters();
+
+    /**
+     * Returns the number of emitters in this particle system.
+     *
+     * @return The number of emitters.
+     */
+    unsigned int getEmitterCount() const;
+
+    /**
+     * Returns the emitter at the specified index.
+     *
+     * @param index The index of the emitter.
+     *
+     * @return The emitter at the specified index.
+     */
+    ParticleEmitter* getEmitter(unsigned int index) const;
+
+    /**
+     * Reseeds the random number generators of all emitters in this particle system.
+     *
+     * Emitters are seeded in the order they were added, so reseeding a system with
+     * the same seed and the same emitters restarts the same random sequences.
+     *
+     * @param seed The new seed.
+     */
+    void setRandomSeed(unsigned int seed);
+
+    /**
+     * Returns the seed of this particle system.
+     *
+     * @return The seed.
+     */
+    unsigned int getRandomSeed() const;
+
+    /**
+     * Updates all emitters in this particle system.
+     *
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     */
+    void update(float elapsedTime);
+
+    /**
+     * Draws all emitters in this particle system.
+     */
+    void draw();
+
+private:
+
+    /**
+     * Job that updates a single emitter.
+     */
+    class UpdateJob;
+
+    /**
+     * Constructor.
+     */
+    ParticleSystem(unsigned int seed);
+
+    /**
+     * Hidden copy constructor.
+     */
+    ParticleSystem(const ParticleSystem& copy);
+
+    /**
+     * Destructor.
+     */
+    ~ParticleSystem();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ParticleSystem& operator=(const ParticleSystem&);
+
+    /**
+     * Returns the seed of the emitter with the given sequence number.
+     */
+    unsigned int getEmitterSeed(unsigned int sequence) const;
+
+    std::vector<ParticleEmitter*> _emitters;        // The emitters, in the order they were added.
+    unsigned int _seed;                             // The seed of the system.
+    unsigned int _emitterSequence;                  // Number of emitters seeded since the last reseed.
+};
+
+}
+
+#endif
@@ -472,6 +472,7 @@ void PhysicsController::resume()
 
 void PhysicsController::update(float elapsedTime)
 {
+    GP_PROFILE_ZONE("PhysicsController::update");
     GP_ASSERT(_world);
     _isUpdating = true;
 
@@ -1153,7 +1154,7 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
 
             // Move the index data into the rigid body's local buffer.
             // Set it to NULL in the MeshPartData so it is not released when the data is freed.
-            shapeMeshData->indexData.push_back(meshPart->indexData);
+            shapeMeshData->indexData.push_back(const_cast<unsigned char*>(meshPart->indexData));
             meshPart->indexData = NULL;
 
             // Create a btIndexedMesh object for the current mesh part.
@@ -0,0 +1,297 @@
+#include "Base.h"
+#include "Profiler.h"
+
+#ifdef GAMEPLAY_PROFILER
+
+#include "Font.h"
+#include "FileSystem.h"
+#include "Stream.h"
+
+#ifdef WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+// Number of zones held by the ring buffer of each thread (must be a power of two).
+#define PROFILER_EVENT_CAPACITY     8192
+// Maximum number of threads that can record zones.
+#define PROFILER_MAX_THREADS        32
+// Maximum number of distinct zones tracked by the statistics.
+#define PROFILER_MAX_ZONES          64
+// Number of frames the statistics are averaged over.
+#define PROFILER_STATS_FRAMES       60
+
+#ifdef WIN32
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#define PROFILER_ATOMIC_INCREMENT(value) (InterlockedIncrement(value) - 1)
+#else
+#define PROFILER_THREAD_LOCAL __thread
+#define PROFILER_ATOMIC_INCREMENT(value) __sync_fetch_and_add(value, 1)
+#endif
+
+namespace gameplay
+{
+
+/**
+ * A zone recorded by a thread.
+ */
+struct ProfilerEvent
+{
+    const char* name;
+    unsigned long long start;
+    unsigned long long end;
+    unsigned int depth;
+};
+
+/**
+ * The ring buffer of zones recorded by a thread.
+ */
+struct ProfilerThread
+{
+    ProfilerEvent events[PROFILER_EVENT_CAPACITY];
+    unsigned int count;     // Total number of zones recorded; the ring holds the last PROFILER_EVENT_CAPACITY.
+    unsigned int depth;     // Number of zones currently open.
+    unsigned int id;        // Index of the thread in the profiler.
+};
+
+/**
+ * The times of a zone over the last frames.
+ */
+struct ProfilerZoneStats
+{
+    const char* name;
+    unsigned int depth;
+    float times[PROFILER_STATS_FRAMES];
+};
+
+static const char* PROFILER_FRAME_ZONE = "Frame";
+
+static ProfilerThread* __profilerThreads[PROFILER_MAX_THREADS];
+static volatile long __profilerThreadCount = 0;
+static PROFILER_THREAD_LOCAL ProfilerThread* __profilerThread = NULL;
+static PROFILER_THREAD_LOCAL bool __profilerThreadFull = false;
+
+static ProfilerZoneStats __profilerZones[PROFILER_MAX_ZONES];
+static unsigned int __profilerZoneCount = 0;
+static unsigned int __profilerFrame = 0;
+static unsigned long long __profilerFrameStart = 0;
+
+static ProfilerThread* getProfilerThread()
+{
+    if (__profilerThread == NULL && !__profilerThreadFull)
+    {
+        long index = PROFILER_ATOMIC_INCREMENT(&__profilerThreadCount);
+        if (index < PROFILER_MAX_THREADS)
+        {
+            ProfilerThread* thread = new ProfilerThread();
+            thread->count = 0;
+            thread->depth = 0;
+            thread->id = (unsigned int)index;
+            __profilerThread = thread;
+            __profilerThreads[index] = thread;
+        }
+        else
+        {
+            GP_WARN("Too many threads for the profiler; zones on this thread will not be recorded.");
+            __profilerThreadFull = true;
+        }
+    }
+    return __profilerThread;
+}
+
+static unsigned int getProfilerThreadCount()
+{
+    return min((unsigned int)__profilerThreadCount, (unsigned int)PROFILER_MAX_THREADS);
+}
+
+static ProfilerZoneStats* getProfilerZoneStats(const char* name, unsigned int depth)
+{
+    for (unsigned int i = 0; i < __profilerZoneCount; ++i)
+    {
+        ProfilerZoneStats& zone = __profilerZones[i];
+        if (zone.depth == depth && (zone.name == name || strcmp(zone.name, name) == 0))
+            return &zone;
+    }
+
+    if (__profilerZoneCount == PROFILER_MAX_ZONES)
+        return NULL;
+
+    ProfilerZoneStats* zone = &__profilerZones[__profilerZoneCount++];
+    zone->name = name;
+    zone->depth = depth;
+    memset(zone->times, 0, sizeof(zone->times));
+    return zone;
+}
+
+Profiler::Zone::Zone(const char* name)
+    : _name(name), _start(0)
+{
+    ProfilerThread* thread = getProfilerThread();
+    if (thread)
+        ++thread->depth;
+    _start = getTime();
+}
+
+Profiler::Zone::~Zone()
+{
+    unsigned long long end = getTime();
+    ProfilerThread* thread = getProfilerThread();
+    if (thread)
+    {
+        --thread->depth;
+        ProfilerEvent& event = thread->events[thread->count & (PROFILER_EVENT_CAPACITY - 1)];
+        event.name = _name;
+        event.start = _start;
+        event.end = end;
+        event.depth = thread->depth;
+        ++thread->count;
+    }
+}
+
+unsigned long long Profiler::getTime()
+{
+#ifdef WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    unsigned long long ticks = (unsigned long long)counter.QuadPart;
+    unsigned long long rate = (unsigned long long)frequency.QuadPart;
+    return (ticks / rate) * 1000000000ULL + (ticks % rate) * 1000000000ULL / rate;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+void Profiler::endFrame()
+{
+    unsigned long long now = getTime();
+    if (__profilerFrameStart == 0)
+    {
+        __profilerFrameStart = now;
+        return;
+    }
+
+    unsigned int slot = __profilerFrame % PROFILER_STATS_FRAMES;
+    for (unsigned int i = 0; i < __profilerZoneCount; ++i)
+    {
+        __profilerZones[i].times[slot] = 0.0f;
+    }
+
+    ProfilerZoneStats* frame = getProfilerZoneStats(PROFILER_FRAME_ZONE, 0);
+    if (frame)
+        frame->times[slot] = (float)(now - __profilerFrameStart) * 1e-6f;
+
+    // Zones are stored in the order they ended, so walk each ring backwards
+    // until reaching zones that ended before this frame started.
+    for (unsigned int t = 0, threadCount = getProfilerThreadCount(); t < threadCount; ++t)
+    {
+        const ProfilerThread* thread = __profilerThreads[t];
+        if (thread == NULL)
+            continue;
+
+        unsigned int available = min(thread->count, (unsigned int)PROFILER_EVENT_CAPACITY);
+        for (unsigned int i = 1; i <= available; ++i)
+        {
+            const ProfilerEvent& event = thread->events[(thread->count - i) & (PROFILER_EVENT_CAPACITY - 1)];
+            if (event.end < __profilerFrameStart)
+                break;
+
+            // Nest the zones below the frame in the statistics.
+            ProfilerZoneStats* zone = getProfilerZoneStats(event.name, event.depth + 1);
+            if (zone)
+                zone->times[slot] += (float)(event.end - event.start) * 1e-6f;
+        }
+    }
+
+    __profilerFrameStart = now;
+    ++__profilerFrame;
+}
+
+void Profiler::drawStats(Font* font, int x, int y, const Vector4& color)
+{
+    GP_ASSERT(font);
+
+    unsigned int frameCount = min(__profilerFrame, (unsigned int)PROFILER_STATS_FRAMES);
+    if (frameCount == 0)
+        return;
+
+    char text[128];
+    int lineHeight = (int)font->getSize();
+    font->start();
+    font->drawText("Zone                               avg ms   max ms", x, y, color);
+    for (unsigned int i = 0; i < __profilerZoneCount; ++i)
+    {
+        const ProfilerZoneStats& zone = __profilerZones[i];
+        float total = 0.0f;
+        float peak = 0.0f;
+        for (unsigned int f = 0; f < frameCount; ++f)
+        {
+            total += zone.times[f];
+            peak = max(peak, zone.times[f]);
+        }
+
+        int indent = (int)min(zone.depth * 2, 16u);
+        sprintf(text, "%*s%-*.*s %8.3f %8.3f", indent, "", 32 - indent, 32 - indent, zone.name, total / frameCount, peak);
+        y += lineHeight;
+        font->drawText(text, x, y, color);
+    }
+    font->finish();
+}
+
+bool Profiler::writeTrace(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open profiler trace file '%s'.", path);
+        return false;
+    }
+
+    char text[256];
+    const char* separator = "";
+    sprintf(text, "{\"traceEvents\":[\n");
+    stream->write(text, 1, strlen(text));
+    for (unsigned int t = 0, threadCount = getProfilerThreadCount(); t < threadCount; ++t)
+    {
+        const ProfilerThread* thread = __profilerThreads[t];
+        if (thread == NULL)
+            continue;
+
+        sprintf(text, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}", separator, thread->id, thread->id);
+        stream->write(text, 1, strlen(text));
+        separator = ",\n";
+
+        // Write the zones from the oldest to the newest.
+        unsigned int available = min(thread->count, (unsigned int)PROFILER_EVENT_CAPACITY);
+        for (unsigned int i = thread->count - available; i != thread->count; ++i)
+        {
+            const ProfilerEvent& event = thread->events[i & (PROFILER_EVENT_CAPACITY - 1)];
+            sprintf(text, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, thread->id, event.start * 1e-3, (event.end - event.start) * 1e-3);
+            stream->write(text, 1, strlen(text));
+        }
+    }
+    sprintf(text, "\n]}\n");
+    stream->write(text, 1, strlen(text));
+    stream->close();
+
+    return true;
+}
+
+}
+
+#endif
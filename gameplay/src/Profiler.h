@@ -0,0 +1,142 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/**
+ * Scoped CPU profiling zones.
+ *
+ * The profiler is only compiled in when the pre-processor definition
+ * GAMEPLAY_PROFILER is defined. Otherwise all of the macros below expand
+ * to nothing and the profiler adds no code or data to the build.
+ *
+ * @code
+ * void MyGame::update(float elapsedTime)
+ * {
+ *     GP_PROFILE_ZONE("MyGame::update");
+ *     ...
+ * }
+ * @endcode
+ *
+ * Zone names must be string literals (or otherwise outlive the profiler).
+ */
+#ifdef GAMEPLAY_PROFILER
+
+#define GP_PROFILE_CONCAT_(a, b) a##b
+#define GP_PROFILE_CONCAT(a, b) GP_PROFILE_CONCAT_(a, b)
+
+/** Profiles the enclosing scope under the given name. */
+#define GP_PROFILE_ZONE(name) gameplay::Profiler::Zone GP_PROFILE_CONCAT(__profileZone, __LINE__)(name)
+
+/** Marks the end of a frame and updates the statistics of the profiler. */
+#define GP_PROFILE_FRAME() gameplay::Profiler::endFrame()
+
+/** Draws the rolling statistics of the profiled zones with the specified font. */
+#define GP_PROFILE_DRAW_STATS(font, x, y, color) gameplay::Profiler::drawStats(font, x, y, color)
+
+/** Writes the recorded zones to a Chrome trace file (open with chrome://tracing). */
+#define GP_PROFILE_WRITE_TRACE(path) gameplay::Profiler::writeTrace(path)
+
+namespace gameplay
+{
+
+class Font;
+class Vector4;
+
+/**
+ * Defines a low overhead hierarchical CPU profiler.
+ *
+ * Each thread records its zones into its own fixed-size ring buffer, so recording
+ * a zone never allocates or takes a lock. Timestamps are in nanoseconds.
+ *
+ * endFrame() should be called once per frame from the main thread while no jobs are
+ * running (Game::frame() does this). It gathers the zones of all threads that ended
+ * during the frame into per-zone statistics averaged over the last few frames.
+ *
+ * Use the GP_PROFILE_* macros rather than this class directly so that profiling is
+ * compiled out of builds that do not define GAMEPLAY_PROFILER.
+ *
+ * @script{ignore}
+ */
+class Profiler
+{
+public:
+
+    /**
+     * Records the time between its construction and destruction as a zone.
+     */
+    class Zone
+    {
+    public:
+
+        /**
+         * Starts a zone.
+         *
+         * @param name The name of the zone.
+         */
+        Zone(const char* name);
+
+        /**
+         * Ends the zone.
+         */
+        ~Zone();
+
+    private:
+
+        Zone(const Zone&);
+        Zone& operator=(const Zone&);
+
+        const char* _name;
+        unsigned long long _start;
+    };
+
+    /**
+     * Returns the current time of the profiler's clock.
+     *
+     * @return The time, in nanoseconds.
+     */
+    static unsigned long long getTime();
+
+    /**
+     * Ends the current frame and updates the zone statistics.
+     */
+    static void endFrame();
+
+    /**
+     * Draws the average and maximum time of each zone over the last frames.
+     *
+     * @param font The font to draw with.
+     * @param x The x position of the first line.
+     * @param y The y position of the first line.
+     * @param color The color of the text.
+     */
+    static void drawStats(Font* font, int x, int y, const Vector4& color);
+
+    /**
+     * Writes the zones held in the ring buffers of all threads to a file in the
+     * Chrome trace event format.
+     *
+     * @param path The path of the file to write.
+     *
+     * @return true if the file was written, false otherwise.
+     */
+    static bool writeTrace(const char* path);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    Profiler();
+};
+
+}
+
+#else
+
+#define GP_PROFILE_ZONE(name)
+#define GP_PROFILE_FRAME()
+#define GP_PROFILE_DRAW_STATS(font, x, y, color)
+#define GP_PROFILE_WRITE_TRACE(path)
+
+#endif
+
+#endif
@@ -0,0 +1,348 @@
+#include "Base.h"
+#include "ProgramCache.h"
+#include "FileSystem.h"
+
+// Identifies a program cache file.
+#define PROGRAMCACHE_MAGIC      "GPPC"
+
+// Version of the cache file format.
+#define PROGRAMCACHE_VERSION    1
+
+namespace gameplay
+{
+
+std::string ProgramCache::_path;
+ProgramCache::BinaryMap ProgramCache::_binaries;
+bool ProgramCache::_fileRead = false;
+bool ProgramCache::_modified = false;
+unsigned int ProgramCache::_hitCount = 0;
+unsigned int ProgramCache::_missCount = 0;
+unsigned int ProgramCache::_rejectedCount = 0;
+
+static unsigned long long hashBytes(unsigned long long hash, const char* bytes)
+{
+    // 64-bit FNV-1a, including the terminating zero so consecutive strings do not run together.
+    if (bytes)
+    {
+        for (; *bytes; ++bytes)
+        {
+            hash ^= (unsigned char)*bytes;
+            hash *= 1099511628211ull;
+        }
+    }
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+#ifdef USE_PROGRAM_BINARY
+static GLint getBinaryFormatCount()
+{
+    GLint formatCount = 0;
+    GL_ASSERT( glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount) );
+    return formatCount;
+}
+#endif
+
+ProgramCache::ProgramCache()
+{
+}
+
+void ProgramCache::initialize(const char* path)
+{
+    setPath(path);
+}
+
+void ProgramCache::finalize()
+{
+    save();
+    _binaries.clear();
+    _fileRead = false;
+    _modified = false;
+}
+
+bool ProgramCache::isSupported()
+{
+#ifdef USE_PROGRAM_BINARY
+#ifdef GLEW_STATIC
+    static bool supported = (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) && getBinaryFormatCount() > 0;
+#else
+    static bool supported = glGetProgramBinary && glProgramBinary && getBinaryFormatCount() > 0;
+#endif
+    return supported;
+#else
+    return false;
+#endif
+}
+
+const char* ProgramCache::getPath()
+{
+    return _path.empty() ? NULL : _path.c_str();
+}
+
+void ProgramCache::setPath(const char* path)
+{
+    std::string newPath = path ? path : "";
+    if (newPath == _path)
+        return;
+
+    // Read the current file first so its programs are written to the new path.
+    if (!_path.empty() && !newPath.empty())
+        loadFile();
+
+    _path = newPath;
+    _modified = !_binaries.empty();
+}
+
+bool ProgramCache::save()
+{
+    if (!_modified || _path.empty())
+        return true;
+
+    std::auto_ptr<Stream> stream(FileSystem::open(_path.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open program cache file '%s' for writing.", _path.c_str());
+        return false;
+    }
+
+    unsigned int version = PROGRAMCACHE_VERSION;
+    unsigned long long driverHash = getDriverHash();
+    bool succeeded = stream->write(PROGRAMCACHE_MAGIC, 1, 4) == 4 &&
+        stream->write(&version, sizeof(version), 1) == 1 &&
+        stream->write(&driverHash, sizeof(driverHash), 1) == 1;
+
+    for (BinaryMap::const_iterator itr = _binaries.begin(); succeeded && itr != _binaries.end(); ++itr)
+    {
+        unsigned int format = itr->second.format;
+        unsigned int length = (unsigned int)itr->second.data.size();
+        succeeded = stream->write(&itr->first, sizeof(itr->first), 1) == 1 &&
+            stream->write(&format, sizeof(format), 1) == 1 &&
+            stream->write(&length, sizeof(length), 1) == 1 &&
+            stream->write(&itr->second.data[0], 1, length) == length;
+    }
+    stream->close();
+
+    if (!succeeded)
+    {
+        GP_WARN("Failed to write program cache file '%s'.", _path.c_str());
+        return false;
+    }
+    _modified = false;
+    return true;
+}
+
+unsigned int ProgramCache::getProgramCount()
+{
+    return (unsigned int)_binaries.size();
+}
+
+unsigned int ProgramCache::getHitCount()
+{
+    return _hitCount;
+}
+
+unsigned int ProgramCache::getMissCount()
+{
+    return _missCount;
+}
+
+unsigned int ProgramCache::getRejectedCount()
+{
+    return _rejectedCount;
+}
+
+unsigned long long ProgramCache::getDriverHash()
+{
+    static unsigned long long driverHash = 0;
+    if (driverHash == 0)
+    {
+        driverHash = 14695981039346656037ull;
+        driverHash = hashBytes(driverHash, (const char*)glGetString(GL_VENDOR));
+        driverHash = hashBytes(driverHash, (const char*)glGetString(GL_RENDERER));
+        driverHash = hashBytes(driverHash, (const char*)glGetString(GL_VERSION));
+    }
+    return driverHash;
+}
+
+unsigned long long ProgramCache::getKey(const char* defines, const char* vshSource, const char* fshSource)
+{
+    unsigned long long key = getDriverHash();
+    key = hashBytes(key, defines);
+    key = hashBytes(key, vshSource);
+    key = hashBytes(key, fshSource);
+    return key;
+}
+
+GLuint ProgramCache::loadProgram(unsigned long long key)
+{
+    if (_path.empty() || !isSupported())
+        return 0;
+
+    loadFile();
+
+    BinaryMap::iterator itr = _binaries.find(key);
+    if (itr == _binaries.end())
+    {
+        ++_missCount;
+        return 0;
+    }
+
+#ifdef USE_PROGRAM_BINARY
+    GLuint program;
+    GL_ASSERT( program = glCreateProgram() );
+
+    // The driver reports a binary it does not accept (after a driver update for instance)
+    // with an error or a failed link status, so neither goes through GL_ASSERT.
+    const Binary& binary = itr->second;
+    glProgramBinary(program, binary.format, &binary.data[0], (GLsizei)binary.data.size());
+    GLenum error = glGetError();
+    GLint success = GL_FALSE;
+    if (error == GL_NO_ERROR)
+    {
+        GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+    }
+    if (success == GL_TRUE)
+    {
+        ++_hitCount;
+        return program;
+    }
+
+    GP_WARN("Cached program binary was rejected by the driver; compiling from source.");
+    GL_ASSERT( glDeleteProgram(program) );
+    _binaries.erase(itr);
+    _modified = true;
+    ++_rejectedCount;
+#endif
+    ++_missCount;
+    return 0;
+}
+
+void ProgramCache::prepareProgram(GLuint program)
+{
+#if defined(USE_PROGRAM_BINARY) && defined(GLEW_STATIC)
+    // Desktop drivers only keep the binary of programs linked with this hint.
+    if (!_path.empty() && isSupported())
+    {
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+    }
+#endif
+}
+
+void ProgramCache::saveProgram(unsigned long long key, GLuint program)
+{
+#ifdef USE_PROGRAM_BINARY
+    if (_path.empty() || !isSupported())
+        return;
+
+    GLint length = 0;
+    GL_ASSERT( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (length <= 0)
+        return;
+
+    Binary& binary = _binaries[key];
+    binary.data.resize(length);
+    GLenum format = 0;
+    GL_ASSERT( glGetProgramBinary(program, length, &length, &format, &binary.data[0]) );
+    binary.format = format;
+    binary.data.resize(length);
+    _modified = true;
+#endif
+}
+
+bool ProgramCache::getFileToRead(std::string* path, unsigned long long* driverHash)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(driverHash);
+
+    if (_fileRead || _path.empty() || !isSupported())
+        return false;
+
+    *path = _path;
+    *driverHash = getDriverHash();
+    return true;
+}
+
+bool ProgramCache::readFile(const char* path, unsigned long long driverHash, BinaryMap& binaries)
+{
+    GP_ASSERT(path);
+
+    if (!FileSystem::fileExists(path))
+        return false;
+
+    std::auto_ptr<Stream> stream(FileSystem::open(path));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open program cache file '%s'.", path);
+        return false;
+    }
+
+    // A file written for another driver is ignored; it is replaced when the cache is saved.
+    char magic[4];
+    unsigned int version;
+    unsigned long long fileDriverHash;
+    if (stream->read(magic, 1, 4) != 4 || memcmp(magic, PROGRAMCACHE_MAGIC, 4) != 0 ||
+        stream->read(&version, sizeof(version), 1) != 1 || version != PROGRAMCACHE_VERSION ||
+        stream->read(&fileDriverHash, sizeof(fileDriverHash), 1) != 1 || fileDriverHash != driverHash)
+    {
+        return false;
+    }
+
+    size_t remaining = stream->length() - stream->position();
+    unsigned long long key;
+    unsigned int format;
+    unsigned int length;
+    while (stream->read(&key, sizeof(key), 1) == 1)
+    {
+        remaining -= sizeof(key);
+        if (stream->read(&format, sizeof(format), 1) != 1 || stream->read(&length, sizeof(length), 1) != 1 ||
+            length == 0 || length > remaining - sizeof(format) - sizeof(length))
+        {
+            GP_WARN("Program cache file '%s' is corrupt.", path);
+            binaries.clear();
+            return false;
+        }
+        remaining -= sizeof(format) + sizeof(length) + length;
+
+        Binary& binary = binaries[key];
+        binary.format = format;
+        binary.data.resize(length);
+        if (stream->read(&binary.data[0], 1, length) != length)
+        {
+            GP_WARN("Program cache file '%s' is corrupt.", path);
+            binaries.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProgramCache::addBinaries(BinaryMap& binaries)
+{
+    // Programs saved since the file was read are newer than the binaries of the file.
+    if (!_fileRead)
+    {
+        for (BinaryMap::iterator itr = binaries.begin(); itr != binaries.end(); ++itr)
+        {
+            Binary& binary = _binaries[itr->first];
+            if (binary.data.empty())
+            {
+                binary.format = itr->second.format;
+                binary.data.swap(itr->second.data);
+            }
+        }
+        _fileRead = true;
+    }
+    binaries.clear();
+}
+
+void ProgramCache::loadFile()
+{
+    if (_fileRead || _path.empty())
+        return;
+
+    BinaryMap binaries;
+    readFile(_path.c_str(), getDriverHash(), binaries);
+    addBinaries(binaries);
+}
+
+}
@@ -0,0 +1,195 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+
+#include "Base.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a cache of linked shader program binaries, stored on disk between runs.
+ *
+ * Compiling and linking the shaders of an effect is one of the slowest steps of
+ * loading content, and it is repeated every time the game starts. Where the driver
+ * supports program binaries (OpenGL 4.1, ARB_get_program_binary or
+ * OES_get_program_binary), the cache saves each program linked by Effect and loads
+ * it back on the next run instead of compiling its shaders.
+ *
+ * Programs are keyed by a hash of their final preprocessed sources (after the defines
+ * and includes are expanded) and of the GL vendor, renderer and version strings. The
+ * cache file is discarded when the driver changes, and binaries that the driver
+ * rejects are dropped and the program is compiled from source, so a stale cache only
+ * costs the time to rebuild it.
+ *
+ * The cache file is read when the first effect is created, or in the background by
+ * AsyncLoader::loadEffects(), and written when the game shuts down or save() is called.
+ *
+ * The path of the cache is set by the "programCache" section of the game config:
+ * <pre>
+ * programCache
+ * {
+ *     path = program.cache
+ * }
+ * </pre>
+ *
+ * @script{ignore}
+ */
+class ProgramCache
+{
+    friend class Game;
+    friend class Effect;
+    friend class AsyncLoader;
+
+public:
+
+    /**
+     * Returns whether the driver supports program binaries.
+     *
+     * @return true if program binaries are supported, false otherwise.
+     */
+    static bool isSupported();
+
+    /**
+     * Returns the path of the cache file.
+     *
+     * @return The path, or NULL if the cache is disabled.
+     */
+    static const char* getPath();
+
+    /**
+     * Sets the path of the cache file.
+     *
+     * The programs cached so far are kept and written to the new path.
+     *
+     * @param path The path, or NULL to disable the cache.
+     */
+    static void setPath(const char* path);
+
+    /**
+     * Writes the cache file if programs were added or dropped since it was read.
+     *
+     * @return true if the cache file is up to date, false if it could not be written.
+     */
+    static bool save();
+
+    /**
+     * Returns the number of cached programs.
+     *
+     * @return The number of programs.
+     */
+    static unsigned int getProgramCount();
+
+    /**
+     * Returns the number of programs created from a cached binary.
+     *
+     * @return The number of cache hits.
+     */
+    static unsigned int getHitCount();
+
+    /**
+     * Returns the number of programs that were compiled because they were not cached.
+     *
+     * @return The number of cache misses.
+     */
+    static unsigned int getMissCount();
+
+    /**
+     * Returns the number of cached binaries that the driver rejected.
+     *
+     * @return The number of rejected binaries.
+     */
+    static unsigned int getRejectedCount();
+
+private:
+
+    /**
+     * A linked program binary.
+     */
+    struct Binary
+    {
+        GLenum format;                      // The driver specific format of the binary.
+        std::vector<unsigned char> data;    // The binary.
+    };
+
+    typedef std::map<unsigned long long, Binary> BinaryMap;
+
+    /**
+     * Hidden constructor.
+     */
+    ProgramCache();
+
+    /**
+     * Sets the path of the cache file. Called when the game starts.
+     */
+    static void initialize(const char* path);
+
+    /**
+     * Writes the cache file and frees the cached binaries. Called when the game shuts down.
+     */
+    static void finalize();
+
+    /**
+     * Returns the hash of the GL vendor, renderer and version strings.
+     */
+    static unsigned long long getDriverHash();
+
+    /**
+     * Returns the key of a program.
+     *
+     * @param defines The defines prepended to both shaders.
+     * @param vshSource The preprocessed vertex shader source.
+     * @param fshSource The preprocessed fragment shader source.
+     */
+    static unsigned long long getKey(const char* defines, const char* vshSource, const char* fshSource);
+
+    /**
+     * Creates a program from its cached binary.
+     *
+     * @return The linked program, or 0 if it is not cached or the driver rejected its binary.
+     */
+    static GLuint loadProgram(unsigned long long key);
+
+    /**
+     * Prepares a program that is about to be linked so its binary can be retrieved.
+     */
+    static void prepareProgram(GLuint program);
+
+    /**
+     * Adds the binary of a linked program to the cache.
+     */
+    static void saveProgram(unsigned long long key, GLuint program);
+
+    /**
+     * Returns whether the cache file must still be read, and the information needed to read it.
+     */
+    static bool getFileToRead(std::string* path, unsigned long long* driverHash);
+
+    /**
+     * Reads the binaries of a cache file. Does not call GL, so it can be called from any thread.
+     *
+     * @return true if the file was read, false if it is missing, corrupt or from another driver.
+     */
+    static bool readFile(const char* path, unsigned long long driverHash, BinaryMap& binaries);
+
+    /**
+     * Adds binaries read by readFile() to the cache, leaving the map empty.
+     */
+    static void addBinaries(BinaryMap& binaries);
+
+    /**
+     * Reads the cache file if it was not read yet.
+     */
+    static void loadFile();
+
+    static std::string _path;               // Path of the cache file, or empty if disabled.
+    static BinaryMap _binaries;             // Cached binaries, by program key.
+    static bool _fileRead;                  // Whether the cache file was read.
+    static bool _modified;                  // Whether the cache differs from the cache file.
+    static unsigned int _hitCount;          // Programs created from a binary.
+    static unsigned int _missCount;         // Programs compiled from source.
+    static unsigned int _rejectedCount;     // Binaries rejected by the driver.
+};
+
+}
+
+#endif
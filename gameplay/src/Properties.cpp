@@ -2,10 +2,340 @@
 #include "Properties.h"
 #include "FileSystem.h"
 #include "Quaternion.h"
+#include "Ref.h"
+
+// Appended to the path of a properties file to get the path of its compiled form.
+#define PROPERTIES_COMPILED_EXTENSION   ".gpp"
+
+// Identifies a compiled properties file.
+#define PROPERTIES_COMPILED_MAGIC       "GPPB"
+
+// Version of the compiled properties format.
+#define PROPERTIES_COMPILED_VERSION     1
+
+// Size of the blocks the strings and numbers of a properties file are copied into, in bytes.
+#define PROPERTIES_BLOCK_SIZE           4096
+
+// Maximum number of numbers read from a value (a matrix).
+#define PROPERTIES_MAX_VALUES           16
 
 namespace gameplay
 {
 
+/**
+ * The layout of a compiled properties file, as written by gameplay-encoder, in native
+ * (little endian) byte order:
+ *
+ * header:     char magic[4] "GPPB", u32 version, u32 namespaceCount, u32 propertyCount,
+ *             u32 valueCount, u32 stringsSize, u32 reserved[2]
+ * namespaces: u32 name, u32 id, u32 firstProperty, u32 propertyCount, u32 firstChild, u32 childCount
+ * properties: u32 name, u32 value, u16 type, u16 valueCount, u32 firstValue
+ * values:     float[valueCount]
+ * strings:    zero terminated strings, starting with the empty string
+ *
+ * The first namespace is the root namespace. Namespaces are stored breadth first, so the
+ * children of a namespace follow it and are contiguous. The properties of a namespace are
+ * contiguous and sorted by name. Names, IDs and values are offsets in the strings. The
+ * values of a property are the numbers at the start of its value, separated by commas,
+ * as read by sscanf("%f,%f,...").
+ */
+struct CompiledHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int namespaceCount;
+    unsigned int propertyCount;
+    unsigned int valueCount;
+    unsigned int stringsSize;
+    unsigned int reserved[2];
+};
+
+struct CompiledNamespace
+{
+    unsigned int name;
+    unsigned int id;
+    unsigned int firstProperty;
+    unsigned int propertyCount;
+    unsigned int firstChild;
+    unsigned int childCount;
+};
+
+struct Properties::CompiledProperty
+{
+    unsigned int name;
+    unsigned int value;
+    unsigned short type;
+    unsigned short valueCount;
+    unsigned int firstValue;
+};
+
+/**
+ * The strings and numbers of a properties file, shared by all of its namespaces.
+ *
+ * The names and values of a text file are copied into blocks that are freed with the
+ * storage, instead of being allocated one by one, and the names are interned. The
+ * strings and numbers of a compiled file are read in place from the file.
+ */
+class Properties::Storage : public Ref
+{
+public:
+
+    /**
+     * Creates an empty storage, for the properties of a text file.
+     */
+    static Storage* create();
+
+    /**
+     * Reads a compiled properties file, mapped in memory when possible, and checks its layout.
+     *
+     * @return The storage, or NULL if the file is not a valid compiled properties file.
+     */
+    static Storage* create(Stream* stream);
+
+    /**
+     * Returns the copy of a name in the storage, the same copy for equal names.
+     */
+    const char* intern(const char* str);
+
+    /**
+     * Copies a string into the storage.
+     */
+    const char* copy(const char* str);
+
+    /**
+     * Copies numbers into the storage.
+     */
+    const float* copy(const float* values, unsigned int count);
+
+    const char* getString(unsigned int offset) const
+    {
+        return strings + offset;
+    }
+
+    const CompiledNamespace* namespaces;
+    const CompiledProperty* properties;
+    const float* values;
+    const char* strings;
+
+private:
+
+    Storage(Stream* stream, unsigned char* buffer);
+
+    ~Storage();
+
+    bool validate() const;
+
+    void* allocate(size_t size, size_t alignment);
+
+    Stream* _stream;                        // The mapped compiled file, or NULL.
+    unsigned char* _buffer;                 // The contents of a compiled file that is not mapped, or NULL.
+    std::vector<char*> _blocks;             // The blocks the strings and numbers are copied into.
+    size_t _blockUsed;                      // The bytes used in the last block.
+    std::vector<const char*> _names;        // The interned names, by hash. The size is a power of two.
+    unsigned int _nameCount;                // The number of interned names.
+};
+
+/**
+ * Hashes a name (FNV-1a).
+ */
+static unsigned int hashName(const char* str)
+{
+    unsigned int hash = 2166136261u;
+    for (; *str; ++str)
+    {
+        hash ^= (unsigned char)*str;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Properties::Storage::Storage(Stream* stream, unsigned char* buffer)
+    : namespaces(NULL), properties(NULL), values(NULL), strings(NULL), _stream(stream), _buffer(buffer),
+      _blockUsed(PROPERTIES_BLOCK_SIZE), _nameCount(0)
+{
+}
+
+Properties::Storage::~Storage()
+{
+    for (size_t i = 0, count = _blocks.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_blocks[i]);
+    }
+    SAFE_DELETE(_stream);
+    SAFE_DELETE_ARRAY(_buffer);
+}
+
+Properties::Storage* Properties::Storage::create()
+{
+    return new Storage(NULL, NULL);
+}
+
+Properties::Storage* Properties::Storage::create(Stream* stream)
+{
+    GP_ASSERT(stream);
+
+    // Read the file in place when it is mapped, and read it whole otherwise.
+    size_t length = stream->length();
+    const unsigned char* data = (const unsigned char*)stream->getMappedData();
+    Storage* storage;
+    if (data)
+    {
+        storage = new Storage(stream, NULL);
+    }
+    else
+    {
+        unsigned char* buffer = new unsigned char[length > 0 ? length : 1];
+        if (stream->read(buffer, 1, length) != length)
+        {
+            SAFE_DELETE_ARRAY(buffer);
+            SAFE_DELETE(stream);
+            return NULL;
+        }
+        SAFE_DELETE(stream);
+        storage = new Storage(NULL, buffer);
+        data = buffer;
+    }
+
+    if (length < sizeof(CompiledHeader) || ((size_t)data & 3) != 0)
+    {
+        SAFE_RELEASE(storage);
+        return NULL;
+    }
+    const CompiledHeader* header = (const CompiledHeader*)data;
+    size_t namespacesSize = (size_t)header->namespaceCount * sizeof(CompiledNamespace);
+    size_t propertiesSize = (size_t)header->propertyCount * sizeof(CompiledProperty);
+    size_t valuesSize = (size_t)header->valueCount * sizeof(float);
+    if (memcmp(header->magic, PROPERTIES_COMPILED_MAGIC, 4) != 0 || header->version != PROPERTIES_COMPILED_VERSION ||
+        header->namespaceCount == 0 || header->stringsSize == 0 ||
+        length - sizeof(CompiledHeader) < (unsigned long long)namespacesSize + propertiesSize + valuesSize + header->stringsSize)
+    {
+        SAFE_RELEASE(storage);
+        return NULL;
+    }
+
+    data += sizeof(CompiledHeader);
+    storage->namespaces = (const CompiledNamespace*)data;
+    data += namespacesSize;
+    storage->properties = (const CompiledProperty*)data;
+    data += propertiesSize;
+    storage->values = (const float*)data;
+    data += valuesSize;
+    storage->strings = (const char*)data;
+
+    if (!storage->validate())
+    {
+        SAFE_RELEASE(storage);
+        return NULL;
+    }
+    return storage;
+}
+
+bool Properties::Storage::validate() const
+{
+    // Check every offset and range once, so lookups do not need to.
+    const CompiledHeader* header = (const CompiledHeader*)namespaces - 1;
+    if (strings[header->stringsSize - 1] != '\0')
+        return false;
+
+    for (unsigned int i = 0; i < header->namespaceCount; ++i)
+    {
+        const CompiledNamespace& ns = namespaces[i];
+        if (ns.name >= header->stringsSize || ns.id >= header->stringsSize ||
+            ns.firstProperty > header->propertyCount || ns.propertyCount > header->propertyCount - ns.firstProperty ||
+            (ns.childCount > 0 && ns.firstChild <= i) ||
+            ns.firstChild > header->namespaceCount || ns.childCount > header->namespaceCount - ns.firstChild)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < header->propertyCount; ++i)
+    {
+        const CompiledProperty& property = properties[i];
+        if (property.name >= header->stringsSize || property.value >= header->stringsSize ||
+            property.type == NONE || property.type > MATRIX ||
+            property.firstValue > header->valueCount || property.valueCount > header->valueCount - property.firstValue ||
+            property.valueCount > PROPERTIES_MAX_VALUES)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* Properties::Storage::intern(const char* str)
+{
+    GP_ASSERT(str);
+
+    // Keep the table at most half full, so probing stays short.
+    if ((_nameCount + 1) * 2 > _names.size())
+    {
+        std::vector<const char*> names(_names.empty() ? 64 : _names.size() * 2, (const char*)NULL);
+        for (size_t i = 0, count = _names.size(); i < count; ++i)
+        {
+            if (_names[i])
+            {
+                size_t j = hashName(_names[i]) & (names.size() - 1);
+                while (names[j])
+                {
+                    j = (j + 1) & (names.size() - 1);
+                }
+                names[j] = _names[i];
+            }
+        }
+        _names.swap(names);
+    }
+
+    size_t i = hashName(str) & (_names.size() - 1);
+    while (_names[i])
+    {
+        if (strcmp(_names[i], str) == 0)
+            return _names[i];
+        i = (i + 1) & (_names.size() - 1);
+    }
+    _names[i] = copy(str);
+    ++_nameCount;
+    return _names[i];
+}
+
+const char* Properties::Storage::copy(const char* str)
+{
+    GP_ASSERT(str);
+
+    size_t size = strlen(str) + 1;
+    char* copy = (char*)allocate(size, 1);
+    memcpy(copy, str, size);
+    return copy;
+}
+
+const float* Properties::Storage::copy(const float* values, unsigned int count)
+{
+    GP_ASSERT(values);
+
+    float* copy = (float*)allocate(count * sizeof(float), sizeof(float));
+    memcpy(copy, values, count * sizeof(float));
+    return copy;
+}
+
+void* Properties::Storage::allocate(size_t size, size_t alignment)
+{
+    // Give large strings a block of their own, so they do not waste the rest of a block.
+    if (size > PROPERTIES_BLOCK_SIZE / 4)
+    {
+        char* block = new char[size];
+        _blocks.insert(_blocks.empty() ? _blocks.end() : _blocks.end() - 1, block);
+        return block;
+    }
+
+    size_t offset = (_blockUsed + alignment - 1) & ~(alignment - 1);
+    if (offset + size > PROPERTIES_BLOCK_SIZE)
+    {
+        _blocks.push_back(new char[PROPERTIES_BLOCK_SIZE]);
+        offset = 0;
+    }
+    _blockUsed = offset + size;
+    return _blocks.back() + offset;
+}
+
 /**
  * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
  */
@@ -26,13 +356,18 @@ void calculateNamespacePath(const std::string& urlString, std::string& fileStrin
 Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
 Properties::Properties()
-    : _dirPath(NULL), _parent(NULL)
+    : _compiledProperties(NULL), _compiledCount(0), _propertyIndex(0), _dirPath(NULL), _parent(NULL), _storage(NULL)
 {
 }
 
 Properties::Properties(const Properties& copy)
-    : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties), _dirPath(NULL), _parent(copy._parent)
+    : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties),
+      _compiledProperties(copy._compiledProperties), _compiledCount(copy._compiledCount), _propertyIndex(0), _dirPath(NULL), _parent(copy._parent), _storage(copy._storage)
 {
+    if (_storage)
+    {
+        _storage->addRef();
+    }
     setDirectoryPath(copy._dirPath);
     _namespaces = std::vector<Properties*>();
     std::vector<Properties*>::const_iterator it;
@@ -46,15 +381,20 @@ Properties::Properties(const Properties& copy)
 
 
 Properties::Properties(Stream* stream)
-    : _dirPath(NULL), _parent(NULL)
+    : _compiledProperties(NULL), _compiledCount(0), _propertyIndex(0), _dirPath(NULL), _parent(NULL), _storage(Storage::create())
 {
     readProperties(stream);
     rewind();
 }
 
 Properties::Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent)
-    : _namespace(name), _dirPath(NULL), _parent(parent)
+    : _namespace(name), _compiledProperties(NULL), _compiledCount(0), _propertyIndex(0), _dirPath(NULL), _parent(parent),
+      _storage(parent->_storage)
 {
+    // Nested namespaces share the storage of the root namespace.
+    GP_ASSERT(_storage);
+    _storage->addRef();
+
     if (id)
     {
         _id = id;
@@ -67,6 +407,27 @@ Properties::Properties(Stream* stream, const char* name, const char* id, const c
     rewind();
 }
 
+Properties::Properties(Storage* storage, unsigned int index, Properties* parent)
+    : _compiledProperties(NULL), _compiledCount(0), _propertyIndex(0), _dirPath(NULL), _parent(parent), _storage(storage)
+{
+    GP_ASSERT(storage);
+    _storage->addRef();
+
+    // The properties are stored sorted by name, with their values converted, so they
+    // are read in place until they are modified.
+    const CompiledNamespace& ns = _storage->namespaces[index];
+    _namespace = _storage->getString(ns.name);
+    _id = _storage->getString(ns.id);
+    _compiledProperties = _storage->properties + ns.firstProperty;
+    _compiledCount = ns.propertyCount;
+    _namespaces.reserve(ns.childCount);
+    for (unsigned int i = 0; i < ns.childCount; ++i)
+    {
+        _namespaces.push_back(new Properties(storage, ns.firstChild + i, this));
+    }
+    rewind();
+}
+
 Properties* Properties::create(const char* url)
 {
     if (!url || strlen(url) == 0)
@@ -81,16 +442,31 @@ Properties* Properties::create(const char* url)
     std::vector<std::string> namespacePath;
     calculateNamespacePath(urlString, fileString, namespacePath);
 
-    std::auto_ptr<Stream> stream(FileSystem::open(fileString.c_str()));
-    if (stream.get() == NULL)
+    // Read the compiled form of the file when there is one.
+    Properties* properties = NULL;
+    std::string compiledString = fileString + PROPERTIES_COMPILED_EXTENSION;
+    if (FileSystem::fileExists(compiledString.c_str()))
     {
-        GP_ERROR("Failed to open file '%s'.", fileString.c_str());
-        return NULL;
+        properties = createCompiled(compiledString.c_str());
+        if (properties == NULL)
+        {
+            GP_WARN("Failed to read compiled properties file '%s'; reading '%s' instead.", compiledString.c_str(), fileString.c_str());
+        }
     }
 
-    Properties* properties = new Properties(stream.get());
-    properties->resolveInheritance();
-    stream->close();
+    if (properties == NULL)
+    {
+        std::auto_ptr<Stream> stream(FileSystem::open(fileString.c_str()));
+        if (stream.get() == NULL)
+        {
+            GP_ERROR("Failed to open file '%s'.", fileString.c_str());
+            return NULL;
+        }
+
+        properties = new Properties(stream.get());
+        properties->resolveInheritance();
+        stream->close();
+    }
 
     // Get the specified properties object.
     Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
@@ -112,6 +488,22 @@ Properties* Properties::create(const char* url)
     return p;
 }
 
+Properties* Properties::createCompiled(const char* path)
+{
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+    if (stream == NULL)
+        return NULL;
+
+    Storage* storage = Storage::create(stream);
+    if (storage == NULL)
+        return NULL;
+
+    // The namespaces reference the storage.
+    Properties* properties = new Properties(storage, 0, NULL);
+    SAFE_RELEASE(storage);
+    return properties;
+}
+
 void Properties::readProperties(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -175,7 +567,7 @@ void Properties::readProperties(Stream* stream)
                 value = trimWhiteSpace(value);
 
                 // Store name/value pair.
-                _properties[name] = value;
+                setProperty(_storage->intern(name), _storage->copy(value));
 
                 if (rc != NULL)
                 {
@@ -326,14 +718,7 @@ void Properties::readProperties(Stream* stream)
                                 GP_ERROR("Failed to seek backwards a single character after testing if the next line starts with '{'.");
 
                             // Store "name value" as a name/value pair, or even just "name".
-                            if (value != NULL)
-                            {
-                                _properties[name] = value;
-                            }
-                            else
-                            {
-                                _properties[name] = std::string();
-                            }
+                            setProperty(_storage->intern(name), _storage->copy(value != NULL ? value : ""));
                         }
                     }
                 }
@@ -349,6 +734,7 @@ Properties::~Properties()
     {
         SAFE_DELETE(_namespaces[i]);
     }
+    SAFE_RELEASE(_storage);
 }
 
 void Properties::skipWhiteSpace(Stream* stream)
@@ -437,6 +823,8 @@ void Properties::resolveInheritance(const char* id)
 
                 // Copy data from the parent into the child.
                 derived->_properties = parent->_properties;
+                derived->_compiledProperties = parent->_compiledProperties;
+                derived->_compiledCount = parent->_compiledCount;
                 derived->_namespaces = std::vector<Properties*>();
                 std::vector<Properties*>::const_iterator itt;
                 for (itt = parent->_namespaces.begin(); itt < parent->_namespaces.end(); ++itt)
@@ -473,17 +861,31 @@ void Properties::mergeWith(Properties* overrides)
 {
     GP_ASSERT(overrides);
 
-    // Overwrite or add each property found in child.
-    char* value = new char[255];
-    overrides->rewind();
-    const char* name = overrides->getNextProperty(&value);
-    while (name)
+    // Overwrite or add each property found in child, stopping at a property
+    // without a name as getNextProperty() does.
+    if (_storage == NULL && overrides->_storage)
     {
-        this->_properties[name] = value;
-        name = overrides->getNextProperty(&value);
+        _storage = overrides->_storage;
+        _storage->addRef();
     }
-    SAFE_DELETE_ARRAY(value);
-    this->_propertiesItr = this->_properties.end();
+    Property record;
+    for (unsigned int i = 0, count = overrides->getPropertyCount(); i < count; ++i)
+    {
+        const Property& property = *overrides->getProperty(i, &record);
+        if (*property.name == '\0')
+            break;
+        if (overrides->_storage == _storage)
+        {
+            // Keep the strings and the converted values.
+            *setProperty(property.name, property.value) = property;
+        }
+        else
+        {
+            setProperty(_storage->intern(property.name), _storage->copy(property.value));
+        }
+    }
+    overrides->rewind();
+    this->_propertyIndex = getPropertyCount();
 
     // Merge all common nested namespaces, add new ones.
     Properties* overridesNamespace = overrides->getNextNamespace();
@@ -520,27 +922,29 @@ void Properties::mergeWith(Properties* overrides)
 
 const char* Properties::getNextProperty(char** value)
 {
-    if (_propertiesItr == _properties.end())
+    unsigned int count = getPropertyCount();
+    if (_propertyIndex >= count)
     {
         // Restart from the beginning
-        _propertiesItr = _properties.begin();
+        _propertyIndex = 0;
     }
     else
     {
         // Move to the next property
-        ++_propertiesItr;
+        ++_propertyIndex;
     }
 
-    if (_propertiesItr != _properties.end())
+    if (_propertyIndex < count)
     {
-        const std::string& name = _propertiesItr->first;
-        if (!name.empty())
+        Property record;
+        const Property& property = *getProperty(_propertyIndex, &record);
+        if (*property.name)
         {
             if (value)
             {
-                strcpy(*value, _propertiesItr->second.c_str());
+                strcpy(*value, property.value);
             }
-            return name.c_str();
+            return property.name;
         }
     }
 
@@ -570,7 +974,7 @@ Properties* Properties::getNextNamespace()
 
 void Properties::rewind()
 {
-    _propertiesItr = _properties.end();
+    _propertyIndex = getPropertyCount();
     _namespacesItr = _namespaces.end();
 }
 
@@ -613,7 +1017,8 @@ const char* Properties::getId() const
 bool Properties::exists(const char* name) const
 {
     GP_ASSERT(name);
-    return _properties.find(name) != _properties.end();
+    Property record;
+    return findProperty(name, &record) != NULL;
 }
 
 static const bool isStringNumeric(const char* str)
@@ -650,14 +1055,11 @@ static const bool isStringNumeric(const char* str)
     return true;
 }
 
-Properties::Type Properties::getType(const char* name) const
+/**
+ * Returns the type of a value.
+ */
+static Properties::Type getValueType(const char* value)
 {
-    const char* value = getString(name);
-    if (!value)
-    {
-        return Properties::NONE;
-    }
-
     // Parse the value to determine the format
     unsigned int commaCount = 0;
     char* valuePtr = const_cast<char*>(value);
@@ -684,33 +1086,51 @@ Properties::Type Properties::getType(const char* name) const
     }
 }
 
-const char* Properties::getString(const char* name) const
+/**
+ * Reads the numbers at the start of a value, as sscanf("%f,%f,...") does.
+ */
+static unsigned int readValues(const char* value, float* values)
 {
-    if (name)
+    unsigned int count = 0;
+    while (count < PROPERTIES_MAX_VALUES)
     {
-        std::map<std::string, std::string>::const_iterator itr = _properties.find(name);
-        if (itr != _properties.end())
-        {
-            return itr->second.c_str();
-        }
-    }
-    else
-    {
-        if (_propertiesItr != _properties.end())
-        {
-            return _propertiesItr->second.c_str();
-        }
+        int length = 0;
+        if (sscanf(value, "%f%n", &values[count], &length) != 1)
+            break;
+        count++;
+        value += length;
+        if (*value != ',')
+            break;
+        value++;
     }
+    return count;
+}
 
-    return NULL;
+Properties::Type Properties::getType(const char* name) const
+{
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    return property ? (Properties::Type)property->type : Properties::NONE;
+}
+
+const char* Properties::getString(const char* name) const
+{
+    Property record;
+    const Property* property = findProperty(name, &record);
+    return property ? property->value : NULL;
 }
 
 bool Properties::updateString(const char* name, const char* value)
 {
-    std::map<std::string, std::string>::iterator itr = _properties.find(name);
-    if (itr != _properties.end())
+    copyCompiledProperties();
+    Property* property = const_cast<Property*>(findProperty(name, NULL));
+    if (property)
     {
-		itr->second.assign(value);
+        GP_ASSERT(_storage);
+        property->value = _storage->copy(value);
+        property->values = NULL;
+        property->valueCount = 0;
+        property->type = NONE;
 		return true;
 	}
 
@@ -761,18 +1181,16 @@ bool Properties::updateInt(const char* name, int value)
 
 float Properties::getFloat(const char* name) const
 {
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float value;
-        int scanned;
-        scanned = sscanf(valueString, "%f", &value);
-        if (scanned != 1)
+        if (property->valueCount < 1)
         {
             GP_ERROR("Error attempting to parse property '%s' as a float.", name);
             return 0.0f;
         }
-        return value;
+        return property->values[0];
     }
 
     return 0.0f;
@@ -815,23 +1233,18 @@ bool Properties::getMatrix(const char* name, Matrix* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float m[16];
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f",
-                &m[0], &m[1], &m[2], &m[3], &m[4], &m[5], &m[6], &m[7],
-                &m[8], &m[9], &m[10], &m[11], &m[12], &m[13], &m[14], &m[15]);
-
-        if (scanned != 16)
+        if (property->valueCount < 16)
         {
             GP_ERROR("Error attempting to parse property '%s' as a matrix.", name);
             out->setIdentity();
             return false;
         }
 
-        out->set(m);
+        out->set(property->values);
         return true;
     }
 
@@ -843,20 +1256,19 @@ bool Properties::getVector2(const char* name, Vector2* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float x, y;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f", &x, &y);
-        if (scanned != 2)
+        if (property->valueCount < 2)
         {
             GP_ERROR("Error attempting to parse property '%s' as a two-dimensional vector.", name);
             out->set(0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y);
+        const float* values = property->values;
+        out->set(values[0], values[1]);
         return true;
     }
     
@@ -868,20 +1280,19 @@ bool Properties::getVector3(const char* name, Vector3* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float x, y, z;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f", &x, &y, &z);
-        if (scanned != 3)
+        if (property->valueCount < 3)
         {
             GP_ERROR("Error attempting to parse property '%s' as a three-dimensional vector.", name);
             out->set(0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y, z);
+        const float* values = property->values;
+        out->set(values[0], values[1], values[2]);
         return true;
     }
     
@@ -893,20 +1304,19 @@ bool Properties::getVector4(const char* name, Vector4* out) const
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float x, y, z, w;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f", &x, &y, &z, &w);
-        if (scanned != 4)
+        if (property->valueCount < 4)
         {
             GP_ERROR("Error attempting to parse property '%s' as a four-dimensional vector.", name);
             out->set(0.0f, 0.0f, 0.0f, 0.0f);
             return false;
         }
 
-        out->set(x, y, z, w);
+        const float* values = property->values;
+        out->set(values[0], values[1], values[2], values[3]);
         return true;
     }
     
@@ -918,20 +1328,19 @@ bool Properties::getQuaternionFromAxisAngle(const char* name, Quaternion* out) c
 {
     GP_ASSERT(out);
 
-    const char* valueString = getString(name);
-    if (valueString)
+    Property record;
+    const Property* property = convertProperty(name, &record);
+    if (property)
     {
-        float x, y, z, theta;
-        int scanned;
-        scanned = sscanf(valueString, "%f,%f,%f,%f", &x, &y, &z, &theta);
-        if (scanned != 4)
+        if (property->valueCount < 4)
         {
             GP_ERROR("Error attempting to parse property '%s' as an axis-angle rotation.", name);
             out->set(0.0f, 0.0f, 0.0f, 1.0f);
             return false;
         }
 
-        out->set(Vector3(x, y, z), MATH_DEG_TO_RAD(theta));
+        const float* values = property->values;
+        out->set(Vector3(values[0], values[1], values[2]), MATH_DEG_TO_RAD(values[3]));
         return true;
     }
     
@@ -1200,7 +1609,13 @@ Properties* Properties::clone()
     p->_id = _id;
     p->_parentID = _parentID;
     p->_properties = _properties;
-    p->_propertiesItr = p->_properties.end();
+    p->_compiledProperties = _compiledProperties;
+    p->_compiledCount = _compiledCount;
+    p->_storage = _storage;
+    if (_storage)
+    {
+        _storage->addRef();
+    }
     p->setDirectoryPath(_dirPath);
 
     for (size_t i = 0, count = _namespaces.size(); i < count; i++)
@@ -1211,10 +1626,143 @@ Properties* Properties::clone()
         child->_parent = p;
     }
     p->_namespacesItr = p->_namespaces.end();
+    p->rewind();
 
     return p;
 }
 
+unsigned int Properties::getPropertyCount() const
+{
+    return _compiledProperties ? _compiledCount : (unsigned int)_properties.size();
+}
+
+const Properties::Property* Properties::getProperty(unsigned int index, Property* record) const
+{
+    if (_compiledProperties == NULL)
+        return &_properties[index];
+
+    // Fill the record from the compiled file, without copying the strings or numbers.
+    GP_ASSERT(record && _storage);
+    const CompiledProperty& compiled = _compiledProperties[index];
+    record->name = _storage->getString(compiled.name);
+    record->value = _storage->getString(compiled.value);
+    record->values = _storage->values + compiled.firstValue;
+    record->valueCount = compiled.valueCount;
+    record->type = compiled.type;
+    return record;
+}
+
+const Properties::Property* Properties::findProperty(const char* name, Property* record) const
+{
+    unsigned int count = getPropertyCount();
+    if (name == NULL)
+    {
+        return _propertyIndex < count ? getProperty(_propertyIndex, record) : NULL;
+    }
+
+    // The properties are sorted by name.
+    unsigned int first = 0;
+    unsigned int last = count;
+    if (_compiledProperties)
+    {
+        const char* strings = _storage->strings;
+        while (first < last)
+        {
+            unsigned int middle = first + (last - first) / 2;
+            int result = strcmp(strings + _compiledProperties[middle].name, name);
+            if (result == 0)
+                return getProperty(middle, record);
+            if (result < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return NULL;
+    }
+    while (first < last)
+    {
+        unsigned int middle = first + (last - first) / 2;
+        int result = strcmp(_properties[middle].name, name);
+        if (result == 0)
+            return &_properties[middle];
+        if (result < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return NULL;
+}
+
+const Properties::Property* Properties::convertProperty(const char* name, Property* record) const
+{
+    // The values of compiled files are converted when they are compiled.
+    const Property* property = findProperty(name, record);
+    if (property == NULL || property->type != NONE)
+        return property;
+
+    // Convert the value once, and keep the numbers in the storage.
+    GP_ASSERT(_storage);
+    float values[PROPERTIES_MAX_VALUES];
+    property->valueCount = (unsigned short)readValues(property->value, values);
+    property->values = property->valueCount > 0 ? _storage->copy(values, property->valueCount) : NULL;
+    property->type = (unsigned short)getValueType(property->value);
+    return property;
+}
+
+Properties::Property* Properties::setProperty(const char* name, const char* value)
+{
+    GP_ASSERT(name && value);
+    copyCompiledProperties();
+
+    // Names are interned, so equal names usually have the same address.
+    unsigned int first = 0;
+    unsigned int last = (unsigned int)_properties.size();
+    int result = 1;
+    while (first < last)
+    {
+        unsigned int middle = first + (last - first) / 2;
+        result = _properties[middle].name == name ? 0 : strcmp(_properties[middle].name, name);
+        if (result == 0)
+        {
+            first = middle;
+            break;
+        }
+        if (result < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    std::vector<Property>::iterator itr = _properties.begin() + first;
+    if (result != 0)
+    {
+        Property property;
+        property.name = name;
+        itr = _properties.insert(itr, property);
+    }
+
+    itr->value = value;
+    itr->values = NULL;
+    itr->valueCount = 0;
+    itr->type = NONE;
+    return &*itr;
+}
+
+void Properties::copyCompiledProperties()
+{
+    if (_compiledProperties == NULL)
+        return;
+
+    // The strings and numbers stay in the storage.
+    _properties.resize(_compiledCount);
+    for (unsigned int i = 0; i < _compiledCount; ++i)
+    {
+        getProperty(i, &_properties[i]);
+    }
+    _compiledProperties = NULL;
+    _compiledCount = 0;
+}
+
 void Properties::setDirectoryPath(const std::string* path)
 {
     if (path)
@@ -123,7 +123,15 @@ class Properties;
  * Note that this method does not keep track of the namespace hierarchy, but could be
  * modified to do so.  Also note that nothing in a properties file indicates the type
  * of a property. If the type is unknown, its string can be retrieved and interpreted
- * as necessary.
+ * as necessary. A value is converted to numbers the first time it is read as a number,
+ * vector or matrix, and the numbers are kept, so reading it again does not parse it.
+ *
+ * A properties file can be compiled by gameplay-encoder into a binary file with the
+ * same path and the ".gpp" extension appended (such as "box.material.gpp"). When the
+ * compiled file is present, create() reads it instead of the text file: its namespaces
+ * are already parsed and inherited, and its numbers and vectors are already converted,
+ * so its strings and numbers are read in place without parsing or copying. The compiled
+ * file takes precedence, so it must be rebuilt when the text file changes.
  */
 class Properties
 {
@@ -430,6 +438,83 @@ private:
      */
     Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent);
 
+    /**
+     * The strings and numbers of a properties file, shared by all of its namespaces
+     * (defined in the implementation).
+     */
+    class Storage;
+
+    /**
+     * A property of a compiled properties file (defined in the implementation).
+     */
+    struct CompiledProperty;
+
+    /**
+     * A property. The name is interned in the storage of the file, so equal names
+     * usually share an address, and the value is converted to numbers when first needed.
+     */
+    struct Property
+    {
+        const char* name;
+        const char* value;
+        mutable const float* values;            // The numbers at the start of the value.
+        mutable unsigned short valueCount;      // The number of values.
+        mutable unsigned short type;            // The type of the value, or NONE until it is converted.
+    };
+
+    /**
+     * Constructor. Creates a namespace of a compiled properties file, and its nested namespaces.
+     */
+    Properties(Storage* storage, unsigned int index, Properties* parent);
+
+    /**
+     * Reads a compiled properties file.
+     *
+     * @return The root namespace, or NULL if the file could not be read.
+     */
+    static Properties* createCompiled(const char* path);
+
+    /**
+     * Returns the number of properties.
+     */
+    unsigned int getPropertyCount() const;
+
+    /**
+     * Returns a property by index.
+     *
+     * @param index The index of the property.
+     * @param record Filled with the property when it is read in place from a compiled file.
+     */
+    const Property* getProperty(unsigned int index, Property* record) const;
+
+    /**
+     * Returns a property, or the current property if name is NULL.
+     *
+     * The properties are sorted by name, so they are found by binary search.
+     *
+     * @param name The name of the property.
+     * @param record Filled with the property when it is read in place from a compiled file.
+     */
+    const Property* findProperty(const char* name, Property* record) const;
+
+    /**
+     * Returns a property with its value converted, or NULL if there is no such property.
+     */
+    const Property* convertProperty(const char* name, Property* record) const;
+
+    /**
+     * Copies the properties of a compiled file into the namespace, before they are modified.
+     */
+    void copyCompiledProperties();
+
+    /**
+     * Adds a property, or replaces the value of the property with the same name.
+     *
+     * @param name The name, interned in the storage.
+     * @param value The value, in the storage.
+     */
+    Property* setProperty(const char* name, const char* value);
+
     void readProperties(Stream* stream);
 
     void skipWhiteSpace(Stream* stream);
@@ -448,12 +533,15 @@ private:
     std::string _namespace;
     std::string _id;
     std::string _parentID;
-    std::map<std::string, std::string> _properties;
-    std::map<std::string, std::string>::const_iterator _propertiesItr;
+    std::vector<Property> _properties;      // The properties, sorted by name.
+    const CompiledProperty* _compiledProperties; // The properties read in place from a compiled file, or NULL.
+    unsigned int _compiledCount;            // The number of properties read in place.
+    unsigned int _propertyIndex;            // The current property, or the property count before the first one.
     std::vector<Properties*> _namespaces;
     std::vector<Properties*>::const_iterator _namespacesItr;
     std::string* _dirPath;
     Properties* _parent;
+    Storage* _storage;                      // The strings and numbers of the properties, or NULL.
 };
 
 }
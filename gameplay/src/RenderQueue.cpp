@@ -0,0 +1,306 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Camera.h"
+#include "Material.h"
+#include "MeshPart.h"
+#include "Model.h"
+#include "Node.h"
+#include "Scene.h"
+
+// Sort key layout, from the most significant bit.
+#define RENDER_QUEUE_LAYER_SHIFT        56
+#define RENDER_QUEUE_BLENDED_SHIFT      55
+#define RENDER_QUEUE_PASS_SHIFT         52
+#define RENDER_QUEUE_PASS_MAX           7
+#define RENDER_QUEUE_EFFECT_SHIFT       36
+#define RENDER_QUEUE_MATERIAL_SHIFT     20
+#define RENDER_QUEUE_DEPTH_BITS         20
+
+namespace gameplay
+{
+
+// Folds a pointer into the given number of bits (Fibonacci hashing).
+static unsigned long long hashPointer(const void* pointer, unsigned int bits)
+{
+    unsigned long long value = (unsigned long long)(size_t)pointer;
+    return ((value >> 4) * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+}
+
+RenderQueue::RenderQueue()
+    : _camera(NULL), _drawCallCount(0), _stateChangeCount(0), _bindsSavedCount(0)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+RenderQueue* RenderQueue::create()
+{
+    return new RenderQueue();
+}
+
+void RenderQueue::begin(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    _camera = camera;
+    _packets.clear();
+    _keys.clear();
+    _drawCallCount = 0;
+    _stateChangeCount = 0;
+    _bindsSavedCount = 0;
+}
+
+void RenderQueue::submit(Model* model, unsigned char layer)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(_camera);
+
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+
+    // Quantize the view depth of the model's bounds.
+    unsigned int depth = 0;
+    Node* node = model->getNode();
+    if (node)
+    {
+        Vector3 center;
+        _camera->getViewMatrix().transformPoint(node->getBoundingSphere().center, &center);
+        float farPlane = _camera->getFarPlane();
+        float z = farPlane > 0.0f ? -center.z / farPlane : 0.0f;
+        z = z < 0.0f ? 0.0f : (z > 1.0f ? 1.0f : z);
+        depth = (unsigned int)(z * ((1 << RENDER_QUEUE_DEPTH_BITS) - 1));
+    }
+
+    unsigned int partCount = mesh->getPartCount();
+    for (unsigned int i = 0, count = partCount > 0 ? partCount : 1; i < count; ++i)
+    {
+        // Meshes without parts are drawn with the model's shared material.
+        Material* material = model->getMaterial(partCount > 0 ? (int)i : -1);
+        if (material == NULL)
+            continue;
+
+        Technique* technique = material->getTechnique();
+        GP_ASSERT(technique);
+        MeshPart* part = partCount > 0 ? mesh->getPart(i) : NULL;
+        for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+        {
+            addPacket(model, part, technique->getPassByIndex(j), j, depth, layer);
+        }
+    }
+}
+
+void RenderQueue::submit(Scene* scene, unsigned char layer)
+{
+    GP_ASSERT(scene);
+    GP_ASSERT(_camera);
+
+    _visibleNodes.clear();
+    scene->findVisibleNodes(_camera->getFrustum(), _visibleNodes);
+    for (size_t i = 0, count = _visibleNodes.size(); i < count; ++i)
+    {
+        Model* model = _visibleNodes[i]->getModel();
+        if (model)
+        {
+            submit(model, layer);
+        }
+    }
+}
+
+void RenderQueue::addPacket(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, unsigned int depth, unsigned char layer)
+{
+    GP_ASSERT(pass);
+
+    Packet packet;
+    packet.model = model;
+    packet.part = part;
+    packet.pass = pass;
+    _packets.push_back(packet);
+
+    unsigned long long key = (unsigned long long)layer << RENDER_QUEUE_LAYER_SHIFT;
+    key |= (unsigned long long)min(passIndex, (unsigned int)RENDER_QUEUE_PASS_MAX) << RENDER_QUEUE_PASS_SHIFT;
+    const void* material = pass->_parent ? pass->_parent->_parent : NULL;
+    if (pass->isBlendEnabled())
+    {
+        // Blended packets are drawn back to front after the opaque ones.
+        unsigned int farDepth = ((1 << RENDER_QUEUE_DEPTH_BITS) - 1) - depth;
+        key |= 1ULL << RENDER_QUEUE_BLENDED_SHIFT;
+        key |= (unsigned long long)farDepth << (RENDER_QUEUE_PASS_SHIFT - RENDER_QUEUE_DEPTH_BITS);
+        key |= hashPointer(material, RENDER_QUEUE_MATERIAL_SHIFT);
+    }
+    else
+    {
+        // Opaque packets are grouped by effect and material, then drawn front to back.
+        key |= hashPointer(pass->getEffect(), RENDER_QUEUE_PASS_SHIFT - RENDER_QUEUE_EFFECT_SHIFT) << RENDER_QUEUE_EFFECT_SHIFT;
+        key |= hashPointer(material, RENDER_QUEUE_EFFECT_SHIFT - RENDER_QUEUE_MATERIAL_SHIFT) << RENDER_QUEUE_MATERIAL_SHIFT;
+        key |= depth;
+    }
+    _keys.push_back(key);
+}
+
+void RenderQueue::sort()
+{
+    unsigned int count = (unsigned int)_keys.size();
+    _order.resize(count);
+    _sortBuffer.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        _order[i] = i;
+    }
+    if (count < 2)
+        return;
+
+    // Least significant digit radix sort of the packet indices, one byte at a time.
+    // Bytes that are the same for all keys are skipped.
+    unsigned int histogram[256];
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        memset(histogram, 0, sizeof(histogram));
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            ++histogram[(_keys[i] >> shift) & 0xFF];
+        }
+        if (histogram[(_keys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            unsigned int digitCount = histogram[i];
+            histogram[i] = offset;
+            offset += digitCount;
+        }
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int index = _order[i];
+            _sortBuffer[histogram[(_keys[index] >> shift) & 0xFF]++] = index;
+        }
+        _order.swap(_sortBuffer);
+    }
+}
+
+void RenderQueue::draw()
+{
+    GP_PROFILE_ZONE("RenderQueue::draw");
+
+    _drawCallCount = 0;
+    _stateChangeCount = 0;
+    _bindsSavedCount = 0;
+
+    sort();
+
+    Pass* currentPass = NULL;
+    VertexAttributeBinding* currentBinding = NULL;
+    IndexBufferHandle currentIndexBuffer = 0;
+    bool indexBufferBound = false;
+    for (size_t i = 0, count = _order.size(); i < count; ++i)
+    {
+        const Packet& packet = _packets[_order[i]];
+        Pass* pass = packet.pass;
+
+        Effect* effect = pass->getEffect();
+        GP_ASSERT(effect);
+        bool effectChanged = effect != Effect::getCurrentEffect();
+        if (effectChanged)
+        {
+            effect->bind();
+            ++_stateChangeCount;
+        }
+        else
+        {
+            ++_bindsSavedCount;
+        }
+
+        // A material is bound to the node of a single model, so its node-dependent auto
+        // bindings only change with the material. When the effect is unchanged, a packet
+        // that shares the pass of the previous one needs no parameter or state block binds,
+        // and one that shares its technique only needs the binds of its own pass, unless
+        // the previous pass set parameters of its own that may hide those of the technique.
+        if (effectChanged || currentPass == NULL || pass->_parent != currentPass->_parent)
+        {
+            pass->RenderState::bind(pass);
+            ++_stateChangeCount;
+        }
+        else if (pass != currentPass)
+        {
+            pass->RenderState::bind(pass, currentPass->_parameters.empty() ? pass->_parent : NULL);
+            ++_stateChangeCount;
+        }
+        else
+        {
+            ++_bindsSavedCount;
+        }
+        currentPass = pass;
+
+        VertexAttributeBinding* binding = pass->getVertexAttributeBinding();
+        if (binding != currentBinding)
+        {
+            if (currentBinding)
+                currentBinding->unbind();
+            if (binding)
+                binding->bind();
+            currentBinding = binding;
+            ++_stateChangeCount;
+
+            // With vertex array objects the element array binding is part of the VAO's
+            // state, so the index buffer must be bound again after switching VAOs.
+            indexBufferBound = false;
+        }
+        else
+        {
+            ++_bindsSavedCount;
+        }
+
+        IndexBufferHandle indexBuffer = packet.part ? packet.part->getIndexBuffer() : 0;
+        if (!indexBufferBound || indexBuffer != currentIndexBuffer)
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer) );
+            currentIndexBuffer = indexBuffer;
+            indexBufferBound = true;
+            ++_stateChangeCount;
+        }
+        else
+        {
+            ++_bindsSavedCount;
+        }
+
+        if (packet.part)
+        {
+            GL_ASSERT( glDrawElements(packet.part->getPrimitiveType(), packet.part->getIndexCount(), packet.part->getIndexFormat(), 0) );
+        }
+        else
+        {
+            Mesh* mesh = packet.model->getMesh();
+            GL_ASSERT( glDrawArrays(mesh->getPrimitiveType(), 0, mesh->getVertexCount()) );
+        }
+        ++_drawCallCount;
+    }
+
+    if (currentBinding)
+    {
+        currentBinding->unbind();
+    }
+}
+
+unsigned int RenderQueue::getPacketCount() const
+{
+    return (unsigned int)_packets.size();
+}
+
+unsigned int RenderQueue::getDrawCallCount() const
+{
+    return _drawCallCount;
+}
+
+unsigned int RenderQueue::getStateChangeCount() const
+{
+    return _stateChangeCount;
+}
+
+unsigned int RenderQueue::getBindsSavedCount() const
+{
+    return _bindsSavedCount;
+}
+
+}
@@ -0,0 +1,168 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+class Camera;
+class MeshPart;
+class Model;
+class Node;
+class Pass;
+class Scene;
+
+/**
+ * Defines a queue of draw packets that are sorted to minimize state changes before being drawn.
+ *
+ * Drawing models in scene traversal order switches effects, vertex bindings and
+ * render states between unrelated materials. A render queue instead collects one
+ * packet per mesh part and pass, each with a 64-bit sort key made of (from the most
+ * to the least significant bits):
+ *
+ * - the layer the model was submitted with;
+ * - whether the pass is blended (blended packets are drawn after opaque ones);
+ * - the index of the pass in its technique;
+ * - for opaque packets, the effect, the material and then the depth front to back;
+ * - for blended packets, the depth back to front and then the material.
+ *
+ * The packets are radix sorted and drawn in key order. Effect, vertex attribute
+ * binding and index buffer binds are skipped when consecutive packets share them.
+ * The parameters and state blocks of a pass are bound again for each packet unless
+ * the previous packet used the same pass with the same effect, as the mesh parts of
+ * a model with a shared material do. A pass that follows another pass of the same
+ * technique with the same effect only binds its own parameters and state block.
+ *
+ * Models are not referenced by the queue and must remain valid until draw() returns.
+ */
+class RenderQueue : public Ref
+{
+public:
+
+    /**
+     * Creates an empty render queue.
+     *
+     * @return The new render queue.
+     */
+    static RenderQueue* create();
+
+    /**
+     * Clears the queue and its counters and starts collecting packets for the given camera.
+     *
+     * The camera is used to compute the depth of submitted models and to cull the
+     * models of submitted scenes.
+     *
+     * @param camera The camera the packets are drawn with.
+     */
+    void begin(Camera* camera);
+
+    /**
+     * Submits the mesh parts of a model.
+     *
+     * @param model The model to submit.
+     * @param layer The layer of the model. Lower layers are drawn first.
+     */
+    void submit(Model* model, unsigned char layer = 0);
+
+    /**
+     * Submits the models of all nodes of a scene that intersect the view frustum of the camera.
+     *
+     * The models are found with the spatial index of the scene (see Scene::findVisibleNodes()).
+     *
+     * @param scene The scene to submit.
+     * @param layer The layer of the models. Lower layers are drawn first.
+     */
+    void submit(Scene* scene, unsigned char layer = 0);
+
+    /**
+     * Sorts and draws the submitted packets.
+     */
+    void draw();
+
+    /**
+     * Returns the number of packets submitted since begin() was called.
+     *
+     * @return The number of packets.
+     */
+    unsigned int getPacketCount() const;
+
+    /**
+     * Returns the number of draw calls issued by the last call to draw().
+     *
+     * @return The number of draw calls.
+     */
+    unsigned int getDrawCallCount() const;
+
+    /**
+     * Returns the number of effect, render state, vertex attribute binding and index
+     * buffer binds issued by the last call to draw().
+     *
+     * @return The number of state changes.
+     */
+    unsigned int getStateChangeCount() const;
+
+    /**
+     * Returns the number of effect, render state, vertex attribute binding and index
+     * buffer binds skipped by the last call to draw() because the previous packet shared them.
+     *
+     * @return The number of binds saved.
+     */
+    unsigned int getBindsSavedCount() const;
+
+private:
+
+    /**
+     * A single draw of a mesh part (or of a whole mesh without parts) with one pass.
+     */
+    struct Packet
+    {
+        Model* model;
+        MeshPart* part;
+        Pass* pass;
+    };
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    /**
+     * Adds a packet to the queue.
+     */
+    void addPacket(Model* model, MeshPart* part, Pass* pass, unsigned int passIndex, unsigned int depth, unsigned char layer);
+
+    /**
+     * Sorts the packet order by key.
+     */
+    void sort();
+
+    Camera* _camera;                            // The camera packets are collected for.
+    std::vector<Packet> _packets;               // The submitted packets.
+    std::vector<unsigned long long> _keys;      // The sort key of each packet.
+    std::vector<unsigned int> _order;           // Packet indices in draw order.
+    std::vector<unsigned int> _sortBuffer;      // Scratch space for sorting.
+    std::vector<Node*> _visibleNodes;           // Scratch space for the visible nodes of a scene.
+    unsigned int _drawCallCount;                // Draw calls issued by the last draw().
+    unsigned int _stateChangeCount;             // Binds issued by the last draw().
+    unsigned int _bindsSavedCount;              // Binds skipped by the last draw().
+};
+
+}
+
+#endif
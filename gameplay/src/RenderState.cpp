@@ -410,7 +410,7 @@ const Vector3& RenderState::autoBindingGetLightDirection() const
     return scene ? scene->getLightDirection() : down;
 }
 
-void RenderState::bind(Pass* pass)
+void RenderState::bind(Pass* pass, RenderState* bound)
 {
     GP_ASSERT(pass);
 
@@ -429,8 +429,8 @@ void RenderState::bind(Pass* pass)
     // Restore renderer state to its default, except for explicitly specified states
     StateBlock::restore(stateOverrideBits);
 
-    // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
-    rs = NULL;
+    // Apply parameter bindings and renderer state for the hierarchy below the bound ancestor, top-down.
+    rs = bound;
     Effect* effect = pass->getEffect();
     while ((rs = getTopmost(rs)))
     {
@@ -469,6 +469,19 @@ RenderState* RenderState::getTopmost(RenderState* below)
     return NULL;
 }
 
+bool RenderState::isBlendEnabled() const
+{
+    // States lower in the hierarchy are bound last, so the first one that sets blending wins.
+    for (const RenderState* rs = this; rs != NULL; rs = rs->_parent)
+    {
+        if (rs->_state && (rs->_state->_bits & RS_BLEND))
+        {
+            return rs->_state->_blendEnabled;
+        }
+    }
+    return false;
+}
+
 void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context) const
 {
     GP_ASSERT(renderState);
@@ -23,6 +23,8 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class InstancedModel;
+    friend class RenderQueue;
 
 public:
 
@@ -580,14 +582,23 @@ protected:
     /**
      * Binds the render state for this RenderState and any of its parents, top-down, 
      * for the given pass.
+     *
+     * The parameters and state of the given ancestor and of its own parents are left
+     * as they are, which is only valid when they were just bound with the same effect.
      */
-    void bind(Pass* pass);
+    void bind(Pass* pass, RenderState* bound = NULL);
 
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
      */
     RenderState* getTopmost(RenderState* below);
 
+    /**
+     * Determines if blending is enabled by the state block of this RenderState
+     * or, if it does not set blending, by the closest parent that does.
+     */
+    bool isBlendEnabled() const;
+
     /**
      * Copies the data from this RenderState into the given RenderState.
      * 
@@ -0,0 +1,319 @@
+#include "Base.h"
+#include "ResourceCache.h"
+
+// Initial number of buckets of a cache (a power of two).
+#define RESOURCECACHE_INITIAL_BUCKETS   64
+
+namespace gameplay
+{
+
+// List of all caches, so the resources they reference can be released at shutdown.
+static ResourceCacheBase* __caches = NULL;
+
+ResourceCacheBase::ResourceCacheBase()
+    : _freeList(-1), _mostRecentlyUsed(-1), _leastRecentlyUsed(-1), _entryCount(0), _hitCount(0), _missCount(0),
+    _memoryUsage(0), _memoryBudget(0), _nextCache(__caches)
+{
+    _keyBuckets.resize(RESOURCECACHE_INITIAL_BUCKETS, -1);
+    _resourceBuckets.resize(RESOURCECACHE_INITIAL_BUCKETS, -1);
+    __caches = this;
+}
+
+ResourceCacheBase::~ResourceCacheBase()
+{
+    // Caches are destroyed at exit, after the game released the resources they reference.
+    for (ResourceCacheBase** cache = &__caches; *cache; cache = &(*cache)->_nextCache)
+    {
+        if (*cache == this)
+        {
+            *cache = _nextCache;
+            break;
+        }
+    }
+}
+
+void ResourceCacheBase::finalize()
+{
+    for (ResourceCacheBase* cache = __caches; cache; cache = cache->_nextCache)
+    {
+        cache->_memoryBudget = 0;
+        cache->clear();
+    }
+}
+
+unsigned int ResourceCacheBase::hashKey(const void* key, unsigned int keySize)
+{
+    // FNV-1a
+    const unsigned char* bytes = (const unsigned char*)key;
+    unsigned int hash = 2166136261u;
+    for (unsigned int i = 0; i < keySize; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+unsigned int ResourceCacheBase::hashResource(const Ref* resource)
+{
+    size_t address = (size_t)resource;
+    unsigned int hash = (unsigned int)(address >> 4) ^ (unsigned int)((unsigned long long)address >> 32);
+    return hash * 2654435761u;
+}
+
+unsigned int ResourceCacheBase::getEntryCount() const
+{
+    return _entryCount;
+}
+
+unsigned int ResourceCacheBase::getHitCount() const
+{
+    return _hitCount;
+}
+
+unsigned int ResourceCacheBase::getMissCount() const
+{
+    return _missCount;
+}
+
+void ResourceCacheBase::resetStatistics()
+{
+    _hitCount = 0;
+    _missCount = 0;
+}
+
+size_t ResourceCacheBase::getMemoryUsage() const
+{
+    return _memoryUsage;
+}
+
+size_t ResourceCacheBase::getMemoryBudget() const
+{
+    return _memoryBudget;
+}
+
+void ResourceCacheBase::setMemoryBudget(size_t budget)
+{
+    _memoryBudget = budget;
+    if (budget == 0)
+    {
+        // Give up the references held by the cache, from the least recently used resource.
+        int index = _leastRecentlyUsed;
+        while (index >= 0)
+        {
+            int previous = _entries[index].previousUsed;
+            if (_entries[index].retained)
+                evict(index);
+            index = previous;
+        }
+    }
+    else
+    {
+        trim();
+    }
+}
+
+void ResourceCacheBase::trim()
+{
+    int index = _leastRecentlyUsed;
+    while (index >= 0 && _memoryUsage > _memoryBudget)
+    {
+        int previous = _entries[index].previousUsed;
+        const Entry& entry = _entries[index];
+        if (entry.retained && entry.resource->getRefCount() == 1)
+            evict(index);
+        index = previous;
+    }
+}
+
+void ResourceCacheBase::clear()
+{
+    while (_mostRecentlyUsed >= 0)
+    {
+        int index = _mostRecentlyUsed;
+        if (_entries[index].retained)
+        {
+            evict(index);
+        }
+        else
+        {
+            unlink(index);
+        }
+    }
+}
+
+Ref* ResourceCacheBase::findResource(const void* key, unsigned int keySize)
+{
+    GP_ASSERT(key || keySize == 0);
+
+    unsigned int hash = hashKey(key, keySize);
+    for (int index = _keyBuckets[hash & (_keyBuckets.size() - 1)]; index >= 0; index = _entries[index].nextByKey)
+    {
+        const Entry& entry = _entries[index];
+        if (entry.hash == hash && entry.key.size() == keySize && memcmp(entry.key.data(), key, keySize) == 0)
+        {
+            ++_hitCount;
+            touch(index);
+            return entry.resource;
+        }
+    }
+
+    ++_missCount;
+    return NULL;
+}
+
+void ResourceCacheBase::insertResource(const void* key, unsigned int keySize, Ref* resource, size_t size)
+{
+    GP_ASSERT(key || keySize == 0);
+    GP_ASSERT(resource);
+
+    if (_entryCount >= _keyBuckets.size())
+        rehash();
+
+    int index = _freeList;
+    if (index >= 0)
+    {
+        _freeList = _entries[index].nextByKey;
+    }
+    else
+    {
+        index = (int)_entries.size();
+        _entries.push_back(Entry());
+    }
+
+    Entry& entry = _entries[index];
+    entry.key.assign((const char*)key, keySize);
+    entry.hash = hashKey(key, keySize);
+    entry.resource = resource;
+    entry.size = size;
+    entry.retained = _memoryBudget > 0;
+    if (entry.retained)
+        resource->addRef();
+
+    unsigned int keyBucket = entry.hash & (_keyBuckets.size() - 1);
+    entry.nextByKey = _keyBuckets[keyBucket];
+    _keyBuckets[keyBucket] = index;
+    unsigned int resourceBucket = hashResource(resource) & (_resourceBuckets.size() - 1);
+    entry.nextByResource = _resourceBuckets[resourceBucket];
+    _resourceBuckets[resourceBucket] = index;
+
+    entry.previousUsed = -1;
+    entry.nextUsed = _mostRecentlyUsed;
+    if (_mostRecentlyUsed >= 0)
+        _entries[_mostRecentlyUsed].previousUsed = index;
+    else
+        _leastRecentlyUsed = index;
+    _mostRecentlyUsed = index;
+
+    ++_entryCount;
+    _memoryUsage += size;
+
+    if (_memoryBudget > 0)
+        trim();
+}
+
+bool ResourceCacheBase::removeResource(Ref* resource)
+{
+    if (resource == NULL)
+        return false;
+
+    for (int index = _resourceBuckets[hashResource(resource) & (_resourceBuckets.size() - 1)]; index >= 0; index = _entries[index].nextByResource)
+    {
+        if (_entries[index].resource == resource)
+        {
+            unlink(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResourceCacheBase::rehash()
+{
+    unsigned int bucketCount = (unsigned int)_keyBuckets.size() * 2;
+    _keyBuckets.assign(bucketCount, -1);
+    _resourceBuckets.assign(bucketCount, -1);
+
+    for (int index = _mostRecentlyUsed; index >= 0; index = _entries[index].nextUsed)
+    {
+        Entry& entry = _entries[index];
+        unsigned int keyBucket = entry.hash & (bucketCount - 1);
+        entry.nextByKey = _keyBuckets[keyBucket];
+        _keyBuckets[keyBucket] = index;
+        unsigned int resourceBucket = hashResource(entry.resource) & (bucketCount - 1);
+        entry.nextByResource = _resourceBuckets[resourceBucket];
+        _resourceBuckets[resourceBucket] = index;
+    }
+}
+
+void ResourceCacheBase::unlink(int index)
+{
+    Entry& entry = _entries[index];
+    GP_ASSERT(entry.resource);
+
+    int* link = &_keyBuckets[entry.hash & (_keyBuckets.size() - 1)];
+    while (*link != index)
+        link = &_entries[*link].nextByKey;
+    *link = entry.nextByKey;
+
+    link = &_resourceBuckets[hashResource(entry.resource) & (_resourceBuckets.size() - 1)];
+    while (*link != index)
+        link = &_entries[*link].nextByResource;
+    *link = entry.nextByResource;
+
+    if (entry.previousUsed >= 0)
+        _entries[entry.previousUsed].nextUsed = entry.nextUsed;
+    else
+        _mostRecentlyUsed = entry.nextUsed;
+    if (entry.nextUsed >= 0)
+        _entries[entry.nextUsed].previousUsed = entry.previousUsed;
+    else
+        _leastRecentlyUsed = entry.previousUsed;
+
+    --_entryCount;
+    _memoryUsage -= entry.size;
+
+    entry.key.clear();
+    entry.resource = NULL;
+    entry.nextByKey = _freeList;
+    _freeList = index;
+}
+
+void ResourceCacheBase::touch(int index)
+{
+    if (index == _mostRecentlyUsed)
+        return;
+
+    Entry& entry = _entries[index];
+    _entries[entry.previousUsed].nextUsed = entry.nextUsed;
+    if (entry.nextUsed >= 0)
+        _entries[entry.nextUsed].previousUsed = entry.previousUsed;
+    else
+        _leastRecentlyUsed = entry.previousUsed;
+
+    entry.previousUsed = -1;
+    entry.nextUsed = _mostRecentlyUsed;
+    _entries[_mostRecentlyUsed].previousUsed = index;
+    _mostRecentlyUsed = index;
+}
+
+void ResourceCacheBase::evict(int index)
+{
+    Entry& entry = _entries[index];
+    Ref* resource = entry.resource;
+    if (entry.retained && resource->getRefCount() > 1)
+    {
+        // The resource is still used: keep it cached until its last reference is released.
+        entry.retained = false;
+        resource->release();
+        return;
+    }
+
+    // Unlink first so the destructor of the resource does not find it in the cache.
+    bool retained = entry.retained;
+    unlink(index);
+    if (retained)
+        resource->release();
+}
+
+}
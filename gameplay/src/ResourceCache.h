@@ -0,0 +1,271 @@
+#ifndef RESOURCECACHE_H_
+#define RESOURCECACHE_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines the untyped implementation of ResourceCache.
+ *
+ * Entries are stored in a hash table keyed on the hash of their key bytes, so finding,
+ * inserting and removing an entry takes constant time regardless of the number of
+ * cached resources. A second hash table indexes the entries by resource so resources
+ * can remove themselves from their cache when they are destroyed.
+ *
+ * By default a cache does not reference its resources: a resource is removed from the
+ * cache when its last reference is released. Once a memory budget is set, resources
+ * inserted into the cache are also referenced by it, so they stay loaded after the game
+ * releases them. When the estimated size of the cached resources exceeds the budget,
+ * the least recently used resources that are only referenced by the cache are released.
+ *
+ * @script{ignore}
+ */
+class ResourceCacheBase
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Returns the number of resources in the cache.
+     *
+     * @return The number of resources.
+     */
+    unsigned int getEntryCount() const;
+
+    /**
+     * Returns the number of lookups that found a resource since the statistics were reset.
+     *
+     * @return The number of cache hits.
+     */
+    unsigned int getHitCount() const;
+
+    /**
+     * Returns the number of lookups that did not find a resource since the statistics were reset.
+     *
+     * @return The number of cache misses.
+     */
+    unsigned int getMissCount() const;
+
+    /**
+     * Resets the hit and miss counts.
+     */
+    void resetStatistics();
+
+    /**
+     * Returns the estimated size of the resources in the cache.
+     *
+     * @return The size of the cached resources, in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Returns the memory budget of the cache.
+     *
+     * @return The memory budget, in bytes, or zero if the cache does not keep resources loaded.
+     */
+    size_t getMemoryBudget() const;
+
+    /**
+     * Sets the memory budget of the cache.
+     *
+     * A budget of zero (the default) stops the cache from referencing its resources
+     * and releases the references it holds.
+     *
+     * @param budget The memory budget, in bytes.
+     */
+    void setMemoryBudget(size_t budget);
+
+    /**
+     * Releases the least recently used resources that are only referenced by the cache
+     * until the memory usage is within the budget.
+     *
+     * This is called whenever a resource is inserted into the cache.
+     */
+    void trim();
+
+    /**
+     * Removes all resources from the cache, releasing the ones it references.
+     */
+    void clear();
+
+protected:
+
+    /**
+     * Constructor.
+     */
+    ResourceCacheBase();
+
+    /**
+     * Destructor.
+     */
+    ~ResourceCacheBase();
+
+    /**
+     * Returns the resource cached with a key, or NULL.
+     */
+    Ref* findResource(const void* key, unsigned int keySize);
+
+    /**
+     * Adds a resource to the cache.
+     */
+    void insertResource(const void* key, unsigned int keySize, Ref* resource, size_t size);
+
+    /**
+     * Removes a resource from the cache without releasing it.
+     */
+    bool removeResource(Ref* resource);
+
+private:
+
+    /**
+     * A cached resource.
+     */
+    struct Entry
+    {
+        std::string key;            // The key bytes.
+        unsigned int hash;          // The hash of the key.
+        Ref* resource;              // The resource, or NULL for unused entries.
+        size_t size;                // The estimated size of the resource, in bytes.
+        int nextByKey;              // The next entry in the key bucket, or the next unused entry.
+        int nextByResource;         // The next entry in the resource bucket.
+        int previousUsed;           // The previous entry in the least recently used list.
+        int nextUsed;               // The next entry in the least recently used list.
+        bool retained;              // Whether the cache references the resource.
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    ResourceCacheBase(const ResourceCacheBase& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ResourceCacheBase& operator=(const ResourceCacheBase&);
+
+    /**
+     * Releases the resources referenced by all caches.
+     */
+    static void finalize();
+
+    /**
+     * Returns the hash of the bytes of a key.
+     */
+    static unsigned int hashKey(const void* key, unsigned int keySize);
+
+    /**
+     * Returns the hash of the address of a resource.
+     */
+    static unsigned int hashResource(const Ref* resource);
+
+    /**
+     * Doubles the number of buckets and redistributes the entries.
+     */
+    void rehash();
+
+    /**
+     * Removes an entry from the buckets and the least recently used list.
+     */
+    void unlink(int index);
+
+    /**
+     * Moves an entry to the front of the least recently used list.
+     */
+    void touch(int index);
+
+    /**
+     * Removes an entry and releases its resource if the cache references it.
+     */
+    void evict(int index);
+
+    std::vector<Entry> _entries;            // Pool of entries.
+    std::vector<int> _keyBuckets;           // First entry of each key bucket.
+    std::vector<int> _resourceBuckets;      // First entry of each resource bucket.
+    int _freeList;                          // First unused entry, or -1.
+    int _mostRecentlyUsed;                  // Head of the least recently used list, or -1.
+    int _leastRecentlyUsed;                 // Tail of the least recently used list, or -1.
+    unsigned int _entryCount;               // Number of cached resources.
+    unsigned int _hitCount;                 // Lookups that found a resource.
+    unsigned int _missCount;                // Lookups that did not find a resource.
+    size_t _memoryUsage;                    // Estimated size of the cached resources.
+    size_t _memoryBudget;                   // Memory budget, or zero.
+    ResourceCacheBase* _nextCache;          // Next cache in the list of all caches.
+};
+
+/**
+ * Defines a cache of shared resources of one type, looked up by key.
+ *
+ * Keys are either strings, such as the path a resource was loaded from, or arbitrary
+ * bytes, such as the addresses of the objects a resource was created from. Lookups
+ * do not add a reference to the resource they find.
+ *
+ * @script{ignore}
+ */
+template <class T>
+class ResourceCache : public ResourceCacheBase
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    ResourceCache();
+
+    /**
+     * Returns the resource cached with a string key.
+     *
+     * @param key The key.
+     *
+     * @return The resource, or NULL if no resource is cached with the key.
+     */
+    T* find(const char* key);
+
+    /**
+     * Returns the resource cached with a key.
+     *
+     * @param key The key bytes.
+     * @param keySize The number of key bytes.
+     *
+     * @return The resource, or NULL if no resource is cached with the key.
+     */
+    T* find(const void* key, unsigned int keySize);
+
+    /**
+     * Adds a resource to the cache with a string key.
+     *
+     * @param key The key.
+     * @param resource The resource.
+     * @param size The estimated size of the resource, in bytes.
+     */
+    void insert(const char* key, T* resource, size_t size = 0);
+
+    /**
+     * Adds a resource to the cache.
+     *
+     * @param key The key bytes.
+     * @param keySize The number of key bytes.
+     * @param resource The resource.
+     * @param size The estimated size of the resource, in bytes.
+     */
+    void insert(const void* key, unsigned int keySize, T* resource, size_t size = 0);
+
+    /**
+     * Removes a resource from the cache without releasing it.
+     *
+     * This is typically called by the destructor of the resource.
+     *
+     * @param resource The resource.
+     *
+     * @return true if the resource was in the cache, false otherwise.
+     */
+    bool remove(T* resource);
+};
+
+}
+
+#include "ResourceCache.inl"
+
+#endif
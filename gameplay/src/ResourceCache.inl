@@ -0,0 +1,43 @@
+#include "ResourceCache.h"
+
+namespace gameplay
+{
+
+template <class T>
+ResourceCache<T>::ResourceCache()
+{
+}
+
+template <class T>
+T* ResourceCache<T>::find(const char* key)
+{
+    GP_ASSERT(key);
+    return static_cast<T*>(findResource(key, (unsigned int)strlen(key)));
+}
+
+template <class T>
+T* ResourceCache<T>::find(const void* key, unsigned int keySize)
+{
+    return static_cast<T*>(findResource(key, keySize));
+}
+
+template <class T>
+void ResourceCache<T>::insert(const char* key, T* resource, size_t size)
+{
+    GP_ASSERT(key);
+    insertResource(key, (unsigned int)strlen(key), resource, size);
+}
+
+template <class T>
+void ResourceCache<T>::insert(const void* key, unsigned int keySize, T* resource, size_t size)
+{
+    insertResource(key, keySize, resource, size);
+}
+
+template <class T>
+bool ResourceCache<T>::remove(T* resource)
+{
+    return removeResource(resource);
+}
+
+}
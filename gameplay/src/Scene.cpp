@@ -13,6 +13,9 @@ namespace gameplay
 // Global list of active scenes
 static std::vector<Scene*> __sceneList;
 
+// Minimum number of nodes in a scene before its transforms are updated in parallel
+#define SCENE_PARALLEL_TRANSFORM_NODES 1024
+
 static inline char lowercase(char c)
 {
     if (c >= 'A' && c <='Z')
@@ -61,7 +64,8 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 Scene::Scene(const char* id)
     : _id(id ? id : ""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), 
-    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL), _tags(NULL)
+    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL), _tags(NULL),
+    _hierarchyRevision(0), _flatRevision((unsigned int)-1)
 {
     __sceneList.push_back(this);
 }
@@ -82,6 +86,10 @@ Scene::~Scene()
 
     // Remove all nodes from the scene
     removeAllNodes();
+    for (size_t i = 0, count = _spatialDirtyNodes.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_spatialDirtyNodes[i]);
+    }
     SAFE_DELETE(_debugBatch);
 	SAFE_DELETE(_tags);
 
@@ -195,6 +203,75 @@ unsigned int Scene::findNodes(const char* id, std::vector<Node*>& nodes, bool re
     return count;
 }
 
+unsigned int Scene::findVisibleNodes(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    updateSpatialIndex();
+    return _spatialIndex.findNodes(frustum, nodes);
+}
+
+unsigned int Scene::findIntersectingNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    updateSpatialIndex();
+    return _spatialIndex.findNodes(sphere, nodes);
+}
+
+unsigned int Scene::findIntersectingNodes(const BoundingBox& box, std::vector<Node*>& nodes)
+{
+    updateSpatialIndex();
+    return _spatialIndex.findNodes(box, nodes);
+}
+
+Node* Scene::pickNode(const Ray& ray, float* distance)
+{
+    updateSpatialIndex();
+    return _spatialIndex.pickNode(ray, distance);
+}
+
+void Scene::updateSpatialIndex()
+{
+    if (_spatialDirtyNodes.empty())
+        return;
+
+    GP_PROFILE_ZONE("Scene::updateSpatialIndex");
+    for (size_t i = 0, count = _spatialDirtyNodes.size(); i < count; ++i)
+    {
+        // Skip nodes that were moved to another scene since they were queued.
+        Node* node = _spatialDirtyNodes[i];
+        if (node->getScene() == this)
+        {
+            node->updateSpatialProxy(&_spatialIndex);
+        }
+        SAFE_RELEASE(node);
+    }
+    _spatialDirtyNodes.clear();
+}
+
+void Scene::spatialChanged(Node* node)
+{
+    GP_ASSERT(node);
+
+    node->addRef();
+    _spatialDirtyNodes.push_back(node);
+}
+
+void Scene::addSpatialProxies(Node* node)
+{
+    node->setSpatialDirty();
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        addSpatialProxies(child);
+    }
+}
+
+void Scene::removeSpatialProxies(Node* node)
+{
+    node->removeSpatialProxy(&_spatialIndex);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        removeSpatialProxies(child);
+    }
+}
+
 void Scene::visitNode(Node* node, const char* visitMethod)
 {
     ScriptController* sc = Game::getInstance()->getScriptController();
@@ -219,6 +296,206 @@ void Scene::visitNode(Node* node, const char* visitMethod)
     }
 }
 
+/**
+ * Thread pool job that computes the matrix palettes of all skins sharing a joint hierarchy.
+ *
+ * The world matrices of the joints are resolved before the jobs are run, so jobs only
+ * read them and never write to a node another job may be reading.
+ */
+class MatrixPaletteJob : public ThreadPool::Job
+{
+public:
+
+    void execute()
+    {
+        for (size_t i = 0, count = skins.size(); i < count; ++i)
+        {
+            skins[i]->getMatrixPalette();
+        }
+    }
+
+    std::vector<MeshSkin*> skins;
+};
+
+/**
+ * Resolves the world matrices of a node and of all its descendants.
+ */
+static void resolveWorldMatrices(Node* node)
+{
+    node->getWorldMatrix();
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        resolveWorldMatrices(child);
+    }
+}
+
+class Scene::TransformJob : public ThreadPool::Job
+{
+public:
+
+    TransformJob() : nodes(NULL), count(0) { }
+
+    void execute()
+    {
+        Scene::updateWorldMatrices(nodes, count);
+    }
+
+    Node* const* nodes;
+    size_t count;
+};
+
+void Scene::updateTransforms()
+{
+    GP_PROFILE_ZONE("Scene::updateTransforms");
+    if (_flatRevision != _hierarchyRevision)
+        flattenHierarchy();
+
+    size_t nodeCount = _flatNodes.size();
+    if (nodeCount == 0)
+        return;
+
+    ThreadPool* threadPool = Game::getInstance()->getThreadPool();
+    unsigned int threadCount = threadPool ? threadPool->getThreadCount() + 1 : 1;
+    if (threadCount == 1 || nodeCount < SCENE_PARALLEL_TRANSFORM_NODES || _flatSubtrees.size() < 2)
+    {
+        updateWorldMatrices(&_flatNodes[0], nodeCount);
+        return;
+    }
+
+    // Split the hierarchy into jobs of whole top level subtrees, so that every node
+    // is resolved by the same job as its parent. A few jobs per thread helps balance
+    // subtrees of different sizes.
+    size_t jobSize = nodeCount / (threadCount * 2) + 1;
+    std::vector<TransformJob> jobs;
+    size_t start = 0;
+    for (size_t i = 0, count = _flatSubtrees.size(); i < count; ++i)
+    {
+        size_t end = (i + 1 < count) ? _flatSubtrees[i + 1] : nodeCount;
+        if (end - start >= jobSize || end == nodeCount)
+        {
+            jobs.push_back(TransformJob());
+            jobs.back().nodes = &_flatNodes[start];
+            jobs.back().count = end - start;
+            start = end;
+        }
+    }
+
+    std::vector<ThreadPool::Job*> jobPointers(jobs.size());
+    for (size_t i = 0, count = jobs.size(); i < count; ++i)
+    {
+        jobPointers[i] = &jobs[i];
+    }
+    threadPool->run(&jobPointers[0], (unsigned int)jobPointers.size());
+}
+
+void Scene::flattenHierarchy()
+{
+    _flatNodes.clear();
+    _flatSubtrees.clear();
+    for (Node* node = _firstNode; node != NULL; node = node->getNextSibling())
+    {
+        _flatSubtrees.push_back(_flatNodes.size());
+        flattenNode(node);
+    }
+    _flatRevision = _hierarchyRevision;
+}
+
+void Scene::flattenNode(Node* node)
+{
+    GP_ASSERT(node);
+    _flatNodes.push_back(node);
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        flattenNode(child);
+    }
+}
+
+void Scene::updateWorldMatrices(Node* const* nodes, size_t count)
+{
+    // Parents always come before their children, so each parent's world matrix
+    // is already resolved when its children are reached.
+    for (size_t i = 0; i < count; ++i)
+    {
+        nodes[i]->updateWorldMatrix();
+    }
+}
+
+bool Scene::collectDirtySkins(Node* node)
+{
+    Model* model = node->getModel();
+    if (model && model->getSkin() && model->getSkin()->isMatrixPaletteDirty())
+    {
+        // Skip skins that are culled by the active camera. Their palettes stay dirty and are
+        // rebuilt on demand if they are drawn anyway.
+        if (_activeCamera && !_activeCamera->getFrustum().intersects(node->getBoundingSphere()))
+            return true;
+
+        _dirtySkins.push_back(model->getSkin());
+    }
+    return true;
+}
+
+void Scene::updateMatrixPalettes()
+{
+    GP_PROFILE_ZONE("Scene::updateMatrixPalettes");
+
+    // Resolve the world matrices of the whole scene first. The transform pass splits the
+    // work by top level subtree, so no two threads ever write to the same node.
+    updateTransforms();
+
+    _dirtySkins.clear();
+    visit(this, &Scene::collectDirtySkins);
+    if (_dirtySkins.empty())
+        return;
+
+    // Skins that share a joint hierarchy must be processed by the same job since
+    // computing a palette writes the cached joint matrices of its joints.
+    std::vector<MatrixPaletteJob> jobs;
+    std::map<Node*, size_t> jobIndices;
+    for (size_t i = 0, count = _dirtySkins.size(); i < count; ++i)
+    {
+        MeshSkin* skin = _dirtySkins[i];
+        std::map<Node*, size_t>::iterator itr = jobIndices.find(skin->_rootNode);
+        if (itr == jobIndices.end())
+        {
+            itr = jobIndices.insert(std::make_pair(skin->_rootNode, jobs.size())).first;
+            jobs.push_back(MatrixPaletteJob());
+
+            // Joint hierarchies that are not part of the scene were not resolved by the
+            // transform pass, so resolve them here before the jobs read them.
+            if (skin->_rootNode && skin->_rootNode->getScene() != this)
+                resolveWorldMatrices(skin->_rootNode);
+        }
+        if (skin->_rootNode == NULL)
+        {
+            for (unsigned int j = 0, jointCount = skin->getJointCount(); j < jointCount; ++j)
+            {
+                skin->getJoint(j)->getWorldMatrix();
+            }
+        }
+        jobs[itr->second].skins.push_back(skin);
+    }
+    _dirtySkins.clear();
+
+    ThreadPool* threadPool = Game::getInstance()->getThreadPool();
+    if (threadPool && jobs.size() > 1)
+    {
+        std::vector<ThreadPool::Job*> jobPointers(jobs.size());
+        for (size_t i = 0, count = jobs.size(); i < count; ++i)
+        {
+            jobPointers[i] = &jobs[i];
+        }
+        threadPool->run(&jobPointers[0], (unsigned int)jobPointers.size());
+    }
+    else
+    {
+        for (size_t i = 0, count = jobs.size(); i < count; ++i)
+        {
+            jobs[i].execute();
+        }
+    }
+}
+
 Node* Scene::addNode(const char* id)
 {
     Node* node = Node::create(id);
@@ -270,6 +547,7 @@ void Scene::addNode(Node* node)
     node->_scene = this;
 
     ++_nodeCount;
+    ++_hierarchyRevision;
 
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
@@ -280,6 +558,8 @@ void Scene::addNode(Node* node)
             setActiveCamera(camera);
         }
     }
+
+    addSpatialProxies(node);
 }
 
 void Scene::removeNode(Node* node)
@@ -5,6 +5,7 @@
 #include "MeshBatch.h"
 #include "ScriptController.h"
 #include "Light.h"
+#include "BoundingVolumeTree.h"
 
 namespace gameplay
 {
@@ -14,6 +15,8 @@ namespace gameplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+
 public:
 
     /**
@@ -96,6 +99,54 @@ public:
      */
     unsigned int findNodes(const char* id, std::vector<Node*>& nodes, bool recursive = true, bool exactMatch = true) const;
 
+    /**
+     * Finds the nodes in the scene whose bounds intersect a frustum.
+     *
+     * Only nodes with a model, terrain or light of their own are indexed; their
+     * bounds exclude their children. Use Camera::getFrustum() to find the nodes
+     * visible from a camera.
+     *
+     * @param frustum The frustum.
+     * @param nodes Vector of nodes the found nodes are appended to.
+     *
+     * @return The number of nodes found.
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the nodes in the scene whose bounds intersect a sphere.
+     *
+     * @param sphere The sphere.
+     * @param nodes Vector of nodes the found nodes are appended to.
+     *
+     * @return The number of nodes found.
+     * @script{ignore}
+     */
+    unsigned int findIntersectingNodes(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the nodes in the scene whose bounds intersect a box.
+     *
+     * @param box The box.
+     * @param nodes Vector of nodes the found nodes are appended to.
+     *
+     * @return The number of nodes found.
+     * @script{ignore}
+     */
+    unsigned int findIntersectingNodes(const BoundingBox& box, std::vector<Node*>& nodes);
+
+    /**
+     * Returns the node in the scene whose bounds are hit first by a ray.
+     *
+     * @param ray The ray.
+     * @param distance Set to the distance along the ray to the bounds of the node, if not NULL.
+     *
+     * @return The node hit first, or NULL if the ray hits no node.
+     * @script{ignore}
+     */
+    Node* pickNode(const Ray& ray, float* distance = NULL);
+
     /**
      * Creates and adds a new node to the scene.
      *
@@ -323,6 +374,48 @@ public:
      */
     inline void visit(const char* visitMethod);
 
+    /**
+     * Resolves the world matrices of all the nodes in the scene whose transforms have changed.
+     *
+     * The scene keeps a flattened copy of its node hierarchy in depth-first order (parents
+     * before children), which is rebuilt only when nodes are attached or detached. Dirty
+     * world matrices are then resolved in one linear sweep over that array. Large scenes
+     * are split by top level subtree and swept in parallel on the game's thread pool.
+     *
+     * This should be called once per frame after animations and game logic have updated
+     * the scene and before it is drawn. Calling it is optional: world matrices that are
+     * not resolved here are still resolved on demand by Node::getWorldMatrix().
+     */
+    void updateTransforms();
+
+    /**
+     * Computes the matrix palettes of all skinned models in the scene whose joints have changed.
+     *
+     * The world matrices of the scene are resolved first by updateTransforms(), then the
+     * palettes are computed in parallel on the game's thread pool. Skins that share a
+     * joint hierarchy are processed by the same job. Models drawn afterwards bind the
+     * precomputed palettes instead of computing them during drawing. Skins of models
+     * outside the active camera's frustum are skipped.
+     *
+     * This should be called once per frame after animations have been updated and
+     * before the scene is drawn. Calling it is optional: palettes that are not
+     * precomputed are still computed on demand when the model is drawn.
+     */
+    void updateMatrixPalettes();
+
+    /**
+     * Updates the spatial index of the scene with the nodes whose bounds have changed.
+     *
+     * The scene keeps the nodes that have a model, terrain or light in a dynamic bounding
+     * volume hierarchy used by findVisibleNodes(), findIntersectingNodes() and pickNode().
+     * Nodes queue themselves when they move, their bounds change or they are attached to
+     * the scene, and only the queued nodes are updated here.
+     *
+     * The queries call this automatically, so calling it is optional. Nodes must only be
+     * moved on the main thread.
+     */
+    void updateSpatialIndex();
+
     /**
      * Draws debugging information (bounding volumes, etc.) for the scene.
      *
@@ -370,6 +463,46 @@ private:
      */
     void visitNode(Node* node, const char* visitMethod);
 
+    /**
+     * Visitor that gathers the skins whose matrix palettes are dirty.
+     */
+    bool collectDirtySkins(Node* node);
+
+    /**
+     * Job that resolves the world matrices of a range of the flattened hierarchy.
+     */
+    class TransformJob;
+
+    /**
+     * Rebuilds the flattened node hierarchy used by updateTransforms().
+     */
+    void flattenHierarchy();
+
+    /**
+     * Appends the given node and its descendants to the flattened node hierarchy.
+     */
+    void flattenNode(Node* node);
+
+    /**
+     * Resolves the world matrices of a range of the flattened node hierarchy.
+     */
+    static void updateWorldMatrices(Node* const* nodes, size_t count);
+
+    /**
+     * Queues a node for the next update of the spatial index.
+     */
+    void spatialChanged(Node* node);
+
+    /**
+     * Queues the given node and its descendants for the next update of the spatial index.
+     */
+    void addSpatialProxies(Node* node);
+
+    /**
+     * Removes the given node and its descendants from the spatial index.
+     */
+    void removeSpatialProxies(Node* node);
+
     std::string _id;
     Camera* _activeCamera;
     Node* _firstNode;
@@ -381,6 +514,13 @@ private:
     bool _bindAudioListenerToCamera;
     MeshBatch* _debugBatch;
     std::map<std::string, std::string>* _tags;
+    std::vector<MeshSkin*> _dirtySkins;
+    std::vector<Node*> _flatNodes;
+    std::vector<size_t> _flatSubtrees;
+    unsigned int _hierarchyRevision;
+    unsigned int _flatRevision;
+    BoundingVolumeTree _spatialIndex;
+    std::vector<Node*> _spatialDirtyNodes;
 };
 
 template <class T>
@@ -13,13 +13,56 @@ namespace gameplay
 extern void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath);
 extern Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
+// Adds the texture paths of the samplers of a material, technique or pass namespace and of its children.
+static void findSamplerTextures(Properties* properties, std::map<std::string, bool>& textures)
+{
+    Properties* ns;
+    while ((ns = properties->getNextNamespace()))
+    {
+        if (strcmp(ns->getNamespace(), "sampler") == 0)
+        {
+            std::string path;
+            if (ns->getPath("path", &path))
+            {
+                bool& mipmap = textures[path];
+                mipmap = mipmap || ns->getBool("mipmap");
+            }
+        }
+        else
+        {
+            findSamplerTextures(ns, textures);
+        }
+    }
+    properties->rewind();
+}
+
 Scene* SceneLoader::load(const char* url, bool keepData)
 {
     SceneLoader loader;
-    return loader.loadInternal(url, keepData);
+    if (!loader.read(url))
+        return NULL;
+    return loader.create(NULL, keepData);
 }
 
-Scene* SceneLoader::loadInternal(const char* url, bool keepData)
+SceneLoader::SceneLoader()
+    : _sceneFile(NULL), _sceneProperties(NULL)
+{
+}
+
+SceneLoader::~SceneLoader()
+{
+    // Clean up all loaded properties objects.
+    std::map<std::string, Properties*>::iterator iter = _propertiesFromFile.begin();
+    for (; iter != _propertiesFromFile.end(); ++iter)
+    {
+        SAFE_DELETE(iter->second);
+    }
+
+    // Clean up the .scene file's properties object.
+    SAFE_DELETE(_sceneFile);
+}
+
+bool SceneLoader::read(const char* url)
 {
     // Get the file part of the url that we are loading the scene from.
     std::string urlStr = url ? url : "";
@@ -31,17 +74,18 @@ Scene* SceneLoader::loadInternal(const char* url, bool keepData)
     if (properties == NULL)
     {
         GP_ERROR("Failed to load scene file '%s'.", url);
-        return NULL;
+        return false;
     }
+    _sceneFile = properties;
 
     // Check if the properties object is valid and has a valid namespace.
     Properties* sceneProperties = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
     if (!sceneProperties || !(strcmp(sceneProperties->getNamespace(), "scene") == 0))
     {
         GP_ERROR("Failed to load scene from properties object: must be non-null object and have namespace equal to 'scene'.");
-        SAFE_DELETE(properties);
-        return NULL;
+        return false;
     }
+    _sceneProperties = sceneProperties;
 
     // Get the path to the main GPB.
     std::string path;
@@ -53,17 +97,51 @@ Scene* SceneLoader::loadInternal(const char* url, bool keepData)
     // Build the node URL/property and animation reference tables and load the referenced files/store the inline properties objects.
     buildReferenceTables(sceneProperties);
     loadReferencedFiles();
+    return true;
+}
+
+void SceneLoader::findMaterialTextures(std::map<std::string, bool>& textures)
+{
+    for (size_t i = 0, sncount = _sceneNodes.size(); i < sncount; ++i)
+    {
+        const SceneNode& sceneNode = _sceneNodes[i];
+        for (size_t j = 0, pcount = sceneNode._properties.size(); j < pcount; ++j)
+        {
+            const SceneNodeProperty& snp = sceneNode._properties[j];
+            if (snp._type != SceneNodeProperty::MATERIAL)
+                continue;
+
+            // Pick the namespace the same way as applyNodeProperty().
+            std::map<std::string, Properties*>::const_iterator itr = _properties.find(snp._url);
+            Properties* p = itr != _properties.end() ? itr->second : NULL;
+            if (p)
+            {
+                p->rewind();
+                Properties* material = (strlen(p->getNamespace()) > 0) ? p : p->getNextNamespace();
+                if (material)
+                {
+                    findSamplerTextures(material, textures);
+                }
+                p->rewind();
+            }
+        }
+    }
+}
+
+Scene* SceneLoader::create(Bundle* bundle, bool keepData)
+{
+    GP_ASSERT(_sceneProperties);
+    Properties* sceneProperties = _sceneProperties;
 
     // Load the main scene data from GPB and apply the global scene properties.
     Scene* scene = NULL;
     if (!_gpbPath.empty())
     {
         // Load scene from bundle
-        scene = loadMainSceneData(sceneProperties, keepData);
+        scene = loadMainSceneData(sceneProperties, bundle, keepData);
         if (!scene)
         {
             GP_ERROR("Failed to load main scene from bundle.");
-            SAFE_DELETE(properties);
             return NULL;
         }
     }
@@ -147,16 +225,6 @@ Scene* SceneLoader::loadInternal(const char* url, bool keepData)
     if (physics)
         loadPhysics(physics, scene);
 
-    // Clean up all loaded properties objects.
-    std::map<std::string, Properties*>::iterator iter = _propertiesFromFile.begin();
-    for (; iter != _propertiesFromFile.end(); ++iter)
-    {
-        SAFE_DELETE(iter->second);
-    }
-
-    // Clean up the .scene file's properties object.
-    SAFE_DELETE(properties);
-
     return scene;
 }
 
@@ -877,12 +945,15 @@ PhysicsConstraint* SceneLoader::loadHingeConstraint(const Properties* constraint
     return physicsConstraint;
 }
 
-Scene* SceneLoader::loadMainSceneData(const Properties* sceneProperties, bool keepData)
+Scene* SceneLoader::loadMainSceneData(const Properties* sceneProperties, Bundle* bundle, bool keepData)
 {
     GP_ASSERT(sceneProperties);
 
-    // Load the main scene from the specified path.
-    Bundle* bundle = Bundle::create(_gpbPath.c_str());
+    // Load the main scene from the specified path, unless its bundle was opened ahead of time.
+    if (bundle)
+        bundle->addRef();
+    else
+        bundle = Bundle::create(_gpbPath.c_str());
     if (!bundle)
     {
         GP_ERROR("Failed to load scene GPB file '%s'.", _gpbPath.c_str());
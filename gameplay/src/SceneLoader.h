@@ -17,6 +17,7 @@ namespace gameplay
 class SceneLoader
 {
     friend class Scene;
+    friend class AsyncLoader;
 
 private:
 
@@ -28,6 +29,41 @@ private:
      * @param url The URL pointing to the Properties object defining the scene.
      */
     static Scene* load(const char* url, bool keepData = false);
+
+    /**
+     * Constructor.
+     */
+    SceneLoader();
+
+    /**
+     * Destructor. Deletes the properties objects that were read.
+     */
+    ~SceneLoader();
+
+    /**
+     * Reads the scene file at the specified URL and the properties files it references, without
+     * creating any object. This does not use GL, so it can be called from a worker thread.
+     *
+     * @param url The URL pointing to the Properties object defining the scene.
+     *
+     * @return true if the scene file was read, false otherwise.
+     */
+    bool read(const char* url);
+
+    /**
+     * Finds the textures of the samplers of the materials referenced by the scene that was read.
+     *
+     * @param textures Set to the paths of the textures, each mapped to whether a sampler of the
+     *      texture generates mipmaps.
+     */
+    void findMaterialTextures(std::map<std::string, bool>& textures);
+
+    /**
+     * Creates the scene that was read.
+     *
+     * @param bundle The main bundle of the scene, or NULL to open the bundle named by the scene.
+     */
+    Scene* create(Bundle* bundle, bool keepData);
     
     /**
      * Helper structures and functions for SceneLoader::load(const char*).
@@ -77,8 +113,6 @@ private:
         std::map<std::string, std::string> _tags;
     };
 
-    Scene* loadInternal(const char* url, bool keepData);
-
     void addSceneAnimation(const char* animationID, const char* targetID, const char* url);
 
     void addSceneNodeProperty(SceneNode& sceneNode, SceneNodeProperty::Type type, const char* url = NULL, int index = 0);
@@ -99,7 +133,7 @@ private:
 
     PhysicsConstraint* loadHingeConstraint(const Properties* constraint, PhysicsRigidBody* rbA, PhysicsRigidBody* rbB);
 
-    Scene* loadMainSceneData(const Properties* sceneProperties, bool keepData = false);
+    Scene* loadMainSceneData(const Properties* sceneProperties, Bundle* bundle, bool keepData = false);
 
     void loadPhysics(Properties* physics, Scene* scene);
 
@@ -115,6 +149,8 @@ private:
     std::vector<SceneNode> _sceneNodes;                          // Holds all the nodes+properties declared in the .scene file.
     std::string _gpbPath;                                        // The path of the main GPB for the scene being loaded.
     std::string _path;                                           // The path of the scene file being loaded.
+    Properties* _sceneFile;                                      // The properties object of the .scene file.
+    Properties* _sceneProperties;                                // The 'scene' namespace of the .scene file.
 };
 
 /**
@@ -796,6 +796,7 @@ void ScriptController::finalizeGame()
 
 void ScriptController::update(float elapsedTime)
 {
+    GP_PROFILE_ZONE("ScriptController::update");
     std::vector<std::string>& list = _callbacks[UPDATE];
     for (size_t i = 0; i < list.size(); ++i)
         executeFunction<void>(list[i].c_str(), "f", elapsedTime);
@@ -803,6 +804,7 @@ void ScriptController::update(float elapsedTime)
 
 void ScriptController::render(float elapsedTime)
 {
+    GP_PROFILE_ZONE("ScriptController::render");
     std::vector<std::string>& list = _callbacks[RENDER];
     for (size_t i = 0; i < list.size(); ++i)
         executeFunction<void>(list[i].c_str(), "f", elapsedTime);
@@ -155,6 +155,18 @@ public:
      */
     virtual bool rewind() = 0;
 
+    /**
+     * Returns the contents of the stream if they are mapped in memory.
+     * 
+     * Streams opened with FileSystem::MAP may map their file instead of reading it
+     * through system calls. Readers can then use the data in place rather than copying
+     * it out with read(). The data is read-only and stays valid until the stream is
+     * closed or destroyed.
+     * 
+     * @return The first byte of the stream, or NULL if the stream is not mapped.
+     */
+    virtual const void* getMappedData() { return NULL; }
+
 protected:
     Stream() {};
 private:
@@ -51,7 +51,7 @@
 namespace gameplay
 {
 
-static std::vector<Texture*> __textureCache;
+static ResourceCache<Texture> __textureCache;
 static TextureHandle __currentTextureId;
 
 Texture::Texture() : _handle(0), _format(UNKNOWN), _width(0), _height(0), _mipmapped(false), _cached(false), _compressed(false), _cubemap(false),
@@ -70,11 +70,7 @@ Texture::~Texture()
     // Remove ourself from the texture cache.
     if (_cached)
     {
-        std::vector<Texture*>::iterator itr = std::find(__textureCache.begin(), __textureCache.end(), this);
-        if (itr != __textureCache.end())
-        {
-            __textureCache.erase(itr);
-        }
+        __textureCache.remove(this);
     }
 }
 
@@ -83,24 +79,20 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     GP_ASSERT(path);
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* t = __textureCache.find(path);
+    if (t)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT(t);
-        if (t->_path == path)
+        // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
+        // texture to generate its mipmap chain if it hasn't already done so.
+        if (generateMipmaps)
         {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
+            t->generateMipmaps();
+        }
 
-            // Found a match.
-            t->addRef();
+        // Found a match.
+        t->addRef();
 
-            return t;
-        }
+        return t;
     }
 
     Texture* texture = NULL;
@@ -168,12 +160,7 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
 
     if (texture)
     {
-        texture->_path = path;
-        texture->_cached = true;
-
-        // Add to texture cache.
-        __textureCache.push_back(texture);
-
+        addToCache(texture, path);
         return texture;
     }
 
@@ -1172,6 +1159,38 @@ TextureHandle Texture::getHandle() const
     return _handle;
 }
 
+ResourceCache<Texture>& Texture::getCache()
+{
+    return __textureCache;
+}
+
+void Texture::addToCache(Texture* texture, const char* path)
+{
+    GP_ASSERT(texture);
+    GP_ASSERT(path);
+
+    texture->_path = path;
+    texture->_cached = true;
+
+    // Estimate the size of the texture in video memory.
+    size_t size = texture->_width * texture->_height;
+    switch (texture->_format)
+    {
+    case RGB:
+        size *= 3;
+        break;
+    case RGBA:
+        size *= 4;
+        break;
+    default:
+        break;
+    }
+    if (texture->_mipmapped)
+        size += size / 3;
+
+    __textureCache.insert(path, texture, size);
+}
+
 void Texture::generateMipmaps()
 {
     if (!_mipmapped)
@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "Stream.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -15,6 +16,7 @@ class Image;
 class Texture : public Ref
 {
     friend class Sampler;
+    friend class AsyncLoader;
 
 public:
 
@@ -282,6 +284,16 @@ public:
      */
     TextureHandle getHandle() const;
 
+    /**
+     * Returns the cache of the textures created from image files.
+     *
+     * Set a memory budget on the cache to keep textures loaded after they are released.
+     *
+     * @return The texture cache.
+     * @script{ignore}
+     */
+    static ResourceCache<Texture>& getCache();
+
 private:
 
     /**
@@ -304,6 +316,11 @@ private:
      */
     Texture& operator=(const Texture&);
 
+    /**
+     * Adds a texture loaded from a file to the texture cache.
+     */
+    static void addToCache(Texture* texture, const char* path);
+
 	bool setCubeFace(GLubyte *data, GLenum direction, unsigned int mipMapCountOrGenerateMipMap);
 
 	static Texture* createCompressedETC(const char* path);
@@ -5,7 +5,7 @@
 namespace gameplay
 {
 
-static std::vector<Theme*> __themeCache;
+static ResourceCache<Theme> __themeCache;
 
 Theme::Theme()
 {
@@ -42,11 +42,7 @@ Theme::~Theme()
     SAFE_RELEASE(_texture);
 
     // Remove ourself from the theme cache.
-    std::vector<Theme*>::iterator itr = std::find(__themeCache.begin(), __themeCache.end(), this);
-    if (itr != __themeCache.end())
-    {
-        __themeCache.erase(itr);
-    }
+    __themeCache.remove(this);
 }
 
 Theme* Theme::create(const char* url)
@@ -54,16 +50,13 @@ Theme* Theme::create(const char* url)
     GP_ASSERT(url);
 
     // Search theme cache first.
-    for (size_t i = 0, count = __themeCache.size(); i < count; ++i)
+    Theme* t = __themeCache.find(url);
+    if (t)
     {
-        Theme* t = __themeCache[i];
-        if (t->_url == url)
-        {
-            // Found a match.
-            t->addRef();
+        // Found a match.
+        t->addRef();
 
-            return t;
-        }
+        return t;
     }
 
     // Load theme properties from file path.
@@ -450,7 +443,7 @@ Theme* Theme::create(const char* url)
     }
 
     // Add this theme to the cache.
-    __themeCache.push_back(theme);
+    __themeCache.insert(url, theme);
 
     SAFE_DELETE(properties);
 
@@ -0,0 +1,247 @@
+#include "Base.h"
+#include "ThreadPool.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace gameplay
+{
+
+#ifdef WIN32
+
+struct ThreadPool::SyncData
+{
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE jobAvailable;
+    CONDITION_VARIABLE jobsDone;
+    std::vector<HANDLE> threads;
+};
+
+#define POOL_LOCK(s)            EnterCriticalSection(&(s)->lock)
+#define POOL_UNLOCK(s)          LeaveCriticalSection(&(s)->lock)
+#define POOL_WAIT(s, cond)      SleepConditionVariableCS(&(s)->cond, &(s)->lock, INFINITE)
+#define POOL_SIGNAL(s, cond)    WakeConditionVariable(&(s)->cond)
+#define POOL_BROADCAST(s, cond) WakeAllConditionVariable(&(s)->cond)
+
+#else
+
+struct ThreadPool::SyncData
+{
+    pthread_mutex_t lock;
+    pthread_cond_t jobAvailable;
+    pthread_cond_t jobsDone;
+    std::vector<pthread_t> threads;
+};
+
+#define POOL_LOCK(s)            pthread_mutex_lock(&(s)->lock)
+#define POOL_UNLOCK(s)          pthread_mutex_unlock(&(s)->lock)
+#define POOL_WAIT(s, cond)      pthread_cond_wait(&(s)->cond, &(s)->lock)
+#define POOL_SIGNAL(s, cond)    pthread_cond_signal(&(s)->cond)
+#define POOL_BROADCAST(s, cond) pthread_cond_broadcast(&(s)->cond)
+
+#endif
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : _sync(NULL), _jobIndex(0), _pendingCount(0), _shutdown(false)
+{
+    _sync = new SyncData();
+
+#ifdef WIN32
+    InitializeCriticalSection(&_sync->lock);
+    InitializeConditionVariable(&_sync->jobAvailable);
+    InitializeConditionVariable(&_sync->jobsDone);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        HANDLE thread = CreateThread(NULL, 0, &ThreadPool::threadFunc, this, 0, NULL);
+        if (thread == NULL)
+        {
+            GP_WARN("Failed to create worker thread %u of %u.", i + 1, threadCount);
+            break;
+        }
+        _sync->threads.push_back(thread);
+    }
+#else
+    pthread_mutex_init(&_sync->lock, NULL);
+    pthread_cond_init(&_sync->jobAvailable, NULL);
+    pthread_cond_init(&_sync->jobsDone, NULL);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &ThreadPool::threadFunc, this) != 0)
+        {
+            GP_WARN("Failed to create worker thread %u of %u.", i + 1, threadCount);
+            break;
+        }
+        _sync->threads.push_back(thread);
+    }
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+    // Finish any outstanding work before stopping the workers.
+    wait();
+
+    POOL_LOCK(_sync);
+    _shutdown = true;
+    POOL_BROADCAST(_sync, jobAvailable);
+    POOL_UNLOCK(_sync);
+
+#ifdef WIN32
+    for (size_t i = 0, count = _sync->threads.size(); i < count; ++i)
+    {
+        WaitForSingleObject(_sync->threads[i], INFINITE);
+        CloseHandle(_sync->threads[i]);
+    }
+    DeleteCriticalSection(&_sync->lock);
+#else
+    for (size_t i = 0, count = _sync->threads.size(); i < count; ++i)
+    {
+        pthread_join(_sync->threads[i], NULL);
+    }
+    pthread_cond_destroy(&_sync->jobsDone);
+    pthread_cond_destroy(&_sync->jobAvailable);
+    pthread_mutex_destroy(&_sync->lock);
+#endif
+
+    SAFE_DELETE(_sync);
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+    return (unsigned int)_sync->threads.size();
+}
+
+unsigned int ThreadPool::getProcessorCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+void ThreadPool::submit(Job* job)
+{
+    GP_ASSERT(job);
+
+    POOL_LOCK(_sync);
+    _jobs.push_back(job);
+    ++_pendingCount;
+    POOL_SIGNAL(_sync, jobAvailable);
+    POOL_UNLOCK(_sync);
+}
+
+void ThreadPool::run(Job** jobs, unsigned int count)
+{
+    GP_ASSERT(jobs || count == 0);
+
+    POOL_LOCK(_sync);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GP_ASSERT(jobs[i]);
+        _jobs.push_back(jobs[i]);
+    }
+    _pendingCount += count;
+    POOL_BROADCAST(_sync, jobAvailable);
+    POOL_UNLOCK(_sync);
+
+    wait();
+}
+
+void ThreadPool::wait()
+{
+    POOL_LOCK(_sync);
+    while (_pendingCount > 0)
+    {
+        Job* job = popJob();
+        if (job)
+        {
+            // Help out on the calling thread rather than blocking.
+            POOL_UNLOCK(_sync);
+            executeJob(job);
+            POOL_LOCK(_sync);
+        }
+        else
+        {
+            // Remaining jobs are in flight on the workers.
+            POOL_WAIT(_sync, jobsDone);
+        }
+    }
+    POOL_UNLOCK(_sync);
+}
+
+ThreadPool::Job* ThreadPool::popJob()
+{
+    if (_jobIndex < _jobs.size())
+    {
+        Job* job = _jobs[_jobIndex++];
+        if (_jobIndex == _jobs.size())
+        {
+            // Queue drained, reuse the storage for the next batch.
+            _jobs.clear();
+            _jobIndex = 0;
+        }
+        return job;
+    }
+    return NULL;
+}
+
+void ThreadPool::executeJob(Job* job)
+{
+    {
+        GP_PROFILE_ZONE("ThreadPool::Job");
+        job->execute();
+    }
+
+    POOL_LOCK(_sync);
+    GP_ASSERT(_pendingCount > 0);
+    if (--_pendingCount == 0)
+    {
+        POOL_BROADCAST(_sync, jobsDone);
+    }
+    POOL_UNLOCK(_sync);
+}
+
+void ThreadPool::workerMain(ThreadPool* pool)
+{
+    SyncData* sync = pool->_sync;
+    for (;;)
+    {
+        POOL_LOCK(sync);
+        Job* job = NULL;
+        while (!pool->_shutdown && (job = pool->popJob()) == NULL)
+        {
+            POOL_WAIT(sync, jobAvailable);
+        }
+        POOL_UNLOCK(sync);
+
+        if (job == NULL)
+            break;
+
+        pool->executeJob(job);
+    }
+}
+
+#ifdef WIN32
+unsigned long __stdcall ThreadPool::threadFunc(void* arg)
+{
+    workerMain(static_cast<ThreadPool*>(arg));
+    return 0;
+}
+#else
+void* ThreadPool::threadFunc(void* arg)
+{
+    workerMain(static_cast<ThreadPool*>(arg));
+    return NULL;
+}
+#endif
+
+}
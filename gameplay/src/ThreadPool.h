@@ -0,0 +1,155 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a fixed-size pool of worker threads used to execute jobs in parallel.
+ *
+ * The thread pool is owned by the Game and created at startup. The number of
+ * worker threads can be specified in the game config file using the
+ * 'threads' namespace:
+ *
+ * @code
+ * threads
+ * {
+ *     workers = 3
+ * }
+ * @endcode
+ *
+ * When no worker count is specified, one worker is created for each available
+ * processor minus one (for the calling thread). The thread calling wait() always
+ * takes part in executing queued jobs, so a pool with zero workers simply runs
+ * all jobs serially on the calling thread.
+ *
+ * Jobs must not touch GL or AL state since they run off the main thread.
+ *
+ * @script{ignore}
+ */
+class ThreadPool
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines a unit of work that can be executed by the thread pool.
+     */
+    class Job
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Job() { }
+
+        /**
+         * Called from a worker thread (or from the thread calling wait()) to execute the job.
+         */
+        virtual void execute() = 0;
+    };
+
+    /**
+     * Returns the number of worker threads in this pool.
+     *
+     * This does not include the thread that calls wait().
+     *
+     * @return The number of worker threads.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Returns the number of processors available on the current system.
+     *
+     * @return The number of processors, always at least one.
+     */
+    static unsigned int getProcessorCount();
+
+    /**
+     * Queues a job to be executed by the pool.
+     *
+     * The job is not owned by the pool and must remain valid until wait() returns.
+     *
+     * @param job The job to execute.
+     */
+    void submit(Job* job);
+
+    /**
+     * Queues a number of jobs and blocks until all queued jobs have completed.
+     *
+     * @param jobs Array of jobs to execute.
+     * @param count The number of jobs in the array.
+     */
+    void run(Job** jobs, unsigned int count);
+
+    /**
+     * Blocks until all queued jobs have completed.
+     *
+     * The calling thread executes queued jobs while waiting.
+     */
+    void wait();
+
+private:
+
+    /**
+     * Platform synchronization data (defined in the implementation).
+     */
+    struct SyncData;
+
+    /**
+     * Constructor.
+     *
+     * @param threadCount The number of worker threads to create.
+     */
+    ThreadPool(unsigned int threadCount);
+
+    /**
+     * Hidden copy constructor.
+     */
+    ThreadPool(const ThreadPool& copy);
+
+    /**
+     * Destructor.
+     */
+    ~ThreadPool();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ThreadPool& operator=(const ThreadPool&);
+
+    /**
+     * Pops the next queued job, or returns NULL if the queue is empty.
+     *
+     * The queue lock must be held by the caller.
+     */
+    Job* popJob();
+
+    /**
+     * Executes a job and signals waiting threads when the pool becomes idle.
+     */
+    void executeJob(Job* job);
+
+    /**
+     * Entry point for each worker thread.
+     */
+    static void workerMain(ThreadPool* pool);
+
+#ifdef WIN32
+    static unsigned long __stdcall threadFunc(void* arg);
+#else
+    static void* threadFunc(void* arg);
+#endif
+
+    SyncData* _sync;
+    std::vector<Job*> _jobs;
+    unsigned int _jobIndex;
+    unsigned int _pendingCount;
+    bool _shutdown;
+};
+
+}
+
+#endif
@@ -835,91 +835,121 @@ void Transform::getAnimationPropertyValue(int propertyId, AnimationValue* value)
 }
 
 void Transform::setAnimationPropertyValue(int propertyId, AnimationValue* value, float blendWeight)
+{
+    GP_ASSERT(value);
+
+    applyAnimationValue(propertyId, value->_value, blendWeight);
+}
+
+void Transform::applyAnimationValue(int propertyId, const float* value, float blendWeight)
 {
     GP_ASSERT(value);
     GP_ASSERT(blendWeight >= 0.0f && blendWeight <= 1.0f);
 
+    if (isStatic())
+        return;
+
+    // Components are written directly and the transform is dirtied once, rather than
+    // going through the individual setters which each notify listeners.
+    char dirtyBits = 0;
     switch (propertyId)
     {
         case ANIMATE_SCALE_UNIT:
         {
-            float scale = Curve::lerp(blendWeight, _scale.x, value->getFloat(0));
-            setScale(scale);
+            float scale = Curve::lerp(blendWeight, _scale.x, value[0]);
+            _scale.set(scale, scale, scale);
+            dirtyBits = DIRTY_SCALE;
             break;
         }   
         case ANIMATE_SCALE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
+            applyAnimationValueVector(&_scale, value, blendWeight);
+            dirtyBits = DIRTY_SCALE;
             break;
         }
         case ANIMATE_SCALE_X:
         {
-            setScaleX(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)));
+            _scale.x = Curve::lerp(blendWeight, _scale.x, value[0]);
+            dirtyBits = DIRTY_SCALE;
             break;
         }
         case ANIMATE_SCALE_Y:
         {
-            setScaleY(Curve::lerp(blendWeight, _scale.y, value->getFloat(0)));
+            _scale.y = Curve::lerp(blendWeight, _scale.y, value[0]);
+            dirtyBits = DIRTY_SCALE;
             break;
         }
         case ANIMATE_SCALE_Z:
         {
-            setScaleZ(Curve::lerp(blendWeight, _scale.z, value->getFloat(0)));
+            _scale.z = Curve::lerp(blendWeight, _scale.z, value[0]);
+            dirtyBits = DIRTY_SCALE;
             break;
         }
         case ANIMATE_ROTATE:
         {
-            applyAnimationValueRotation(value, 0, blendWeight);
+            applyAnimationValueRotation(value, blendWeight);
+            dirtyBits = DIRTY_ROTATION;
             break;
         }
         case ANIMATE_TRANSLATE:
         {
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(0)), Curve::lerp(blendWeight, _translation.y, value->getFloat(1)), Curve::lerp(blendWeight, _translation.z, value->getFloat(2)));
+            applyAnimationValueVector(&_translation, value, blendWeight);
+            dirtyBits = DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_TRANSLATE_X:
         {
-            setTranslationX(Curve::lerp(blendWeight, _translation.x, value->getFloat(0)));
+            _translation.x = Curve::lerp(blendWeight, _translation.x, value[0]);
+            dirtyBits = DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_TRANSLATE_Y:
         {
-            setTranslationY(Curve::lerp(blendWeight, _translation.y, value->getFloat(0)));
+            _translation.y = Curve::lerp(blendWeight, _translation.y, value[0]);
+            dirtyBits = DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_TRANSLATE_Z:
         {
-            setTranslationZ(Curve::lerp(blendWeight, _translation.z, value->getFloat(0)));
+            _translation.z = Curve::lerp(blendWeight, _translation.z, value[0]);
+            dirtyBits = DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_ROTATE_TRANSLATE:
         {
-            applyAnimationValueRotation(value, 0, blendWeight);
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(4)), Curve::lerp(blendWeight, _translation.y, value->getFloat(5)), Curve::lerp(blendWeight, _translation.z, value->getFloat(6)));
+            applyAnimationValueRotation(value, blendWeight);
+            applyAnimationValueVector(&_translation, value + 4, blendWeight);
+            dirtyBits = DIRTY_ROTATION | DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_SCALE_ROTATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            applyAnimationValueRotation(value, 3, blendWeight);
+            applyAnimationValueVector(&_scale, value, blendWeight);
+            applyAnimationValueRotation(value + 3, blendWeight);
+            dirtyBits = DIRTY_SCALE | DIRTY_ROTATION;
             break;
         }
         case ANIMATE_SCALE_TRANSLATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(3)), Curve::lerp(blendWeight, _translation.y, value->getFloat(4)), Curve::lerp(blendWeight, _translation.z, value->getFloat(5)));
+            applyAnimationValueVector(&_scale, value, blendWeight);
+            applyAnimationValueVector(&_translation, value + 3, blendWeight);
+            dirtyBits = DIRTY_SCALE | DIRTY_TRANSLATION;
             break;
         }
         case ANIMATE_SCALE_ROTATE_TRANSLATE:
         {
-            setScale(Curve::lerp(blendWeight, _scale.x, value->getFloat(0)), Curve::lerp(blendWeight, _scale.y, value->getFloat(1)), Curve::lerp(blendWeight, _scale.z, value->getFloat(2)));
-            applyAnimationValueRotation(value, 3, blendWeight);
-            setTranslation(Curve::lerp(blendWeight, _translation.x, value->getFloat(7)), Curve::lerp(blendWeight, _translation.y, value->getFloat(8)), Curve::lerp(blendWeight, _translation.z, value->getFloat(9)));
+            applyAnimationValueVector(&_scale, value, blendWeight);
+            applyAnimationValueRotation(value + 3, blendWeight);
+            applyAnimationValueVector(&_translation, value + 7, blendWeight);
+            dirtyBits = DIRTY_SCALE | DIRTY_ROTATION | DIRTY_TRANSLATION;
             break;
         }
         default:
             break;
     }
+
+    if (dirtyBits)
+        dirty(dirtyBits);
 }
 
 void Transform::dirty(char matrixDirtyBits)
@@ -1006,15 +1036,20 @@ void Transform::cloneInto(Transform* transform, NodeCloneContext &context) const
     transform->dirty(DIRTY_TRANSLATION | DIRTY_ROTATION | DIRTY_SCALE);
 }
 
-void Transform::applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight)
+void Transform::applyAnimationValueRotation(const float* value, float blendWeight)
 {
-    if (isStatic())
-        return;
-
     GP_ASSERT(value);
-    Quaternion::slerp(_rotation.x, _rotation.y, _rotation.z, _rotation.w, value->getFloat(index), value->getFloat(index + 1), value->getFloat(index + 2), value->getFloat(index + 3), blendWeight, 
+    Quaternion::slerp(_rotation.x, _rotation.y, _rotation.z, _rotation.w, value[0], value[1], value[2], value[3], blendWeight, 
         &_rotation.x, &_rotation.y, &_rotation.z, &_rotation.w);
-    dirty(DIRTY_ROTATION);
+}
+
+void Transform::applyAnimationValueVector(Vector3* dst, const float* value, float blendWeight)
+{
+    GP_ASSERT(dst);
+    GP_ASSERT(value);
+    dst->x = Curve::lerp(blendWeight, dst->x, value[0]);
+    dst->y = Curve::lerp(blendWeight, dst->y, value[1]);
+    dst->z = Curve::lerp(blendWeight, dst->z, value[2]);
 }
 
 }
@@ -787,6 +787,20 @@ public:
      */
     void setAnimationPropertyValue(int propertyId, AnimationValue* value, float blendWeight = 1.0f);
 
+    /**
+     * Blends a raw animation value into this transform.
+     *
+     * This is the non-virtual equivalent of setAnimationPropertyValue, used by baked
+     * animation clips to write sampled values directly into the transform components.
+     * The transform is marked dirty once for all of the components that were changed.
+     *
+     * @param propertyId The ID of the property to set.
+     * @param value The values of the property, laid out as for getAnimationPropertyComponentCount.
+     * @param blendWeight The blend weight.
+     * @script{ignore}
+     */
+    void applyAnimationValue(int propertyId, const float* value, float blendWeight = 1.0f);
+
 protected:
 
     /**
@@ -881,7 +895,9 @@ protected:
 
 private:
    
-    void applyAnimationValueRotation(AnimationValue* value, unsigned int index, float blendWeight);
+    void applyAnimationValueRotation(const float* value, float blendWeight);
+
+    static void applyAnimationValueVector(Vector3* dst, const float* value, float blendWeight);
 
     static int _suspendTransformChanged;
     static std::vector<Transform*> _transformsChanged;
@@ -7,7 +7,14 @@ namespace gameplay
 {
 
 static GLuint __maxVertexAttribs = 0;
-static std::vector<VertexAttributeBinding*> __vertexAttributeBindingCache;
+static ResourceCache<VertexAttributeBinding> __vertexAttributeBindingCache;
+
+// Key of a vertex attribute binding in the cache.
+struct VertexAttributeBindingKey
+{
+    Mesh* mesh;
+    Effect* effect;
+};
 
 VertexAttributeBinding::VertexAttributeBinding() :
     _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL)
@@ -17,11 +24,7 @@ VertexAttributeBinding::VertexAttributeBinding() :
 VertexAttributeBinding::~VertexAttributeBinding()
 {
     // Delete from the vertex attribute binding cache.
-    std::vector<VertexAttributeBinding*>::iterator itr = std::find(__vertexAttributeBindingCache.begin(), __vertexAttributeBindingCache.end(), this);
-    if (itr != __vertexAttributeBindingCache.end())
-    {
-        __vertexAttributeBindingCache.erase(itr);
-    }
+    __vertexAttributeBindingCache.remove(this);
 
     SAFE_RELEASE(_mesh);
     SAFE_RELEASE(_effect);
@@ -39,17 +42,15 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
     GP_ASSERT(mesh);
 
     // Search for an existing vertex attribute binding that can be used.
-    VertexAttributeBinding* b;
-    for (size_t i = 0, count = __vertexAttributeBindingCache.size(); i < count; ++i)
+    VertexAttributeBindingKey key;
+    key.mesh = mesh;
+    key.effect = effect;
+    VertexAttributeBinding* b = __vertexAttributeBindingCache.find(&key, sizeof(key));
+    if (b)
     {
-        b = __vertexAttributeBindingCache[i];
-        GP_ASSERT(b);
-        if (b->_mesh == mesh && b->_effect == effect)
-        {
-            // Found a match!
-            b->addRef();
-            return b;
-        }
+        // Found a match!
+        b->addRef();
+        return b;
     }
 
     b = create(mesh, mesh->getVertexFormat(), 0, effect);
@@ -57,7 +58,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
     // Add the new vertex attribute binding to the cache.
     if (b)
     {
-        __vertexAttributeBindingCache.push_back(b);
+        __vertexAttributeBindingCache.insert(&key, sizeof(key), b);
     }
 
     return b;
@@ -68,6 +69,11 @@ VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& verte
     return create(NULL, vertexFormat, vertexPointer, effect);
 }
 
+ResourceCache<VertexAttributeBinding>& VertexAttributeBinding::getCache()
+{
+    return __vertexAttributeBindingCache;
+}
+
 VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
 {
     GP_ASSERT(effect);
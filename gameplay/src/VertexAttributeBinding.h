@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "VertexFormat.h"
+#include "ResourceCache.h"
 
 namespace gameplay
 {
@@ -68,6 +69,15 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Returns the cache of the vertex attribute bindings created for meshes,
+     * keyed on their mesh and effect.
+     *
+     * @return The vertex attribute binding cache.
+     * @script{ignore}
+     */
+    static ResourceCache<VertexAttributeBinding>& getCache();
+
     /**
      * Binds this vertex array object.
      */
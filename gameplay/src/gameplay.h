@@ -8,7 +8,10 @@
 #include "Gesture.h"
 #include "Gamepad.h"
 #include "FileSystem.h"
+#include "PackFile.h"
 #include "Bundle.h"
+#include "ResourceCache.h"
+#include "AsyncLoader.h"
 #include "MathUtil.h"
 #include "Logger.h"
 #include "InAppPurchase.h"
@@ -34,21 +37,26 @@
 #include "Mesh.h"
 #include "MeshPart.h"
 #include "Effect.h"
+#include "ProgramCache.h"
 #include "Material.h"
 #include "RenderState.h"
 #include "VertexFormat.h"
 #include "VertexAttributeBinding.h"
 #include "Model.h"
+#include "InstancedModel.h"
 #include "Camera.h"
 #include "Light.h"
+#include "LightGrid.h"
 #include "Scene.h"
 #include "Node.h"
 #include "Joint.h"
 #include "Font.h"
 #include "SpriteBatch.h"
 #include "ParticleEmitter.h"
+#include "ParticleSystem.h"
 #include "FrameBuffer.h"
 #include "RenderTarget.h"
+#include "RenderQueue.h"
 #include "DepthStencilTarget.h"
 #include "ScreenDisplayer.h"
 #include "HeightField.h"
@@ -59,6 +67,7 @@
 #include "AudioListener.h"
 #include "AudioBuffer.h"
 #include "AudioSource.h"
+#include "AudioStream.h"
 
 // Animation
 #include "AnimationController.h"
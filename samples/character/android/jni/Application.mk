@@ -1 +1,2 @@
-APP_STL     := stlport_static
\ No newline at end of file
+APP_STL     := stlport_static
+APP_ABI     := armeabi-v7a
\ No newline at end of file
@@ -20,7 +20,7 @@ CharacterGame game;
 #define BUTTON_2 1
 
 CharacterGame::CharacterGame()
-    : _font(NULL), _scene(NULL), _character(NULL), _characterNode(NULL), _characterMeshNode(NULL), _characterShadowNode(NULL), _basketballNode(NULL),
+    : _font(NULL), _scene(NULL), _renderQueue(NULL), _character(NULL), _characterNode(NULL), _characterMeshNode(NULL), _characterShadowNode(NULL), _basketballNode(NULL),
       _animation(NULL), _currentClip(NULL), _jumpClip(NULL), _kickClip(NULL), _rotateX(0), _materialParameterAlpha(NULL),
       _keyFlags(0), _drawDebug(0), _wireframe(false), _hasBall(false), _applyKick(false), _gamepad(NULL)
 {
@@ -61,6 +61,9 @@ void CharacterGame::initialize()
     // Initialize scene.
     _scene->visit(this, &CharacterGame::initializeScene);
 
+    // Create the queue the scene is drawn through.
+    _renderQueue = RenderQueue::create();
+
     _gamepad = getGamepad(0);
 }
 
@@ -123,6 +126,7 @@ void CharacterGame::initializeCharacter()
 
 void CharacterGame::finalize()
 {
+    SAFE_RELEASE(_renderQueue);
     SAFE_RELEASE(_scene);
     SAFE_RELEASE(_font);
     SAFE_DELETE_ARRAY(_buttonPressed);
@@ -366,9 +370,24 @@ void CharacterGame::render(float elapsedTime)
     // Clear the color and depth buffers.
     clear(CLEAR_COLOR_DEPTH, Vector4(0.41f, 0.48f, 0.54f, 1.0f), 1.0f, 0);
 
-    // Draw our scene, with separate passes for opaque and transparent objects.
-    _scene->visit(this, &CharacterGame::drawScene, false);
-    _scene->visit(this, &CharacterGame::drawScene, true);
+    // Resolve world matrices and compute the skinning matrix palettes for all characters up front.
+    _scene->updateMatrixPalettes();
+
+    // Queue the models the camera sees and draw them sorted by state. Blended
+    // packets, such as the character's shadow, are drawn after the opaque ones.
+    _renderQueue->begin(_scene->getActiveCamera());
+    if (_wireframe)
+    {
+        // The render queue only draws filled primitives, so wireframes are drawn node by node,
+        // with separate passes for opaque and transparent objects.
+        _scene->visit(this, &CharacterGame::drawScene, false);
+        _scene->visit(this, &CharacterGame::drawScene, true);
+    }
+    else
+    {
+        _renderQueue->submit(_scene);
+        _renderQueue->draw();
+    }
 
     // Draw debug info (physics bodies, bounds, etc).
     switch (_drawDebug)
@@ -386,10 +405,11 @@ void CharacterGame::render(float elapsedTime)
 
     _gamepad->draw();
 
-    // Draw FPS
+    // Draw FPS and the draw counters of the render queue
     _font->start();
-    char fps[32];
-    sprintf(fps, "%d", getFrameRate());
+    char fps[100];
+    sprintf(fps, "FPS: %d\nDraws: %u\nState changes: %u\nBinds saved: %u", getFrameRate(),
+            _renderQueue->getDrawCallCount(), _renderQueue->getStateChangeCount(), _renderQueue->getBindsSavedCount());
     _font->drawText(fps, 5, 5, Vector4(1,1,0,1), 20);
     _font->finish();
 }
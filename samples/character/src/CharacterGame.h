@@ -88,6 +88,7 @@ private:
 
     Font* _font;
     Scene* _scene;
+    RenderQueue* _renderQueue;
     PhysicsCharacter* _character;
     Node* _characterNode;
     Node* _characterMeshNode;
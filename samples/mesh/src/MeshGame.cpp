@@ -4,7 +4,7 @@
 MeshGame game;
 
 MeshGame::MeshGame()
-    : _font(NULL), _scene(NULL), _modelNode(NULL), _touched(false), _touchX(0)
+    : _font(NULL), _scene(NULL), _renderQueue(NULL), _modelNode(NULL), _touched(false), _touchX(0)
 {
 }
 
@@ -42,10 +42,14 @@ void MeshGame::initialize()
     Model* model = createGridModel();
     _scene->addNode("grid")->setModel(model);
     model->release();
+
+    // Create the queue the scene is drawn through.
+    _renderQueue = RenderQueue::create();
 }
 
 void MeshGame::finalize()
 {
+    SAFE_RELEASE(_renderQueue);
     SAFE_RELEASE(_font);
     SAFE_RELEASE(_scene);
 }
@@ -62,10 +66,12 @@ void MeshGame::render(float elapsedTime)
     // Clear the color and depth buffers.
     clear(CLEAR_COLOR_DEPTH, Vector4::zero(), 1.0f, 0);
     
-    // Visit all the nodes in the scene, drawing the models/mesh.
-    _scene->visit(this, &MeshGame::drawScene);
+    // Queue the models the camera sees, sorted by state, and draw them.
+    _renderQueue->begin(_scene->getActiveCamera());
+    _renderQueue->submit(_scene);
+    _renderQueue->draw();
 
-    // Draw the fps
+    // Draw the fps and the draw counters of the queue
     drawFrameRate(_font, Vector4(0, 0.5f, 1, 1), 5, 1, getFrameRate());
 }
 
@@ -110,18 +116,11 @@ void MeshGame::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int cont
     };
 }
 
-bool MeshGame::drawScene(Node* node)
-{
-    Model* model = node->getModel();
-    if (model)
-        model->draw();
-    return true;
-}
-
 void MeshGame::drawFrameRate(Font* font, const Vector4& color, unsigned int x, unsigned int y, unsigned int fps)
 {
-    char buffer[10];
-    sprintf(buffer, "%u", fps);
+    char buffer[100];
+    sprintf(buffer, "FPS: %u\nDraws: %u\nState changes: %u\nBinds saved: %u", fps,
+            _renderQueue->getDrawCallCount(), _renderQueue->getStateChangeCount(), _renderQueue->getBindsSavedCount());
     font->start();
     font->drawText(buffer, x, y, color, font->getSize());
     font->finish();
@@ -215,6 +214,10 @@ Model* MeshGame::createGridModel(unsigned int lineCount)
     mesh->setPrimitiveType(Mesh::LINES);
     mesh->setVertexData(&vertices[0], 0, pointCount);
 
+    // Give the grid bounds so that the scene's spatial index can cull it.
+    mesh->setBoundingBox(BoundingBox(-gridLength, 0.0f, -gridLength, gridLength, 0.0f, gridLength));
+    mesh->setBoundingSphere(BoundingSphere(Vector3::zero(), gridLength * 1.4143f));
+
     Model* model = Model::create(mesh);
     model->setMaterial("res/grid.material");
     SAFE_RELEASE(mesh);
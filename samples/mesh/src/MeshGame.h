@@ -56,8 +56,6 @@ protected:
 
 private:
 
-    bool drawScene(Node* node);
-
     void drawFrameRate(Font* font, const Vector4& color, unsigned int x, unsigned int y, unsigned int fps);
 
     void drawSplash(void* param);
@@ -66,6 +64,7 @@ private:
 
     Font* _font;
     Scene* _scene;
+    RenderQueue* _renderQueue;
     Node* _modelNode;
     bool _touched;
     int _touchX;
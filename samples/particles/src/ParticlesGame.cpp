@@ -16,7 +16,7 @@ const static float EMIT_RATE_MAX[] = { 500, 100, 100 };
 const float INPUT_SENSITIVITY = 0.05f;
 const Vector4 BACKGROUND_COLOR = Vector4::zero();
 
-ParticlesGame::ParticlesGame() : _scene(NULL)
+ParticlesGame::ParticlesGame() : _scene(NULL), _particleSystem(NULL)
 {
 }
 
@@ -49,7 +49,8 @@ void ParticlesGame::initialize()
     // Create a font for drawing the framerate.
     _font = Font::create("res/arial.gpb");
 
-    // Load preset emitters.
+    // Load preset emitters. The selected emitter is updated and drawn through a particle system.
+    _particleSystem = ParticleSystem::create();
     loadEmitters();
 
     // Load the form for editing ParticleEmitters.
@@ -465,6 +466,7 @@ void ParticlesGame::controlEvent(Control* control, EventType evt)
 
 void ParticlesGame::finalize()
 {
+    SAFE_RELEASE(_particleSystem);
     SAFE_RELEASE(_scene);
     SAFE_RELEASE(_form);
     SAFE_RELEASE(_font);
@@ -508,7 +510,7 @@ void ParticlesGame::update(float elapsedTime)
     }
 
     // Update particles.
-    _particleEmitterNode->getParticleEmitter()->update(elapsedTime);
+    _particleSystem->update(elapsedTime);
 }
 
 void ParticlesGame::render(float elapsedTime)
@@ -519,23 +521,13 @@ void ParticlesGame::render(float elapsedTime)
     // Draw the UI.
     _form->draw();
 
-    // Visit all the nodes in the scene for drawing.
-    _scene->visit(this, &ParticlesGame::drawScene, (void*)0);
+    // Draw the particles.
+    _particleSystem->draw();
 
     // Draw the framerate and number of live particles.
     drawFrameRate(_font, Vector4(0, 0.5f, 1, 1), 170, 10, getFrameRate());
 }
 
-bool ParticlesGame::drawScene(Node* node, void* cookie)
-{
-    ParticleEmitter* emitter = node->getParticleEmitter();
-    if (emitter)
-    {
-        emitter->draw();
-    }
-    return true;
-}
-
 void ParticlesGame::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
 {
     // Touch events that don't hit the UI
@@ -653,6 +645,8 @@ void ParticlesGame::emitterChanged()
     // Set the new emitter on the node.
     ParticleEmitter* emitter = _particleEmitters[_particleEmitterIndex];
     _particleEmitterNode->setParticleEmitter(emitter);
+    _particleSystem->removeAllEmitters();
+    _particleSystem->addEmitter(emitter);
 
     // The 'explosion' emitter is meant to emit in bursts.
     if (_particleEmitterIndex == 2)
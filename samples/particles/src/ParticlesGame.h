@@ -56,8 +56,6 @@ protected:
 
 private:
 
-    bool drawScene(Node* node, void* cookie);
-
     void drawSplash(void* param);
 
     void loadEmitters();
@@ -74,6 +72,7 @@ private:
     bool _touched;
     int _prevX, _prevY;
     std::vector<ParticleEmitter*> _particleEmitters;
+    ParticleSystem* _particleSystem;
     unsigned int _particleEmitterIndex;
     Font* _font;
     
@@ -0,0 +1,128 @@
+#include "Benchmarks.h"
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-benchmark animation [options]\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -n <count>\tThe number of clips (runs 1000 and 10000 clips by default).\n");
+    fprintf(stderr, "  -r <frames>\tThe number of frames timed (100 by default).\n");
+    fprintf(stderr, "  -s <percent>\tThe percentage of the clips stopped and started each frame (1 by default).\n");
+    fprintf(stderr, "example: gameplay-benchmark animation -n 5000 -s 10\n");
+}
+
+/**
+ * Times updates of the animation controller with a number of clips.
+ */
+static void runClips(BenchmarkGame* game, unsigned int clipCount, int frames, int percent)
+{
+    // Each clip animates its own node, and repeats until it is stopped.
+    unsigned int keyTimes[2] = { 0, 1000 };
+    float keyValues[2] = { 0.0f, 1.0f };
+    std::vector<Node*> nodes(clipCount);
+    std::vector<AnimationClip*> clips(clipCount);
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        char id[32];
+        sprintf(id, "clip%u", i);
+        nodes[i] = Node::create(id);
+        Animation* animation = nodes[i]->createAnimation(id, Transform::ANIMATE_TRANSLATE_X, 2, keyTimes, keyValues, Curve::LINEAR);
+        clips[i] = animation->getClip();
+        clips[i]->setRepeatCount(AnimationClip::REPEAT_INDEFINITE);
+    }
+
+    // The controllers are updated without clips first, for the cost of the other controllers.
+    game->updateControllers();
+    double start = Game::getAbsoluteTime();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        game->updateControllers();
+    }
+    double idleTime = (Game::getAbsoluteTime() - start) / frames;
+
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        clips[i]->play();
+    }
+    game->updateControllers();
+    start = Game::getAbsoluteTime();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        game->updateControllers();
+    }
+    double runningTime = (Game::getAbsoluteTime() - start) / frames;
+
+    // Stop a window of clips each frame, and start again the window stopped the frame
+    // before, once update() has unscheduled it. Stopped clips leave holes in the running
+    // clips, which update() compacts.
+    unsigned int churn = max(clipCount * percent / 100, 1u);
+    for (unsigned int i = 0; i < churn; ++i)
+    {
+        clips[i]->stop();
+    }
+    game->updateControllers();
+    start = Game::getAbsoluteTime();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        unsigned int stopped = frame * churn;
+        for (unsigned int i = 0; i < churn; ++i)
+        {
+            clips[(stopped + churn + i) % clipCount]->stop();
+            clips[(stopped + i) % clipCount]->play();
+        }
+        game->updateControllers();
+    }
+    double churnTime = (Game::getAbsoluteTime() - start) / frames;
+
+    fprintf(stdout, "%6u clips   idle %8.3f ms   running %8.3f ms   %u stopped and started %8.3f ms\n",
+        clipCount, idleTime, runningTime, churn, churnTime);
+
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        clips[i]->stop();
+    }
+    game->updateControllers();
+    for (unsigned int i = 0; i < clipCount; ++i)
+    {
+        SAFE_RELEASE(nodes[i]);
+    }
+}
+
+int runAnimationBenchmark(BenchmarkGame* game, int argc, const char** argv)
+{
+    int clipCount = 0;
+    int frames = 100;
+    int percent = 1;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            clipCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0 && atoi(argv[i + 1]) <= 50)
+        {
+            percent = atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+
+    // Game::updateOnce() also updates the other controllers, which cost the idle time.
+    fprintf(stdout, "%d frames, ms per update of the controllers (idle: no clips running)\n", frames);
+    if (clipCount > 0)
+    {
+        runClips(game, (unsigned int)clipCount, frames, percent);
+    }
+    else
+    {
+        runClips(game, 1000, frames, percent);
+        runClips(game, 10000, frames, percent);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "BenchmarkGame.h"
+
+BenchmarkGame::BenchmarkGame(Benchmark benchmark, int argc, const char** argv)
+    : _benchmark(benchmark), _argc(argc), _argv(argv)
+{
+}
+
+void BenchmarkGame::updateControllers()
+{
+    updateOnce();
+}
+
+void BenchmarkGame::initialize()
+{
+    _benchmark(this, _argc, _argv);
+    exit();
+}
+
+void BenchmarkGame::finalize()
+{
+}
+
+void BenchmarkGame::update(float elapsedTime)
+{
+}
+
+void BenchmarkGame::render(float elapsedTime)
+{
+}
+
+void BenchmarkGame::postFrameUpdate(float elapsedTime)
+{
+}
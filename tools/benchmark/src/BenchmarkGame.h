@@ -0,0 +1,70 @@
+#ifndef BENCHMARKGAME_H_
+#define BENCHMARKGAME_H_
+
+#include "gameplay.h"
+
+using namespace gameplay;
+
+/**
+ * Runs a benchmark that needs the game systems (a GL context, the animation controller
+ * or the thread pool), then exits. The benchmark reports its errors itself, since
+ * Game::exit() ends the process.
+ */
+class BenchmarkGame : public Game
+{
+public:
+
+    /**
+     * A benchmark run from initialize().
+     */
+    typedef int (*Benchmark)(BenchmarkGame* game, int argc, const char** argv);
+
+    /**
+     * Constructor.
+     *
+     * @param benchmark The benchmark to run.
+     * @param argc The number of arguments of the benchmark.
+     * @param argv The arguments of the benchmark.
+     */
+    BenchmarkGame(Benchmark benchmark, int argc, const char** argv);
+
+    /**
+     * Updates the animation, physics, AI, audio and script controllers once, as a frame does.
+     */
+    void updateControllers();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+
+    /**
+     * @see Game::postFrameUpdate
+     */
+    void postFrameUpdate(float elapsedTime);
+
+private:
+
+    Benchmark _benchmark;
+    int _argc;
+    const char** _argv;
+};
+
+#endif
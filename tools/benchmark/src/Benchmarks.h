@@ -0,0 +1,57 @@
+#ifndef BENCHMARKS_H_
+#define BENCHMARKS_H_
+
+#include "gameplay.h"
+#include "BenchmarkGame.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace gameplay;
+
+/**
+ * Times loading and querying properties files.
+ *
+ * @param argc The number of arguments following the name of the benchmark.
+ * @param argv The arguments following the name of the benchmark.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or a file could not be loaded.
+ */
+int runPropertiesBenchmark(int argc, const char** argv);
+
+/**
+ * Times the scalar kernels of MathUtil.inl against the kernels that Matrix uses in this
+ * build, and checks that both compute the same results.
+ *
+ * @param argc The number of arguments following the name of the benchmark.
+ * @param argv The arguments following the name of the benchmark.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or the results differ.
+ */
+int runMathBenchmark(int argc, const char** argv);
+
+/**
+ * Times Scene::updateMatrixPalettes() on many skinned characters, with the thread pool
+ * sized from one thread up to the number of processors.
+ *
+ * @param game The game the benchmark runs in.
+ * @param argc The number of arguments following the name of the benchmark.
+ * @param argv The arguments following the name of the benchmark.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid or the scene could not be loaded.
+ */
+int runPaletteBenchmark(BenchmarkGame* game, int argc, const char** argv);
+
+/**
+ * Times AnimationController::update() with thousands of running clips, and with clips
+ * started and stopped every frame.
+ *
+ * @param game The game the benchmark runs in.
+ * @param argc The number of arguments following the name of the benchmark.
+ * @param argv The arguments following the name of the benchmark.
+ *
+ * @return 0 on success, or -1 if the arguments are invalid.
+ */
+int runAnimationBenchmark(BenchmarkGame* game, int argc, const char** argv);
+
+#endif
@@ -0,0 +1,225 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace gameplay
+{
+
+/**
+ * The portable kernels of MathUtil.inl, compiled under another name so that they can be
+ * compared with the SSE or NEON kernels that MathUtil uses in this build.
+ */
+class ScalarMathUtil
+{
+public:
+
+    inline static void addMatrix(const float* m, float scalar, float* dst);
+
+    inline static void addMatrix(const float* m1, const float* m2, float* dst);
+
+    inline static void subtractMatrix(const float* m1, const float* m2, float* dst);
+
+    inline static void multiplyMatrix(const float* m, float scalar, float* dst);
+
+    inline static void multiplyMatrix(const float* m1, const float* m2, float* dst);
+
+    inline static void multiplyMatrices(const float* m, const float* matrices, unsigned int count, float* dst);
+
+    inline static void negateMatrix(const float* m, float* dst);
+
+    inline static void transposeMatrix(const float* m, float* dst);
+
+    inline static void transformVector4(const float* m, float x, float y, float z, float w, float* dst);
+
+    inline static void transformVector4(const float* m, const float* v, float* dst);
+
+    inline static void transformPoints(const float* m, const float* points, unsigned int count, float* dst);
+
+    inline static void crossVector3(const float* v1, const float* v2, float* dst);
+
+    inline static unsigned int cullSpheres(const float* planes, unsigned int planeMask, const float* x, const float* y, const float* z, const float* radius,
+                                           unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+
+    inline static unsigned int cullBoxes(const float* planes, unsigned int planeMask, const float* minX, const float* minY, const float* minZ,
+                                         const float* maxX, const float* maxY, const float* maxZ, unsigned int count, unsigned int* visibility, unsigned char* planeCache);
+};
+
+}
+
+#define MathUtil ScalarMathUtil
+#include "MathUtil.inl"
+#undef MathUtil
+
+// Results further apart than this are reported as a mismatch.
+#define RESULT_TOLERANCE 1e-5f
+
+// Keeps the compiler from dropping the results.
+static float sink = 0.0f;
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-benchmark math [options]\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -n <count>\tThe number of matrices and points in a batch (1024 by default).\n");
+    fprintf(stderr, "  -r <rounds>\tThe number of times each batch is computed (1000 by default).\n");
+    fprintf(stderr, "example: gameplay-benchmark math -n 4096 -r 500\n");
+}
+
+/**
+ * Returns the processor time used so far, in milliseconds.
+ */
+static double getTime()
+{
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/**
+ * Fills an array with values between -1 and 1.
+ */
+static void fill(float* values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    }
+}
+
+/**
+ * Returns the largest difference between two arrays, relative to the magnitude of the values.
+ */
+static float compare(const float* a, const float* b, size_t count)
+{
+    float difference = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float d = fabsf(a[i] - b[i]) / std::max(1.0f, fabsf(a[i]));
+        difference = std::max(difference, d);
+    }
+    return difference;
+}
+
+/**
+ * Prints the timings of a kernel and returns whether both of its versions agree.
+ */
+static bool report(const char* name, double scalarTime, double engineTime, float difference, int rounds)
+{
+    bool match = difference <= RESULT_TOLERANCE;
+    fprintf(stdout, "%-22s%12.3f%12.3f%10.2fx%14g  %s\n", name, scalarTime / rounds, engineTime / rounds,
+            engineTime > 0.0 ? scalarTime / engineTime : 0.0, difference, match ? "ok" : "MISMATCH");
+    return match;
+}
+
+int runMathBenchmark(int argc, const char** argv)
+{
+    unsigned int count = 1024;
+    int rounds = 1000;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            count = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+
+    srand(1);
+    Matrix m;
+    fill(m.m, 16);
+    std::vector<Matrix> matrices(count);
+    fill(matrices[0].m, count * 16);
+    std::vector<Vector3> points(count);
+    fill(&points[0].x, count * 3);
+
+    std::vector<Matrix> scalarMatrices(count);
+    std::vector<Matrix> engineMatrices(count);
+    std::vector<Vector3> scalarPoints(count);
+    std::vector<Vector3> enginePoints(count);
+
+#if defined(USE_NEON)
+    const char* backend = "NEON";
+#elif defined(USE_SSE)
+    const char* backend = "SSE";
+#else
+    const char* backend = "scalar";
+#endif
+    fprintf(stdout, "MathUtil backend: %s, %u matrices and points, %d rounds\n\n", backend, count, rounds);
+    fprintf(stdout, "%-22s%12s%12s%11s%14s\n", "kernel", "scalar ms", "engine ms", "speedup", "difference");
+
+    bool match = true;
+
+    // Matrix::multiply(const Matrix&, const Matrix&, Matrix*), one product at a time.
+    double start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (unsigned int j = 0; j < count; ++j)
+        {
+            ScalarMathUtil::multiplyMatrix(m.m, matrices[j].m, scalarMatrices[j].m);
+        }
+        sink += scalarMatrices[round % count].m[0];
+    }
+    double scalarTime = getTime() - start;
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (unsigned int j = 0; j < count; ++j)
+        {
+            Matrix::multiply(m, matrices[j], &engineMatrices[j]);
+        }
+        sink += engineMatrices[round % count].m[0];
+    }
+    double engineTime = getTime() - start;
+    match &= report("multiply", scalarTime, engineTime, compare(scalarMatrices[0].m, engineMatrices[0].m, count * 16), rounds);
+
+    // Matrix::multiply(const Matrix&, const Matrix*, unsigned int, Matrix*), the batched form.
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        ScalarMathUtil::multiplyMatrices(m.m, matrices[0].m, count, scalarMatrices[0].m);
+        sink += scalarMatrices[round % count].m[0];
+    }
+    scalarTime = getTime() - start;
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        Matrix::multiply(m, &matrices[0], count, &engineMatrices[0]);
+        sink += engineMatrices[round % count].m[0];
+    }
+    engineTime = getTime() - start;
+    match &= report("multiply (batch)", scalarTime, engineTime, compare(scalarMatrices[0].m, engineMatrices[0].m, count * 16), rounds);
+
+    // Matrix::transformPoints.
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        ScalarMathUtil::transformPoints(m.m, &points[0].x, count, &scalarPoints[0].x);
+        sink += scalarPoints[round % count].x;
+    }
+    scalarTime = getTime() - start;
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        m.transformPoints(&points[0], count, &enginePoints[0]);
+        sink += enginePoints[round % count].x;
+    }
+    engineTime = getTime() - start;
+    match &= report("transformPoints", scalarTime, engineTime, compare(&scalarPoints[0].x, &enginePoints[0].x, count * 3), rounds);
+
+    if (!match)
+    {
+        fprintf(stderr, "\nThe %s kernels do not match the scalar kernels.\n", backend);
+        return -1;
+    }
+    return sink == 0.5f ? 1 : 0;
+}
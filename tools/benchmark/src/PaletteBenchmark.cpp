@@ -0,0 +1,129 @@
+#include "Benchmarks.h"
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-benchmark palettes [options] <scene file> <node id>\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -n <count>\tThe number of copies of the character (64 by default).\n");
+    fprintf(stderr, "  -r <frames>\tThe number of frames timed for each thread count (100 by default).\n");
+    fprintf(stderr, "\nThe node is a skinned character of the scene, with its joints below it.\n");
+    fprintf(stderr, "example: gameplay-benchmark palettes -n 128 res/common/scene.gpb boycharacter\n");
+}
+
+/**
+ * Adds the root joints of the skinned models of a node and of its descendants.
+ */
+static void findRootJoints(Node* node, std::vector<Joint*>& joints)
+{
+    Model* model = node->getModel();
+    if (model && model->getSkin() && model->getSkin()->getRootJoint())
+    {
+        joints.push_back(model->getSkin()->getRootJoint());
+    }
+    for (Node* child = node->getFirstChild(); child; child = child->getNextSibling())
+    {
+        findRootJoints(child, joints);
+    }
+}
+
+/**
+ * Moves every character, so all of their palettes must be computed again.
+ */
+static void moveJoints(const std::vector<Joint*>& joints)
+{
+    for (size_t i = 0, count = joints.size(); i < count; ++i)
+    {
+        joints[i]->rotateY(0.01f);
+    }
+}
+
+int runPaletteBenchmark(BenchmarkGame* game, int argc, const char** argv)
+{
+    int characterCount = 64;
+    int frames = 100;
+    int i = 0;
+    for (; i < argc && argv[i][0] == '-'; ++i)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            characterCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            frames = atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+    if (argc - i != 2)
+    {
+        printUsage();
+        return -1;
+    }
+
+    Scene* source = Scene::load(argv[i]);
+    if (source == NULL)
+    {
+        fprintf(stderr, "Failed to load scene '%s'.\n", argv[i]);
+        return -1;
+    }
+    Node* character = source->findNode(argv[i + 1]);
+    if (character == NULL)
+    {
+        fprintf(stderr, "Scene '%s' has no node '%s'.\n", argv[i], argv[i + 1]);
+        SAFE_RELEASE(source);
+        return -1;
+    }
+
+    // Each copy has its own joints, so the copies are computed by separate jobs.
+    Scene* scene = Scene::create();
+    std::vector<Joint*> joints;
+    for (int j = 0; j < characterCount; ++j)
+    {
+        Node* copy = character->clone();
+        copy->translateX((float)j);
+        scene->addNode(copy);
+        findRootJoints(copy, joints);
+        SAFE_RELEASE(copy);
+    }
+    if (joints.empty())
+    {
+        fprintf(stderr, "Node '%s' has no skinned model.\n", argv[i + 1]);
+        SAFE_RELEASE(scene);
+        SAFE_RELEASE(source);
+        return -1;
+    }
+
+    fprintf(stdout, "%d characters, %u skins, %d frames\n", characterCount, (unsigned int)joints.size(), frames);
+    fprintf(stdout, "threads   ms per frame   speedup\n");
+    unsigned int processorCount = ThreadPool::getProcessorCount();
+    double singleTime = 0.0;
+    for (unsigned int threadCount = 1; threadCount <= processorCount; ++threadCount)
+    {
+        // The thread that waits for the jobs runs them too.
+        game->setWorkerThreadCount(threadCount - 1);
+
+        moveJoints(joints);
+        scene->updateMatrixPalettes();
+
+        double start = Game::getAbsoluteTime();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            moveJoints(joints);
+            scene->updateMatrixPalettes();
+        }
+        double time = (Game::getAbsoluteTime() - start) / frames;
+        if (threadCount == 1)
+        {
+            singleTime = time;
+        }
+        fprintf(stdout, "%7u   %12.3f   %6.2fx\n", threadCount, time, time > 0.0 ? singleTime / time : 0.0);
+    }
+
+    SAFE_RELEASE(scene);
+    SAFE_RELEASE(source);
+    return 0;
+}
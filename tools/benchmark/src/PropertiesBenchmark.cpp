@@ -0,0 +1,157 @@
+#include "Benchmarks.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace gameplay;
+
+// Keeps the compiler from dropping the queries.
+static float sink = 0.0f;
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-benchmark properties [options] <properties file>...\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -r <rounds>\tThe number of times each file is loaded and queried (50 by default).\n");
+    fprintf(stderr, "\nFiles are read through FileSystem, so run the benchmark from the resource\n");
+    fprintf(stderr, "path of the game. A file is read from its compiled form (.gpp) when there is one.\n");
+    fprintf(stderr, "example: gameplay-benchmark properties -r 100 res/common/game.scene res/common/box.material\n");
+}
+
+/**
+ * Returns the processor time used so far, in milliseconds.
+ */
+static double getTime()
+{
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/**
+ * Reads every property of a namespace and of its nested namespaces, with its typed getter.
+ */
+static void query(Properties* properties)
+{
+    std::vector<std::string> names;
+    const char* name;
+    while ((name = properties->getNextProperty()) != NULL)
+    {
+        names.push_back(name);
+    }
+
+    for (size_t i = 0, count = names.size(); i < count; ++i)
+    {
+        name = names[i].c_str();
+        sink += (float)strlen(properties->getString(name));
+        sink += properties->exists(name) ? 1.0f : 0.0f;
+        switch (properties->getType(name))
+        {
+        case Properties::NUMBER:
+            sink += properties->getFloat(name);
+            break;
+        case Properties::VECTOR2:
+            {
+                Vector2 v;
+                properties->getVector2(name, &v);
+                sink += v.x;
+            }
+            break;
+        case Properties::VECTOR3:
+            {
+                Vector3 v;
+                properties->getVector3(name, &v);
+                sink += v.x;
+            }
+            break;
+        case Properties::VECTOR4:
+            {
+                Vector4 v;
+                properties->getVector4(name, &v);
+                sink += v.x;
+            }
+            break;
+        case Properties::MATRIX:
+            {
+                Matrix m;
+                properties->getMatrix(name, &m);
+                sink += m.m[0];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    Properties* child;
+    while ((child = properties->getNextNamespace()) != NULL)
+    {
+        query(child);
+    }
+}
+
+int runPropertiesBenchmark(int argc, const char** argv)
+{
+    int rounds = 50;
+    int i = 0;
+    for (; i < argc && argv[i][0] == '-'; ++i)
+    {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            rounds = atoi(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+    if (i == argc)
+    {
+        printUsage();
+        return -1;
+    }
+
+    std::vector<const char*> paths(argv + i, argv + argc);
+
+    // Load each file and free it, so the loads start from nothing.
+    double start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t j = 0; j < paths.size(); ++j)
+        {
+            Properties* properties = Properties::create(paths[j]);
+            if (properties == NULL)
+            {
+                fprintf(stderr, "Failed to load '%s'.\n", paths[j]);
+                return -1;
+            }
+            SAFE_DELETE(properties);
+        }
+    }
+    double loadTime = getTime() - start;
+
+    // Query files that stay loaded, as a game reads its materials and scenes.
+    std::vector<Properties*> loaded;
+    for (size_t j = 0; j < paths.size(); ++j)
+    {
+        loaded.push_back(Properties::create(paths[j]));
+    }
+    start = getTime();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t j = 0; j < loaded.size(); ++j)
+        {
+            query(loaded[j]);
+        }
+    }
+    double queryTime = getTime() - start;
+    for (size_t j = 0; j < loaded.size(); ++j)
+    {
+        SAFE_DELETE(loaded[j]);
+    }
+
+    fprintf(stdout, "%u files, %d rounds\n", (unsigned int)paths.size(), rounds);
+    fprintf(stdout, "load:    %.3f ms per round\n", loadTime / rounds);
+    fprintf(stdout, "queries: %.3f ms per round\n", queryTime / rounds);
+    return sink == 0.5f ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+#include "Benchmarks.h"
+
+extern int __argc;
+extern char** __argv;
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-benchmark <benchmark> [options] [files]\n\n");
+    fprintf(stderr, "Benchmarks:\n");
+    fprintf(stderr, "  properties\tLoads and queries properties files.\n");
+    fprintf(stderr, "  palettes\tComputes the matrix palettes of skinned characters with 1 to N threads.\n");
+    fprintf(stderr, "  animation\tUpdates thousands of animation clips, starting and stopping some of them.\n");
+    fprintf(stderr, "  math\t\tCompares the scalar matrix kernels with the SSE or NEON kernels of the build.\n");
+    fprintf(stderr, "\nRun a benchmark without arguments to print its options.\n");
+}
+
+/**
+ * Runs a benchmark in a game, which opens a window for its GL context.
+ */
+static int runGameBenchmark(BenchmarkGame::Benchmark benchmark, int argc, const char** argv)
+{
+    BenchmarkGame game(benchmark, argc - 2, argv + 2);
+    Platform* platform = Platform::create(&game);
+    GP_ASSERT(platform);
+    int result = platform->enterMessagePump();
+    delete platform;
+    return result;
+}
+
+/**
+ * Main application entry point.
+ *
+ * @param argc The number of command line arguments
+ * @param argv The array of command line arguments.
+ */
+int main(int argc, const char** argv)
+{
+    __argc = argc;
+    __argv = (char**)argv;
+    if (argc < 2)
+    {
+        printUsage();
+        return -1;
+    }
+
+    if (strcmp(argv[1], "properties") == 0)
+        return runPropertiesBenchmark(argc - 2, argv + 2);
+    if (strcmp(argv[1], "math") == 0)
+        return runMathBenchmark(argc - 2, argv + 2);
+    if (strcmp(argv[1], "palettes") == 0)
+        return runGameBenchmark(&runPaletteBenchmark, argc, argv);
+    if (strcmp(argv[1], "animation") == 0)
+        return runGameBenchmark(&runAnimationBenchmark, argc, argv);
+
+    printUsage();
+    return -1;
+}
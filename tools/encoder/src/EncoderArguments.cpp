@@ -107,6 +107,9 @@ std::string EncoderArguments::getOutputFileExtension() const
         if (_normalMap)
             return ".png";
 
+    case FILEFORMAT_PROPERTIES:
+        return ".gpp";
+
     default:
         return ".gpb";
     }
@@ -119,6 +122,11 @@ std::string EncoderArguments::getOutputFilePath() const
         // Output file explicitly set
         return _fileOutputPath;
     }
+    else if (getFileFormat() == FILEFORMAT_PROPERTIES)
+    {
+        // Compiled properties files keep the extension of the text file (box.material.gpp)
+        return _filePath + getOutputFileExtension();
+    }
     else
     {
         // Generate an output file path
@@ -252,6 +260,9 @@ void EncoderArguments::printUsage() const
     "Supported file extensions:\n" \
     "  .fbx\t(FBX)\n" \
     "  .ttf\t(TrueType Font)\n" \
+    "  .material, .scene, .form, .theme, .particle, .physics, .animation,\n" \
+    "  .terrain, .audio, .config, .properties\n" \
+    "\t(Properties, compiled to <input filepath>.gpp)\n" \
     "\n" \
     "General Options:\n" \
     "  -v <verbosity>\tVerbosity level (0-4).\n" \
@@ -400,6 +411,13 @@ EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
     {
         return FILEFORMAT_RAW;
     }
+    if (ext.compare("material") == 0 || ext.compare("scene") == 0 || ext.compare("form") == 0 ||
+        ext.compare("theme") == 0 || ext.compare("particle") == 0 || ext.compare("physics") == 0 ||
+        ext.compare("animation") == 0 || ext.compare("terrain") == 0 || ext.compare("audio") == 0 ||
+        ext.compare("config") == 0 || ext.compare("properties") == 0)
+    {
+        return FILEFORMAT_PROPERTIES;
+    }
 
     return FILEFORMAT_UNKNOWN;
 }
@@ -22,7 +22,8 @@ public:
         FILEFORMAT_TTF,
         FILEFORMAT_GPB,
         FILEFORMAT_PNG,
-        FILEFORMAT_RAW
+        FILEFORMAT_RAW,
+        FILEFORMAT_PROPERTIES
     };
 
     struct HeightmapOption
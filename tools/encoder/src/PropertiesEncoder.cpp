@@ -0,0 +1,541 @@
+#include "Base.h"
+#include "PropertiesEncoder.h"
+
+// Identifies a compiled properties file.
+#define PROPERTIES_COMPILED_MAGIC       "GPPB"
+
+// Version of the compiled properties format.
+#define PROPERTIES_COMPILED_VERSION     1
+
+// The most values stored for a property (a matrix).
+#define PROPERTIES_MAX_VALUES           16
+
+// Types of properties, as in gameplay::Properties::Type.
+#define PROPERTIES_STRING               1
+#define PROPERTIES_NUMBER               2
+#define PROPERTIES_VECTOR2              3
+#define PROPERTIES_VECTOR3              4
+#define PROPERTIES_VECTOR4              5
+#define PROPERTIES_MATRIX               6
+
+namespace gameplay
+{
+
+static char* trimWhiteSpace(char* str)
+{
+    if (str == NULL)
+        return str;
+
+    while (isspace(*str))
+        str++;
+    if (*str == 0)
+        return str;
+
+    char* end = str + strlen(str) - 1;
+    while (end > str && isspace(*end))
+        end--;
+    *(end + 1) = 0;
+    return str;
+}
+
+static bool isStringNumeric(const char* str)
+{
+    if (*str == '-')
+        str++;
+    if (!isdigit(*str))
+        return false;
+    str++;
+
+    unsigned int decimalCount = 0;
+    while (*str)
+    {
+        if (!isdigit(*str))
+        {
+            if (*str == '.' && decimalCount == 0)
+                decimalCount++;
+            else
+                return false;
+        }
+        str++;
+    }
+    return true;
+}
+
+/**
+ * Returns the type of a value, as Properties::getType() does.
+ */
+static unsigned short getType(const char* value)
+{
+    unsigned int commaCount = 0;
+    for (const char* c = strchr(value, ','); c; c = strchr(c + 1, ','))
+    {
+        commaCount++;
+    }
+    switch (commaCount)
+    {
+    case 0:
+        return isStringNumeric(value) ? PROPERTIES_NUMBER : PROPERTIES_STRING;
+    case 1:
+        return PROPERTIES_VECTOR2;
+    case 2:
+        return PROPERTIES_VECTOR3;
+    case 3:
+        return PROPERTIES_VECTOR4;
+    case 15:
+        return PROPERTIES_MATRIX;
+    default:
+        return PROPERTIES_STRING;
+    }
+}
+
+/**
+ * Reads the numbers at the start of a value, as sscanf("%f,%f,...") does.
+ */
+static unsigned int readValues(const char* value, float* values)
+{
+    unsigned int count = 0;
+    while (count < PROPERTIES_MAX_VALUES)
+    {
+        int length = 0;
+        if (sscanf(value, "%f%n", &values[count], &length) != 1)
+            break;
+        count++;
+        value += length;
+        if (*value != ',')
+            break;
+        value++;
+    }
+    return count;
+}
+
+/**
+ * Returns the offset of a string in the strings of the file, adding it if needed.
+ */
+static unsigned int internString(const std::string& str, std::string& strings, std::map<std::string, unsigned int>& offsets)
+{
+    std::map<std::string, unsigned int>::const_iterator itr = offsets.find(str);
+    if (itr != offsets.end())
+        return itr->second;
+
+    unsigned int offset = (unsigned int)strings.size();
+    strings.append(str.c_str(), str.size() + 1);
+    offsets[str] = offset;
+    return offset;
+}
+
+static bool writeUnsignedInt(FILE* file, unsigned int value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+PropertiesEncoder::Namespace::~Namespace()
+{
+    for (size_t i = 0; i < namespaces.size(); ++i)
+    {
+        delete namespaces[i];
+    }
+}
+
+PropertiesEncoder::Namespace* PropertiesEncoder::Namespace::clone() const
+{
+    Namespace* copy = new Namespace();
+    copy->name = name;
+    copy->id = id;
+    copy->parentID = parentID;
+    copy->properties = properties;
+    for (size_t i = 0; i < namespaces.size(); ++i)
+    {
+        copy->namespaces.push_back(namespaces[i]->clone());
+    }
+    return copy;
+}
+
+PropertiesEncoder::PropertiesEncoder()
+    : _position(0)
+{
+}
+
+PropertiesEncoder::~PropertiesEncoder()
+{
+}
+
+bool PropertiesEncoder::write(const std::string& inFilePath, const std::string& outFilePath)
+{
+    FILE* file = fopen(inFilePath.c_str(), "rb");
+    if (file == NULL)
+    {
+        LOG(1, "Error: Failed to open file: %s\n", inFilePath.c_str());
+        return false;
+    }
+    char buffer[4096];
+    size_t count;
+    _text.clear();
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        _text.append(buffer, count);
+    }
+    fclose(file);
+    _position = 0;
+
+    Namespace root;
+    if (!readNamespace(&root))
+    {
+        LOG(1, "Error: Failed to parse properties file: %s\n", inFilePath.c_str());
+        return false;
+    }
+    resolveInheritance(&root);
+
+    if (!writeBinary(&root, outFilePath))
+    {
+        LOG(1, "Error: Failed to write file: %s\n", outFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PropertiesEncoder::readNamespace(Namespace* ns)
+{
+    // Same parsing as Properties::readProperties().
+    char line[2048];
+    char* name;
+    char* value;
+    char* parentID;
+    char* rc;
+    char* rcc;
+    char* rccc;
+
+    while (true)
+    {
+        skipWhiteSpace();
+        if (eof())
+            break;
+
+        if (readLine(line, 2048) == NULL)
+        {
+            LOG(1, "Error reading line from file.\n");
+            return false;
+        }
+
+        // Ignore comments.
+        if (strncmp(line, "//", 2) == 0)
+            continue;
+
+        if (strchr(line, '=') != NULL)
+        {
+            // There could be a '}' at the end of the line, ending the namespace.
+            rc = strchr(line, '}');
+
+            name = strtok(line, "=");
+            if (name == NULL)
+            {
+                LOG(1, "Error parsing properties file: attribute without name.\n");
+                return false;
+            }
+            name = trimWhiteSpace(name);
+
+            value = strtok(NULL, "=");
+            if (value == NULL)
+            {
+                LOG(1, "Error parsing properties file: attribute with name ('%s') but no value.\n", name);
+                return false;
+            }
+            value = trimWhiteSpace(value);
+
+            ns->properties[name] = value;
+            if (rc != NULL)
+                return true;
+            continue;
+        }
+
+        parentID = NULL;
+
+        // Get the last character on the line (ignoring whitespace).
+        const char* lineEnd = trimWhiteSpace(line) + (strlen(trimWhiteSpace(line)) - 1);
+
+        rc = strchr(line, '{');
+        rcc = strchr(line, ':');
+        rccc = strchr(line, '}');
+
+        name = strtok(line, " \t\n{");
+        name = trimWhiteSpace(name);
+        if (name == NULL)
+        {
+            LOG(1, "Error parsing properties file: failed to determine a valid token for line '%s'.\n", line);
+            return false;
+        }
+        else if (name[0] == '}')
+        {
+            // End of namespace.
+            return true;
+        }
+
+        value = strtok(NULL, ":{");
+        value = trimWhiteSpace(value);
+        if (rcc != NULL)
+        {
+            parentID = strtok(NULL, "{");
+            parentID = trimWhiteSpace(parentID);
+        }
+
+        bool opensNamespace = (value != NULL && value[0] == '{') || rc != NULL;
+        if (!opensNamespace)
+        {
+            // Find out if the next line starts with "{".
+            skipWhiteSpace();
+            if (readChar() == '{')
+            {
+                opensNamespace = true;
+                rccc = NULL;
+            }
+            else
+            {
+                if (!seek(-1))
+                {
+                    LOG(1, "Failed to seek backwards a single character after testing if the next line starts with '{'.\n");
+                    return false;
+                }
+
+                // Store "name value" as a name/value pair, or even just "name".
+                ns->properties[name] = value != NULL ? value : "";
+                continue;
+            }
+        }
+
+        // If the namespace ends on this line, seek back to right before the '}' character.
+        bool endsOnLine = rccc && rccc == lineEnd;
+        if (endsOnLine)
+        {
+            if (!seek(-1))
+                return false;
+            while (readChar() != '}')
+            {
+                if (!seek(-2))
+                    return false;
+            }
+            if (!seek(-1))
+                return false;
+        }
+
+        Namespace* child = new Namespace();
+        child->name = name;
+        if (value != NULL && value[0] != '{')
+            child->id = value;
+        if (parentID != NULL)
+            child->parentID = parentID;
+        ns->namespaces.push_back(child);
+        if (!readNamespace(child))
+            return false;
+
+        // If the namespace ended on this line, seek to right after the '}' character.
+        if (endsOnLine && !seek(1))
+            return false;
+    }
+    return true;
+}
+
+void PropertiesEncoder::skipWhiteSpace()
+{
+    int c;
+    do
+    {
+        c = readChar();
+    } while (c != EOF && isspace(c));
+
+    if (c != EOF)
+        seek(-1);
+}
+
+int PropertiesEncoder::readChar()
+{
+    if (eof())
+        return EOF;
+    return (signed char)_text[_position++];
+}
+
+char* PropertiesEncoder::readLine(char* str, int num)
+{
+    if (num <= 0 || eof())
+        return NULL;
+
+    int i = 0;
+    while (i < num - 1 && !eof())
+    {
+        char c = _text[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+bool PropertiesEncoder::seek(long int offset)
+{
+    if (offset < 0 ? (size_t)-offset > _position : _position + offset > _text.size())
+        return false;
+    _position += offset;
+    return true;
+}
+
+bool PropertiesEncoder::eof() const
+{
+    return _position >= _text.size();
+}
+
+PropertiesEncoder::Namespace* PropertiesEncoder::getNamespace(Namespace* ns, const std::string& id)
+{
+    for (size_t i = 0; i < ns->namespaces.size(); ++i)
+    {
+        Namespace* child = ns->namespaces[i];
+        if (child->id == id)
+            return child;
+        Namespace* found = getNamespace(child, id);
+        if (found)
+            return found;
+    }
+    return NULL;
+}
+
+void PropertiesEncoder::resolveInheritance(Namespace* ns, const char* id)
+{
+    // Same as Properties::resolveInheritance().
+    std::vector<Namespace*> derivedNamespaces;
+    if (id)
+    {
+        Namespace* derived = getNamespace(ns, id);
+        if (derived)
+            derivedNamespaces.push_back(derived);
+    }
+    else
+    {
+        derivedNamespaces = ns->namespaces;
+    }
+
+    for (size_t i = 0; i < derivedNamespaces.size(); ++i)
+    {
+        Namespace* derived = derivedNamespaces[i];
+        if (!derived->parentID.empty())
+        {
+            Namespace* parent = getNamespace(ns, derived->parentID);
+            if (parent)
+            {
+                resolveInheritance(ns, parent->id.c_str());
+
+                // Copy the data of the parent into the child, then override it with the data of the child.
+                Namespace* overrides = derived->clone();
+                for (size_t j = 0; j < derived->namespaces.size(); ++j)
+                {
+                    delete derived->namespaces[j];
+                }
+                derived->namespaces.clear();
+                derived->properties = parent->properties;
+                for (size_t j = 0; j < parent->namespaces.size(); ++j)
+                {
+                    derived->namespaces.push_back(parent->namespaces[j]->clone());
+                }
+                mergeWith(derived, overrides);
+                delete overrides;
+            }
+        }
+        resolveInheritance(derived);
+    }
+}
+
+void PropertiesEncoder::mergeWith(Namespace* derived, const Namespace* overrides)
+{
+    // Properties::getNextProperty() stops at a property without a name.
+    std::map<std::string, std::string>::const_iterator itr;
+    for (itr = overrides->properties.begin(); itr != overrides->properties.end() && !itr->first.empty(); ++itr)
+    {
+        derived->properties[itr->first] = itr->second;
+    }
+
+    for (size_t i = 0; i < overrides->namespaces.size(); ++i)
+    {
+        const Namespace* overridesNamespace = overrides->namespaces[i];
+        bool merged = false;
+        for (size_t j = 0; j < derived->namespaces.size(); ++j)
+        {
+            Namespace* derivedNamespace = derived->namespaces[j];
+            if (derivedNamespace->name == overridesNamespace->name && derivedNamespace->id == overridesNamespace->id)
+            {
+                mergeWith(derivedNamespace, overridesNamespace);
+                merged = true;
+            }
+        }
+        if (!merged)
+        {
+            derived->namespaces.push_back(overridesNamespace->clone());
+        }
+    }
+}
+
+bool PropertiesEncoder::writeBinary(const Namespace* root, const std::string& filePath)
+{
+    // Number the namespaces breadth first, so the children of each namespace are contiguous.
+    std::vector<const Namespace*> order;
+    order.push_back(root);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order.insert(order.end(), order[i]->namespaces.begin(), order[i]->namespaces.end());
+    }
+
+    // Intern the strings, starting with the empty string.
+    std::string strings(1, '\0');
+    std::map<std::string, unsigned int> stringOffsets;
+    stringOffsets[""] = 0;
+
+    std::vector<unsigned int> namespaceRecords;
+    std::vector<unsigned int> propertyRecords;
+    std::vector<float> values;
+    unsigned int nextChild = 1;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const Namespace* ns = order[i];
+        namespaceRecords.push_back(internString(ns->name, strings, stringOffsets));
+        namespaceRecords.push_back(internString(ns->id, strings, stringOffsets));
+        namespaceRecords.push_back((unsigned int)(propertyRecords.size() / 4));
+        namespaceRecords.push_back((unsigned int)ns->properties.size());
+        namespaceRecords.push_back(nextChild);
+        namespaceRecords.push_back((unsigned int)ns->namespaces.size());
+        nextChild += (unsigned int)ns->namespaces.size();
+
+        // The map keeps the properties sorted by name, as the runtime looks them up.
+        std::map<std::string, std::string>::const_iterator itr;
+        for (itr = ns->properties.begin(); itr != ns->properties.end(); ++itr)
+        {
+            float propertyValues[PROPERTIES_MAX_VALUES];
+            unsigned int valueCount = readValues(itr->second.c_str(), propertyValues);
+            propertyRecords.push_back(internString(itr->first, strings, stringOffsets));
+            propertyRecords.push_back(internString(itr->second, strings, stringOffsets));
+            propertyRecords.push_back(getType(itr->second.c_str()) | (valueCount << 16));
+            propertyRecords.push_back((unsigned int)values.size());
+            values.insert(values.end(), propertyValues, propertyValues + valueCount);
+        }
+    }
+
+    FILE* file = fopen(filePath.c_str(), "wb");
+    if (file == NULL)
+        return false;
+
+    unsigned int propertyCount = (unsigned int)(propertyRecords.size() / 4);
+    bool succeeded = fwrite(PROPERTIES_COMPILED_MAGIC, 1, 4, file) == 4 &&
+        writeUnsignedInt(file, PROPERTIES_COMPILED_VERSION) &&
+        writeUnsignedInt(file, (unsigned int)order.size()) &&
+        writeUnsignedInt(file, propertyCount) &&
+        writeUnsignedInt(file, (unsigned int)values.size()) &&
+        writeUnsignedInt(file, (unsigned int)strings.size()) &&
+        writeUnsignedInt(file, 0) &&
+        writeUnsignedInt(file, 0);
+    succeeded = succeeded &&
+        fwrite(&namespaceRecords[0], sizeof(unsigned int), namespaceRecords.size(), file) == namespaceRecords.size();
+    if (succeeded && !propertyRecords.empty())
+        succeeded = fwrite(&propertyRecords[0], sizeof(unsigned int), propertyRecords.size(), file) == propertyRecords.size();
+    if (succeeded && !values.empty())
+        succeeded = fwrite(&values[0], sizeof(float), values.size(), file) == values.size();
+    succeeded = succeeded && fwrite(strings.c_str(), 1, strings.size(), file) == strings.size();
+    succeeded = fclose(file) == 0 && succeeded;
+    return succeeded;
+}
+
+}
@@ -0,0 +1,85 @@
+#ifndef PROPERTIESENCODER_H_
+#define PROPERTIESENCODER_H_
+
+#include "Base.h"
+
+namespace gameplay
+{
+
+/**
+ * Compiles a properties file (such as a .material, .scene or .form file) into the
+ * binary form read by gameplay::Properties.
+ *
+ * The text is parsed as the runtime parses it, and inheritance ("name id : parentID")
+ * is resolved, so the runtime reads the compiled namespaces as is. Numbers and vectors
+ * are converted to floats. The layout of the file is described in gameplay/src/Properties.cpp.
+ */
+class PropertiesEncoder
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    PropertiesEncoder();
+
+    /**
+     * Destructor.
+     */
+    ~PropertiesEncoder();
+
+    /**
+     * Compiles a properties file.
+     *
+     * @param inFilePath The path of the properties file.
+     * @param outFilePath The path of the compiled file, usually the input path with ".gpp" appended.
+     *
+     * @return true if the file was compiled, false otherwise.
+     */
+    bool write(const std::string& inFilePath, const std::string& outFilePath);
+
+private:
+
+    /**
+     * A namespace of the properties file.
+     */
+    struct Namespace
+    {
+        std::string name;
+        std::string id;
+        std::string parentID;
+        std::map<std::string, std::string> properties;
+        std::vector<Namespace*> namespaces;
+
+        ~Namespace();
+
+        Namespace* clone() const;
+    };
+
+    bool readNamespace(Namespace* ns);
+
+    void skipWhiteSpace();
+
+    int readChar();
+
+    char* readLine(char* str, int num);
+
+    bool seek(long int offset);
+
+    bool eof() const;
+
+    static Namespace* getNamespace(Namespace* ns, const std::string& id);
+
+    static void resolveInheritance(Namespace* ns, const char* id = NULL);
+
+    static void mergeWith(Namespace* derived, const Namespace* overrides);
+
+    bool writeBinary(const Namespace* root, const std::string& filePath);
+
+    std::string _text;
+    size_t _position;
+};
+
+}
+
+#endif
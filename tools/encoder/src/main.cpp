@@ -4,6 +4,7 @@
 #include "GPBDecoder.h"
 #include "EncoderArguments.h"
 #include "NormalMapGenerator.h"
+#include "PropertiesEncoder.h"
 
 using namespace gameplay;
 
@@ -113,6 +114,13 @@ int main(int argc, const char** argv)
             }
             break;
         }
+    case EncoderArguments::FILEFORMAT_PROPERTIES:
+        {
+            PropertiesEncoder encoder;
+            if (!encoder.write(arguments.getFilePath(), arguments.getOutputFilePath()))
+                return -1;
+            break;
+        }
    default:
         {
             LOG(1, "Error: Unsupported file format: %s\n", arguments.getFilePathPointer());
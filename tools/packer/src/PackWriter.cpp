@@ -0,0 +1,359 @@
+#include "PackWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+// Identifies a pack file.
+#define PACKFILE_MAGIC          "GPAK"
+
+// Version of the pack file format.
+#define PACKFILE_VERSION        1
+
+// Marks the end of a bucket.
+#define PACKFILE_NO_ENTRY       0xFFFFFFFF
+
+// Ways a file can be stored.
+#define PACKFILE_STORED         0
+#define PACKFILE_ZLIB           1
+
+// Size of the header, in bytes.
+#define PACKFILE_HEADER_SIZE    24
+
+// Alignment of the stored bytes of each file, in bytes.
+#define PACKFILE_ALIGNMENT      16
+
+namespace gameplay
+{
+
+static unsigned int hashName(const std::string& name)
+{
+    // FNV-1a, as in gameplay::PackFile.
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static std::string normalizeName(const std::string& path)
+{
+    std::string name(path);
+    std::replace(name.begin(), name.end(), '\\', '/');
+    while (name.compare(0, 2, "./") == 0)
+    {
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& data)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+
+    bool succeeded = fseek(file, 0, SEEK_END) == 0;
+    long int size = succeeded ? ftell(file) : -1;
+    succeeded = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+    if (succeeded)
+    {
+        data.resize((size_t)size);
+        succeeded = size == 0 || fread(&data[0], 1, (size_t)size, file) == (size_t)size;
+    }
+    fclose(file);
+    return succeeded;
+}
+
+static bool writeUnsignedInt(FILE* file, unsigned int value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool writeUnsignedLongLong(FILE* file, unsigned long long value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+bool PackWriter::Entry::operator<(const Entry& other) const
+{
+    return name < other.name;
+}
+
+PackWriter::PackWriter(bool compress)
+    : _compress(compress)
+{
+}
+
+PackWriter::~PackWriter()
+{
+}
+
+void PackWriter::addStoredExtension(const char* extension)
+{
+    std::string ext(extension);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    _storedExtensions.push_back(ext);
+}
+
+bool PackWriter::add(const char* path)
+{
+    std::string filePath(path);
+    while (filePath.size() > 1 && (filePath[filePath.size() - 1] == '/' || filePath[filePath.size() - 1] == '\\'))
+    {
+        filePath.erase(filePath.size() - 1);
+    }
+
+    struct stat s;
+    if (stat(filePath.c_str(), &s) != 0)
+    {
+        fprintf(stderr, "Error: File not found: %s\n", path);
+        return false;
+    }
+    if (s.st_mode & S_IFDIR)
+    {
+        return addDirectory(filePath);
+    }
+    addFile(filePath);
+    return true;
+}
+
+bool PackWriter::write(const char* path)
+{
+    // Do not pack the pack file itself when it is written in a directory being packed.
+    std::string outputName = normalizeName(path);
+    for (size_t i = _entries.size(); i-- > 0;)
+    {
+        if (_entries[i].name == outputName)
+            _entries.erase(_entries.begin() + i);
+    }
+
+    // Sort the files so a pack built from the same files is always the same.
+    std::sort(_entries.begin(), _entries.end());
+    for (size_t i = 1; i < _entries.size(); ++i)
+    {
+        if (_entries[i].name == _entries[i - 1].name)
+        {
+            fprintf(stderr, "Error: File added twice: %s\n", _entries[i].name.c_str());
+            return false;
+        }
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Failed to open %s for writing.\n", path);
+        return false;
+    }
+
+    // Leave room for the header, which is written once the directory offset is known.
+    static const unsigned char padding[PACKFILE_ALIGNMENT] = { 0 };
+    unsigned long long offset = PACKFILE_HEADER_SIZE;
+    bool succeeded = fwrite(padding, 1, PACKFILE_HEADER_SIZE, file) == PACKFILE_HEADER_SIZE;
+
+    unsigned long long totalSize = 0;
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> compressed;
+    for (size_t i = 0; succeeded && i < _entries.size(); ++i)
+    {
+        Entry& entry = _entries[i];
+        if (!readFile(entry.path, data))
+        {
+            fprintf(stderr, "Error: Failed to read %s\n", entry.path.c_str());
+            succeeded = false;
+            break;
+        }
+
+        unsigned int paddingSize = (unsigned int)((PACKFILE_ALIGNMENT - offset % PACKFILE_ALIGNMENT) % PACKFILE_ALIGNMENT);
+        succeeded = fwrite(padding, 1, paddingSize, file) == paddingSize;
+        offset += paddingSize;
+
+        entry.offset = offset;
+        entry.size = (unsigned int)data.size();
+        entry.storedSize = entry.size;
+        entry.compression = PACKFILE_STORED;
+        const std::vector<unsigned char>* stored = &data;
+
+        // Keep the compressed bytes only when they are smaller.
+        if (!data.empty() && shouldCompress(entry.name))
+        {
+            uLongf compressedSize = compressBound((uLong)data.size());
+            compressed.resize(compressedSize);
+            if (compress2(&compressed[0], &compressedSize, &data[0], (uLong)data.size(), Z_BEST_COMPRESSION) == Z_OK &&
+                compressedSize < data.size())
+            {
+                compressed.resize(compressedSize);
+                entry.storedSize = (unsigned int)compressedSize;
+                entry.compression = PACKFILE_ZLIB;
+                stored = &compressed;
+            }
+        }
+
+        if (succeeded && entry.storedSize > 0)
+        {
+            succeeded = fwrite(&(*stored)[0], 1, entry.storedSize, file) == entry.storedSize;
+        }
+        offset += entry.storedSize;
+        totalSize += entry.size;
+    }
+
+    // Chain the entries in power of two buckets, at least as many as there are files.
+    unsigned int entryCount = (unsigned int)_entries.size();
+    unsigned int bucketCount = 1;
+    while (bucketCount < entryCount)
+    {
+        bucketCount <<= 1;
+    }
+    std::vector<unsigned int> buckets(bucketCount, PACKFILE_NO_ENTRY);
+    for (unsigned int i = entryCount; i-- > 0;)
+    {
+        Entry& entry = _entries[i];
+        entry.hash = hashName(entry.name);
+        unsigned int& bucket = buckets[entry.hash & (bucketCount - 1)];
+        entry.next = bucket;
+        bucket = i;
+    }
+
+    unsigned long long directoryOffset = offset;
+    for (unsigned int i = 0; succeeded && i < bucketCount; ++i)
+    {
+        succeeded = writeUnsignedInt(file, buckets[i]);
+    }
+    unsigned int nameOffset = 0;
+    for (unsigned int i = 0; succeeded && i < entryCount; ++i)
+    {
+        const Entry& entry = _entries[i];
+        succeeded = writeUnsignedInt(file, entry.hash) &&
+            writeUnsignedInt(file, entry.next) &&
+            writeUnsignedInt(file, nameOffset) &&
+            writeUnsignedInt(file, (unsigned int)entry.name.size()) &&
+            writeUnsignedLongLong(file, entry.offset) &&
+            writeUnsignedInt(file, entry.size) &&
+            writeUnsignedInt(file, entry.storedSize) &&
+            writeUnsignedInt(file, entry.compression) &&
+            writeUnsignedInt(file, 0);
+        nameOffset += (unsigned int)entry.name.size() + 1;
+    }
+    for (unsigned int i = 0; succeeded && i < entryCount; ++i)
+    {
+        const std::string& name = _entries[i].name;
+        succeeded = fwrite(name.c_str(), 1, name.size() + 1, file) == name.size() + 1;
+    }
+
+    if (succeeded)
+    {
+        succeeded = fseek(file, 0, SEEK_SET) == 0 &&
+            fwrite(PACKFILE_MAGIC, 1, 4, file) == 4 &&
+            writeUnsignedInt(file, PACKFILE_VERSION) &&
+            writeUnsignedInt(file, entryCount) &&
+            writeUnsignedInt(file, bucketCount) &&
+            writeUnsignedLongLong(file, directoryOffset);
+    }
+    succeeded = fclose(file) == 0 && succeeded;
+
+    if (!succeeded)
+    {
+        fprintf(stderr, "Error: Failed to write %s\n", path);
+        remove(path);
+        return false;
+    }
+
+    fprintf(stderr, "Packed %u files (%llu bytes) into %s (%llu bytes).\n", entryCount, totalSize, path, directoryOffset);
+    return true;
+}
+
+bool PackWriter::addDirectory(const std::string& path)
+{
+    std::vector<std::string> names;
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((path + "/*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Error: Failed to list %s\n", path.c_str());
+        return false;
+    }
+    do
+    {
+        names.push_back(data.cFileName);
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Error: Failed to list %s\n", path.c_str());
+        return false;
+    }
+    struct dirent* dp;
+    while ((dp = readdir(dir)) != NULL)
+    {
+        names.push_back(dp->d_name);
+    }
+    closedir(dir);
+#endif
+
+    bool succeeded = true;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i] == "." || names[i] == "..")
+            continue;
+
+        std::string childPath = path == "." ? names[i] : path + "/" + names[i];
+        struct stat s;
+        if (stat(childPath.c_str(), &s) != 0)
+        {
+            succeeded = false;
+        }
+        else if (s.st_mode & S_IFDIR)
+        {
+            succeeded = addDirectory(childPath) && succeeded;
+        }
+        else
+        {
+            addFile(childPath);
+        }
+    }
+    return succeeded;
+}
+
+void PackWriter::addFile(const std::string& path)
+{
+    Entry entry;
+    entry.path = path;
+    entry.name = normalizeName(path);
+    entry.hash = 0;
+    entry.next = PACKFILE_NO_ENTRY;
+    entry.offset = 0;
+    entry.size = 0;
+    entry.storedSize = 0;
+    entry.compression = PACKFILE_STORED;
+    _entries.push_back(entry);
+}
+
+bool PackWriter::shouldCompress(const std::string& name) const
+{
+    if (!_compress)
+        return false;
+
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos || name.find('/', dot) != std::string::npos)
+        return true;
+
+    std::string ext = name.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return std::find(_storedExtensions.begin(), _storedExtensions.end(), ext) == _storedExtensions.end();
+}
+
+}
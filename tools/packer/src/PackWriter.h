@@ -0,0 +1,89 @@
+#ifndef PACKWRITER_H_
+#define PACKWRITER_H_
+
+#include <string>
+#include <vector>
+
+namespace gameplay
+{
+
+/**
+ * Writes a pack file, in the format read by gameplay::PackFile (see gameplay/src/PackFile.h).
+ */
+class PackWriter
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param compress Whether to compress files with zlib.
+     */
+    PackWriter(bool compress);
+
+    /**
+     * Destructor.
+     */
+    ~PackWriter();
+
+    /**
+     * Stores files with the given extension uncompressed, such as files that are already compressed.
+     *
+     * @param extension The extension, with its leading dot (".png").
+     */
+    void addStoredExtension(const char* extension);
+
+    /**
+     * Adds a file, or all the files of a directory and of its subdirectories.
+     *
+     * The files are named in the pack by their path, with '/' separators and without a
+     * leading "./", so the packer should be run from the resource path of the game.
+     *
+     * @param path The path of the file or directory.
+     *
+     * @return true if the files were found, false otherwise.
+     */
+    bool add(const char* path);
+
+    /**
+     * Writes the pack file.
+     *
+     * @param path The path of the pack file.
+     *
+     * @return true if the pack file was written, false otherwise.
+     */
+    bool write(const char* path);
+
+private:
+
+    /**
+     * A file to pack.
+     */
+    struct Entry
+    {
+        std::string path;                   // The path of the file on disk.
+        std::string name;                   // The path of the file in the pack.
+        unsigned int hash;                  // The hash of the name.
+        unsigned int next;                  // The next entry in the bucket.
+        unsigned long long offset;          // The offset of the stored bytes.
+        unsigned int size;                  // The size of the file.
+        unsigned int storedSize;            // The size of the stored bytes.
+        unsigned int compression;           // How the file is stored.
+
+        bool operator<(const Entry& other) const;
+    };
+
+    bool addDirectory(const std::string& path);
+
+    void addFile(const std::string& path);
+
+    bool shouldCompress(const std::string& name) const;
+
+    bool _compress;
+    std::vector<std::string> _storedExtensions;
+    std::vector<Entry> _entries;
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "PackWriter.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace gameplay;
+
+static void printUsage()
+{
+    fprintf(stderr, "Usage: gameplay-packer [options] <output file> <file or directory>...\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -z\t\tCompress files with zlib. Files that do not get smaller are stored as is.\n");
+    fprintf(stderr, "  -s <ext>\tStore files with the extension <ext> (such as .png) uncompressed.\n");
+    fprintf(stderr, "\nFiles are named in the pack by their path, so run the packer from the\n");
+    fprintf(stderr, "resource path of the game.\n");
+    fprintf(stderr, "example: gameplay-packer -z -s .png -s .ogg game.pak res game.config\n");
+}
+
+/**
+ * Main application entry point.
+ *
+ * @param argc The number of command line arguments
+ * @param argv The array of command line arguments.
+ */
+int main(int argc, const char** argv)
+{
+    bool compress = false;
+    std::vector<const char*> storedExtensions;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i)
+    {
+        if (strcmp(argv[i], "-z") == 0)
+        {
+            compress = true;
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            storedExtensions.push_back(argv[++i]);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+    if (argc - i < 2)
+    {
+        printUsage();
+        return -1;
+    }
+
+    PackWriter writer(compress);
+    for (size_t j = 0; j < storedExtensions.size(); ++j)
+    {
+        writer.addStoredExtension(storedExtensions[j]);
+    }
+
+    const char* outputPath = argv[i++];
+    for (; i < argc; ++i)
+    {
+        if (!writer.add(argv[i]))
+            return -1;
+    }
+    return writer.write(outputPath) ? 0 : -1;
+}